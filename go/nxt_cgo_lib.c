@@ -73,6 +73,75 @@ nxt_cgo_response_write(nxt_unit_request_info_t *req, uintptr_t start,
 }
 
 
+ssize_t
+nxt_cgo_response_flush(nxt_unit_request_info_t *req, uint16_t status,
+    uintptr_t fields, uint32_t *lens, uint32_t fields_count,
+    uint32_t fields_size, uintptr_t body, uint32_t body_len, int last)
+{
+    int       rc;
+    char      *p;
+    ssize_t   res;
+    uint32_t  i;
+
+    if (nxt_unit_response_is_sent(req)) {
+        res = 0;
+
+        if (body_len > 0) {
+            res = nxt_unit_response_write_nb(req, (void *) body, body_len, 0);
+            if (res < 0) {
+                return -1;
+            }
+        }
+
+        if (last && res == (ssize_t) body_len) {
+            nxt_unit_request_done(req, NXT_UNIT_OK);
+        }
+
+        return res;
+    }
+
+    /* Reserve space to piggyback the body on the header buffer. */
+    rc = nxt_unit_response_init(req, status, fields_count,
+                                fields_size + body_len);
+    if (rc != NXT_UNIT_OK) {
+        return -1;
+    }
+
+    p = (char *) fields;
+
+    for (i = 0; i < fields_count; i++) {
+        rc = nxt_unit_response_add_field(req, p, lens[0], p + lens[0],
+                                         lens[1]);
+        if (rc != NXT_UNIT_OK) {
+            return -1;
+        }
+
+        p += lens[0] + lens[1];
+        lens += 2;
+    }
+
+    if (body_len > 0) {
+        rc = nxt_unit_response_add_content(req, (void *) body, body_len);
+        if (rc != NXT_UNIT_OK) {
+            return -1;
+        }
+    }
+
+    if (last) {
+        nxt_unit_request_done(req, NXT_UNIT_OK);
+
+        return body_len;
+    }
+
+    rc = nxt_unit_response_send(req);
+    if (rc != NXT_UNIT_OK) {
+        return -1;
+    }
+
+    return body_len;
+}
+
+
 ssize_t
 nxt_cgo_request_read(nxt_unit_request_info_t *req, uintptr_t dst,
     uint32_t dst_len)
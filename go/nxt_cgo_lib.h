@@ -23,6 +23,10 @@ int nxt_cgo_run(uintptr_t handler);
 ssize_t nxt_cgo_response_write(nxt_unit_request_info_t *req,
     uintptr_t src, uint32_t len);
 
+ssize_t nxt_cgo_response_flush(nxt_unit_request_info_t *req, uint16_t status,
+    uintptr_t fields, uint32_t *lens, uint32_t fields_count,
+    uint32_t fields_size, uintptr_t body, uint32_t body_len, int last);
+
 ssize_t nxt_cgo_request_read(nxt_unit_request_info_t *req,
     uintptr_t dst, uint32_t dst_len);
 
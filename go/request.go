@@ -25,7 +25,33 @@ type request struct {
 }
 
 func (r *request) Read(p []byte) (n int, err error) {
-	res := C.nxt_cgo_request_read(r.c_req, buf_ref(p), C.uint32_t(len(p)))
+	c_req := r.c_req
+	b := c_req.content_buf
+
+	/*
+	 * Body data already mapped into the process is copied without
+	 * crossing into C; libunit is called only to switch to the next
+	 * buffer or to read from the body file.
+	 */
+	if b != nil && len(p) > 0 {
+		start := uintptr(unsafe.Pointer(b.free))
+		size := int(uintptr(unsafe.Pointer(b.end)) - start)
+
+		if uint64(size) > uint64(c_req.content_length) {
+			size = int(c_req.content_length)
+		}
+
+		if size > 0 {
+			n = copy(p, GoBytes(unsafe.Pointer(b.free), C.int(size)))
+
+			b.free = (*C.char)(unsafe.Pointer(start + uintptr(n)))
+			c_req.content_length -= C.uint64_t(n)
+
+			return n, nil
+		}
+	}
+
+	res := C.nxt_cgo_request_read(c_req, buf_ref(p), C.uint32_t(len(p)))
 
 	if res == 0 && len(p) > 0 {
 		return 0, io.EOF
@@ -116,11 +142,11 @@ func nxt_go_request_handler(c_req *C.nxt_unit_request_info_t) {
 			if err == nil {
 				handler.ServeHTTP(&r.resp, &r.req)
 
-				if !r.resp.header_sent {
+				if r.resp.status == 0 {
 					r.resp.WriteHeader(http.StatusOK)
 				}
 
-				C.nxt_unit_request_done(c_req, C.NXT_UNIT_OK)
+				r.resp.flush(true)
 
 			} else {
 				C.nxt_unit_request_done(c_req, C.NXT_UNIT_ERROR)
@@ -14,11 +14,21 @@ import (
 	"net/http"
 )
 
+/*
+ * Header fields and small body writes are kept in Go memory until Flush()
+ * or handler return and then passed to libunit in a single cgo call.
+ * The limit matches the shared memory chunk size, so a small response
+ * goes to the router as one port message.
+ */
+const resp_buf_size = 16384
+
 type response struct {
-	header     http.Header
+	header      http.Header
 	header_sent bool
-	c_req      *C.nxt_unit_request_info_t
-	ch         chan int
+	status      int
+	buf         []byte
+	c_req       *C.nxt_unit_request_info_t
+	ch          chan int
 }
 
 func (r *response) Header() http.Header {
@@ -26,11 +36,20 @@ func (r *response) Header() http.Header {
 }
 
 func (r *response) Write(p []byte) (n int, err error) {
-	if !r.header_sent {
+	if r.status == 0 {
 		r.WriteHeader(http.StatusOK)
 	}
 
 	l := len(p)
+
+	if len(r.buf) + l <= resp_buf_size {
+		r.buf = append(r.buf, p...)
+
+		return l, nil
+	}
+
+	r.flush(false)
+
 	written := int(0)
 	br := buf_ref(p)
 
@@ -41,11 +60,7 @@ func (r *response) Write(p []byte) (n int, err error) {
 		br += C.uintptr_t(res)
 
 		if (written < l) {
-			if r.ch == nil {
-				r.ch = make(chan int, 2)
-			}
-
-			wait_shm_ack(r.ch)
+			r.wait()
 		}
 	}
 
@@ -53,10 +68,43 @@ func (r *response) Write(p []byte) (n int, err error) {
 }
 
 func (r *response) WriteHeader(code int) {
-	if r.header_sent {
+	if r.status != 0 {
 		nxt_go_warn("multiple response.WriteHeader calls")
 		return
 	}
+
+	r.status = code
+}
+
+func (r *response) Flush() {
+	if r.status == 0 {
+		r.WriteHeader(http.StatusOK)
+	}
+
+	r.flush(false)
+}
+
+/*
+ * Sends header (once) and buffered body.  If 'last' is set, the request
+ * is completed within the same cgo call.
+ */
+func (r *response) flush(last bool) {
+	var c_last C.int
+
+	if last {
+		c_last = 1
+
+	} else if r.header_sent && len(r.buf) == 0 {
+		return
+	}
+
+	if r.header_sent {
+		r.send(C.nxt_cgo_response_flush(r.c_req, 0, 0, nil, 0, 0,
+			buf_ref(r.buf), C.uint32_t(len(r.buf)), c_last), last)
+
+		return
+	}
+
 	r.header_sent = true
 
 	// Set a default Content-Type
@@ -74,23 +122,75 @@ func (r *response) WriteHeader(code int) {
 		}
 	}
 
-	C.nxt_unit_response_init(r.c_req, C.uint16_t(code), C.uint32_t(fields),
-		C.uint32_t(fields_size))
+	names := make([]byte, 0, fields_size)
+	lens := make([]C.uint32_t, 0, fields * 2 + 1)
 
 	for k, vv := range r.header {
 		for _, v := range vv {
-			C.nxt_unit_response_add_field(r.c_req, str_ref(k), C.uint8_t(len(k)),
-				str_ref(v), C.uint32_t(len(v)))
+			names = append(names, k...)
+			names = append(names, v...)
+			lens = append(lens, C.uint32_t(len(k)), C.uint32_t(len(v)))
 		}
 	}
 
-	C.nxt_unit_response_send(r.c_req)
+	lens = append(lens, 0)
+
+	r.send(C.nxt_cgo_response_flush(r.c_req, C.uint16_t(r.status),
+		buf_ref(names), &lens[0], C.uint32_t(fields),
+		C.uint32_t(fields_size), buf_ref(r.buf), C.uint32_t(len(r.buf)),
+		c_last), last)
 }
 
-func (r *response) Flush() {
-	if !r.header_sent {
-		r.WriteHeader(http.StatusOK)
+func (r *response) send(res C.ssize_t, last bool) {
+	l := len(r.buf)
+	br := buf_ref(r.buf)
+
+	r.buf = r.buf[:0]
+
+	if res < 0 {
+		if last {
+			C.nxt_unit_request_done(r.c_req, C.NXT_UNIT_ERROR)
+		}
+
+		return
 	}
+
+	written := int(res)
+
+	/* The request is already completed by libunit. */
+	if written == l {
+		return
+	}
+
+	/* Out of shared memory: write the rest once the router frees some. */
+	for written < l {
+		r.wait()
+
+		res = C.nxt_cgo_response_write(r.c_req, br + C.uintptr_t(written),
+			C.uint32_t(l - written))
+		if res < 0 {
+			break
+		}
+
+		written += int(res)
+	}
+
+	if last {
+		if res < 0 {
+			C.nxt_unit_request_done(r.c_req, C.NXT_UNIT_ERROR)
+
+		} else {
+			C.nxt_unit_request_done(r.c_req, C.NXT_UNIT_OK)
+		}
+	}
+}
+
+func (r *response) wait() {
+	if r.ch == nil {
+		r.ch = make(chan int, 2)
+	}
+
+	wait_shm_ack(r.ch)
 }
 
 var observer_registry_ observable
@@ -48,6 +48,8 @@ static nxt_conf_value_t *nxt_cert_name_details(nxt_mp_t *mp, X509 *x509,
     nxt_bool_t issuer);
 static nxt_conf_value_t *nxt_cert_alt_names_details(nxt_mp_t *mp,
     STACK_OF(GENERAL_NAME) *alt_names);
+static void nxt_cert_request(nxt_task_t *task, nxt_uint_t type,
+    nxt_str_t *name, nxt_mp_t *mp, nxt_port_rpc_handler_t handler, void *ctx);
 static void nxt_cert_buf_completion(nxt_task_t *task, void *obj, void *data);
 
 
@@ -1061,6 +1063,14 @@ nxt_cert_store_discovery_handler(nxt_task_t *task, nxt_port_recv_msg_t *msg)
 void
 nxt_cert_store_get(nxt_task_t *task, nxt_str_t *name, nxt_mp_t *mp,
     nxt_port_rpc_handler_t handler, void *ctx)
+{
+    nxt_cert_request(task, NXT_PORT_MSG_CERT_GET, name, mp, handler, ctx);
+}
+
+
+static void
+nxt_cert_request(nxt_task_t *task, nxt_uint_t type, nxt_str_t *name,
+    nxt_mp_t *mp, nxt_port_rpc_handler_t handler, void *ctx)
 {
     uint32_t       stream;
     nxt_int_t      ret;
@@ -1089,8 +1099,8 @@ nxt_cert_store_get(nxt_task_t *task, nxt_str_t *name, nxt_mp_t *mp,
         goto fail;
     }
 
-    ret = nxt_port_socket_write(task, main_port, NXT_PORT_MSG_CERT_GET, -1,
-                                stream, recv_port->id, b);
+    ret = nxt_port_socket_write(task, main_port, type, -1, stream,
+                                recv_port->id, b);
 
     if (nxt_slow_path(ret != NXT_OK)) {
         nxt_port_rpc_cancel(task, recv_port, stream);
@@ -1252,3 +1262,110 @@ nxt_cert_store_delete_handler(nxt_task_t *task, nxt_port_recv_msg_t *msg)
         nxt_free(path);
     }
 }
+
+
+void
+nxt_cert_ocsp_get(nxt_task_t *task, nxt_str_t *path, nxt_mp_t *mp,
+    nxt_port_rpc_handler_t handler, void *ctx)
+{
+    nxt_cert_request(task, NXT_PORT_MSG_OCSP_GET, path, mp, handler, ctx);
+}
+
+
+/*
+ * OCSP responses are read by the main process, so the files may be
+ * accessible to the privileged user only.  A response is a single
+ * DER encoded structure, usually a few kilobytes long.
+ */
+
+#define NXT_CERT_OCSP_MAX_SIZE  (64 * 1024)
+
+
+void
+nxt_cert_ocsp_get_handler(nxt_task_t *task, nxt_port_recv_msg_t *msg)
+{
+    ssize_t              n;
+    nxt_off_t            size;
+    nxt_buf_t            *b;
+    nxt_file_t           file;
+    nxt_port_t           *port, *router_port;
+    nxt_runtime_t        *rt;
+    nxt_file_info_t      fi;
+    nxt_port_msg_type_t  type;
+
+    rt = task->thread->runtime;
+
+    port = nxt_runtime_port_find(rt, msg->port_msg.pid,
+                                 msg->port_msg.reply_port);
+
+    if (nxt_slow_path(port == NULL)) {
+        nxt_alert(task, "process port not found (pid %PI, reply_port %d)",
+                  msg->port_msg.pid, msg->port_msg.reply_port);
+        return;
+    }
+
+    router_port = rt->port_by_type[NXT_PROCESS_ROUTER];
+
+    if (nxt_slow_path(router_port == NULL
+                      || nxt_recv_msg_cmsg_pid(msg) != router_port->pid))
+    {
+        nxt_alert(task, "process %PI cannot read OCSP responses",
+                  nxt_recv_msg_cmsg_pid(msg));
+        return;
+    }
+
+    b = NULL;
+    type = NXT_PORT_MSG_RPC_ERROR;
+
+    nxt_memzero(&file, sizeof(nxt_file_t));
+
+    file.name = (nxt_file_name_t *) msg->buf->mem.pos;
+    file.log_level = NXT_LOG_ERR;
+
+    if (nxt_file_open(task, &file, NXT_FILE_RDONLY, NXT_FILE_OPEN, 0)
+        != NXT_OK)
+    {
+        goto error;
+    }
+
+    if (nxt_file_info(&file, &fi) != NXT_OK) {
+        goto close;
+    }
+
+    size = nxt_file_size(&fi);
+
+    if (!nxt_is_file(&fi) || size == 0 || size > NXT_CERT_OCSP_MAX_SIZE) {
+        nxt_log(task, NXT_LOG_ERR, "OCSP response \"%FN\" has invalid size",
+                file.name);
+        goto close;
+    }
+
+    b = nxt_buf_mem_alloc(port->mem_pool, size, 0);
+    if (nxt_slow_path(b == NULL)) {
+        goto close;
+    }
+
+    n = nxt_file_read(&file, b->mem.free, size, 0);
+
+    if (n != size) {
+        nxt_log(task, NXT_LOG_ERR, "OCSP response \"%FN\" read failed",
+                file.name);
+
+        nxt_mp_free(port->mem_pool, b);
+        b = NULL;
+
+        goto close;
+    }
+
+    b->mem.free += n;
+    type = NXT_PORT_MSG_RPC_READY_LAST;
+
+close:
+
+    nxt_file_close(task, &file);
+
+error:
+
+    (void) nxt_port_socket_write(task, port, type, -1, msg->port_msg.stream,
+                                 0, b);
+}
@@ -131,6 +131,29 @@
 #endif
 
 
+#if (NXT_HAVE_BUILTIN_CTZ)
+
+#define nxt_ctz            __builtin_ctz
+
+#else
+
+/* The argument must not be zero. */
+
+nxt_inline int
+nxt_ctz(unsigned int x)
+{
+    int  n;
+
+    for (n = 0; (x & 1) == 0; n++) {
+        x >>= 1;
+    }
+
+    return n;
+}
+
+#endif
+
+
 #if (NXT_HAVE_BUILTIN_POPCOUNT)
 
 #define nxt_popcount       __builtin_popcount
@@ -18,6 +18,9 @@
 
 #define NXT_CONF_MAX_TOKEN_LEN     256
 
+/* Objects with more members are checked for duplicates using a hash. */
+#define NXT_CONF_JSON_HASH_MIN     16
+
 
 typedef enum {
     NXT_CONF_VALUE_NULL = 0,
@@ -78,6 +81,18 @@ typedef struct {
 } nxt_conf_object_member_t;
 
 
+/*
+ * Members and elements of all objects and arrays being parsed are kept
+ * in a single stack until the enclosing container is complete, and then
+ * are copied to the container of the exact size.
+ */
+
+typedef struct {
+    nxt_conf_object_member_t  member;
+    u_char                    *pos;
+} nxt_conf_json_member_t;
+
+
 struct nxt_conf_object_s {
     nxt_uint_t                count;
     nxt_conf_object_member_t  members[];
@@ -103,18 +118,23 @@ static nxt_int_t nxt_conf_path_next_token(nxt_conf_path_parse_t *parse,
     nxt_str_t *token);
 
 static u_char *nxt_conf_json_skip_space(u_char *start, const u_char *end);
-static u_char *nxt_conf_json_parse_value(nxt_mp_t *mp, nxt_conf_value_t *value,
-    u_char *start, u_char *end, nxt_conf_json_error_t *error);
-static u_char *nxt_conf_json_parse_object(nxt_mp_t *mp, nxt_conf_value_t *value,
-    u_char *start, u_char *end, nxt_conf_json_error_t *error);
+static u_char *nxt_conf_json_parse_value(nxt_mp_t *mp, nxt_array_t *stack,
+    nxt_conf_value_t *value, u_char *start, u_char *end,
+    nxt_conf_json_error_t *error);
+static u_char *nxt_conf_json_parse_object(nxt_mp_t *mp, nxt_array_t *stack,
+    nxt_conf_value_t *value, u_char *start, u_char *end,
+    nxt_conf_json_error_t *error);
+static nxt_int_t nxt_conf_json_object_unique(nxt_mp_t *mp,
+    nxt_conf_object_t *object, nxt_uint_t *dup);
 static nxt_int_t nxt_conf_object_hash_add(nxt_mp_t *mp,
     nxt_lvlhsh_t *lvlhsh, nxt_conf_object_member_t *member);
 static nxt_int_t nxt_conf_object_hash_test(nxt_lvlhsh_query_t *lhq,
     void *data);
 static void *nxt_conf_object_hash_alloc(void *data, size_t size);
 static void nxt_conf_object_hash_free(void *data, void *p);
-static u_char *nxt_conf_json_parse_array(nxt_mp_t *mp, nxt_conf_value_t *value,
-    u_char *start, u_char *end, nxt_conf_json_error_t *error);
+static u_char *nxt_conf_json_parse_array(nxt_mp_t *mp, nxt_array_t *stack,
+    nxt_conf_value_t *value, u_char *start, u_char *end,
+    nxt_conf_json_error_t *error);
 static u_char *nxt_conf_json_parse_string(nxt_mp_t *mp, nxt_conf_value_t *value,
     u_char *start, u_char *end, nxt_conf_json_error_t *error);
 static u_char *nxt_conf_json_parse_number(nxt_mp_t *mp, nxt_conf_value_t *value,
@@ -1238,11 +1258,136 @@ nxt_conf_copy_object(nxt_mp_t *mp, nxt_conf_op_t *op, nxt_conf_value_t *dst,
 }
 
 
+/*
+ * Applies the compiled operation to the value in place.  The value must
+ * be allocated from the pool, as its array or object is reallocated there
+ * to create an element or a member.  Values of the operation are linked
+ * without copying, so they must be allocated from the pool too.
+ */
+
+nxt_int_t
+nxt_conf_op_apply(nxt_mp_t *mp, nxt_conf_op_t *op, nxt_conf_value_t *value)
+{
+    size_t                    size;
+    nxt_int_t                 rc;
+    nxt_uint_t                n;
+    nxt_conf_array_t          *array;
+    nxt_conf_value_t          *elements;
+    nxt_conf_object_t         *object;
+    nxt_conf_object_member_t  *member;
+
+    while (op->action == NXT_CONF_OP_PASS) {
+
+        if (value->type == NXT_CONF_VALUE_ARRAY) {
+            value = &value->u.array->elements[op->index];
+
+        } else {
+            value = &value->u.object->members[op->index].value;
+        }
+
+        op = op->ctx;
+    }
+
+    if (value->type == NXT_CONF_VALUE_ARRAY) {
+        array = value->u.array;
+        n = array->count - op->index;
+
+        switch (op->action) {
+
+        case NXT_CONF_OP_CREATE:
+            size = sizeof(nxt_conf_array_t)
+                   + (array->count + 1) * sizeof(nxt_conf_value_t);
+
+            value->u.array = nxt_mp_get(mp, size);
+            if (nxt_slow_path(value->u.array == NULL)) {
+                return NXT_ERROR;
+            }
+
+            value->u.array->count = array->count + 1;
+            elements = value->u.array->elements;
+
+            nxt_memcpy(elements, array->elements,
+                       op->index * sizeof(nxt_conf_value_t));
+
+            elements[op->index] = *(nxt_conf_value_t *) op->ctx;
+
+            nxt_memcpy(&elements[op->index + 1],
+                       &array->elements[op->index],
+                       n * sizeof(nxt_conf_value_t));
+            break;
+
+        case NXT_CONF_OP_REPLACE:
+            array->elements[op->index] = *(nxt_conf_value_t *) op->ctx;
+            break;
+
+        case NXT_CONF_OP_DELETE:
+            nxt_memmove(&array->elements[op->index],
+                        &array->elements[op->index + 1],
+                        (n - 1) * sizeof(nxt_conf_value_t));
+
+            array->count--;
+            break;
+        }
+
+        return NXT_OK;
+    }
+
+    object = value->u.object;
+    n = object->count - op->index;
+
+    switch (op->action) {
+
+    case NXT_CONF_OP_CREATE:
+        size = sizeof(nxt_conf_object_t)
+               + (object->count + 1) * sizeof(nxt_conf_object_member_t);
+
+        value->u.object = nxt_mp_get(mp, size);
+        if (nxt_slow_path(value->u.object == NULL)) {
+            return NXT_ERROR;
+        }
+
+        value->u.object->count = object->count + 1;
+
+        nxt_memcpy(value->u.object->members, object->members,
+                   object->count * sizeof(nxt_conf_object_member_t));
+
+        member = op->ctx;
+
+        rc = nxt_conf_copy_value(mp, NULL,
+                                 &value->u.object->members[op->index].name,
+                                 &member->name);
+
+        if (nxt_slow_path(rc != NXT_OK)) {
+            return NXT_ERROR;
+        }
+
+        value->u.object->members[op->index].value = member->value;
+        break;
+
+    case NXT_CONF_OP_REPLACE:
+        object->members[op->index].value = *(nxt_conf_value_t *) op->ctx;
+        break;
+
+    case NXT_CONF_OP_DELETE:
+        nxt_memmove(&object->members[op->index],
+                    &object->members[op->index + 1],
+                    (n - 1) * sizeof(nxt_conf_object_member_t));
+
+        object->count--;
+        break;
+    }
+
+    return NXT_OK;
+}
+
+
 nxt_conf_value_t *
 nxt_conf_json_parse(nxt_mp_t *mp, u_char *start, u_char *end,
     nxt_conf_json_error_t *error)
 {
     u_char            *p;
+    nxt_mp_t          *mp_temp;
+    nxt_array_t       *stack;
     nxt_conf_value_t  *value;
 
     value = nxt_mp_get(mp, sizeof(nxt_conf_value_t));
@@ -1263,10 +1408,20 @@ nxt_conf_json_parse(nxt_mp_t *mp, u_char *start, u_char *end,
         return NULL;
     }
 
-    p = nxt_conf_json_parse_value(mp, value, p, end, error);
+    mp_temp = nxt_mp_create(1024, 128, 256, 32);
+    if (nxt_slow_path(mp_temp == NULL)) {
+        return NULL;
+    }
+
+    stack = nxt_array_create(mp_temp, 64, sizeof(nxt_conf_json_member_t));
+    if (nxt_slow_path(stack == NULL)) {
+        goto fail;
+    }
+
+    p = nxt_conf_json_parse_value(mp, stack, value, p, end, error);
 
     if (nxt_slow_path(p == NULL)) {
-        return NULL;
+        goto fail;
     }
 
     p = nxt_conf_json_skip_space(p, end);
@@ -1277,10 +1432,18 @@ nxt_conf_json_parse(nxt_mp_t *mp, u_char *start, u_char *end,
             "Unexpected character after the end of a valid JSON value."
         );
 
-        return NULL;
+        goto fail;
     }
 
+    nxt_mp_destroy(mp_temp);
+
     return value;
+
+fail:
+
+    nxt_mp_destroy(mp_temp);
+
+    return NULL;
 }
 
 
@@ -1297,6 +1460,10 @@ nxt_conf_json_skip_space(u_char *start, const u_char *end)
         sw_after_asterisk,
     } state;
 
+    if (nxt_fast_path(start != end && *start > ' ' && *start != '/')) {
+        return start;
+    }
+
     state = sw_normal;
 
     for (p = start; nxt_fast_path(p != end); p++) {
@@ -1370,8 +1537,9 @@ nxt_conf_json_skip_space(u_char *start, const u_char *end)
 
 
 static u_char *
-nxt_conf_json_parse_value(nxt_mp_t *mp, nxt_conf_value_t *value, u_char *start,
-    u_char *end, nxt_conf_json_error_t *error)
+nxt_conf_json_parse_value(nxt_mp_t *mp, nxt_array_t *stack,
+    nxt_conf_value_t *value, u_char *start, u_char *end,
+    nxt_conf_json_error_t *error)
 {
     u_char  ch, *p;
 
@@ -1379,10 +1547,10 @@ nxt_conf_json_parse_value(nxt_mp_t *mp, nxt_conf_value_t *value, u_char *start,
 
     switch (ch) {
     case '{':
-        return nxt_conf_json_parse_object(mp, value, start, end, error);
+        return nxt_conf_json_parse_object(mp, stack, value, start, end, error);
 
     case '[':
-        return nxt_conf_json_parse_array(mp, value, start, end, error);
+        return nxt_conf_json_parse_array(mp, stack, value, start, end, error);
 
     case '"':
         return nxt_conf_json_parse_string(mp, value, start, end, error);
@@ -1480,26 +1648,18 @@ static const nxt_lvlhsh_proto_t  nxt_conf_object_hash_proto
 
 
 static u_char *
-nxt_conf_json_parse_object(nxt_mp_t *mp, nxt_conf_value_t *value, u_char *start,
-    u_char *end, nxt_conf_json_error_t *error)
+nxt_conf_json_parse_object(nxt_mp_t *mp, nxt_array_t *stack,
+    nxt_conf_value_t *value, u_char *start, u_char *end,
+    nxt_conf_json_error_t *error)
 {
     u_char                    *p, *name;
-    nxt_mp_t                  *mp_temp;
     nxt_int_t                 rc;
-    nxt_uint_t                count;
-    nxt_lvlhsh_t              hash;
-    nxt_lvlhsh_each_t         lhe;
+    nxt_uint_t                i, n, base, count;
     nxt_conf_object_t         *object;
-    nxt_conf_object_member_t  *member, *element;
+    nxt_conf_json_member_t    *elts, *elt;
+    nxt_conf_object_member_t  member;
 
-    mp_temp = nxt_mp_create(1024, 128, 256, 32);
-    if (nxt_slow_path(mp_temp == NULL)) {
-        return NULL;
-    }
-
-    nxt_lvlhsh_init(&hash);
-
-    count = 0;
+    base = stack->nelts;
     p = start;
 
     for ( ;; ) {
@@ -1531,33 +1691,12 @@ nxt_conf_json_parse_object(nxt_mp_t *mp, nxt_conf_value_t *value, u_char *start,
 
         name = p;
 
-        count++;
-
-        member = nxt_mp_get(mp_temp, sizeof(nxt_conf_object_member_t));
-        if (nxt_slow_path(member == NULL)) {
-            goto error;
-        }
-
-        p = nxt_conf_json_parse_string(mp, &member->name, p, end, error);
+        p = nxt_conf_json_parse_string(mp, &member.name, p, end, error);
 
         if (nxt_slow_path(p == NULL)) {
             goto error;
         }
 
-        rc = nxt_conf_object_hash_add(mp_temp, &hash, member);
-
-        if (nxt_slow_path(rc != NXT_OK)) {
-
-            if (rc == NXT_DECLINED) {
-                nxt_conf_json_parse_error(error, name,
-                    "Duplicate object member.  All JSON object members must "
-                    "have unique names."
-                );
-            }
-
-            goto error;
-        }
-
         p = nxt_conf_json_skip_space(p, end);
 
         if (nxt_slow_path(p == end)) {
@@ -1592,12 +1731,20 @@ nxt_conf_json_parse_object(nxt_mp_t *mp, nxt_conf_value_t *value, u_char *start,
             goto error;
         }
 
-        p = nxt_conf_json_parse_value(mp, &member->value, p, end, error);
+        p = nxt_conf_json_parse_value(mp, stack, &member.value, p, end, error);
 
         if (nxt_slow_path(p == NULL)) {
             goto error;
         }
 
+        elt = nxt_array_add(stack);
+        if (nxt_slow_path(elt == NULL)) {
+            goto error;
+        }
+
+        elt->member = member;
+        elt->pos = name;
+
         p = nxt_conf_json_skip_space(p, end);
 
         if (nxt_slow_path(p == end)) {
@@ -1625,6 +1772,8 @@ nxt_conf_json_parse_object(nxt_mp_t *mp, nxt_conf_value_t *value, u_char *start,
         }
     }
 
+    count = stack->nelts - base;
+
     object = nxt_mp_get(mp, sizeof(nxt_conf_object_t)
                             + count * sizeof(nxt_conf_object_member_t));
     if (nxt_slow_path(object == NULL)) {
@@ -1635,31 +1784,89 @@ nxt_conf_json_parse_object(nxt_mp_t *mp, nxt_conf_value_t *value, u_char *start,
     value->type = NXT_CONF_VALUE_OBJECT;
 
     object->count = count;
-    member = object->members;
 
-    nxt_lvlhsh_each_init(&lhe, &nxt_conf_object_hash_proto);
+    elts = stack->elts;
 
-    for ( ;; ) {
-        element = nxt_lvlhsh_each(&hash, &lhe);
+    for (i = 0; i < count; i++) {
+        object->members[i] = elts[base + i].member;
+    }
 
-        if (element == NULL) {
-            break;
+    rc = nxt_conf_json_object_unique(stack->mem_pool, object, &n);
+
+    if (nxt_slow_path(rc != NXT_OK)) {
+
+        if (rc == NXT_DECLINED) {
+            nxt_conf_json_parse_error(error, elts[base + n].pos,
+                "Duplicate object member.  All JSON object members must "
+                "have unique names."
+            );
         }
 
-        *member++ = *element;
+        goto error;
     }
 
-    nxt_mp_destroy(mp_temp);
+    stack->nelts = base;
 
     return p + 1;
 
 error:
 
-    nxt_mp_destroy(mp_temp);
+    stack->nelts = base;
+
     return NULL;
 }
 
 
+static nxt_int_t
+nxt_conf_json_object_unique(nxt_mp_t *mp, nxt_conf_object_t *object,
+    nxt_uint_t *dup)
+{
+    nxt_int_t     rc;
+    nxt_str_t     name, str;
+    nxt_uint_t    i, j;
+    nxt_lvlhsh_t  hash;
+
+    if (object->count <= NXT_CONF_JSON_HASH_MIN) {
+
+        for (i = 1; i < object->count; i++) {
+            nxt_conf_get_string(&object->members[i].name, &name);
+
+            for (j = 0; j < i; j++) {
+                nxt_conf_get_string(&object->members[j].name, &str);
+
+                if (nxt_strstr_eq(&name, &str)) {
+                    *dup = i;
+                    return NXT_DECLINED;
+                }
+            }
+        }
+
+        return NXT_OK;
+    }
+
+    nxt_lvlhsh_init(&hash);
+
+    for (i = 0; i < object->count; i++) {
+        rc = nxt_conf_object_hash_add(mp, &hash, &object->members[i]);
+
+        if (nxt_slow_path(rc != NXT_OK)) {
+            *dup = i;
+            break;
+        }
+    }
+
+    /* Release the hash memory for the next objects. */
+
+    while (nxt_lvlhsh_retrieve(&hash, &nxt_conf_object_hash_proto, mp)
+           != NULL)
+    {
+        /* void */
+    }
+
+    return (i == object->count) ? NXT_OK : rc;
+}
+
+
 static nxt_int_t
 nxt_conf_object_hash_add(nxt_mp_t *mp, nxt_lvlhsh_t *lvlhsh,
     nxt_conf_object_member_t *member)
@@ -1707,27 +1914,17 @@ nxt_conf_object_hash_free(void *data, void *p)
 
 
 static u_char *
-nxt_conf_json_parse_array(nxt_mp_t *mp, nxt_conf_value_t *value, u_char *start,
-    u_char *end, nxt_conf_json_error_t *error)
+nxt_conf_json_parse_array(nxt_mp_t *mp, nxt_array_t *stack,
+    nxt_conf_value_t *value, u_char *start, u_char *end,
+    nxt_conf_json_error_t *error)
 {
-    u_char            *p;
-    nxt_mp_t          *mp_temp;
-    nxt_uint_t        count;
-    nxt_list_t        *list;
-    nxt_conf_array_t  *array;
-    nxt_conf_value_t  *element;
-
-    mp_temp = nxt_mp_create(1024, 128, 256, 32);
-    if (nxt_slow_path(mp_temp == NULL)) {
-        return NULL;
-    }
-
-    list = nxt_list_create(mp_temp, 8, sizeof(nxt_conf_value_t));
-    if (nxt_slow_path(list == NULL)) {
-        goto error;
-    }
+    u_char                  *p;
+    nxt_uint_t              i, base, count;
+    nxt_conf_array_t        *array;
+    nxt_conf_value_t        element;
+    nxt_conf_json_member_t  *elts, *elt;
 
-    count = 0;
+    base = stack->nelts;
     p = start;
 
     for ( ;; ) {
@@ -1747,19 +1944,19 @@ nxt_conf_json_parse_array(nxt_mp_t *mp, nxt_conf_value_t *value, u_char *start,
             break;
         }
 
-        count++;
+        p = nxt_conf_json_parse_value(mp, stack, &element, p, end, error);
 
-        element = nxt_list_add(list);
-        if (nxt_slow_path(element == NULL)) {
+        if (nxt_slow_path(p == NULL)) {
             goto error;
         }
 
-        p = nxt_conf_json_parse_value(mp, element, p, end, error);
-
-        if (nxt_slow_path(p == NULL)) {
+        elt = nxt_array_add(stack);
+        if (nxt_slow_path(elt == NULL)) {
             goto error;
         }
 
+        elt->member.value = element;
+
         p = nxt_conf_json_skip_space(p, end);
 
         if (nxt_slow_path(p == end)) {
@@ -1787,6 +1984,8 @@ nxt_conf_json_parse_array(nxt_mp_t *mp, nxt_conf_value_t *value, u_char *start,
         }
     }
 
+    count = stack->nelts - base;
+
     array = nxt_mp_get(mp, sizeof(nxt_conf_array_t)
                            + count * sizeof(nxt_conf_value_t));
     if (nxt_slow_path(array == NULL)) {
@@ -1797,19 +1996,21 @@ nxt_conf_json_parse_array(nxt_mp_t *mp, nxt_conf_value_t *value, u_char *start,
     value->type = NXT_CONF_VALUE_ARRAY;
 
     array->count = count;
-    element = array->elements;
 
-    nxt_list_each(value, list) {
-        *element++ = *value;
-    } nxt_list_loop;
+    elts = stack->elts;
 
-    nxt_mp_destroy(mp_temp);
+    for (i = 0; i < count; i++) {
+        array->elements[i] = elts[base + i].member.value;
+    }
+
+    stack->nelts = base;
 
     return p + 1;
 
 error:
 
-    nxt_mp_destroy(mp_temp);
+    stack->nelts = base;
+
     return NULL;
 }
 
@@ -1836,9 +2037,19 @@ nxt_conf_json_parse_string(nxt_mp_t *mp, nxt_conf_value_t *value, u_char *start,
     state = 0;
     surplus = 0;
 
+    /* Skip the plain characters quickly. */
+
     for (p = start; nxt_fast_path(p != end); p++) {
         ch = *p;
 
+        if (ch == '"' || ch == '\\' || ch < ' ') {
+            break;
+        }
+    }
+
+    for ( /* void */ ; nxt_fast_path(p != end); p++) {
+        ch = *p;
+
         switch (state) {
 
         case sw_usual:
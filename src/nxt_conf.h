@@ -99,6 +99,8 @@ nxt_conf_op_ret_t nxt_conf_op_compile(nxt_mp_t *mp, nxt_conf_op_t **ops,
     nxt_bool_t add);
 nxt_conf_value_t *nxt_conf_clone(nxt_mp_t *mp, nxt_conf_op_t *op,
     nxt_conf_value_t *value);
+nxt_int_t nxt_conf_op_apply(nxt_mp_t *mp, nxt_conf_op_t *op,
+    nxt_conf_value_t *value);
 
 nxt_conf_value_t *nxt_conf_json_parse(nxt_mp_t *mp, u_char *start, u_char *end,
     nxt_conf_json_error_t *error);
@@ -80,6 +80,10 @@ nxt_inline nxt_int_t nxt_conf_vldt_unsupported(nxt_conf_validation_t *vldt,
     nxt_conf_value_t *value, void *data)
     NXT_MAYBE_UNUSED;
 
+#if (NXT_HAVE_ZLIB)
+static nxt_int_t nxt_conf_vldt_websocket_window_bits(
+    nxt_conf_validation_t *vldt, nxt_conf_value_t *value, void *data);
+#endif
 static nxt_int_t nxt_conf_vldt_mtypes(nxt_conf_validation_t *vldt,
     nxt_conf_value_t *value, void *data);
 static nxt_int_t nxt_conf_vldt_mtypes_type(nxt_conf_validation_t *vldt,
@@ -106,10 +110,18 @@ static nxt_int_t nxt_conf_vldt_ticket_key(nxt_conf_validation_t *vldt,
     nxt_conf_value_t *value, void *data);
 static nxt_int_t nxt_conf_vldt_ticket_key_element(nxt_conf_validation_t *vldt,
     nxt_conf_value_t *value);
+static nxt_int_t nxt_conf_vldt_ocsp_response(nxt_conf_validation_t *vldt,
+    nxt_str_t *name, nxt_conf_value_t *value);
+static nxt_int_t nxt_conf_vldt_ocsp_refresh(nxt_conf_validation_t *vldt,
+    nxt_conf_value_t *value, void *data);
 #endif
 #endif
 static nxt_int_t nxt_conf_vldt_action(nxt_conf_validation_t *vldt,
     nxt_conf_value_t *value, void *data);
+static nxt_int_t nxt_conf_vldt_limit(nxt_conf_validation_t *vldt,
+    nxt_conf_value_t *value, void *data);
+static nxt_int_t nxt_conf_vldt_limit_number(nxt_conf_validation_t *vldt,
+    nxt_conf_value_t *value, void *data);
 static nxt_int_t nxt_conf_vldt_pass(nxt_conf_validation_t *vldt,
     nxt_conf_value_t *value, void *data);
 static nxt_int_t nxt_conf_vldt_return(nxt_conf_validation_t *vldt,
@@ -130,6 +142,12 @@ static nxt_int_t nxt_conf_vldt_python_protocol(nxt_conf_validation_t *vldt,
     nxt_conf_value_t *value, void *data);
 static nxt_int_t nxt_conf_vldt_python_prefix(nxt_conf_validation_t *vldt,
     nxt_conf_value_t *value, void *data);
+static nxt_int_t nxt_conf_vldt_dispatch_depth(nxt_conf_validation_t *vldt,
+    nxt_conf_value_t *value, void *data);
+static nxt_int_t nxt_conf_vldt_autoscale_time(nxt_conf_validation_t *vldt,
+    nxt_conf_value_t *value, void *data);
+static nxt_int_t nxt_conf_vldt_autoscale_step(nxt_conf_validation_t *vldt,
+    nxt_conf_value_t *value, void *data);
 static nxt_int_t nxt_conf_vldt_threads(nxt_conf_validation_t *vldt,
     nxt_conf_value_t *value, void *data);
 static nxt_int_t nxt_conf_vldt_thread_stack_size(nxt_conf_validation_t *vldt,
@@ -230,21 +248,30 @@ static nxt_int_t nxt_conf_vldt_cgroup_path(nxt_conf_validation_t *vldt,
 static nxt_conf_vldt_object_t  nxt_conf_vldt_setting_members[];
 static nxt_conf_vldt_object_t  nxt_conf_vldt_http_members[];
 static nxt_conf_vldt_object_t  nxt_conf_vldt_websocket_members[];
+#if (NXT_HAVE_ZLIB)
+static nxt_conf_vldt_object_t  nxt_conf_vldt_websocket_deflate_members[];
+#endif
 static nxt_conf_vldt_object_t  nxt_conf_vldt_static_members[];
 static nxt_conf_vldt_object_t  nxt_conf_vldt_forwarded_members[];
 static nxt_conf_vldt_object_t  nxt_conf_vldt_client_ip_members[];
 #if (NXT_TLS)
 static nxt_conf_vldt_object_t  nxt_conf_vldt_tls_members[];
 static nxt_conf_vldt_object_t  nxt_conf_vldt_session_members[];
+#if (NXT_HAVE_OPENSSL_TLSEXT)
+static nxt_conf_vldt_object_t  nxt_conf_vldt_ocsp_members[];
+#endif
 #endif
 static nxt_conf_vldt_object_t  nxt_conf_vldt_match_members[];
+static nxt_conf_vldt_object_t  nxt_conf_vldt_limit_members[];
 static nxt_conf_vldt_object_t  nxt_conf_vldt_python_target_members[];
 static nxt_conf_vldt_object_t  nxt_conf_vldt_php_common_members[];
 static nxt_conf_vldt_object_t  nxt_conf_vldt_php_options_members[];
 static nxt_conf_vldt_object_t  nxt_conf_vldt_php_target_members[];
 static nxt_conf_vldt_object_t  nxt_conf_vldt_common_members[];
 static nxt_conf_vldt_object_t  nxt_conf_vldt_app_limits_members[];
+static nxt_conf_vldt_object_t  nxt_conf_vldt_app_dispatch_members[];
 static nxt_conf_vldt_object_t  nxt_conf_vldt_app_processes_members[];
+static nxt_conf_vldt_object_t  nxt_conf_vldt_app_autoscale_members[];
 static nxt_conf_vldt_object_t  nxt_conf_vldt_app_isolation_members[];
 static nxt_conf_vldt_object_t  nxt_conf_vldt_app_namespaces_members[];
 #if (NXT_HAVE_CGROUP)
@@ -361,11 +388,42 @@ static nxt_conf_vldt_object_t  nxt_conf_vldt_websocket_members[] = {
     }, {
         .name       = nxt_string("max_frame_size"),
         .type       = NXT_CONF_VLDT_INTEGER,
+    }, {
+        .name       = nxt_string("permessage_deflate"),
+        .type       = NXT_CONF_VLDT_OBJECT,
+#if (NXT_HAVE_ZLIB)
+        .validator  = nxt_conf_vldt_object,
+        .u.members  = nxt_conf_vldt_websocket_deflate_members,
+#else
+        .validator  = nxt_conf_vldt_unsupported,
+        .u.string   = "permessage_deflate",
+#endif
+    },
+
+    NXT_CONF_VLDT_END
+};
+
+
+#if (NXT_HAVE_ZLIB)
+
+static nxt_conf_vldt_object_t  nxt_conf_vldt_websocket_deflate_members[] = {
+    {
+        .name       = nxt_string("window_bits"),
+        .type       = NXT_CONF_VLDT_INTEGER,
+        .validator  = nxt_conf_vldt_websocket_window_bits,
+    }, {
+        .name       = nxt_string("context_takeover"),
+        .type       = NXT_CONF_VLDT_BOOLEAN,
+    }, {
+        .name       = nxt_string("threshold"),
+        .type       = NXT_CONF_VLDT_INTEGER,
     },
 
     NXT_CONF_VLDT_END
 };
 
+#endif
+
 
 static nxt_conf_vldt_object_t  nxt_conf_vldt_static_members[] = {
     {
@@ -474,6 +532,26 @@ static nxt_conf_vldt_object_t  nxt_conf_vldt_tls_members[] = {
         .type       = NXT_CONF_VLDT_OBJECT,
         .validator  = nxt_conf_vldt_object,
         .u.members  = nxt_conf_vldt_session_members,
+    }, {
+        .name       = nxt_string("ktls"),
+        .type       = NXT_CONF_VLDT_BOOLEAN,
+#if !(NXT_HAVE_OPENSSL_KTLS)
+        .validator  = nxt_conf_vldt_unsupported,
+        .u.string   = "ktls",
+#endif
+    }, {
+        .name       = nxt_string("async_handshake"),
+        .type       = NXT_CONF_VLDT_BOOLEAN,
+    }, {
+        .name       = nxt_string("ocsp"),
+        .type       = NXT_CONF_VLDT_OBJECT,
+#if (NXT_HAVE_OPENSSL_TLSEXT)
+        .validator  = nxt_conf_vldt_object,
+        .u.members  = nxt_conf_vldt_ocsp_members,
+#else
+        .validator  = nxt_conf_vldt_unsupported,
+        .u.string   = "ocsp",
+#endif
     },
 
     NXT_CONF_VLDT_END
@@ -506,6 +584,27 @@ static nxt_conf_vldt_object_t  nxt_conf_vldt_session_members[] = {
 };
 
 
+#if (NXT_HAVE_OPENSSL_TLSEXT)
+
+static nxt_conf_vldt_object_t  nxt_conf_vldt_ocsp_members[] = {
+    {
+        .name       = nxt_string("responses"),
+        .type       = NXT_CONF_VLDT_OBJECT,
+        .flags      = NXT_CONF_VLDT_REQUIRED,
+        .validator  = nxt_conf_vldt_object_iterator,
+        .u.object   = nxt_conf_vldt_ocsp_response,
+    }, {
+        .name       = nxt_string("refresh"),
+        .type       = NXT_CONF_VLDT_INTEGER,
+        .validator  = nxt_conf_vldt_ocsp_refresh,
+    },
+
+    NXT_CONF_VLDT_END
+};
+
+#endif
+
+
 static nxt_int_t
 nxt_conf_vldt_tls_cache_size(nxt_conf_validation_t *vldt,
     nxt_conf_value_t *value, void *data)
@@ -591,6 +690,50 @@ nxt_conf_vldt_ticket_key_element(nxt_conf_validation_t *vldt,
     return NXT_OK;
 }
 
+
+static nxt_int_t
+nxt_conf_vldt_ocsp_response(nxt_conf_validation_t *vldt, nxt_str_t *name,
+    nxt_conf_value_t *value)
+{
+    nxt_str_t  path;
+
+    if (nxt_cert_info_get(name) == NULL) {
+        return nxt_conf_vldt_error(vldt, "Certificate \"%V\" is not found.",
+                                   name);
+    }
+
+    if (nxt_conf_type(value) != NXT_CONF_STRING) {
+        return nxt_conf_vldt_error(vldt, "The \"responses\" object must "
+                                   "contain only string values.");
+    }
+
+    nxt_conf_get_string(value, &path);
+
+    if (path.length == 0 || path.start[0] != '/') {
+        return nxt_conf_vldt_error(vldt, "The OCSP response path \"%V\" "
+                                   "must be absolute.", &path);
+    }
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+nxt_conf_vldt_ocsp_refresh(nxt_conf_validation_t *vldt,
+    nxt_conf_value_t *value, void *data)
+{
+    int64_t  refresh;
+
+    refresh = nxt_conf_get_number(value);
+
+    if (refresh <= 0 || refresh > 86400) {
+        return nxt_conf_vldt_error(vldt, "The \"refresh\" number must be "
+                                         "between 1 and 86400.");
+    }
+
+    return NXT_OK;
+}
+
 #endif
 
 
@@ -604,6 +747,41 @@ static nxt_conf_vldt_object_t  nxt_conf_vldt_route_members[] = {
         .name       = nxt_string("action"),
         .type       = NXT_CONF_VLDT_OBJECT,
         .validator  = nxt_conf_vldt_action,
+    }, {
+        .name       = nxt_string("limit"),
+        .type       = NXT_CONF_VLDT_OBJECT,
+        .validator  = nxt_conf_vldt_limit,
+    },
+
+    NXT_CONF_VLDT_END
+};
+
+
+static nxt_conf_vldt_object_t  nxt_conf_vldt_limit_members[] = {
+    {
+        .name       = nxt_string("key"),
+        .type       = NXT_CONF_VLDT_STRING,
+        .flags      = NXT_CONF_VLDT_REQUIRED | NXT_CONF_VLDT_TSTR,
+    }, {
+        .name       = nxt_string("rate"),
+        .type       = NXT_CONF_VLDT_INTEGER,
+        .validator  = nxt_conf_vldt_limit_number,
+        .u.string   = "rate",
+    }, {
+        .name       = nxt_string("burst"),
+        .type       = NXT_CONF_VLDT_INTEGER,
+        .validator  = nxt_conf_vldt_limit_number,
+        .u.string   = "burst",
+    }, {
+        .name       = nxt_string("requests"),
+        .type       = NXT_CONF_VLDT_INTEGER,
+        .validator  = nxt_conf_vldt_limit_number,
+        .u.string   = "requests",
+    }, {
+        .name       = nxt_string("max_keys"),
+        .type       = NXT_CONF_VLDT_INTEGER,
+        .validator  = nxt_conf_vldt_limit_number,
+        .u.string   = "max_keys",
     },
 
     NXT_CONF_VLDT_END
@@ -1020,6 +1198,11 @@ static nxt_conf_vldt_object_t  nxt_conf_vldt_common_members[] = {
         .type       = NXT_CONF_VLDT_OBJECT,
         .validator  = nxt_conf_vldt_object,
         .u.members  = nxt_conf_vldt_app_limits_members,
+    }, {
+        .name       = nxt_string("dispatch"),
+        .type       = NXT_CONF_VLDT_OBJECT,
+        .validator  = nxt_conf_vldt_object,
+        .u.members  = nxt_conf_vldt_app_dispatch_members,
     }, {
         .name       = nxt_string("processes"),
         .type       = NXT_CONF_VLDT_INTEGER | NXT_CONF_VLDT_OBJECT,
@@ -1057,6 +1240,12 @@ static nxt_conf_vldt_object_t  nxt_conf_vldt_app_limits_members[] = {
     }, {
         .name       = nxt_string("requests"),
         .type       = NXT_CONF_VLDT_INTEGER,
+    }, {
+        .name       = nxt_string("max_queue"),
+        .type       = NXT_CONF_VLDT_INTEGER,
+    }, {
+        .name       = nxt_string("queue_timeout"),
+        .type       = NXT_CONF_VLDT_INTEGER,
     }, {
         .name       = nxt_string("shm"),
         .type       = NXT_CONF_VLDT_INTEGER,
@@ -1066,6 +1255,21 @@ static nxt_conf_vldt_object_t  nxt_conf_vldt_app_limits_members[] = {
 };
 
 
+static nxt_conf_vldt_object_t  nxt_conf_vldt_app_dispatch_members[] = {
+    {
+        .name       = nxt_string("depth"),
+        .type       = NXT_CONF_VLDT_INTEGER,
+        .validator  = nxt_conf_vldt_dispatch_depth,
+    }, {
+        .name       = nxt_string("key"),
+        .type       = NXT_CONF_VLDT_STRING,
+        .flags      = NXT_CONF_VLDT_TSTR,
+    },
+
+    NXT_CONF_VLDT_END
+};
+
+
 static nxt_conf_vldt_object_t  nxt_conf_vldt_app_processes_members[] = {
     {
         .name       = nxt_string("spare"),
@@ -1076,6 +1280,38 @@ static nxt_conf_vldt_object_t  nxt_conf_vldt_app_processes_members[] = {
     }, {
         .name       = nxt_string("idle_timeout"),
         .type       = NXT_CONF_VLDT_INTEGER,
+    }, {
+        .name       = nxt_string("autoscale"),
+        .type       = NXT_CONF_VLDT_OBJECT,
+        .validator  = nxt_conf_vldt_object,
+        .u.members  = nxt_conf_vldt_app_autoscale_members,
+    },
+
+    NXT_CONF_VLDT_END
+};
+
+
+static nxt_conf_vldt_object_t  nxt_conf_vldt_app_autoscale_members[] = {
+    {
+        .name       = nxt_string("queue_time"),
+        .type       = NXT_CONF_VLDT_NUMBER,
+        .validator  = nxt_conf_vldt_autoscale_time,
+    }, {
+        .name       = nxt_string("service_time"),
+        .type       = NXT_CONF_VLDT_NUMBER,
+        .validator  = nxt_conf_vldt_autoscale_time,
+    }, {
+        .name       = nxt_string("cooldown"),
+        .type       = NXT_CONF_VLDT_NUMBER,
+        .validator  = nxt_conf_vldt_autoscale_time,
+    }, {
+        .name       = nxt_string("step_up"),
+        .type       = NXT_CONF_VLDT_INTEGER,
+        .validator  = nxt_conf_vldt_autoscale_step,
+    }, {
+        .name       = nxt_string("step_down"),
+        .type       = NXT_CONF_VLDT_INTEGER,
+        .validator  = nxt_conf_vldt_autoscale_step,
     },
 
     NXT_CONF_VLDT_END
@@ -1449,12 +1685,35 @@ nxt_conf_vldt_var(nxt_conf_validation_t *vldt, nxt_str_t *name,
 
 
 typedef struct {
-    nxt_mp_t      *pool;
-    nxt_str_t     *type;
-    nxt_lvlhsh_t  hash;
+    nxt_mp_t       *pool;
+    nxt_str_t      *type;
+    nxt_flathsh_t  hash;
 } nxt_conf_vldt_mtypes_ctx_t;
 
 
+#if (NXT_HAVE_ZLIB)
+
+static nxt_int_t
+nxt_conf_vldt_websocket_window_bits(nxt_conf_validation_t *vldt,
+    nxt_conf_value_t *value, void *data)
+{
+    int64_t  bits;
+
+    bits = nxt_conf_get_number(value);
+
+    /* zlib does not support 256-byte windows for raw deflate. */
+
+    if (bits < 9 || bits > 15) {
+        return nxt_conf_vldt_error(vldt, "The \"window_bits\" number must be "
+                                   "between 9 and 15.");
+    }
+
+    return NXT_OK;
+}
+
+#endif
+
+
 static nxt_int_t
 nxt_conf_vldt_mtypes(nxt_conf_validation_t *vldt, nxt_conf_value_t *value,
     void *data)
@@ -1467,7 +1726,7 @@ nxt_conf_vldt_mtypes(nxt_conf_validation_t *vldt, nxt_conf_value_t *value,
         return NXT_ERROR;
     }
 
-    nxt_lvlhsh_init(&ctx.hash);
+    nxt_flathsh_init(&ctx.hash);
 
     vldt->ctx = &ctx;
 
@@ -1578,6 +1837,64 @@ nxt_conf_vldt_listener(nxt_conf_validation_t *vldt, nxt_str_t *name,
 }
 
 
+static nxt_int_t
+nxt_conf_vldt_limit(nxt_conf_validation_t *vldt, nxt_conf_value_t *value,
+    void *data)
+{
+    nxt_int_t  ret;
+
+    static nxt_str_t  rate_str = nxt_string("rate");
+    static nxt_str_t  requests_str = nxt_string("requests");
+    static nxt_str_t  burst_str = nxt_string("burst");
+
+    ret = nxt_conf_vldt_object(vldt, value, nxt_conf_vldt_limit_members);
+    if (ret != NXT_OK) {
+        return ret;
+    }
+
+    if (nxt_conf_get_object_member(value, &rate_str, NULL) == NULL) {
+        if (nxt_conf_get_object_member(value, &requests_str, NULL) == NULL) {
+            return nxt_conf_vldt_error(vldt, "The \"limit\" object must "
+                                       "contain either \"rate\" or "
+                                       "\"requests\" option.");
+        }
+
+        if (nxt_conf_get_object_member(value, &burst_str, NULL) != NULL) {
+            return nxt_conf_vldt_error(vldt, "The \"burst\" option of "
+                                       "\"limit\" requires \"rate\".");
+        }
+    }
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+nxt_conf_vldt_limit_number(nxt_conf_validation_t *vldt,
+    nxt_conf_value_t *value, void *data)
+{
+    int64_t     n, min;
+    const char  *name;
+
+    name = data;
+    n = nxt_conf_get_number(value);
+
+    min = (nxt_strcmp(name, "burst") == 0) ? 0 : 1;
+
+    if (n < min) {
+        return nxt_conf_vldt_error(vldt, "The \"%s\" number must be "
+                                   "equal to or greater than %L.", name, min);
+    }
+
+    if (n > NXT_INT32_T_MAX) {
+        return nxt_conf_vldt_error(vldt, "The \"%s\" number must not "
+                                   "exceed %d.", name, NXT_INT32_T_MAX);
+    }
+
+    return NXT_OK;
+}
+
+
 static nxt_int_t
 nxt_conf_vldt_action(nxt_conf_validation_t *vldt, nxt_conf_value_t *value,
     void *data)
@@ -1917,6 +2234,74 @@ nxt_conf_vldt_python_prefix(nxt_conf_validation_t *vldt,
 }
 
 
+static nxt_int_t
+nxt_conf_vldt_dispatch_depth(nxt_conf_validation_t *vldt,
+    nxt_conf_value_t *value, void *data)
+{
+    int64_t  depth;
+
+    depth = nxt_conf_get_number(value);
+
+    if (depth < 1) {
+        return nxt_conf_vldt_error(vldt, "The \"depth\" number must be "
+                                   "equal to or greater than 1.");
+    }
+
+    if (depth > NXT_INT32_T_MAX) {
+        return nxt_conf_vldt_error(vldt, "The \"depth\" number must "
+                                   "not exceed %d.", NXT_INT32_T_MAX);
+    }
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+nxt_conf_vldt_autoscale_time(nxt_conf_validation_t *vldt,
+    nxt_conf_value_t *value, void *data)
+{
+    double  time;
+
+    time = nxt_conf_get_number(value);
+
+    if (time < 0) {
+        return nxt_conf_vldt_error(vldt, "The \"autoscale\" time values "
+                                   "must be equal to or greater than 0.");
+    }
+
+    if (time > 86400) {
+        return nxt_conf_vldt_error(vldt, "The \"autoscale\" time values "
+                                   "must not exceed 86400 seconds.");
+    }
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+nxt_conf_vldt_autoscale_step(nxt_conf_validation_t *vldt,
+    nxt_conf_value_t *value, void *data)
+{
+    int64_t  step;
+
+    step = nxt_conf_get_number(value);
+
+    if (step < 1) {
+        return nxt_conf_vldt_error(vldt, "The \"step_up\" and "
+                                   "\"step_down\" numbers must be equal to "
+                                   "or greater than 1.");
+    }
+
+    if (step > NXT_INT32_T_MAX) {
+        return nxt_conf_vldt_error(vldt, "The \"step_up\" and "
+                                   "\"step_down\" numbers must not "
+                                   "exceed %d.", NXT_INT32_T_MAX);
+    }
+
+    return NXT_OK;
+}
+
+
 static nxt_int_t
 nxt_conf_vldt_threads(nxt_conf_validation_t *vldt, nxt_conf_value_t *value,
     void *data)
@@ -157,6 +157,12 @@ struct nxt_conn_s {
     nxt_sockaddr_t                *local;
     const char                    *action;
 
+#if (NXT_TLS)
+    /* Monotonic times of the TLS handshake start and end. */
+    nxt_nsec_t                    tls_start;
+    nxt_nsec_t                    tls_end;
+#endif
+
     uint8_t                       block_read;   /* 1 bit */
     uint8_t                       block_write;  /* 1 bit */
     uint8_t                       delayed;      /* 1 bit */
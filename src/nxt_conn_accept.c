@@ -93,7 +93,7 @@ nxt_conn_accept_alloc(nxt_task_t *task, nxt_listen_event_t *lev)
 
     if (engine->connections < engine->max_connections) {
 
-        mp = nxt_mp_create(1024, 128, 256, 32);
+        mp = nxt_mp_cache_get(engine->conn_mp_cache);
 
         if (nxt_fast_path(mp != NULL)) {
             c = nxt_conn_create(mp, lev->socket.task);
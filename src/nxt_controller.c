@@ -31,6 +31,7 @@ typedef struct {
 typedef struct {
     nxt_uint_t        status;
     nxt_conf_value_t  *conf;
+    nxt_buf_t         *metrics;
 
     u_char            *title;
     nxt_str_t         detail;
@@ -85,6 +86,8 @@ static void nxt_controller_process_request(nxt_task_t *task,
     nxt_controller_request_t *req);
 static void nxt_controller_process_config(nxt_task_t *task,
     nxt_controller_request_t *req, nxt_str_t *path);
+static void nxt_controller_process_batch(nxt_task_t *task,
+    nxt_controller_request_t *req);
 static nxt_bool_t nxt_controller_check_postpone_request(nxt_task_t *task);
 static void nxt_controller_process_status(nxt_task_t *task,
     nxt_controller_request_t *req);
@@ -120,7 +123,7 @@ static nxt_http_field_proc_t  nxt_controller_request_fields[] = {
       &nxt_controller_request_content_length, 0 },
 };
 
-static nxt_lvlhsh_t            nxt_controller_fields_hash;
+static nxt_flathsh_t           nxt_controller_fields_hash;
 
 static nxt_uint_t              nxt_controller_listening;
 static nxt_uint_t              nxt_controller_router_ready;
@@ -1101,6 +1104,28 @@ nxt_controller_process_request(nxt_task_t *task, nxt_controller_request_t *req)
         return;
     }
 
+    if (nxt_str_eq(&path, "/metrics", 8)) {
+
+        if (!nxt_str_eq(&req->parser.method, "GET", 3)) {
+            goto invalid_method;
+        }
+
+        if (nxt_controller_status == NULL) {
+            nxt_controller_process_status(task, req);
+            return;
+        }
+
+        resp.metrics = nxt_status_metrics(nxt_controller_status, c->mem_pool);
+        if (nxt_slow_path(resp.metrics == NULL)) {
+            goto alloc_fail;
+        }
+
+        resp.status = 200;
+
+        nxt_controller_response(task, req, &resp);
+        return;
+    }
+
 #if (NXT_TLS)
 
     if (nxt_str_start(&path, "/certificates", 13)
@@ -1357,6 +1382,20 @@ nxt_controller_process_config(nxt_task_t *task, nxt_controller_request_t *req,
         return;
     }
 
+    if (nxt_str_eq(&req->parser.method, "PATCH", 5)) {
+        if (path->length != 1) {
+            goto not_allowed;
+        }
+
+        if (nxt_controller_check_postpone_request(task)) {
+            nxt_queue_insert_tail(&nxt_controller_waiting_requests, &req->link);
+            return;
+        }
+
+        nxt_controller_process_batch(task, req);
+        return;
+    }
+
     if (nxt_str_eq(&req->parser.method, "DELETE", 6)) {
 
         if (nxt_controller_check_postpone_request(task)) {
@@ -1477,6 +1516,307 @@ nxt_controller_process_config(nxt_task_t *task, nxt_controller_request_t *req,
 }
 
 
+/*
+ * A batch is a JSON array of operations in the JSON Patch style:
+ *
+ *   [{"op": "add", "path": "/routes/-", "value": {...}},
+ *    {"op": "replace", "path": "/applications/app/processes", "value": 4},
+ *    {"op": "remove", "path": "/listeners/127.0.0.1:8080"}]
+ *
+ * "add" sets the value like PUT does, or appends it to an array like POST
+ * if the path ends with "/-"; "replace" requires the value to exist;
+ * "remove" deletes it like DELETE.  All operations are applied in place
+ * one after another to a single copy of the current configuration, which
+ * is then validated and sent to the router once.  The copy is discarded
+ * on the first failure, so the current configuration is never changed
+ * partially.
+ */
+
+static void
+nxt_controller_process_batch(nxt_task_t *task, nxt_controller_request_t *req)
+{
+    u_char                     *p;
+    size_t                     size;
+    uint32_t                   i, n;
+    nxt_mp_t                   *mp;
+    nxt_int_t                  rc;
+    nxt_str_t                  op, path;
+    nxt_conn_t                 *c;
+    nxt_bool_t                 add;
+    const char                 *reason;
+    nxt_buf_mem_t              *mbuf;
+    nxt_conf_op_t              *ops;
+    nxt_conf_value_t           *batch, *item, *member, *root, *value;
+    nxt_conf_validation_t      vldt;
+    nxt_conf_json_error_t      error;
+    nxt_controller_response_t  resp;
+
+    static nxt_str_t  op_str = nxt_string("op");
+    static nxt_str_t  path_str = nxt_string("path");
+    static nxt_str_t  value_str = nxt_string("value");
+
+    static const nxt_str_t empty_obj = nxt_string("{}");
+
+    nxt_memzero(&resp, sizeof(nxt_controller_response_t));
+
+    c = req->conn;
+    mbuf = &c->read->mem;
+
+    nxt_memzero(&error, sizeof(nxt_conf_json_error_t));
+
+    /* Skip UTF-8 BOM. */
+    if (nxt_buf_mem_used_size(mbuf) >= 3
+        && memcmp(mbuf->pos, "\xEF\xBB\xBF", 3) == 0)
+    {
+        mbuf->pos += 3;
+    }
+
+    mp = nxt_mp_create(1024, 128, 256, 32);
+    if (nxt_slow_path(mp == NULL)) {
+        goto alloc_fail;
+    }
+
+    /*
+     * The batch is parsed into the pool of the new configuration,
+     * so the values of the operations are linked there without copying.
+     */
+
+    batch = nxt_conf_json_parse(mp, mbuf->pos, mbuf->free, &error);
+
+    if (batch == NULL) {
+        nxt_mp_destroy(mp);
+
+        if (error.pos == NULL) {
+            goto alloc_fail;
+        }
+
+        resp.status = 400;
+        resp.title = (u_char *) "Invalid JSON.";
+        resp.detail.length = nxt_strlen(error.detail);
+        resp.detail.start = error.detail;
+        resp.offset = error.pos - mbuf->pos;
+
+        nxt_conf_json_position(mbuf->pos, error.pos,
+                               &resp.line, &resp.column);
+
+        nxt_controller_response(task, req, &resp);
+        return;
+    }
+
+    if (nxt_conf_type(batch) != NXT_CONF_ARRAY) {
+        nxt_mp_destroy(mp);
+
+        resp.status = 400;
+        resp.title = (u_char *) "Invalid batch.";
+        nxt_str_set(&resp.detail, "A batch must be an array of operations.");
+        resp.offset = -1;
+
+        nxt_controller_response(task, req, &resp);
+        return;
+    }
+
+    root = nxt_conf_clone(mp, NULL, nxt_controller_conf.root);
+    if (nxt_slow_path(root == NULL)) {
+        goto conf_fail;
+    }
+
+    n = nxt_conf_array_elements_count(batch);
+
+    for (i = 0; i < n; i++) {
+        item = nxt_conf_get_array_element(batch, i);
+
+        reason = "must be an object with the \"op\" and \"path\" strings";
+
+        if (nxt_conf_type(item) != NXT_CONF_OBJECT) {
+            goto invalid_op;
+        }
+
+        member = nxt_conf_get_object_member(item, &op_str, NULL);
+
+        if (member == NULL || nxt_conf_type(member) != NXT_CONF_STRING) {
+            goto invalid_op;
+        }
+
+        nxt_conf_get_string(member, &op);
+
+        member = nxt_conf_get_object_member(item, &path_str, NULL);
+
+        if (member == NULL || nxt_conf_type(member) != NXT_CONF_STRING) {
+            goto invalid_op;
+        }
+
+        nxt_conf_get_string(member, &path);
+
+        reason = "has an invalid \"path\"";
+
+        if (path.length == 0 || path.start[0] != '/') {
+            goto invalid_op;
+        }
+
+        if (path.length > 1 && path.start[path.length - 1] == '/') {
+            path.length--;
+        }
+
+        value = nxt_conf_get_object_member(item, &value_str, NULL);
+        add = 0;
+
+        if (nxt_str_eq(&op, "remove", 6)) {
+            reason = "must not have a \"value\"";
+
+            if (value != NULL) {
+                goto invalid_op;
+            }
+
+        } else if (nxt_str_eq(&op, "add", 3)
+                   || nxt_str_eq(&op, "replace", 7))
+        {
+            reason = "must have a \"value\"";
+
+            if (value == NULL) {
+                goto invalid_op;
+            }
+
+            if (op.length == 3
+                && path.length > 2
+                && memcmp(&path.start[path.length - 2], "/-", 2) == 0)
+            {
+                path.length -= 2;
+                add = 1;
+            }
+
+            if (op.length == 7 && nxt_conf_get_path(root, &path) == NULL) {
+                goto not_found;
+            }
+
+        } else {
+            reason = "has an unknown \"op\"";
+            goto invalid_op;
+        }
+
+        if (path.length == 1) {
+            if (value == NULL) {
+                value = nxt_conf_json_parse_str(mp, &empty_obj);
+
+                if (nxt_slow_path(value == NULL)) {
+                    goto conf_fail;
+                }
+            }
+
+            root = value;
+            continue;
+        }
+
+        rc = nxt_conf_op_compile(c->mem_pool, &ops, root, &path, value, add);
+
+        if (rc != NXT_CONF_OP_OK) {
+            switch (rc) {
+            case NXT_CONF_OP_NOT_FOUND:
+                goto not_found;
+
+            case NXT_CONF_OP_NOT_ALLOWED:
+                reason = "appends to a value that isn't an array";
+                goto invalid_op;
+            }
+
+            /* rc == NXT_CONF_OP_ERROR */
+            goto conf_fail;
+        }
+
+        rc = nxt_conf_op_apply(mp, ops, root);
+
+        if (nxt_slow_path(rc != NXT_OK)) {
+            goto conf_fail;
+        }
+    }
+
+    nxt_memzero(&vldt, sizeof(nxt_conf_validation_t));
+
+    vldt.conf = root;
+    vldt.pool = c->mem_pool;
+    vldt.conf_pool = mp;
+    vldt.ver = NXT_VERNUM;
+
+    rc = nxt_conf_validate(&vldt);
+
+    if (nxt_slow_path(rc != NXT_OK)) {
+
+        if (rc == NXT_DECLINED) {
+            nxt_mp_destroy(mp);
+
+            resp.status = 400;
+            resp.title = (u_char *) "Invalid configuration.";
+            resp.detail = vldt.error;
+            resp.offset = -1;
+
+            nxt_controller_response(task, req, &resp);
+            return;
+        }
+
+        /* rc == NXT_ERROR */
+        goto conf_fail;
+    }
+
+    rc = nxt_controller_conf_send(task, mp, root,
+                                  nxt_controller_conf_handler, req);
+
+    if (nxt_slow_path(rc != NXT_OK)) {
+        /* rc == NXT_ERROR */
+        goto conf_fail;
+    }
+
+    req->conf.root = root;
+    req->conf.pool = mp;
+
+    nxt_queue_insert_head(&nxt_controller_waiting_requests, &req->link);
+
+    return;
+
+not_found:
+
+    resp.status = 404;
+    resp.title = (u_char *) "Value doesn't exist.";
+    reason = "refers to a value that doesn't exist";
+
+    goto op_fail;
+
+invalid_op:
+
+    resp.status = 400;
+    resp.title = (u_char *) "Invalid operation.";
+
+op_fail:
+
+    size = nxt_length("Operation  .") + NXT_INT32_T_LEN + nxt_strlen(reason);
+
+    p = nxt_mp_nget(c->mem_pool, size);
+
+    if (nxt_fast_path(p != NULL)) {
+        resp.detail.start = p;
+        p = nxt_sprintf(p, p + size, "Operation %uD %s.", i, reason);
+        resp.detail.length = p - resp.detail.start;
+    }
+
+    resp.offset = -1;
+
+    nxt_mp_destroy(mp);
+
+    nxt_controller_response(task, req, &resp);
+    return;
+
+conf_fail:
+
+    nxt_mp_destroy(mp);
+
+alloc_fail:
+
+    resp.status = 500;
+    resp.title = (u_char *) "Memory allocation failed.";
+    resp.offset = -1;
+
+    nxt_controller_response(task, req, &resp);
+}
+
+
 static nxt_bool_t
 nxt_controller_check_postpone_request(nxt_task_t *task)
 {
@@ -2125,8 +2465,8 @@ nxt_controller_response(nxt_task_t *task, nxt_controller_request_t *req,
     nxt_controller_response_t *resp)
 {
     size_t                  size;
-    nxt_str_t               status_line, str;
-    nxt_buf_t               *b, *body;
+    nxt_str_t               status_line, str, type;
+    nxt_buf_t               *b, *body, *next;
     nxt_conn_t              *c;
     nxt_uint_t              n;
     nxt_conf_value_t        *value, *location;
@@ -2173,6 +2513,14 @@ nxt_controller_response(nxt_task_t *task, nxt_controller_request_t *req,
     }
 
     c = req->conn;
+
+    if (resp->metrics != NULL) {
+        body = resp->metrics;
+        nxt_str_set(&type, "text/plain; version=0.0.4");
+
+        goto header;
+    }
+
     value = resp->conf;
 
     if (value == NULL) {
@@ -2241,10 +2589,14 @@ nxt_controller_response(nxt_task_t *task, nxt_controller_request_t *req,
 
     body->mem.free = nxt_cpymem(body->mem.free, "\r\n", 2);
 
+    nxt_str_set(&type, "application/json");
+
+header:
+
     size = nxt_length("HTTP/1.1 " "\r\n") + status_line.length
            + nxt_length("Server: " NXT_SERVER "\r\n")
            + nxt_length("Date: Wed, 31 Dec 1986 16:40:00 GMT\r\n")
-           + nxt_length("Content-Type: application/json\r\n")
+           + nxt_length("Content-Type: " "\r\n") + type.length
            + nxt_length("Content-Length: " "\r\n") + NXT_SIZE_T_LEN
            + nxt_length("Connection: close\r\n")
            + nxt_length("\r\n");
@@ -2273,13 +2625,23 @@ nxt_controller_response(nxt_task_t *task, nxt_controller_request_t *req,
                                          b->mem.free);
 
     nxt_str_set(&str, "\r\n"
-                      "Content-Type: application/json\r\n"
+                      "Content-Type: ");
+
+    b->mem.free = nxt_cpymem(b->mem.free, str.start, str.length);
+    b->mem.free = nxt_cpymem(b->mem.free, type.start, type.length);
+
+    nxt_str_set(&str, "\r\n"
                       "Content-Length: ");
 
     b->mem.free = nxt_cpymem(b->mem.free, str.start, str.length);
 
-    b->mem.free = nxt_sprintf(b->mem.free, b->mem.end, "%uz",
-                              nxt_buf_mem_used_size(&body->mem));
+    size = 0;
+
+    for (next = body; next != NULL; next = next->next) {
+        size += nxt_buf_mem_used_size(&next->mem);
+    }
+
+    b->mem.free = nxt_sprintf(b->mem.free, b->mem.end, "%uz", size);
 
     nxt_str_set(&str, "\r\n"
                       "Connection: close\r\n"
@@ -136,12 +136,27 @@ nxt_event_engine_create(nxt_task_t *task,
 
     engine->max_connections = 0xFFFFFFFF;
 
+    engine->conn_mp_cache = nxt_mp_cache_create(1024, 128, 256, 32, 64);
+    if (nxt_slow_path(engine->conn_mp_cache == NULL)) {
+        goto conn_mp_cache_fail;
+    }
+
+    engine->request_mp_cache = nxt_mp_cache_create(4096, 128, 512, 32, 64);
+    if (nxt_slow_path(engine->request_mp_cache == NULL)) {
+        goto request_mp_cache_fail;
+    }
+
     nxt_queue_init(&engine->joints);
     nxt_queue_init(&engine->listen_connections);
     nxt_queue_init(&engine->idle_connections);
 
     return engine;
 
+request_mp_cache_fail:
+
+    nxt_mp_cache_destroy(engine->conn_mp_cache);
+
+conn_mp_cache_fail:
 timers_fail:
 post_fail:
 
@@ -454,6 +469,9 @@ nxt_event_engine_free(nxt_event_engine_t *engine)
 
     nxt_work_queue_cache_destroy(&engine->work_queue_cache);
 
+    nxt_mp_cache_destroy(engine->conn_mp_cache);
+    nxt_mp_cache_destroy(engine->request_mp_cache);
+
     engine->event.free(engine);
 
     /* TODO: free timers */
@@ -479,15 +479,23 @@ struct nxt_event_engine_s {
     nxt_port_t                 *port;
     nxt_mp_t                   *mem_pool;
     nxt_queue_t                joints;
+    nxt_lvlhsh_t               websocket_channels;
     nxt_queue_t                listen_connections;
     nxt_queue_t                idle_connections;
     nxt_array_t                *mem_cache;
+    nxt_mp_cache_t             *conn_mp_cache;
+    nxt_mp_cache_t             *request_mp_cache;
 
     nxt_atomic_uint_t          accepted_conns_cnt;
     nxt_atomic_uint_t          idle_conns_cnt;
     nxt_atomic_uint_t          closed_conns_cnt;
+    nxt_atomic_uint_t          tls_conns_cnt;
+    nxt_atomic_uint_t          ktls_conns_cnt;
     nxt_atomic_uint_t          requests_cnt;
 
+    /* The copy of router status counters, 0 for the main router engine. */
+    uint32_t                   status_slot;
+
     nxt_queue_link_t           link;
     // STUB: router link
     nxt_queue_link_t           link0;
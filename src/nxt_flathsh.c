@@ -0,0 +1,460 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+#include <nxt_main.h>
+
+#if (NXT_HAVE_SSE2)
+#include <emmintrin.h>
+#endif
+
+
+/*
+ * The flat hash is an array of slots split into groups of 16 slots,
+ * the number of groups is a power of 2.  Each slot consists of pointer
+ * to value data and 32-bit key.  Each slot has a control byte stored
+ * in a separate array, so control bytes of a group occupy 16 successive
+ * bytes in one CPU cache line.  A control byte of an occupied slot
+ * contains 7 high bits of the mixed key hash, empty and deleted slots
+ * are marked by control bytes with the high bit set.  A group is tested
+ * by comparing all its control bytes at once, so usually only a slot
+ * with matching key is accessed.
+ *
+ * Groups are probed starting from the group selected by low bits of
+ * the mixed key hash in triangular sequence which visits all groups.
+ * A probe stops at a group which has an empty slot.  A deleted slot
+ * is marked as empty if its group still has an empty slot, because
+ * no probe has ever passed through such group.  Otherwise the slot
+ * is marked as deleted and is reused by subsequent insertions.
+ *
+ * The table is resized when occupied and deleted slots exceed 7/8 of
+ * all slots, so a probe always ends.  The resized table is at most
+ * half full.
+ */
+
+#define NXT_FLATHSH_EMPTY     0x80
+#define NXT_FLATHSH_DELETED   0xFE
+
+
+typedef struct {
+    uint32_t                  key_hash;
+    void                      *value;
+} nxt_flathsh_slot_t;
+
+
+#define nxt_flathsh_size(fh)                                                  \
+    (((fh)->mask + 1) * NXT_FLATHSH_GROUP_SIZE)
+
+
+#define nxt_flathsh_capacity(fh)                                              \
+    (((fh)->ctrl != NULL) ? nxt_flathsh_size(fh) / 8 * 7 : 0)
+
+
+#define nxt_flathsh_is_full(ctrl)                                             \
+    (((ctrl) & 0x80) == 0)
+
+
+#define nxt_flathsh_h2(hash)                                                  \
+    ((uint8_t) ((hash) >> 25))
+
+
+static nxt_flathsh_slot_t *nxt_flathsh_find_slot(nxt_flathsh_t *fh,
+    nxt_lvlhsh_query_t *lhq, uint32_t *pos);
+static nxt_int_t nxt_flathsh_resize(nxt_flathsh_t *fh,
+    const nxt_lvlhsh_proto_t *proto, void *pool);
+static void nxt_flathsh_put(nxt_flathsh_t *fh, uint32_t key_hash,
+    void *value);
+static void nxt_flathsh_remove(nxt_flathsh_t *fh,
+    const nxt_lvlhsh_proto_t *proto, void *pool, uint32_t pos);
+static void *nxt_flathsh_first(nxt_flathsh_t *fh, uint32_t *pos);
+
+
+/*
+ * Keys may have just a few significant low bits, e.g. HTTP field
+ * hashes are 16-bit, so the key hash is mixed to use its high bits
+ * in control bytes.  This is the MurmurHash3 finalizer first half.
+ */
+
+nxt_inline uint32_t
+nxt_flathsh_hash(uint32_t key_hash)
+{
+    key_hash ^= key_hash >> 16;
+    key_hash *= 0x85EBCA6B;
+    key_hash ^= key_hash >> 13;
+
+    return key_hash;
+}
+
+
+#if (NXT_HAVE_SSE2)
+
+nxt_inline uint32_t
+nxt_flathsh_match(const uint8_t *group, uint8_t h2)
+{
+    __m128i  ctrl;
+
+    ctrl = _mm_loadu_si128((const __m128i *) group);
+
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char) h2)));
+}
+
+
+nxt_inline uint32_t
+nxt_flathsh_match_free(const uint8_t *group)
+{
+    return _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) group));
+}
+
+#else
+
+nxt_inline uint32_t
+nxt_flathsh_match(const uint8_t *group, uint8_t h2)
+{
+    uint32_t    bits;
+    nxt_uint_t  i;
+
+    bits = 0;
+
+    for (i = 0; i < NXT_FLATHSH_GROUP_SIZE; i++) {
+        if (group[i] == h2) {
+            bits |= 1 << i;
+        }
+    }
+
+    return bits;
+}
+
+
+nxt_inline uint32_t
+nxt_flathsh_match_free(const uint8_t *group)
+{
+    uint32_t    bits;
+    nxt_uint_t  i;
+
+    bits = 0;
+
+    for (i = 0; i < NXT_FLATHSH_GROUP_SIZE; i++) {
+        bits |= (uint32_t) (group[i] >> 7) << i;
+    }
+
+    return bits;
+}
+
+#endif
+
+
+nxt_int_t
+nxt_flathsh_find(nxt_flathsh_t *fh, nxt_lvlhsh_query_t *lhq)
+{
+    uint32_t            pos;
+    nxt_flathsh_slot_t  *slot;
+
+    if (nxt_slow_path(fh->ctrl == NULL)) {
+        return NXT_DECLINED;
+    }
+
+    slot = nxt_flathsh_find_slot(fh, lhq, &pos);
+
+    if (slot != NULL) {
+        lhq->value = slot->value;
+        return NXT_OK;
+    }
+
+    return NXT_DECLINED;
+}
+
+
+static nxt_flathsh_slot_t *
+nxt_flathsh_find_slot(nxt_flathsh_t *fh, nxt_lvlhsh_query_t *lhq,
+    uint32_t *pos)
+{
+    uint8_t             h2, *group;
+    uint32_t            hash, bits, n, i, g;
+    nxt_flathsh_slot_t  *slot, *slots;
+
+    hash = nxt_flathsh_hash(lhq->key_hash);
+    h2 = nxt_flathsh_h2(hash);
+
+    slots = fh->slots;
+    g = hash & fh->mask;
+
+    for (n = 0; n <= fh->mask; n++) {
+        group = &fh->ctrl[g * NXT_FLATHSH_GROUP_SIZE];
+
+        for (bits = nxt_flathsh_match(group, h2); bits != 0; bits &= bits - 1)
+        {
+            i = g * NXT_FLATHSH_GROUP_SIZE + nxt_ctz(bits);
+            slot = &slots[i];
+
+            if (slot->key_hash == lhq->key_hash
+                && lhq->proto->test(lhq, slot->value) == NXT_OK)
+            {
+                *pos = i;
+                return slot;
+            }
+        }
+
+        if (nxt_fast_path(nxt_flathsh_match(group, NXT_FLATHSH_EMPTY) != 0)) {
+            return NULL;
+        }
+
+        g = (g + n + 1) & fh->mask;
+    }
+
+    return NULL;
+}
+
+
+nxt_int_t
+nxt_flathsh_insert(nxt_flathsh_t *fh, nxt_lvlhsh_query_t *lhq)
+{
+    void                *old;
+    uint32_t            pos;
+    nxt_flathsh_slot_t  *slot;
+
+    if (fh->ctrl != NULL) {
+        slot = nxt_flathsh_find_slot(fh, lhq, &pos);
+
+        if (slot != NULL) {
+            old = slot->value;
+
+            if (lhq->replace) {
+                slot->value = lhq->value;
+                lhq->value = old;
+
+                return NXT_OK;
+            }
+
+            lhq->value = old;
+
+            return NXT_DECLINED;
+        }
+    }
+
+    if (fh->items + fh->deleted >= nxt_flathsh_capacity(fh)) {
+        if (nxt_flathsh_resize(fh, lhq->proto, lhq->pool) != NXT_OK) {
+            return NXT_ERROR;
+        }
+    }
+
+    nxt_flathsh_put(fh, lhq->key_hash, lhq->value);
+
+    fh->items++;
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+nxt_flathsh_resize(nxt_flathsh_t *fh, const nxt_lvlhsh_proto_t *proto,
+    void *pool)
+{
+    uint8_t             *ctrl;
+    uint32_t            i, size, groups;
+    nxt_flathsh_t       old;
+    nxt_flathsh_slot_t  *slots;
+
+    groups = (fh->ctrl != NULL) ? fh->mask + 1 : 1;
+
+    while ((fh->items + 1) * 2 > groups * NXT_FLATHSH_GROUP_SIZE / 8 * 7) {
+        groups *= 2;
+    }
+
+    size = groups * NXT_FLATHSH_GROUP_SIZE;
+
+    ctrl = proto->alloc(pool, size);
+    if (nxt_slow_path(ctrl == NULL)) {
+        return NXT_ERROR;
+    }
+
+    slots = proto->alloc(pool, size * sizeof(nxt_flathsh_slot_t));
+    if (nxt_slow_path(slots == NULL)) {
+        proto->free(pool, ctrl);
+        return NXT_ERROR;
+    }
+
+    nxt_memset(ctrl, NXT_FLATHSH_EMPTY, size);
+
+    old = *fh;
+
+    fh->ctrl = ctrl;
+    fh->slots = slots;
+    fh->mask = groups - 1;
+    fh->deleted = 0;
+    fh->first = 0;
+
+    if (old.ctrl != NULL) {
+        slots = old.slots;
+        size = nxt_flathsh_size(&old);
+
+        for (i = 0; i < size; i++) {
+            if (nxt_flathsh_is_full(old.ctrl[i])) {
+                nxt_flathsh_put(fh, slots[i].key_hash, slots[i].value);
+            }
+        }
+
+        proto->free(pool, old.ctrl);
+        proto->free(pool, old.slots);
+    }
+
+    return NXT_OK;
+}
+
+
+static void
+nxt_flathsh_put(nxt_flathsh_t *fh, uint32_t key_hash, void *value)
+{
+    uint32_t            hash, bits, n, i, g;
+    nxt_flathsh_slot_t  *slot;
+
+    hash = nxt_flathsh_hash(key_hash);
+    g = hash & fh->mask;
+
+    /* The table always has a free slot. */
+
+    for (n = 0; /* void */; n++) {
+        bits = nxt_flathsh_match_free(&fh->ctrl[g * NXT_FLATHSH_GROUP_SIZE]);
+
+        if (bits != 0) {
+            break;
+        }
+
+        g = (g + n + 1) & fh->mask;
+    }
+
+    i = g * NXT_FLATHSH_GROUP_SIZE + nxt_ctz(bits);
+
+    if (fh->ctrl[i] == NXT_FLATHSH_DELETED) {
+        fh->deleted--;
+    }
+
+    fh->ctrl[i] = nxt_flathsh_h2(hash);
+
+    if (i < fh->first) {
+        fh->first = i;
+    }
+
+    slot = &((nxt_flathsh_slot_t *) fh->slots)[i];
+    slot->key_hash = key_hash;
+    slot->value = value;
+}
+
+
+nxt_int_t
+nxt_flathsh_delete(nxt_flathsh_t *fh, nxt_lvlhsh_query_t *lhq)
+{
+    uint32_t            pos;
+    nxt_flathsh_slot_t  *slot;
+
+    if (fh->ctrl == NULL) {
+        return NXT_DECLINED;
+    }
+
+    slot = nxt_flathsh_find_slot(fh, lhq, &pos);
+
+    if (slot == NULL) {
+        return NXT_DECLINED;
+    }
+
+    lhq->value = slot->value;
+
+    nxt_flathsh_remove(fh, lhq->proto, lhq->pool, pos);
+
+    return NXT_OK;
+}
+
+
+static void
+nxt_flathsh_remove(nxt_flathsh_t *fh, const nxt_lvlhsh_proto_t *proto,
+    void *pool, uint32_t pos)
+{
+    uint8_t  *group;
+
+    group = &fh->ctrl[pos & ~(NXT_FLATHSH_GROUP_SIZE - 1)];
+
+    if (nxt_flathsh_match(group, NXT_FLATHSH_EMPTY) != 0) {
+        fh->ctrl[pos] = NXT_FLATHSH_EMPTY;
+
+    } else {
+        fh->ctrl[pos] = NXT_FLATHSH_DELETED;
+        fh->deleted++;
+    }
+
+    fh->items--;
+
+    if (fh->items == 0) {
+        proto->free(pool, fh->ctrl);
+        proto->free(pool, fh->slots);
+
+        nxt_flathsh_init(fh);
+    }
+}
+
+
+void *
+nxt_flathsh_each(nxt_flathsh_t *fh, nxt_flathsh_each_t *fhe)
+{
+    uint32_t  i, size;
+
+    size = (fh->ctrl != NULL) ? nxt_flathsh_size(fh) : 0;
+
+    while (fhe->current < size) {
+        i = fhe->current++;
+
+        if (nxt_flathsh_is_full(fh->ctrl[i])) {
+            return ((nxt_flathsh_slot_t *) fh->slots)[i].value;
+        }
+    }
+
+    return NULL;
+}
+
+
+void *
+nxt_flathsh_peek(nxt_flathsh_t *fh, const nxt_lvlhsh_proto_t *proto)
+{
+    uint32_t  pos;
+
+    return nxt_flathsh_first(fh, &pos);
+}
+
+
+void *
+nxt_flathsh_retrieve(nxt_flathsh_t *fh, const nxt_lvlhsh_proto_t *proto,
+    void *pool)
+{
+    void      *value;
+    uint32_t  pos;
+
+    value = nxt_flathsh_first(fh, &pos);
+
+    if (value != NULL) {
+        nxt_flathsh_remove(fh, proto, pool, pos);
+    }
+
+    return value;
+}
+
+
+static void *
+nxt_flathsh_first(nxt_flathsh_t *fh, uint32_t *pos)
+{
+    uint32_t  i, size;
+
+    if (fh->ctrl == NULL) {
+        return NULL;
+    }
+
+    size = nxt_flathsh_size(fh);
+
+    for (i = fh->first; i < size; i++) {
+        if (nxt_flathsh_is_full(fh->ctrl[i])) {
+            fh->first = i;
+            *pos = i;
+            return ((nxt_flathsh_slot_t *) fh->slots)[i].value;
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,70 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+#ifndef _NXT_FLAT_HASH_H_INCLUDED_
+#define _NXT_FLAT_HASH_H_INCLUDED_
+
+
+/*
+ * The flat hash is an open addressing alternative to the level hash for
+ * read-mostly tables.  It uses the same nxt_lvlhsh_query_t queries and
+ * nxt_lvlhsh_proto_t protos, however only the proto test, alloc, and
+ * free functions are used, the level and bucket sizes are ignored.
+ */
+
+#define NXT_FLATHSH_GROUP_SIZE  16
+
+
+typedef struct {
+    uint8_t                   *ctrl;
+    void                      *slots;
+    uint32_t                  mask;
+    uint32_t                  items;
+    uint32_t                  deleted;
+    /* No slot is occupied below this one, used by peek and retrieve. */
+    uint32_t                  first;
+} nxt_flathsh_t;
+
+
+typedef struct {
+    const nxt_lvlhsh_proto_t  *proto;
+    uint32_t                  current;
+} nxt_flathsh_each_t;
+
+
+#define nxt_flathsh_is_empty(fh)                                              \
+    ((fh)->items == 0)
+
+
+#define nxt_flathsh_init(fh)                                                  \
+    nxt_memzero(fh, sizeof(nxt_flathsh_t))
+
+/*
+ * nxt_flathsh_find(), nxt_flathsh_insert(), and nxt_flathsh_delete()
+ * have the same semantics and required nxt_lvlhsh_query_t fields as
+ * nxt_lvlhsh_find(), nxt_lvlhsh_insert(), and nxt_lvlhsh_delete().
+ * The table memory is freed when the last element is deleted.
+ */
+NXT_EXPORT nxt_int_t nxt_flathsh_find(nxt_flathsh_t *fh,
+    nxt_lvlhsh_query_t *lhq);
+NXT_EXPORT nxt_int_t nxt_flathsh_insert(nxt_flathsh_t *fh,
+    nxt_lvlhsh_query_t *lhq);
+NXT_EXPORT nxt_int_t nxt_flathsh_delete(nxt_flathsh_t *fh,
+    nxt_lvlhsh_query_t *lhq);
+
+#define nxt_flathsh_each_init(fhe, _proto)                                    \
+    do {                                                                      \
+        (fhe)->proto = _proto;                                                \
+        (fhe)->current = 0;                                                   \
+    } while (0)
+
+NXT_EXPORT void *nxt_flathsh_each(nxt_flathsh_t *fh, nxt_flathsh_each_t *fhe);
+NXT_EXPORT void *nxt_flathsh_peek(nxt_flathsh_t *fh,
+    const nxt_lvlhsh_proto_t *proto);
+NXT_EXPORT void *nxt_flathsh_retrieve(nxt_flathsh_t *fh,
+    const nxt_lvlhsh_proto_t *proto, void *pool);
+
+
+#endif /* _NXT_FLAT_HASH_H_INCLUDED_ */
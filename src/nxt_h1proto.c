@@ -39,6 +39,8 @@ static nxt_int_t nxt_h1p_websocket_key(void *ctx, nxt_http_field_t *field,
     uintptr_t data);
 static nxt_int_t nxt_h1p_websocket_version(void *ctx, nxt_http_field_t *field,
     uintptr_t data);
+static nxt_int_t nxt_h1p_websocket_extensions(void *ctx,
+    nxt_http_field_t *field, uintptr_t data);
 static nxt_int_t nxt_h1p_transfer_encoding(void *ctx, nxt_http_field_t *field,
     uintptr_t data);
 static void nxt_h1p_request_body_read(nxt_task_t *task, nxt_http_request_t *r);
@@ -154,58 +156,42 @@ const nxt_http_proto_table_t  nxt_http_proto[3] = {
 };
 
 
-static nxt_lvlhsh_t                    nxt_h1p_fields_hash;
-
-static nxt_http_field_proc_t           nxt_h1p_fields[] = {
-    { nxt_string("Connection"),        &nxt_h1p_connection, 0 },
-    { nxt_string("Upgrade"),           &nxt_h1p_upgrade, 0 },
-    { nxt_string("Sec-WebSocket-Key"), &nxt_h1p_websocket_key, 0 },
-    { nxt_string("Sec-WebSocket-Version"),
-                                       &nxt_h1p_websocket_version, 0 },
-    { nxt_string("Transfer-Encoding"), &nxt_h1p_transfer_encoding, 0 },
-
-    { nxt_string("Host"),              &nxt_http_request_host, 0 },
-    { nxt_string("Cookie"),            &nxt_http_request_field,
-        offsetof(nxt_http_request_t, cookie) },
-    { nxt_string("Referer"),           &nxt_http_request_field,
-        offsetof(nxt_http_request_t, referer) },
-    { nxt_string("User-Agent"),        &nxt_http_request_field,
-        offsetof(nxt_http_request_t, user_agent) },
-    { nxt_string("Content-Type"),      &nxt_http_request_field,
-        offsetof(nxt_http_request_t, content_type) },
-    { nxt_string("Content-Length"),    &nxt_http_request_content_length, 0 },
-    { nxt_string("Authorization"),     &nxt_http_request_field,
-        offsetof(nxt_http_request_t, authorization) },
-};
-
-
-static nxt_lvlhsh_t                    nxt_h1p_peer_fields_hash;
-
-static nxt_http_field_proc_t           nxt_h1p_peer_fields[] = {
-    { nxt_string("Connection"),        &nxt_http_proxy_skip, 0 },
-    { nxt_string("Transfer-Encoding"), &nxt_h1p_peer_transfer_encoding, 0 },
-    { nxt_string("Server"),            &nxt_http_proxy_skip, 0 },
-    { nxt_string("Date"),              &nxt_http_proxy_date, 0 },
-    { nxt_string("Content-Length"),    &nxt_http_proxy_content_length, 0 },
+static const nxt_http_field_dispatch_t  nxt_h1p_fields[NXT_HTTP_FIELD_KNOWN] = {
+    [NXT_HTTP_FIELD_CONNECTION]        = { &nxt_h1p_connection, 0 },
+    [NXT_HTTP_FIELD_UPGRADE]           = { &nxt_h1p_upgrade, 0 },
+    [NXT_HTTP_FIELD_SEC_WEBSOCKET_KEY] = { &nxt_h1p_websocket_key, 0 },
+    [NXT_HTTP_FIELD_SEC_WEBSOCKET_VERSION] =
+                                         { &nxt_h1p_websocket_version, 0 },
+    [NXT_HTTP_FIELD_SEC_WEBSOCKET_EXTENSIONS] =
+                                         { &nxt_h1p_websocket_extensions, 0 },
+    [NXT_HTTP_FIELD_TRANSFER_ENCODING] = { &nxt_h1p_transfer_encoding, 0 },
+
+    [NXT_HTTP_FIELD_HOST]              = { &nxt_http_request_host, 0 },
+    [NXT_HTTP_FIELD_COOKIE]            = { &nxt_http_request_field,
+                                  offsetof(nxt_http_request_t, cookie) },
+    [NXT_HTTP_FIELD_REFERER]           = { &nxt_http_request_field,
+                                  offsetof(nxt_http_request_t, referer) },
+    [NXT_HTTP_FIELD_USER_AGENT]        = { &nxt_http_request_field,
+                                  offsetof(nxt_http_request_t, user_agent) },
+    [NXT_HTTP_FIELD_CONTENT_TYPE]      = { &nxt_http_request_field,
+                                  offsetof(nxt_http_request_t, content_type) },
+    [NXT_HTTP_FIELD_CONTENT_LENGTH]    = { &nxt_http_request_content_length,
+                                           0 },
+    [NXT_HTTP_FIELD_AUTHORIZATION]     = { &nxt_http_request_field,
+                                  offsetof(nxt_http_request_t, authorization) },
 };
 
 
-nxt_int_t
-nxt_h1p_init(nxt_task_t *task)
+static const nxt_http_field_dispatch_t
+    nxt_h1p_peer_fields[NXT_HTTP_FIELD_KNOWN] =
 {
-    nxt_int_t  ret;
-
-    ret = nxt_http_fields_hash(&nxt_h1p_fields_hash,
-                               nxt_h1p_fields, nxt_nitems(nxt_h1p_fields));
-
-    if (nxt_fast_path(ret == NXT_OK)) {
-        ret = nxt_http_fields_hash(&nxt_h1p_peer_fields_hash,
-                                   nxt_h1p_peer_fields,
-                                   nxt_nitems(nxt_h1p_peer_fields));
-    }
-
-    return ret;
-}
+    [NXT_HTTP_FIELD_CONNECTION]        = { &nxt_http_proxy_skip, 0 },
+    [NXT_HTTP_FIELD_TRANSFER_ENCODING] = { &nxt_h1p_peer_transfer_encoding,
+                                           0 },
+    [NXT_HTTP_FIELD_SERVER]            = { &nxt_http_proxy_skip, 0 },
+    [NXT_HTTP_FIELD_DATE]              = { &nxt_http_proxy_date, 0 },
+    [NXT_HTTP_FIELD_CONTENT_LENGTH]    = { &nxt_http_proxy_content_length, 0 },
+};
 
 
 void
@@ -488,9 +474,12 @@ nxt_h1p_conn_request_init(nxt_task_t *task, void *obj, void *data)
 
         /* r->protocol = NXT_HTTP_PROTO_H1 is done by zeroing. */
         r->remote = c->remote;
+        r->sendfile = (c->sendfile == NXT_CONN_SENDFILE_ON);
 
 #if (NXT_TLS)
         r->tls = (c->u.tls != NULL);
+        r->tls_start = c->tls_start;
+        r->tls_end = c->tls_end;
 #endif
 
         r->task = c->task;
@@ -655,7 +644,7 @@ nxt_h1p_header_process(nxt_task_t *task, nxt_h1proto_t *h1p,
 
     r->fields = h1p->parser.fields;
 
-    ret = nxt_http_fields_process(r->fields, &nxt_h1p_fields_hash, r);
+    ret = nxt_http_fields_dispatch(r->fields, nxt_h1p_fields, r);
     if (nxt_slow_path(ret != NXT_OK)) {
         return ret;
     }
@@ -694,6 +683,17 @@ nxt_h1p_header_process(nxt_task_t *task, nxt_h1proto_t *h1p,
         }
 
         r->websocket_handshake = 1;
+
+#if (NXT_HAVE_ZLIB)
+        if (h1p->websocket_extensions_field != NULL) {
+            ret = nxt_http_websocket_deflate_negotiate(r,
+                                               h1p->websocket_extensions_field,
+                                               &h1p->websocket_extensions);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return NXT_HTTP_INTERNAL_SERVER_ERROR;
+            }
+        }
+#endif
     }
 
     return ret;
@@ -812,6 +812,36 @@ nxt_h1p_websocket_version(void *ctx, nxt_http_field_t *field, uintptr_t data)
 }
 
 
+static nxt_int_t
+nxt_h1p_websocket_extensions(void *ctx, nxt_http_field_t *field,
+    uintptr_t data)
+{
+#if (NXT_HAVE_ZLIB)
+    nxt_h1proto_t       *h1p;
+    nxt_http_request_t  *r;
+
+    r = ctx;
+
+    if (!r->conf->socket_conf->websocket_conf.deflate) {
+        return NXT_OK;
+    }
+
+    /* Extensions are negotiated by the router instead of application. */
+    field->skip = 1;
+
+    /* The first offer is negotiated if the request is a valid upgrade. */
+
+    h1p = r->proto.h1;
+
+    if (h1p->websocket_extensions_field == NULL) {
+        h1p->websocket_extensions_field = field;
+    }
+#endif
+
+    return NXT_OK;
+}
+
+
 static nxt_int_t
 nxt_h1p_transfer_encoding(void *ctx, nxt_http_field_t *field, uintptr_t data)
 {
@@ -1197,7 +1227,7 @@ static void
 nxt_h1p_request_header_send(nxt_task_t *task, nxt_http_request_t *r,
     nxt_work_handler_t body_handler, void *data)
 {
-    u_char              *p;
+    u_char              *p, *date;
     size_t              size;
     nxt_buf_t           *header;
     nxt_str_t           unknown_status;
@@ -1210,8 +1240,11 @@ nxt_h1p_request_header_send(nxt_task_t *task, nxt_http_request_t *r,
     nxt_http_field_t    *field;
     u_char              buf[UNKNOWN_STATUS_LENGTH];
 
+    static const char   server[] = "Server: " NXT_SERVER "\r\n";
+    static const char   content_length[] = "Content-Length: ";
     static const char   chunked[] = "Transfer-Encoding: chunked\r\n";
     static const char   websocket_version[] = "Sec-WebSocket-Version: 13\r\n";
+    static const char   websocket_extensions[] = "Sec-WebSocket-Extensions: ";
 
     static const nxt_str_t  connection[3] = {
         nxt_string("Connection: close\r\n"),
@@ -1265,6 +1298,19 @@ nxt_h1p_request_header_send(nxt_task_t *task, nxt_http_request_t *r,
     /* Trailing CRLF at the end of header. */
     size += nxt_length("\r\n");
 
+    if (r->resp.date == NULL) {
+        size += nxt_http_server_date_cache.size;
+
+    } else {
+        size += nxt_length(server);
+    }
+
+    if (r->resp.content_length_n != -1
+        && (r->resp.content_length == NULL || r->resp.content_length->skip))
+    {
+        size += nxt_length(content_length) + NXT_OFF_T_LEN + 2;
+    }
+
     conn = -1;
 
     if (r->websocket_handshake && n == NXT_HTTP_SWITCHING_PROTOCOLS) {
@@ -1273,11 +1319,18 @@ nxt_h1p_request_header_send(nxt_task_t *task, nxt_http_request_t *r,
         conn = 2;
         size += NXT_WEBSOCKET_ACCEPT_SIZE + 2;
 
+        if (r->ws_deflate != NULL) {
+            size += nxt_length(websocket_extensions)
+                    + h1p->websocket_extensions.length + 2;
+        }
+
     } else {
         http11 = (h1p->parser.version.s.minor != '0');
 
-        if (r->resp.content_length == NULL || r->resp.content_length->skip) {
-
+        if (r->resp.content_length_n == -1
+            && (r->resp.content_length == NULL
+                || r->resp.content_length->skip))
+        {
             if (http11) {
                 if (n != NXT_HTTP_NOT_MODIFIED
                     && n != NXT_HTTP_NO_CONTENT
@@ -1313,6 +1366,10 @@ nxt_h1p_request_header_send(nxt_task_t *task, nxt_http_request_t *r,
 
     } nxt_list_loop;
 
+    if (r->resp.prepared != NULL) {
+        size += r->resp.prepared->length;
+    }
+
     if (nxt_slow_path(n == NXT_HTTP_UPGRADE_REQUIRED)) {
         size += nxt_length(websocket_version);
     }
@@ -1325,6 +1382,17 @@ nxt_h1p_request_header_send(nxt_task_t *task, nxt_http_request_t *r,
 
     p = nxt_cpymem(header->mem.free, status->start, status->length);
 
+    date = p;
+
+    if (r->resp.date == NULL) {
+        p = nxt_thread_time_string(task->thread, &nxt_http_server_date_cache,
+                                   p);
+    }
+
+    if (p == date) {
+        p = nxt_cpymem(p, server, nxt_length(server));
+    }
+
     nxt_list_each(field, r->resp.fields) {
 
         if (!field->skip) {
@@ -1336,6 +1404,18 @@ nxt_h1p_request_header_send(nxt_task_t *task, nxt_http_request_t *r,
 
     } nxt_list_loop;
 
+    if (r->resp.prepared != NULL) {
+        p = nxt_cpymem(p, r->resp.prepared->start, r->resp.prepared->length);
+    }
+
+    if (r->resp.content_length_n != -1
+        && (r->resp.content_length == NULL || r->resp.content_length->skip))
+    {
+        p = nxt_cpymem(p, content_length, nxt_length(content_length));
+        p = nxt_sprintf(p, p + NXT_OFF_T_LEN, "%O", r->resp.content_length_n);
+        *p++ = '\r'; *p++ = '\n';
+    }
+
     if (conn >= 0) {
         p = nxt_cpymem(p, connection[conn].start, connection[conn].length);
     }
@@ -1345,6 +1425,15 @@ nxt_h1p_request_header_send(nxt_task_t *task, nxt_http_request_t *r,
         p += NXT_WEBSOCKET_ACCEPT_SIZE;
 
         *p++ = '\r'; *p++ = '\n';
+
+        if (r->ws_deflate != NULL) {
+            p = nxt_cpymem(p, websocket_extensions,
+                           nxt_length(websocket_extensions));
+            p = nxt_cpymem(p, h1p->websocket_extensions.start,
+                           h1p->websocket_extensions.length);
+
+            *p++ = '\r'; *p++ = '\n';
+        }
     }
 
     if (nxt_slow_path(n == NXT_HTTP_UPGRADE_REQUIRED)) {
@@ -2522,8 +2611,8 @@ nxt_h1p_peer_header_read_done(nxt_task_t *task, void *obj, void *data)
     case NXT_DONE:
         peer->fields = peer->proto.h1->parser.fields;
 
-        ret = nxt_http_fields_process(peer->fields,
-                                      &nxt_h1p_peer_fields_hash, r);
+        ret = nxt_http_fields_dispatch(peer->fields, nxt_h1p_peer_fields,
+                                       r);
         if (nxt_slow_path(ret != NXT_OK)) {
             peer->status = NXT_HTTP_INTERNAL_SERVER_ERROR;
             break;
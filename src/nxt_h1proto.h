@@ -34,10 +34,13 @@ struct nxt_h1proto_s {
 
     uint8_t                   websocket_cont_expected;  /* 1 bit */
     uint8_t                   websocket_closed;         /* 1 bit */
+    uint8_t                   websocket_inflate;        /* 1 bit */
 
     uint32_t                  header_size;
 
     nxt_http_field_t          *websocket_key;
+    nxt_http_field_t          *websocket_extensions_field;
+    nxt_str_t                 websocket_extensions;
     nxt_h1p_websocket_timer_t *websocket_timer;
 
     nxt_http_request_t        *request;
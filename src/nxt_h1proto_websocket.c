@@ -25,6 +25,10 @@ static void nxt_h1p_conn_ws_keepalive_enable(nxt_task_t *task,
     nxt_h1proto_t *h1p);
 static void nxt_h1p_conn_ws_frame_process(nxt_task_t *task, nxt_conn_t *c,
     nxt_h1proto_t *h1p, nxt_websocket_header_t *wsh);
+#if (NXT_HAVE_ZLIB)
+static void nxt_h1p_conn_ws_inflate(nxt_task_t *task, nxt_h1proto_t *h1p,
+    nxt_http_request_t *r);
+#endif
 static void nxt_h1p_conn_ws_error(nxt_task_t *task, void *obj, void *data);
 static ssize_t nxt_h1p_ws_io_read_handler(nxt_task_t *task, nxt_conn_t *c);
 static void nxt_h1p_conn_ws_timeout(nxt_task_t *task, void *obj, void *data);
@@ -68,6 +72,12 @@ static const nxt_ws_error_t  nxt_ws_err_invalid_opcode = {
 static const nxt_ws_error_t  nxt_ws_err_cont_expected = {
     NXT_WEBSOCKET_CR_PROTOCOL_ERROR,
     1, nxt_string("Continuation expected, but %ud opcode received") };
+static const nxt_ws_error_t  nxt_ws_err_unexpected_rsv1 = {
+    NXT_WEBSOCKET_CR_PROTOCOL_ERROR,
+    1, nxt_string("Unexpected RSV1 bit in %ud opcode frame") };
+static const nxt_ws_error_t  nxt_ws_err_invalid_data = {
+    NXT_WEBSOCKET_CR_INVALID_DATA,
+    0, nxt_string("Invalid compressed data") };
 
 void
 nxt_h1p_websocket_first_frame_start(nxt_task_t *task, nxt_http_request_t *r,
@@ -295,6 +305,12 @@ nxt_h1p_conn_ws_frame_header_read(nxt_task_t *task, void *obj, void *data)
             return;
         }
 
+        if (nxt_slow_path(wsh->rsv1 && r->ws_deflate != NULL)) {
+            hxt_h1p_send_ws_error(task, r, &nxt_ws_err_unexpected_rsv1,
+                                  wsh->opcode);
+            return;
+        }
+
     } else {
         if (h1p->websocket_cont_expected) {
             if (nxt_slow_path(wsh->opcode != NXT_WEBSOCKET_OP_CONT)) {
@@ -313,6 +329,17 @@ nxt_h1p_conn_ws_frame_header_read(nxt_task_t *task, void *obj, void *data)
             }
         }
 
+        if (r->ws_deflate != NULL) {
+            if (wsh->opcode != NXT_WEBSOCKET_OP_CONT) {
+                h1p->websocket_inflate = wsh->rsv1;
+
+            } else if (nxt_slow_path(wsh->rsv1)) {
+                hxt_h1p_send_ws_error(task, r, &nxt_ws_err_unexpected_rsv1,
+                                      wsh->opcode);
+                return;
+            }
+        }
+
         h1p->websocket_cont_expected = !wsh->fin;
     }
 
@@ -434,10 +461,51 @@ nxt_h1p_conn_ws_frame_process(nxt_task_t *task, nxt_conn_t *c,
         h1p->websocket_closed = 1;
     }
 
+#if (NXT_HAVE_ZLIB)
+    if (h1p->websocket_inflate && (wsh->opcode & NXT_WEBSOCKET_OP_CTRL) == 0) {
+        nxt_h1p_conn_ws_inflate(task, h1p, r);
+        return;
+    }
+#endif
+
     r->state->ready_handler(task, r, NULL);
 }
 
 
+#if (NXT_HAVE_ZLIB)
+
+static void
+nxt_h1p_conn_ws_inflate(nxt_task_t *task, nxt_h1proto_t *h1p,
+    nxt_http_request_t *r)
+{
+    size_t     max_frame_size;
+    uint64_t   size;
+    nxt_int_t  ret;
+
+    max_frame_size = r->conf->socket_conf->websocket_conf.max_frame_size;
+
+    ret = nxt_http_websocket_inflate(task, r, max_frame_size, &size);
+
+    if (nxt_slow_path(ret != NXT_OK)) {
+        if (ret == NXT_ERROR) {
+            hxt_h1p_send_ws_error(task, r, &nxt_ws_err_out_of_memory);
+
+        } else if (size > max_frame_size) {
+            hxt_h1p_send_ws_error(task, r, &nxt_ws_err_too_big, size);
+
+        } else {
+            hxt_h1p_send_ws_error(task, r, &nxt_ws_err_invalid_data);
+        }
+
+        return;
+    }
+
+    r->state->ready_handler(task, r, NULL);
+}
+
+#endif
+
+
 static void
 nxt_h1p_conn_ws_error(nxt_task_t *task, void *obj, void *data)
 {
@@ -645,7 +713,8 @@ nxt_h1p_conn_ws_error_sent(nxt_task_t *task, void *obj, void *data)
 static void
 nxt_h1p_conn_ws_pong(nxt_task_t *task, void *obj, void *data)
 {
-    uint8_t                 payload_len, i;
+    size_t                  size;
+    uint8_t                 payload_len, rest;
     nxt_buf_t               *b, *out, *next;
     nxt_http_request_t      *r;
     nxt_websocket_header_t  *wsh;
@@ -680,7 +749,7 @@ nxt_h1p_conn_ws_pong(nxt_task_t *task, void *obj, void *data)
     wsh->fin = 1;
     wsh->opcode = NXT_WEBSOCKET_OP_PONG;
 
-    for (i = 0; i < payload_len; i++) {
+    for (rest = payload_len; rest != 0; rest -= size) {
         while (nxt_buf_mem_used_size(&b->mem) == 0) {
             next = b->next;
             b->next = NULL;
@@ -691,9 +760,14 @@ nxt_h1p_conn_ws_pong(nxt_task_t *task, void *obj, void *data)
             b = next;
         }
 
-        *out->mem.free++ = *b->mem.pos++ ^ mask[i % 4];
+        size = nxt_min(rest, nxt_buf_mem_used_size(&b->mem));
+
+        out->mem.free = nxt_cpymem(out->mem.free, b->mem.pos, size);
+        b->mem.pos += size;
     }
 
+    nxt_websocket_unmask(out->mem.free - payload_len, payload_len, mask, 0);
+
     r->ws_frame = b;
 
     nxt_http_request_send(task, r, out);
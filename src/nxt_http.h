@@ -74,6 +74,10 @@ typedef struct {
 
 
 typedef struct nxt_h1proto_s        nxt_h1proto_t;
+typedef struct nxt_http_websocket_deflate_s  nxt_http_websocket_deflate_t;
+typedef struct nxt_http_websocket_subscription_s
+    nxt_http_websocket_subscription_t;
+
 
 struct nxt_h1p_websocket_timer_s {
     nxt_timer_t                     timer;
@@ -110,6 +114,8 @@ typedef struct {
     nxt_http_field_t                *content_type;
     nxt_http_field_t                *content_length;
     nxt_off_t                       content_length_n;
+    /* Header lines serialized in advance, copied as is. */
+    nxt_str_t                       *prepared;
 } nxt_http_response_t;
 
 
@@ -137,11 +143,32 @@ struct nxt_http_request_s {
 
     nxt_buf_t                       *body;
     nxt_buf_t                       *ws_frame;
+    nxt_http_websocket_deflate_t    *ws_deflate;
+    nxt_http_websocket_subscription_t  *ws_subscriptions;
+    /* Published frames waiting for the end of an application message. */
+    nxt_buf_t                       *ws_published;
+    /* The size of published frames queued or not yet sent. */
+    size_t                          ws_published_size;
+    /* The bytes left in the current application frame. */
+    uint64_t                        ws_out_rest;
     nxt_buf_t                       *out;
     const nxt_http_request_state_t  *state;
 
     nxt_nsec_t                      start_time;
 
+    /*
+     * Monotonic times of the request processing phases,
+     * zero if the phase has not been started.
+     */
+    nxt_nsec_t                      tls_start;
+    nxt_nsec_t                      tls_end;
+    nxt_nsec_t                      queue_start;
+    nxt_nsec_t                      app_start;
+    nxt_nsec_t                      app_end;
+    nxt_nsec_t                      upstream_start;
+    nxt_nsec_t                      upstream_connected;
+    nxt_nsec_t                      upstream_end;
+
     nxt_str_t                       host;
     nxt_str_t                       server_name;
     nxt_str_t                       target;
@@ -174,6 +201,12 @@ struct nxt_http_request_s {
 
     void                            *req_rpc_data;
 
+    /* Statistics of the route step and the application, if any. */
+    nxt_status_traffic_t            *route_traffic;
+    nxt_app_t                       *app;
+
+    nxt_http_limit_entry_t          *limit_entry;
+
 #if (NXT_HAVE_REGEX)
     nxt_regex_match_t               *regex_match;
 #endif
@@ -182,6 +215,8 @@ struct nxt_http_request_s {
     nxt_buf_t                       *last;
 
     nxt_queue_link_t                app_link;   /* nxt_app_t.ack_waiting_req */
+    nxt_port_t                      *app_port;  /* Per-process dispatch. */
+    nxt_pid_t                       app_pid;
     nxt_event_engine_t              *engine;
     nxt_work_t                      err_work;
 
@@ -198,6 +233,8 @@ struct nxt_http_request_s {
     uint8_t                         inconsistent; /* 1 bit  */
     uint8_t                         error;        /* 1 bit  */
     uint8_t                         websocket_handshake;  /* 1 bit */
+    uint8_t                         ws_out_fragmented;    /* 1 bit */
+    uint8_t                         sendfile;     /* 1 bit  */
 };
 
 
@@ -310,7 +347,6 @@ nxt_http_date(u_char *buf, struct tm *tm)
 
 
 nxt_int_t nxt_http_init(nxt_task_t *task);
-nxt_int_t nxt_h1p_init(nxt_task_t *task);
 nxt_int_t nxt_http_response_hash_init(nxt_task_t *task);
 
 void nxt_http_conn_init(nxt_task_t *task, void *obj, void *data);
@@ -352,6 +388,10 @@ nxt_http_action_t *nxt_http_action_create(nxt_task_t *task,
     nxt_router_temp_conf_t *tmcf, nxt_str_t *pass);
 nxt_int_t nxt_http_routes_resolve(nxt_task_t *task,
     nxt_router_temp_conf_t *tmcf);
+nxt_int_t nxt_http_routes_status(nxt_http_routes_t *routes, uint32_t i,
+    nxt_str_t **name, uint32_t *steps);
+nxt_status_traffic_t *nxt_http_route_traffic(nxt_http_routes_t *routes,
+    uint32_t i, uint32_t step);
 nxt_int_t nxt_http_pass_segments(nxt_mp_t *mp, nxt_str_t *pass,
     nxt_str_t *segments, nxt_uint_t n);
 nxt_http_action_t *nxt_http_pass_application(nxt_task_t *task,
@@ -367,6 +407,14 @@ nxt_int_t nxt_http_route_test_rule(nxt_http_request_t *r,
 
 nxt_int_t nxt_http_action_init(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
     nxt_conf_value_t *cv, nxt_http_action_t *action);
+
+nxt_http_limit_t *nxt_http_limit_create(nxt_task_t *task,
+    nxt_router_temp_conf_t *tmcf, nxt_conf_value_t *cv);
+nxt_http_action_t *nxt_http_limit_handler(nxt_task_t *task,
+    nxt_http_request_t *r, nxt_http_limit_t *limit, nxt_http_action_t *action);
+void nxt_http_limit_release(nxt_task_t *task, nxt_http_request_t *r);
+void nxt_http_limits_release(nxt_router_conf_t *rtcf);
+
 void nxt_http_request_action(nxt_task_t *task, nxt_http_request_t *r,
     nxt_http_action_t *action);
 
@@ -380,10 +428,10 @@ nxt_int_t nxt_http_return_init(nxt_router_conf_t *rtcf,
 
 nxt_int_t nxt_http_static_init(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
     nxt_http_action_t *action, nxt_http_action_conf_t *acf);
-nxt_int_t nxt_http_static_mtypes_init(nxt_mp_t *mp, nxt_lvlhsh_t *hash);
-nxt_int_t nxt_http_static_mtypes_hash_add(nxt_mp_t *mp, nxt_lvlhsh_t *hash,
+nxt_int_t nxt_http_static_mtypes_init(nxt_mp_t *mp, nxt_flathsh_t *hash);
+nxt_int_t nxt_http_static_mtypes_hash_add(nxt_mp_t *mp, nxt_flathsh_t *hash,
     const nxt_str_t *exten, nxt_str_t *type);
-nxt_str_t *nxt_http_static_mtype_get(nxt_lvlhsh_t *hash,
+nxt_str_t *nxt_http_static_mtype_get(nxt_flathsh_t *hash,
     const nxt_str_t *exten);
 
 nxt_http_action_t *nxt_http_application_handler(nxt_task_t *task,
@@ -406,9 +454,28 @@ nxt_buf_t *nxt_http_proxy_buf_mem_alloc(nxt_task_t *task, nxt_http_request_t *r,
 void nxt_http_proxy_buf_mem_free(nxt_task_t *task, nxt_http_request_t *r,
     nxt_buf_t *b);
 
+#if (NXT_HAVE_ZLIB)
+nxt_int_t nxt_http_websocket_deflate_negotiate(nxt_http_request_t *r,
+    nxt_http_field_t *field, nxt_str_t *response);
+nxt_int_t nxt_http_websocket_inflate(nxt_task_t *task, nxt_http_request_t *r,
+    size_t limit, uint64_t *size);
+nxt_int_t nxt_http_websocket_deflate(nxt_task_t *task, nxt_http_request_t *r,
+    nxt_buf_t **chain);
+#endif
+
+void nxt_http_websocket_channel_handler(nxt_task_t *task,
+    nxt_http_request_t *r, nxt_app_t *app, nxt_port_recv_msg_t *msg);
+void nxt_http_websocket_channels_release(nxt_task_t *task,
+    nxt_http_request_t *r);
+void nxt_http_websocket_publish(nxt_task_t *task, nxt_port_recv_msg_t *msg,
+    nxt_app_t *app, nxt_queue_t *engines);
+void nxt_http_websocket_frames(nxt_http_request_t *r, nxt_buf_t *b);
+void nxt_http_websocket_published(nxt_task_t *task, nxt_http_request_t *r);
+
 extern nxt_time_string_t  nxt_http_date_cache;
+extern nxt_time_string_t  nxt_http_server_date_cache;
 
-extern nxt_lvlhsh_t                        nxt_response_fields_hash;
+extern nxt_flathsh_t                       nxt_response_fields_hash;
 
 extern const nxt_http_proto_table_t  nxt_http_proto[];
 
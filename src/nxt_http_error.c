@@ -54,6 +54,7 @@ nxt_http_request_error(nxt_task_t *task, nxt_http_request_t *r,
 
     r->resp.content_length = NULL;
     r->resp.content_length_n = NXT_HTTP_ERROR_LEN;
+    r->resp.prepared = NULL;
 
     r->state = &nxt_http_request_send_error_body_state;
 
@@ -0,0 +1,792 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+#include <nxt_router.h>
+#include <nxt_http.h>
+
+
+/*
+ * Each engine keeps its own table of limited keys and checks requests
+ * against it without locking.  Every NXT_HTTP_LIMIT_SYNC milliseconds,
+ * on the next request it handles, an engine merges the keys it has used
+ * since the previous merge with the table shared by all engines under
+ * a spinlock: the requests admitted since the previous merge and the
+ * number of active requests are added to the shared values, and the local
+ * values are updated to include the requests of the other engines.  Thus,
+ * a limit can be exceeded by the requests admitted by the other engines
+ * since their last merge.
+ *
+ * Tables keep keys in the least recently used order.  Each merge also
+ * expires up to NXT_HTTP_LIMIT_SWEEP least recently used idle keys, so
+ * the time spent under the lock does not depend on the number of keys.
+ * A table holds up to "max_keys" keys; the least recently used idle key
+ * is evicted to add a new one.
+ */
+
+#define NXT_HTTP_LIMIT_SYNC      100
+#define NXT_HTTP_LIMIT_SWEEP     16
+#define NXT_HTTP_LIMIT_MAX_KEYS  10000
+
+
+typedef struct {
+    nxt_queue_link_t            link;
+
+    nxt_msec_t                  used;
+    nxt_msec_t                  last;
+    nxt_int_t                   excess;  /* in 1/1000 of requests */
+    nxt_uint_t                  requests;
+
+    nxt_str_t                   key;
+} nxt_http_limit_node_t;
+
+
+typedef struct {
+    nxt_lvlhsh_t                hash;
+    nxt_queue_t                 nodes;  /* the least recently used first */
+    nxt_uint_t                  count;
+    nxt_uint_t                  max;
+} nxt_http_limit_table_t;
+
+
+typedef struct {
+    nxt_event_engine_t          *engine;
+    nxt_http_limit_t            *limit;
+    nxt_http_limit_table_t      table;
+    nxt_msec_t                  synced;
+} nxt_http_limit_shard_t;
+
+
+struct nxt_http_limit_entry_s {
+    /* The node must be the first field. */
+    nxt_http_limit_node_t       node;
+
+    nxt_http_limit_shard_t      *shard;
+
+    /* The excess right after the last merge. */
+    nxt_int_t                   merged;
+    nxt_msec_t                  merged_at;
+
+    /* Active requests on this engine accounted in the shared table. */
+    nxt_uint_t                  reported;
+
+    /* Active requests on the other engines as of the last merge. */
+    nxt_uint_t                  others;
+};
+
+
+struct nxt_http_limit_s {
+    nxt_tstr_t                  *key;
+
+    nxt_uint_t                  rate;   /* in 1/1000 of requests per msec */
+    nxt_uint_t                  burst;  /* in 1/1000 of requests */
+    nxt_uint_t                  requests;
+
+    nxt_thread_spinlock_t       lock;
+    nxt_http_limit_table_t      shared;
+
+    nxt_uint_t                  nshards;
+    nxt_http_limit_shard_t      shards[];
+};
+
+
+typedef struct {
+    nxt_str_t                   key;
+    nxt_int_t                   rate;
+    nxt_int_t                   burst;
+    nxt_int_t                   requests;
+    nxt_int_t                   max_keys;
+} nxt_http_limit_conf_t;
+
+
+typedef struct {
+    nxt_http_limit_t            *limit;
+    nxt_http_action_t           *action;
+    nxt_str_t                   key;
+} nxt_http_limit_ctx_t;
+
+
+static void nxt_http_limit_query_ready(nxt_task_t *task, void *obj,
+    void *data);
+static void nxt_http_limit_query_error(nxt_task_t *task, void *obj,
+    void *data);
+static nxt_int_t nxt_http_limit_check(nxt_task_t *task,
+    nxt_http_request_t *r, nxt_http_limit_t *limit, nxt_str_t *key);
+static nxt_http_limit_shard_t *nxt_http_limit_shard(nxt_http_limit_t *limit,
+    nxt_event_engine_t *engine);
+static void nxt_http_limit_excess(nxt_http_limit_t *limit,
+    nxt_http_limit_node_t *node, nxt_msec_t now);
+static void nxt_http_limit_sync(nxt_http_limit_shard_t *shard,
+    nxt_msec_t now);
+static void nxt_http_limit_merge(nxt_http_limit_t *limit,
+    nxt_http_limit_entry_t *entry, nxt_msec_t now);
+static void *nxt_http_limit_node(nxt_http_limit_table_t *table,
+    nxt_str_t *key, size_t size, nxt_msec_t now);
+static void nxt_http_limit_node_use(nxt_http_limit_table_t *table,
+    nxt_http_limit_node_t *node, nxt_msec_t now);
+static void nxt_http_limit_node_delete(nxt_http_limit_table_t *table,
+    nxt_http_limit_node_t *node);
+static void nxt_http_limit_table_free(nxt_http_limit_table_t *table);
+static nxt_int_t nxt_http_limit_node_test(nxt_lvlhsh_query_t *lhq,
+    void *data);
+
+
+static nxt_conf_map_t  nxt_http_limit_conf[] = {
+    {
+        nxt_string("key"),
+        NXT_CONF_MAP_STR,
+        offsetof(nxt_http_limit_conf_t, key),
+    },
+
+    {
+        nxt_string("rate"),
+        NXT_CONF_MAP_INT,
+        offsetof(nxt_http_limit_conf_t, rate),
+    },
+
+    {
+        nxt_string("burst"),
+        NXT_CONF_MAP_INT,
+        offsetof(nxt_http_limit_conf_t, burst),
+    },
+
+    {
+        nxt_string("requests"),
+        NXT_CONF_MAP_INT,
+        offsetof(nxt_http_limit_conf_t, requests),
+    },
+
+    {
+        nxt_string("max_keys"),
+        NXT_CONF_MAP_INT,
+        offsetof(nxt_http_limit_conf_t, max_keys),
+    },
+};
+
+
+static const nxt_lvlhsh_proto_t  nxt_http_limit_hash_proto  nxt_aligned(64) = {
+    NXT_LVLHSH_DEFAULT,
+    nxt_http_limit_node_test,
+    nxt_lvlhsh_alloc,
+    nxt_lvlhsh_free,
+};
+
+
+nxt_http_limit_t *
+nxt_http_limit_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
+    nxt_conf_value_t *cv)
+{
+    nxt_int_t              ret;
+    nxt_uint_t             i, n;
+    nxt_router_conf_t      *rtcf;
+    nxt_http_limit_t       *limit, **p;
+    nxt_http_limit_conf_t  lcf;
+
+    nxt_memzero(&lcf, sizeof(lcf));
+
+    lcf.max_keys = NXT_HTTP_LIMIT_MAX_KEYS;
+
+    ret = nxt_conf_map_object(tmcf->mem_pool, cv, nxt_http_limit_conf,
+                              nxt_nitems(nxt_http_limit_conf), &lcf);
+    if (ret != NXT_OK) {
+        return NULL;
+    }
+
+    rtcf = tmcf->router_conf;
+    n = rtcf->threads;
+
+    limit = nxt_mp_zalloc(rtcf->mem_pool, sizeof(nxt_http_limit_t)
+                                          + n * sizeof(nxt_http_limit_shard_t));
+    if (nxt_slow_path(limit == NULL)) {
+        return NULL;
+    }
+
+    limit->key = nxt_tstr_compile(rtcf->tstr_state, &lcf.key, 0);
+    if (nxt_slow_path(limit->key == NULL)) {
+        return NULL;
+    }
+
+    limit->rate = lcf.rate;
+    limit->burst = lcf.burst * 1000;
+    limit->requests = lcf.requests;
+
+    /* The shared table holds the keys of all engines. */
+
+    nxt_queue_init(&limit->shared.nodes);
+    limit->shared.max = lcf.max_keys * n;
+
+    limit->nshards = n;
+
+    for (i = 0; i < n; i++) {
+        limit->shards[i].limit = limit;
+        nxt_queue_init(&limit->shards[i].table.nodes);
+        limit->shards[i].table.max = lcf.max_keys;
+    }
+
+    if (rtcf->limits == NULL) {
+        rtcf->limits = nxt_array_create(rtcf->mem_pool, 4,
+                                        sizeof(nxt_http_limit_t *));
+        if (nxt_slow_path(rtcf->limits == NULL)) {
+            return NULL;
+        }
+    }
+
+    p = nxt_array_add(rtcf->limits);
+    if (nxt_slow_path(p == NULL)) {
+        return NULL;
+    }
+
+    *p = limit;
+
+    return limit;
+}
+
+
+nxt_http_action_t *
+nxt_http_limit_handler(nxt_task_t *task, nxt_http_request_t *r,
+    nxt_http_limit_t *limit, nxt_http_action_t *action)
+{
+    nxt_int_t             ret;
+    nxt_str_t             key;
+    nxt_router_conf_t     *rtcf;
+    nxt_http_limit_ctx_t  *ctx;
+
+    if (r->limit_entry != NULL) {
+        /* The request has already passed a limit. */
+        return action;
+    }
+
+    if (nxt_tstr_is_const(limit->key)) {
+        nxt_tstr_str(limit->key, &key);
+
+        ret = nxt_http_limit_check(task, r, limit, &key);
+        if (ret != NXT_OK) {
+            goto fail;
+        }
+
+        return action;
+    }
+
+    ctx = nxt_mp_get(r->mem_pool, sizeof(nxt_http_limit_ctx_t));
+    if (nxt_slow_path(ctx == NULL)) {
+        ret = NXT_HTTP_INTERNAL_SERVER_ERROR;
+        goto fail;
+    }
+
+    ctx->limit = limit;
+    ctx->action = action;
+
+    rtcf = r->conf->socket_conf->router_conf;
+
+    ret = nxt_tstr_query_init(&r->tstr_query, rtcf->tstr_state, &r->tstr_cache,
+                              r, r->mem_pool);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        ret = NXT_HTTP_INTERNAL_SERVER_ERROR;
+        goto fail;
+    }
+
+    nxt_tstr_query(task, r->tstr_query, limit->key, &ctx->key);
+    nxt_tstr_query_resolve(task, r->tstr_query, ctx,
+                           nxt_http_limit_query_ready,
+                           nxt_http_limit_query_error);
+    return NULL;
+
+fail:
+
+    nxt_http_request_error(task, r, ret);
+    return NULL;
+}
+
+
+static void
+nxt_http_limit_query_ready(nxt_task_t *task, void *obj, void *data)
+{
+    nxt_int_t             ret;
+    nxt_http_request_t    *r;
+    nxt_http_limit_ctx_t  *ctx;
+
+    r = obj;
+    ctx = data;
+
+    ret = nxt_http_limit_check(task, r, ctx->limit, &ctx->key);
+
+    if (ret != NXT_OK) {
+        nxt_http_request_error(task, r, ret);
+        return;
+    }
+
+    nxt_http_request_action(task, r, ctx->action);
+}
+
+
+static void
+nxt_http_limit_query_error(nxt_task_t *task, void *obj, void *data)
+{
+    nxt_http_request_t  *r;
+
+    r = obj;
+
+    nxt_http_request_error(task, r, NXT_HTTP_INTERNAL_SERVER_ERROR);
+}
+
+
+/*
+ * Returns NXT_OK if the request is admitted, or an HTTP status otherwise.
+ * Requests with an empty key are not limited.
+ */
+
+static nxt_int_t
+nxt_http_limit_check(nxt_task_t *task, nxt_http_request_t *r,
+    nxt_http_limit_t *limit, nxt_str_t *key)
+{
+    nxt_int_t               excess;
+    nxt_msec_t              now;
+    nxt_http_limit_shard_t  *shard;
+    nxt_http_limit_entry_t  *entry;
+
+    if (key->length == 0) {
+        return NXT_OK;
+    }
+
+    shard = nxt_http_limit_shard(limit, task->thread->engine);
+    if (nxt_slow_path(shard == NULL)) {
+        return NXT_HTTP_INTERNAL_SERVER_ERROR;
+    }
+
+    now = task->thread->engine->timers.now;
+
+    if (now - shard->synced >= NXT_HTTP_LIMIT_SYNC) {
+        nxt_http_limit_sync(shard, now);
+    }
+
+    entry = nxt_http_limit_node(&shard->table, key,
+                                sizeof(nxt_http_limit_entry_t), now);
+    if (nxt_slow_path(entry == NULL)) {
+        /* All keys are active or memory allocation failed. */
+        return NXT_HTTP_SERVICE_UNAVAILABLE;
+    }
+
+    entry->shard = shard;
+
+    /*
+     * The requests of the other engines could have completed since
+     * the key was merged last time.
+     */
+
+    if (entry->others != 0 && now - entry->merged_at >= NXT_HTTP_LIMIT_SYNC) {
+        nxt_thread_spin_lock(&limit->lock);
+
+        nxt_http_limit_merge(limit, entry, now);
+
+        nxt_thread_spin_unlock(&limit->lock);
+    }
+
+    if (limit->requests != 0
+        && entry->node.requests + entry->others >= limit->requests)
+    {
+        nxt_debug(task, "http limit \"%V\": %ui active requests", key,
+                  entry->node.requests + entry->others);
+
+        return NXT_HTTP_SERVICE_UNAVAILABLE;
+    }
+
+    if (limit->rate != 0) {
+        nxt_http_limit_excess(limit, &entry->node, now);
+
+        excess = entry->node.excess + 1000;
+
+        if ((nxt_uint_t) excess > limit->burst + 1000) {
+            nxt_debug(task, "http limit \"%V\": excess %i.%03i", key,
+                      excess / 1000, excess % 1000);
+
+            return NXT_HTTP_SERVICE_UNAVAILABLE;
+        }
+
+        entry->node.excess = excess;
+    }
+
+    entry->node.requests++;
+    r->limit_entry = entry;
+
+    return NXT_OK;
+}
+
+
+void
+nxt_http_limit_release(nxt_task_t *task, nxt_http_request_t *r)
+{
+    nxt_msec_t              now;
+    nxt_http_limit_t        *limit;
+    nxt_http_limit_entry_t  *entry;
+
+    entry = r->limit_entry;
+    r->limit_entry = NULL;
+
+    entry->node.requests--;
+
+    limit = entry->shard->limit;
+    now = task->thread->engine->timers.now;
+
+    /* The key is merged on the next synchronization. */
+    nxt_http_limit_node_use(&entry->shard->table, &entry->node, now);
+
+    /*
+     * The last active request on the engine is accounted in the shared
+     * table immediately, otherwise it could block the key on the other
+     * engines while this engine is idle.
+     */
+
+    if (entry->node.requests == 0 && entry->reported != 0) {
+        nxt_thread_spin_lock(&limit->lock);
+
+        nxt_http_limit_merge(limit, entry, now);
+
+        nxt_thread_spin_unlock(&limit->lock);
+    }
+}
+
+
+static nxt_http_limit_shard_t *
+nxt_http_limit_shard(nxt_http_limit_t *limit, nxt_event_engine_t *engine)
+{
+    nxt_uint_t              i;
+    nxt_http_limit_shard_t  *shard;
+
+    for (i = 0; i < limit->nshards; i++) {
+        shard = &limit->shards[i];
+
+        if (shard->engine == engine) {
+            return shard;
+        }
+
+        if (shard->engine == NULL
+            && nxt_atomic_cmp_set((nxt_atomic_t *) &shard->engine,
+                                  (nxt_atomic_t) NULL,
+                                  (nxt_atomic_t) engine))
+        {
+            shard->synced = engine->timers.now;
+            return shard;
+        }
+    }
+
+    return NULL;
+}
+
+
+static void
+nxt_http_limit_excess(nxt_http_limit_t *limit, nxt_http_limit_node_t *node,
+    nxt_msec_t now)
+{
+    nxt_msec_t  ms;
+
+    ms = now - node->last;
+    node->last = now;
+
+    if (node->excess > (nxt_int_t) (limit->rate * ms)) {
+        node->excess -= limit->rate * ms;
+
+    } else {
+        node->excess = 0;
+    }
+}
+
+
+static void
+nxt_http_limit_sync(nxt_http_limit_shard_t *shard, nxt_msec_t now)
+{
+    nxt_uint_t              n;
+    nxt_queue_t             *nodes;
+    nxt_http_limit_t        *limit;
+    nxt_queue_link_t        *lnk, *next;
+    nxt_http_limit_node_t   *node;
+    nxt_http_limit_entry_t  *entry;
+
+    limit = shard->limit;
+    nodes = &shard->table.nodes;
+
+    nxt_thread_spin_lock(&limit->lock);
+
+    /* The keys used since the previous merge are at the tail. */
+
+    for (lnk = nxt_queue_last(nodes);
+         lnk != nxt_queue_head(nodes);
+         lnk = nxt_queue_prev(lnk))
+    {
+        entry = nxt_queue_link_data(lnk, nxt_http_limit_entry_t, node.link);
+
+        if (nxt_msec_diff(entry->node.used, shard->synced) < 0) {
+            break;
+        }
+
+        nxt_http_limit_merge(limit, entry, now);
+    }
+
+    lnk = nxt_queue_first(nodes);
+
+    for (n = 0; n < NXT_HTTP_LIMIT_SWEEP && lnk != nxt_queue_tail(nodes); n++)
+    {
+        next = nxt_queue_next(lnk);
+
+        entry = nxt_queue_link_data(lnk, nxt_http_limit_entry_t, node.link);
+
+        if (entry->node.requests == 0) {
+            nxt_http_limit_merge(limit, entry, now);
+
+            if (entry->node.excess == 0 && entry->others == 0) {
+                nxt_http_limit_node_delete(&shard->table, &entry->node);
+            }
+        }
+
+        lnk = next;
+    }
+
+    nodes = &limit->shared.nodes;
+    lnk = nxt_queue_first(nodes);
+
+    for (n = 0; n < NXT_HTTP_LIMIT_SWEEP && lnk != nxt_queue_tail(nodes); n++)
+    {
+        next = nxt_queue_next(lnk);
+
+        node = nxt_queue_link_data(lnk, nxt_http_limit_node_t, link);
+
+        if (node->requests == 0) {
+            nxt_http_limit_excess(limit, node, now);
+
+            if (node->excess == 0) {
+                nxt_http_limit_node_delete(&limit->shared, node);
+            }
+        }
+
+        lnk = next;
+    }
+
+    nxt_thread_spin_unlock(&limit->lock);
+
+    shard->synced = now;
+}
+
+
+/* The function is called with the limit locked. */
+
+static void
+nxt_http_limit_merge(nxt_http_limit_t *limit, nxt_http_limit_entry_t *entry,
+    nxt_msec_t now)
+{
+    nxt_int_t              merged;
+    nxt_msec_t             ms;
+    nxt_http_limit_node_t  *node;
+
+    node = nxt_http_limit_node(&limit->shared, &entry->node.key,
+                               sizeof(nxt_http_limit_node_t), now);
+    if (nxt_slow_path(node == NULL)) {
+        /*
+         * The key is not in the shared table, so nothing is accounted
+         * there for the engine; all its requests are reported again by
+         * the next successful merge instead of being subtracted from
+         * a node created later.
+         */
+        entry->reported = 0;
+        return;
+    }
+
+    if (limit->rate != 0) {
+        nxt_http_limit_excess(limit, node, now);
+        nxt_http_limit_excess(limit, &entry->node, now);
+
+        /*
+         * The excess accumulated by the engine since the last merge is
+         * the difference with the merged excess leaked to the same time.
+         */
+
+        ms = now - entry->merged_at;
+        merged = entry->merged;
+
+        if (merged > (nxt_int_t) (limit->rate * ms)) {
+            merged -= limit->rate * ms;
+
+        } else {
+            merged = 0;
+        }
+
+        if (entry->node.excess > merged) {
+            node->excess += entry->node.excess - merged;
+        }
+
+        entry->node.excess = nxt_max(entry->node.excess, node->excess);
+
+        entry->merged = entry->node.excess;
+    }
+
+    entry->merged_at = now;
+
+    node->requests += entry->node.requests;
+    node->requests -= entry->reported;
+    entry->reported = entry->node.requests;
+
+    entry->others = node->requests - entry->node.requests;
+
+    if (node->excess == 0 && node->requests == 0) {
+        nxt_http_limit_node_delete(&limit->shared, node);
+    }
+}
+
+
+/*
+ * Finds the node of the key in the table or creates a structure of the size
+ * that starts with the node.  If the table is full, the least recently used
+ * node without active requests is deleted; NULL is returned if there is no
+ * such node among the first NXT_HTTP_LIMIT_SWEEP ones.
+ */
+
+static void *
+nxt_http_limit_node(nxt_http_limit_table_t *table, nxt_str_t *key,
+    size_t size, nxt_msec_t now)
+{
+    nxt_int_t              ret;
+    nxt_uint_t             n;
+    nxt_queue_link_t       *lnk;
+    nxt_http_limit_node_t  *node;
+    nxt_lvlhsh_query_t     lhq;
+
+    lhq.key_hash = nxt_djb_hash(key->start, key->length);
+    lhq.key = *key;
+    lhq.proto = &nxt_http_limit_hash_proto;
+
+    if (nxt_lvlhsh_find(&table->hash, &lhq) == NXT_OK) {
+        node = lhq.value;
+
+        nxt_http_limit_node_use(table, node, now);
+
+        return node;
+    }
+
+    if (table->count >= table->max) {
+        lnk = nxt_queue_first(&table->nodes);
+
+        for (n = 0; n < NXT_HTTP_LIMIT_SWEEP; n++) {
+            if (lnk == nxt_queue_tail(&table->nodes)) {
+                return NULL;
+            }
+
+            node = nxt_queue_link_data(lnk, nxt_http_limit_node_t, link);
+
+            if (node->requests == 0) {
+                nxt_http_limit_node_delete(table, node);
+                break;
+            }
+
+            lnk = nxt_queue_next(lnk);
+        }
+
+        if (n == NXT_HTTP_LIMIT_SWEEP) {
+            return NULL;
+        }
+    }
+
+    node = nxt_zalloc(size + key->length);
+    if (nxt_slow_path(node == NULL)) {
+        return NULL;
+    }
+
+    node->key.length = key->length;
+    node->key.start = (u_char *) node + size;
+    nxt_memcpy(node->key.start, key->start, key->length);
+
+    lhq.key = node->key;
+    lhq.value = node;
+    lhq.replace = 0;
+    lhq.pool = NULL;
+
+    ret = nxt_lvlhsh_insert(&table->hash, &lhq);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        nxt_free(node);
+        return NULL;
+    }
+
+    nxt_queue_insert_tail(&table->nodes, &node->link);
+    table->count++;
+
+    node->used = now;
+
+    return node;
+}
+
+
+static void
+nxt_http_limit_node_use(nxt_http_limit_table_t *table,
+    nxt_http_limit_node_t *node, nxt_msec_t now)
+{
+    node->used = now;
+
+    nxt_queue_remove(&node->link);
+    nxt_queue_insert_tail(&table->nodes, &node->link);
+}
+
+
+static void
+nxt_http_limit_node_delete(nxt_http_limit_table_t *table,
+    nxt_http_limit_node_t *node)
+{
+    nxt_lvlhsh_query_t  lhq;
+
+    lhq.key = node->key;
+    lhq.key_hash = nxt_djb_hash(lhq.key.start, lhq.key.length);
+    lhq.proto = &nxt_http_limit_hash_proto;
+    lhq.pool = NULL;
+
+    (void) nxt_lvlhsh_delete(&table->hash, &lhq);
+
+    nxt_queue_remove(&node->link);
+    table->count--;
+
+    nxt_free(node);
+}
+
+
+void
+nxt_http_limits_release(nxt_router_conf_t *rtcf)
+{
+    nxt_uint_t        i, k;
+    nxt_http_limit_t  **limit;
+
+    if (rtcf->limits == NULL) {
+        return;
+    }
+
+    limit = rtcf->limits->elts;
+
+    for (i = 0; i < rtcf->limits->nelts; i++) {
+        for (k = 0; k < limit[i]->nshards; k++) {
+            nxt_http_limit_table_free(&limit[i]->shards[k].table);
+        }
+
+        nxt_http_limit_table_free(&limit[i]->shared);
+    }
+}
+
+
+static void
+nxt_http_limit_table_free(nxt_http_limit_table_t *table)
+{
+    nxt_queue_link_t       *lnk;
+    nxt_http_limit_node_t  *node;
+
+    while (!nxt_queue_is_empty(&table->nodes)) {
+        lnk = nxt_queue_first(&table->nodes);
+        node = nxt_queue_link_data(lnk, nxt_http_limit_node_t, link);
+
+        nxt_http_limit_node_delete(table, node);
+    }
+}
+
+
+static nxt_int_t
+nxt_http_limit_node_test(nxt_lvlhsh_query_t *lhq, void *data)
+{
+    nxt_http_limit_node_t  *node;
+
+    node = data;
+
+    return nxt_strstr_eq(&lhq->key, &node->key) ? NXT_OK : NXT_DECLINED;
+}
@@ -1177,7 +1177,7 @@ nxt_http_field_hash_collision(nxt_lvlhsh_query_t *lhq, void *data)
 
 
 nxt_int_t
-nxt_http_fields_hash(nxt_lvlhsh_t *hash,
+nxt_http_fields_hash(nxt_flathsh_t *hash,
     nxt_http_field_proc_t items[], nxt_uint_t count)
 {
     u_char              ch;
@@ -1203,7 +1203,7 @@ nxt_http_fields_hash(nxt_lvlhsh_t *hash,
         lhq.key = *name;
         lhq.value = &items[i];
 
-        ret = nxt_lvlhsh_insert(hash, &lhq);
+        ret = nxt_flathsh_insert(hash, &lhq);
 
         if (nxt_slow_path(ret != NXT_OK)) {
             return NXT_ERROR;
@@ -1257,7 +1257,7 @@ nxt_http_fields_hash_collisions(nxt_lvlhsh_t *hash,
 
 
 nxt_int_t
-nxt_http_fields_process(nxt_list_t *fields, nxt_lvlhsh_t *hash, void *ctx)
+nxt_http_fields_process(nxt_list_t *fields, nxt_flathsh_t *hash, void *ctx)
 {
     nxt_int_t         ret;
     nxt_http_field_t  *field;
@@ -1273,3 +1273,138 @@ nxt_http_fields_process(nxt_list_t *fields, nxt_lvlhsh_t *hash, void *ctx)
 
     return NXT_OK;
 }
+
+
+static const char  *nxt_http_field_names[NXT_HTTP_FIELD_KNOWN] = {
+    [NXT_HTTP_FIELD_CONNECTION]               = "connection",
+    [NXT_HTTP_FIELD_UPGRADE]                  = "upgrade",
+    [NXT_HTTP_FIELD_SEC_WEBSOCKET_KEY]        = "sec-websocket-key",
+    [NXT_HTTP_FIELD_SEC_WEBSOCKET_VERSION]    = "sec-websocket-version",
+    [NXT_HTTP_FIELD_SEC_WEBSOCKET_EXTENSIONS] = "sec-websocket-extensions",
+    [NXT_HTTP_FIELD_TRANSFER_ENCODING]        = "transfer-encoding",
+    [NXT_HTTP_FIELD_HOST]                     = "host",
+    [NXT_HTTP_FIELD_COOKIE]                   = "cookie",
+    [NXT_HTTP_FIELD_REFERER]                  = "referer",
+    [NXT_HTTP_FIELD_USER_AGENT]               = "user-agent",
+    [NXT_HTTP_FIELD_CONTENT_TYPE]             = "content-type",
+    [NXT_HTTP_FIELD_CONTENT_LENGTH]           = "content-length",
+    [NXT_HTTP_FIELD_AUTHORIZATION]            = "authorization",
+    [NXT_HTTP_FIELD_SERVER]                   = "server",
+    [NXT_HTTP_FIELD_DATE]                     = "date",
+};
+
+
+/*
+ * The length and the first character are enough to tell the known fields
+ * apart, so the candidate is chosen without hashing and then the whole
+ * name is compared case-insensitively.
+ */
+
+nxt_http_field_id_t
+nxt_http_field_id(const u_char *name, size_t length)
+{
+    u_char               ch;
+    size_t               i;
+    const char           *known;
+    nxt_http_field_id_t  id;
+
+    if (nxt_slow_path(length == 0)) {
+        return NXT_HTTP_FIELD_UNKNOWN;
+    }
+
+    ch = name[0] | 0x20;
+
+    switch (length) {
+
+    case 4:
+        id = (ch == 'h') ? NXT_HTTP_FIELD_HOST : NXT_HTTP_FIELD_DATE;
+        break;
+
+    case 6:
+        id = (ch == 'c') ? NXT_HTTP_FIELD_COOKIE : NXT_HTTP_FIELD_SERVER;
+        break;
+
+    case 7:
+        id = (ch == 'u') ? NXT_HTTP_FIELD_UPGRADE : NXT_HTTP_FIELD_REFERER;
+        break;
+
+    case 10:
+        id = (ch == 'c') ? NXT_HTTP_FIELD_CONNECTION
+                         : NXT_HTTP_FIELD_USER_AGENT;
+        break;
+
+    case 12:
+        id = NXT_HTTP_FIELD_CONTENT_TYPE;
+        break;
+
+    case 13:
+        id = NXT_HTTP_FIELD_AUTHORIZATION;
+        break;
+
+    case 14:
+        id = NXT_HTTP_FIELD_CONTENT_LENGTH;
+        break;
+
+    case 17:
+        id = (ch == 's') ? NXT_HTTP_FIELD_SEC_WEBSOCKET_KEY
+                         : NXT_HTTP_FIELD_TRANSFER_ENCODING;
+        break;
+
+    case 21:
+        id = NXT_HTTP_FIELD_SEC_WEBSOCKET_VERSION;
+        break;
+
+    case 24:
+        id = NXT_HTTP_FIELD_SEC_WEBSOCKET_EXTENSIONS;
+        break;
+
+    default:
+        return NXT_HTTP_FIELD_UNKNOWN;
+    }
+
+    known = nxt_http_field_names[id];
+
+    for (i = 0; i < length; i++) {
+        ch = name[i];
+
+        if (nxt_lowcase(ch) != (u_char) known[i]) {
+            return NXT_HTTP_FIELD_UNKNOWN;
+        }
+    }
+
+    return id;
+}
+
+
+nxt_int_t
+nxt_http_fields_dispatch(nxt_list_t *fields,
+    const nxt_http_field_dispatch_t *table, void *ctx)
+{
+    nxt_int_t                        ret;
+    nxt_http_field_t                 *field;
+    nxt_http_field_id_t              id;
+    const nxt_http_field_dispatch_t  *entry;
+
+    nxt_list_each(field, fields) {
+
+        id = nxt_http_field_id(field->name, field->name_length);
+
+        if (id == NXT_HTTP_FIELD_UNKNOWN) {
+            continue;
+        }
+
+        entry = &table[id];
+
+        if (entry->handler == NULL) {
+            continue;
+        }
+
+        ret = entry->handler(ctx, field, entry->data);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+
+    } nxt_list_loop;
+
+    return NXT_OK;
+}
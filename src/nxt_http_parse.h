@@ -83,6 +83,38 @@ typedef struct {
 } nxt_http_field_proc_t;
 
 
+/*
+ * The fixed set of fields handled by the HTTP/1 request and peer response
+ * processing, recognized by nxt_http_field_id() without a hash lookup.
+ */
+typedef enum {
+    NXT_HTTP_FIELD_UNKNOWN = 0,
+    NXT_HTTP_FIELD_CONNECTION,
+    NXT_HTTP_FIELD_UPGRADE,
+    NXT_HTTP_FIELD_SEC_WEBSOCKET_KEY,
+    NXT_HTTP_FIELD_SEC_WEBSOCKET_VERSION,
+    NXT_HTTP_FIELD_SEC_WEBSOCKET_EXTENSIONS,
+    NXT_HTTP_FIELD_TRANSFER_ENCODING,
+    NXT_HTTP_FIELD_HOST,
+    NXT_HTTP_FIELD_COOKIE,
+    NXT_HTTP_FIELD_REFERER,
+    NXT_HTTP_FIELD_USER_AGENT,
+    NXT_HTTP_FIELD_CONTENT_TYPE,
+    NXT_HTTP_FIELD_CONTENT_LENGTH,
+    NXT_HTTP_FIELD_AUTHORIZATION,
+    NXT_HTTP_FIELD_SERVER,
+    NXT_HTTP_FIELD_DATE,
+    NXT_HTTP_FIELD_KNOWN,
+} nxt_http_field_id_t;
+
+
+/* Indexed by nxt_http_field_id_t, entries without handler are ignored. */
+typedef struct {
+    nxt_http_field_handler_t  handler;
+    uintptr_t                 data;
+} nxt_http_field_dispatch_t;
+
+
 struct nxt_http_field_s {
     uint16_t                  hash;
     uint8_t                   skip:1;
@@ -119,12 +151,15 @@ nxt_int_t nxt_http_parse_request(nxt_http_request_parse_t *rp,
 nxt_int_t nxt_http_parse_fields(nxt_http_request_parse_t *rp,
     nxt_buf_mem_t *b);
 
-nxt_int_t nxt_http_fields_hash(nxt_lvlhsh_t *hash,
+nxt_int_t nxt_http_fields_hash(nxt_flathsh_t *hash,
     nxt_http_field_proc_t items[], nxt_uint_t count);
 nxt_uint_t nxt_http_fields_hash_collisions(nxt_lvlhsh_t *hash,
     nxt_http_field_proc_t items[], nxt_uint_t count, nxt_bool_t level);
-nxt_int_t nxt_http_fields_process(nxt_list_t *fields, nxt_lvlhsh_t *hash,
+nxt_int_t nxt_http_fields_process(nxt_list_t *fields, nxt_flathsh_t *hash,
     void *ctx);
+nxt_http_field_id_t nxt_http_field_id(const u_char *name, size_t length);
+nxt_int_t nxt_http_fields_dispatch(nxt_list_t *fields,
+    const nxt_http_field_dispatch_t *table, void *ctx);
 
 nxt_buf_t *nxt_http_chunk_parse(nxt_task_t *task, nxt_http_chunk_parse_t *hcp,
     nxt_buf_t *in);
@@ -133,7 +168,7 @@ nxt_buf_t *nxt_http_chunk_parse(nxt_task_t *task, nxt_http_chunk_parse_t *hcp,
 extern const nxt_lvlhsh_proto_t  nxt_http_fields_hash_proto;
 
 nxt_inline nxt_int_t
-nxt_http_field_process(nxt_http_field_t *field, nxt_lvlhsh_t *hash, void *ctx)
+nxt_http_field_process(nxt_http_field_t *field, nxt_flathsh_t *hash, void *ctx)
 {
     nxt_lvlhsh_query_t     lhq;
     nxt_http_field_proc_t  *proc;
@@ -144,7 +179,7 @@ nxt_http_field_process(nxt_http_field_t *field, nxt_lvlhsh_t *hash, void *ctx)
     lhq.key.length = field->name_length;
     lhq.key.start = field->name;
 
-    if (nxt_lvlhsh_find(hash, &lhq) != NXT_OK) {
+    if (nxt_flathsh_find(hash, &lhq) != NXT_OK) {
         return NXT_OK;
     }
 
@@ -173,6 +173,7 @@ nxt_http_proxy_upstream_ready(nxt_task_t *task, nxt_upstream_server_t *us)
     peer->protocol = us->protocol;
 
     peer->request->state = &nxt_http_proxy_header_send_state;
+    peer->request->upstream_start = nxt_thread_monotonic_time(task->thread);
 
     nxt_http_proto[peer->protocol].peer_connect(task, peer);
 }
@@ -208,6 +209,7 @@ nxt_http_proxy_header_send(nxt_task_t *task, void *obj, void *data)
     r = obj;
     peer = data;
     r->state = &nxt_http_proxy_header_sent_state;
+    r->upstream_connected = nxt_thread_monotonic_time(task->thread);
 
     nxt_http_proto[peer->protocol].peer_header_send(task, peer);
 }
@@ -309,6 +311,8 @@ nxt_http_proxy_send_body(nxt_task_t *task, void *obj, void *data)
         nxt_http_proto[peer->protocol].peer_read(task, peer);
 
     } else {
+        r->upstream_end = nxt_thread_monotonic_time(task->thread);
+
         nxt_http_proto[peer->protocol].peer_close(task, peer);
 
         nxt_mp_release(r->mem_pool);
@@ -381,6 +385,8 @@ nxt_http_proxy_error(nxt_task_t *task, void *obj, void *data)
     r = obj;
     peer = r->peer;
 
+    r->upstream_end = nxt_thread_monotonic_time(task->thread);
+
     nxt_http_proto[peer->protocol].peer_close(task, peer);
 
     nxt_mp_release(r->mem_pool);
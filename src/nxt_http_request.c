@@ -27,6 +27,8 @@ static void nxt_http_request_done(nxt_task_t *task, void *obj, void *data);
 
 static u_char *nxt_http_date_cache_handler(u_char *buf, nxt_realtime_t *now,
     struct tm *tm, size_t size, const char *format);
+static u_char *nxt_http_server_date_cache_handler(u_char *buf,
+    nxt_realtime_t *now, struct tm *tm, size_t size, const char *format);
 
 static nxt_http_name_value_t *nxt_http_argument(nxt_array_t *array,
     u_char *name, size_t name_length, uint32_t hash, u_char *start,
@@ -62,17 +64,25 @@ nxt_time_string_t  nxt_http_date_cache = {
 };
 
 
-nxt_int_t
-nxt_http_init(nxt_task_t *task)
-{
-    nxt_int_t  ret;
+#define NXT_HTTP_SERVER_DATE  "Server: " NXT_SERVER "\r\nDate: "
 
-    ret = nxt_h1p_init(task);
+/*
+ * The "Server" and "Date" response header lines serialized together
+ * once a second per thread.
+ */
+nxt_time_string_t  nxt_http_server_date_cache = {
+    (nxt_atomic_uint_t) -1,
+    nxt_http_server_date_cache_handler,
+    NULL,
+    nxt_length(NXT_HTTP_SERVER_DATE "\r\n") + NXT_HTTP_DATE_LEN,
+    NXT_THREAD_TIME_GMT,
+    NXT_THREAD_TIME_SEC,
+};
 
-    if (ret != NXT_OK) {
-        return ret;
-    }
 
+nxt_int_t
+nxt_http_init(nxt_task_t *task)
+{
     return nxt_http_response_hash_init(task);
 }
 
@@ -247,7 +257,7 @@ nxt_http_request_create(nxt_task_t *task)
     nxt_buf_t           *last;
     nxt_http_request_t  *r;
 
-    mp = nxt_mp_create(4096, 128, 512, 32);
+    mp = nxt_mp_cache_get(task->thread->engine->request_mp_cache);
     if (nxt_slow_path(mp == NULL)) {
         return NULL;
     }
@@ -622,73 +632,14 @@ void
 nxt_http_request_header_send(nxt_task_t *task, nxt_http_request_t *r,
     nxt_work_handler_t body_handler, void *data)
 {
-    u_char            *p, *end;
-    nxt_http_field_t  *server, *date, *content_length;
-
     /*
-     * TODO: "Server", "Date", and "Content-Length" processing should be moved
-     * to the last header filter.
+     * The "Server", "Date", and "Content-Length" fields are serialized
+     * by the protocol header send handler.
      */
 
-    server = nxt_list_zero_add(r->resp.fields);
-    if (nxt_slow_path(server == NULL)) {
-        goto fail;
-    }
-
-    nxt_http_field_set(server, "Server", NXT_SERVER);
-
-    if (r->resp.date == NULL) {
-        date = nxt_list_zero_add(r->resp.fields);
-        if (nxt_slow_path(date == NULL)) {
-            goto fail;
-        }
-
-        nxt_http_field_name_set(date, "Date");
-
-        p = nxt_mp_nget(r->mem_pool, nxt_http_date_cache.size);
-        if (nxt_slow_path(p == NULL)) {
-            goto fail;
-        }
-
-        (void) nxt_thread_time_string(task->thread, &nxt_http_date_cache, p);
-
-        date->value = p;
-        date->value_length = nxt_http_date_cache.size;
-
-        r->resp.date = date;
-    }
-
-    if (r->resp.content_length_n != -1
-        && (r->resp.content_length == NULL || r->resp.content_length->skip))
-    {
-        content_length = nxt_list_zero_add(r->resp.fields);
-        if (nxt_slow_path(content_length == NULL)) {
-            goto fail;
-        }
-
-        nxt_http_field_name_set(content_length, "Content-Length");
-
-        p = nxt_mp_nget(r->mem_pool, NXT_OFF_T_LEN);
-        if (nxt_slow_path(p == NULL)) {
-            goto fail;
-        }
-
-        content_length->value = p;
-        end = nxt_sprintf(p, p + NXT_OFF_T_LEN, "%O", r->resp.content_length_n);
-        content_length->value_length = end - p;
-
-        r->resp.content_length = content_length;
-    }
-
     if (nxt_fast_path(r->proto.any != NULL)) {
         nxt_http_proto[r->protocol].header_send(task, r, body_handler, data);
     }
-
-    return;
-
-fail:
-
-    nxt_http_request_error(task, r, NXT_HTTP_INTERNAL_SERVER_ERROR);
 }
 
 
@@ -812,6 +763,8 @@ nxt_http_request_close_handler(nxt_task_t *task, void *obj, void *data)
     if (!r->logged) {
         r->logged = 1;
 
+        nxt_router_http_request_stats(task, r);
+
         access_log = conf->socket_conf->router_conf->access_log;
         log_format = conf->socket_conf->router_conf->log_format;
 
@@ -837,6 +790,14 @@ nxt_http_request_close_handler(nxt_task_t *task, void *obj, void *data)
         nxt_tstr_query_release(r->tstr_query);
     }
 
+    if (r->limit_entry != NULL) {
+        nxt_http_limit_release(task, r);
+    }
+
+    if (r->ws_subscriptions != NULL || r->ws_published != NULL) {
+        nxt_http_websocket_channels_release(task, r);
+    }
+
     if (nxt_fast_path(proto.any != NULL)) {
         protocol = r->protocol;
 
@@ -855,6 +816,20 @@ nxt_http_date_cache_handler(u_char *buf, nxt_realtime_t *now, struct tm *tm,
 }
 
 
+static u_char *
+nxt_http_server_date_cache_handler(u_char *buf, nxt_realtime_t *now,
+    struct tm *tm, size_t size, const char *format)
+{
+    buf = nxt_cpymem(buf, NXT_HTTP_SERVER_DATE,
+                     nxt_length(NXT_HTTP_SERVER_DATE));
+    buf = nxt_http_date(buf, tm);
+
+    *buf++ = '\r'; *buf++ = '\n';
+
+    return buf;
+}
+
+
 nxt_array_t *
 nxt_http_arguments_parse(nxt_http_request_t *r)
 {
@@ -11,6 +11,7 @@ typedef struct {
     nxt_http_status_t  status;
     nxt_tstr_t         *location;
     nxt_str_t          encoded;
+    nxt_str_t          header;
 } nxt_http_return_conf_t;
 
 
@@ -24,6 +25,8 @@ static nxt_http_action_t *nxt_http_return(nxt_task_t *task,
     nxt_http_request_t *r, nxt_http_action_t *action);
 static nxt_int_t nxt_http_return_encode(nxt_mp_t *mp, nxt_str_t *encoded,
     const nxt_str_t *location);
+static nxt_int_t nxt_http_return_header(nxt_mp_t *mp,
+    nxt_http_return_conf_t *conf);
 static void nxt_http_return_send_ready(nxt_task_t *task, void *obj, void *data);
 static void nxt_http_return_send_error(nxt_task_t *task, void *obj, void *data);
 
@@ -35,6 +38,7 @@ nxt_int_t
 nxt_http_return_init(nxt_router_conf_t *rtcf, nxt_http_action_t *action,
     nxt_http_action_conf_t *acf)
 {
+    nxt_int_t               ret;
     nxt_mp_t                *mp;
     nxt_str_t               str;
     nxt_http_return_conf_t  *conf;
@@ -64,7 +68,13 @@ nxt_http_return_init(nxt_router_conf_t *rtcf, nxt_http_action_t *action,
 
     if (nxt_tstr_is_const(conf->location)) {
         nxt_tstr_str(conf->location, &str);
-        return nxt_http_return_encode(mp, &conf->encoded, &str);
+
+        ret = nxt_http_return_encode(mp, &conf->encoded, &str);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+
+        return nxt_http_return_header(mp, conf);
     }
 
     return NXT_OK;
@@ -102,42 +112,38 @@ nxt_http_return(nxt_task_t *task, nxt_http_request_t *r,
         return NULL;
     }
 
-    if (conf->location == NULL) {
-        ctx = NULL;
-
-    } else {
-        ctx = nxt_mp_zget(r->mem_pool, sizeof(nxt_http_return_ctx_t));
-        if (nxt_slow_path(ctx == NULL)) {
-            goto fail;
-        }
-    }
-
     r->status = conf->status;
     r->resp.content_length_n = 0;
 
-    if (ctx == NULL || nxt_tstr_is_const(conf->location)) {
-        if (ctx != NULL) {
-            ctx->encoded = conf->encoded;
+    if (conf->location == NULL || nxt_tstr_is_const(conf->location)) {
+        if (conf->location != NULL) {
+            r->resp.prepared = &conf->header;
         }
 
-        nxt_http_return_send_ready(task, r, ctx);
+        nxt_http_return_send_ready(task, r, NULL);
 
-    } else {
-        rtcf = r->conf->socket_conf->router_conf;
+        return NULL;
+    }
 
-        ret = nxt_tstr_query_init(&r->tstr_query, rtcf->tstr_state,
-                                  &r->tstr_cache, r, r->mem_pool);
-        if (nxt_slow_path(ret != NXT_OK)) {
-            goto fail;
-        }
+    ctx = nxt_mp_zget(r->mem_pool, sizeof(nxt_http_return_ctx_t));
+    if (nxt_slow_path(ctx == NULL)) {
+        goto fail;
+    }
 
-        nxt_tstr_query(task, r->tstr_query, conf->location, &ctx->location);
+    rtcf = r->conf->socket_conf->router_conf;
 
-        nxt_tstr_query_resolve(task, r->tstr_query, ctx,
-                               nxt_http_return_send_ready,
-                               nxt_http_return_send_error);
+    ret = nxt_tstr_query_init(&r->tstr_query, rtcf->tstr_state,
+                              &r->tstr_cache, r, r->mem_pool);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        goto fail;
     }
 
+    nxt_tstr_query(task, r->tstr_query, conf->location, &ctx->location);
+
+    nxt_tstr_query_resolve(task, r->tstr_query, ctx,
+                           nxt_http_return_send_ready,
+                           nxt_http_return_send_error);
+
     return NULL;
 
 fail:
@@ -173,6 +179,27 @@ nxt_http_return_encode(nxt_mp_t *mp, nxt_str_t *encoded,
 }
 
 
+static nxt_int_t
+nxt_http_return_header(nxt_mp_t *mp, nxt_http_return_conf_t *conf)
+{
+    u_char  *p;
+
+    conf->header.length = nxt_length("Location: \r\n")
+                          + conf->encoded.length;
+
+    conf->header.start = nxt_mp_nget(mp, conf->header.length);
+    if (nxt_slow_path(conf->header.start == NULL)) {
+        return NXT_ERROR;
+    }
+
+    p = nxt_cpymem(conf->header.start, "Location: ", nxt_length("Location: "));
+    p = nxt_cpymem(p, conf->encoded.start, conf->encoded.length);
+    *p++ = '\r'; *p = '\n';
+
+    return NXT_OK;
+}
+
+
 static void
 nxt_http_return_send_ready(nxt_task_t *task, void *obj, void *data)
 {
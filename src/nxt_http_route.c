@@ -139,6 +139,8 @@ typedef union {
 typedef struct {
     uint32_t                       items;
     nxt_http_action_t              action;
+    nxt_http_limit_t               *limit;
+    nxt_status_traffic_t           *traffic;  /* per router engine */
     nxt_http_route_test_t          test[0];
 } nxt_http_route_match_t;
 
@@ -291,6 +293,28 @@ nxt_http_routes_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
 }
 
 
+nxt_int_t
+nxt_http_routes_status(nxt_http_routes_t *routes, uint32_t i, nxt_str_t **name,
+    uint32_t *steps)
+{
+    if (routes == NULL || i >= routes->items) {
+        return NXT_DECLINED;
+    }
+
+    *name = &routes->route[i]->name;
+    *steps = routes->route[i]->items;
+
+    return NXT_OK;
+}
+
+
+nxt_status_traffic_t *
+nxt_http_route_traffic(nxt_http_routes_t *routes, uint32_t i, uint32_t step)
+{
+    return routes->route[i]->match[step]->traffic;
+}
+
+
 static nxt_conf_map_t  nxt_http_route_match_conf[] = {
     {
         nxt_string("scheme"),
@@ -397,7 +421,7 @@ nxt_http_route_match_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
     uint32_t                     n;
     nxt_mp_t                     *mp;
     nxt_int_t                    ret;
-    nxt_conf_value_t             *match_conf, *action_conf;
+    nxt_conf_value_t             *match_conf, *action_conf, *limit_conf;
     nxt_http_route_test_t        *test;
     nxt_http_route_rule_t        *rule;
     nxt_http_route_table_t       *table;
@@ -407,6 +431,7 @@ nxt_http_route_match_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
 
     static nxt_str_t  match_path = nxt_string("/match");
     static nxt_str_t  action_path = nxt_string("/action");
+    static nxt_str_t  limit_path = nxt_string("/limit");
 
     match_conf = nxt_conf_get_path(cv, &match_path);
 
@@ -422,6 +447,12 @@ nxt_http_route_match_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
 
     match->items = n;
 
+    match->traffic = nxt_mp_zget(mp, nxt_router->status_slots
+                                     * sizeof(nxt_status_traffic_t));
+    if (nxt_slow_path(match->traffic == NULL)) {
+        return NULL;
+    }
+
     action_conf = nxt_conf_get_path(cv, &action_path);
     if (nxt_slow_path(action_conf == NULL)) {
         return NULL;
@@ -432,6 +463,17 @@ nxt_http_route_match_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
         return NULL;
     }
 
+    match->limit = NULL;
+
+    limit_conf = nxt_conf_get_path(cv, &limit_path);
+
+    if (limit_conf != NULL) {
+        match->limit = nxt_http_limit_create(task, tmcf, limit_conf);
+        if (nxt_slow_path(match->limit == NULL)) {
+            return NULL;
+        }
+    }
+
     if (n == 0) {
         return match;
     }
@@ -1551,6 +1593,15 @@ nxt_http_route_handler(nxt_task_t *task, nxt_http_request_t *r,
     while (match < end) {
         action = nxt_http_route_match(task, r, *match);
         if (action != NULL) {
+            if (action != NXT_HTTP_ACTION_ERROR) {
+                r->route_traffic = (*match)->traffic;
+
+                if ((*match)->limit != NULL) {
+                    return nxt_http_limit_handler(task, r, (*match)->limit,
+                                                  action);
+                }
+            }
+
             return action;
         }
 
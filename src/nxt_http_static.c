@@ -60,6 +60,8 @@ static void nxt_http_static_body_handler(nxt_task_t *task, void *obj,
     void *data);
 static void nxt_http_static_buf_completion(nxt_task_t *task, void *obj,
     void *data);
+static void nxt_http_static_file_completion(nxt_task_t *task, void *obj,
+    void *data);
 
 static nxt_int_t nxt_http_static_mtypes_hash_test(nxt_lvlhsh_query_t *lhq,
     void *data);
@@ -796,6 +798,21 @@ nxt_http_static_body_handler(nxt_task_t *task, void *obj, void *data)
     r = obj;
     fb = r->out;
 
+    if (r->sendfile) {
+        /* The connection sends the file with sendfile(). */
+        r->out = NULL;
+
+        nxt_buf_set_file(fb);
+        fb->completion_handler = nxt_http_static_file_completion;
+        fb->parent = r;
+        fb->next = nxt_http_buf_last(r);
+
+        nxt_mp_retain(r->mem_pool);
+
+        nxt_http_request_send(task, r, fb);
+        return;
+    }
+
     rest = fb->file_end - fb->file_pos;
     out = NULL;
     next = &out;
@@ -924,8 +941,23 @@ nxt_http_static_buf_completion(nxt_task_t *task, void *obj, void *data)
 }
 
 
+static void
+nxt_http_static_file_completion(nxt_task_t *task, void *obj, void *data)
+{
+    nxt_buf_t           *b;
+    nxt_http_request_t  *r;
+
+    b = obj;
+    r = data;
+
+    nxt_file_close(task, b->file);
+
+    nxt_mp_release(r->mem_pool);
+}
+
+
 nxt_int_t
-nxt_http_static_mtypes_init(nxt_mp_t *mp, nxt_lvlhsh_t *hash)
+nxt_http_static_mtypes_init(nxt_mp_t *mp, nxt_flathsh_t *hash)
 {
     nxt_str_t   *type, exten;
     nxt_int_t   ret;
@@ -1030,7 +1062,7 @@ typedef struct {
 
 
 nxt_int_t
-nxt_http_static_mtypes_hash_add(nxt_mp_t *mp, nxt_lvlhsh_t *hash,
+nxt_http_static_mtypes_hash_add(nxt_mp_t *mp, nxt_flathsh_t *hash,
     const nxt_str_t *exten, nxt_str_t *type)
 {
     nxt_lvlhsh_query_t       lhq;
@@ -1051,12 +1083,12 @@ nxt_http_static_mtypes_hash_add(nxt_mp_t *mp, nxt_lvlhsh_t *hash,
     lhq.proto = &nxt_http_static_mtypes_hash_proto;
     lhq.pool = mp;
 
-    return nxt_lvlhsh_insert(hash, &lhq);
+    return nxt_flathsh_insert(hash, &lhq);
 }
 
 
 nxt_str_t *
-nxt_http_static_mtype_get(nxt_lvlhsh_t *hash, const nxt_str_t *exten)
+nxt_http_static_mtype_get(nxt_flathsh_t *hash, const nxt_str_t *exten)
 {
     nxt_lvlhsh_query_t       lhq;
     nxt_http_static_mtype_t  *mtype;
@@ -1067,7 +1099,7 @@ nxt_http_static_mtype_get(nxt_lvlhsh_t *hash, const nxt_str_t *exten)
     lhq.key_hash = nxt_djb_hash_lowcase(lhq.key.start, lhq.key.length);
     lhq.proto = &nxt_http_static_mtypes_hash_proto;
 
-    if (nxt_lvlhsh_find(hash, &lhq) == NXT_OK) {
+    if (nxt_flathsh_find(hash, &lhq) == NXT_OK) {
         mtype = lhq.value;
         return mtype->type;
     }
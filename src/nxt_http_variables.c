@@ -11,6 +11,18 @@ static nxt_int_t nxt_http_var_dollar(nxt_task_t *task, nxt_str_t *str,
     void *ctx, uint16_t field);
 static nxt_int_t nxt_http_var_request_time(nxt_task_t *task, nxt_str_t *str,
     void *ctx, uint16_t field);
+static nxt_int_t nxt_http_var_tls_handshake_time(nxt_task_t *task,
+    nxt_str_t *str, void *ctx, uint16_t field);
+static nxt_int_t nxt_http_var_queue_time(nxt_task_t *task, nxt_str_t *str,
+    void *ctx, uint16_t field);
+static nxt_int_t nxt_http_var_app_time(nxt_task_t *task, nxt_str_t *str,
+    void *ctx, uint16_t field);
+static nxt_int_t nxt_http_var_upstream_connect_time(nxt_task_t *task,
+    nxt_str_t *str, void *ctx, uint16_t field);
+static nxt_int_t nxt_http_var_upstream_response_time(nxt_task_t *task,
+    nxt_str_t *str, void *ctx, uint16_t field);
+static nxt_int_t nxt_http_var_time_span(nxt_str_t *str, nxt_mp_t *mp,
+    nxt_nsec_t start, nxt_nsec_t end);
 static nxt_int_t nxt_http_var_method(nxt_task_t *task, nxt_str_t *str,
     void *ctx, uint16_t field);
 static nxt_int_t nxt_http_var_request_uri(nxt_task_t *task, nxt_str_t *str,
@@ -50,6 +62,21 @@ static nxt_var_decl_t  nxt_http_vars[] = {
     }, {
         .name = nxt_string("request_time"),
         .handler = nxt_http_var_request_time,
+    }, {
+        .name = nxt_string("tls_handshake_time"),
+        .handler = nxt_http_var_tls_handshake_time,
+    }, {
+        .name = nxt_string("queue_time"),
+        .handler = nxt_http_var_queue_time,
+    }, {
+        .name = nxt_string("app_time"),
+        .handler = nxt_http_var_app_time,
+    }, {
+        .name = nxt_string("upstream_connect_time"),
+        .handler = nxt_http_var_upstream_connect_time,
+    }, {
+        .name = nxt_string("upstream_response_time"),
+        .handler = nxt_http_var_upstream_response_time,
     }, {
         .name = nxt_string("method"),
         .handler = nxt_http_var_method,
@@ -143,6 +170,102 @@ nxt_http_var_request_time(nxt_task_t *task, nxt_str_t *str, void *ctx,
 }
 
 
+static nxt_int_t
+nxt_http_var_tls_handshake_time(nxt_task_t *task, nxt_str_t *str, void *ctx,
+    uint16_t field)
+{
+    nxt_http_request_t  *r;
+
+    r = ctx;
+
+    return nxt_http_var_time_span(str, r->mem_pool, r->tls_start, r->tls_end);
+}
+
+
+static nxt_int_t
+nxt_http_var_queue_time(nxt_task_t *task, nxt_str_t *str, void *ctx,
+    uint16_t field)
+{
+    nxt_http_request_t  *r;
+
+    r = ctx;
+
+    return nxt_http_var_time_span(str, r->mem_pool, r->queue_start,
+                                  r->app_start);
+}
+
+
+static nxt_int_t
+nxt_http_var_app_time(nxt_task_t *task, nxt_str_t *str, void *ctx,
+    uint16_t field)
+{
+    nxt_http_request_t  *r;
+
+    r = ctx;
+
+    return nxt_http_var_time_span(str, r->mem_pool, r->app_start, r->app_end);
+}
+
+
+static nxt_int_t
+nxt_http_var_upstream_connect_time(nxt_task_t *task, nxt_str_t *str,
+    void *ctx, uint16_t field)
+{
+    nxt_http_request_t  *r;
+
+    r = ctx;
+
+    return nxt_http_var_time_span(str, r->mem_pool, r->upstream_start,
+                                  r->upstream_connected);
+}
+
+
+static nxt_int_t
+nxt_http_var_upstream_response_time(nxt_task_t *task, nxt_str_t *str,
+    void *ctx, uint16_t field)
+{
+    nxt_http_request_t  *r;
+
+    r = ctx;
+
+    return nxt_http_var_time_span(str, r->mem_pool, r->upstream_start,
+                                  r->upstream_end);
+}
+
+
+/*
+ * The duration of a request processing phase in seconds with millisecond
+ * resolution, or "-" if the phase has not been started or completed.
+ */
+
+static nxt_int_t
+nxt_http_var_time_span(nxt_str_t *str, nxt_mp_t *mp, nxt_nsec_t start,
+    nxt_nsec_t end)
+{
+    u_char      *p;
+    nxt_msec_t  ms;
+
+    if (start == 0 || end == 0) {
+        nxt_str_set(str, "-");
+        return NXT_OK;
+    }
+
+    ms = (end - start) / 1000000;
+
+    str->start = nxt_mp_nget(mp, NXT_TIME_T_LEN + 4);
+    if (nxt_slow_path(str->start == NULL)) {
+        return NXT_ERROR;
+    }
+
+    p = nxt_sprintf(str->start, str->start + NXT_TIME_T_LEN, "%T.%03M",
+                    (nxt_time_t) ms / 1000, ms % 1000);
+
+    str->length = p - str->start;
+
+    return NXT_OK;
+}
+
+
 static nxt_int_t
 nxt_http_var_method(nxt_task_t *task, nxt_str_t *str, void *ctx, uint16_t field)
 {
@@ -80,15 +80,16 @@ nxt_http_websocket_client(nxt_task_t *task, void *obj, void *data)
                                        chunk_copy_size);
 
             copy_size -= chunk_copy_size;
+            frame_size -= chunk_copy_size;
             b->mem.pos += chunk_copy_size;
             buf_free_size -= chunk_copy_size;
         }
 
-        frame_size -= copy_size;
         next = b->next;
-        b->next = NULL;
 
         if (nxt_buf_mem_used_size(&b->mem) == 0) {
+            b->next = NULL;
+
             nxt_work_queue_add(&task->thread->engine->fast_work_queue,
                                b->completion_handler, task, b, b->parent);
 
@@ -0,0 +1,719 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+#include <nxt_router.h>
+#include <nxt_http.h>
+#include <nxt_websocket.h>
+#include <nxt_websocket_header.h>
+
+
+/*
+ * Each engine keeps its own table of channels with the WebSocket
+ * connections it handles subscribed.  Channels are scoped per application:
+ * a connection subscribes to a channel of the application it is passed to,
+ * and a frame is published to the channels of the application whose
+ * process has sent it.  A published frame is posted to every engine, and
+ * each engine queues it to its subscribers.  A subscriber's queue is sent
+ * only between application messages, so published frames never get into
+ * an application frame or a fragmented message.  The subscribers' buffers
+ * refer to the published frame, which is released after it has been sent
+ * to all of them.
+ */
+
+
+/*
+ * The size of published frames a connection may have queued or not yet
+ * sent.  A subscriber that falls further behind is closed, so it does not
+ * pin shared memory of the application and router memory.
+ */
+#define NXT_HTTP_WS_PUBLISHED_MAX  (1024 * 1024)
+
+
+typedef struct {
+    nxt_queue_t                         subscriptions;
+    /* The reference to the application is held by the channel. */
+    nxt_app_t                           *app;
+    nxt_str_t                           name;
+    /* The channel is not deleted while a frame is queued to it. */
+    uint8_t                             publishing;   /* 1 bit */
+} nxt_http_websocket_channel_t;
+
+
+struct nxt_http_websocket_subscription_s {
+    nxt_queue_link_t                    link;
+    nxt_http_websocket_subscription_t   *next;
+    nxt_http_request_t                  *request;
+    nxt_http_websocket_channel_t        *channel;
+};
+
+
+typedef struct {
+    nxt_atomic_t                        count;
+
+    /* The shared memory buffer, NULL if the frame has been copied. */
+    nxt_buf_t                           *buf;
+
+    /* The reference to the application is held by the message. */
+    nxt_app_t                           *app;
+    nxt_str_t                           channel;
+    u_char                              *start;
+    u_char                              *end;
+
+    nxt_work_t                          work[];
+} nxt_http_websocket_message_t;
+
+
+static nxt_int_t nxt_http_websocket_subscribe(nxt_task_t *task,
+    nxt_http_request_t *r, nxt_app_t *app, nxt_str_t *name);
+static void nxt_http_websocket_unsubscribe(nxt_task_t *task,
+    nxt_http_request_t *r, nxt_str_t *name);
+static void nxt_http_websocket_subscription_free(nxt_task_t *task,
+    nxt_http_request_t *r, nxt_http_websocket_subscription_t *sub);
+static nxt_http_websocket_channel_t *nxt_http_websocket_channel_find(
+    nxt_event_engine_t *engine, nxt_app_t *app, nxt_str_t *name);
+static void nxt_http_websocket_channel_delete(nxt_task_t *task,
+    nxt_http_websocket_channel_t *channel);
+static nxt_websocket_channel_msg_t *nxt_http_websocket_channel_msg(
+    nxt_task_t *task, nxt_buf_t *b, size_t size, nxt_str_t *name);
+static void nxt_http_websocket_publish_handler(nxt_task_t *task, void *obj,
+    void *data);
+static void nxt_http_websocket_message_queue(nxt_task_t *task,
+    nxt_http_request_t *r, nxt_http_websocket_message_t *wm);
+static void nxt_http_websocket_message_buf_completion(nxt_task_t *task,
+    void *obj, void *data);
+static void nxt_http_websocket_message_release(nxt_task_t *task,
+    nxt_http_websocket_message_t *wm);
+static nxt_int_t nxt_http_websocket_channel_test(nxt_lvlhsh_query_t *lhq,
+    void *data);
+
+
+static const nxt_lvlhsh_proto_t  nxt_http_websocket_channel_proto
+    nxt_aligned(64) =
+{
+    NXT_LVLHSH_DEFAULT,
+    nxt_http_websocket_channel_test,
+    nxt_lvlhsh_alloc,
+    nxt_lvlhsh_free,
+};
+
+
+void
+nxt_http_websocket_channel_handler(nxt_task_t *task, nxt_http_request_t *r,
+    nxt_app_t *app, nxt_port_recv_msg_t *msg)
+{
+    nxt_str_t                    name;
+    nxt_websocket_channel_msg_t  *cm;
+
+    cm = nxt_http_websocket_channel_msg(task, msg->buf, msg->size, &name);
+    if (nxt_slow_path(cm == NULL)) {
+        return;
+    }
+
+    if (nxt_slow_path(!r->websocket_handshake)) {
+        nxt_alert(task, "websocket channel message for not WebSocket request");
+        return;
+    }
+
+    switch (cm->type) {
+
+    case NXT_WEBSOCKET_CHANNEL_SUBSCRIBE:
+        (void) nxt_http_websocket_subscribe(task, r, app, &name);
+        break;
+
+    case NXT_WEBSOCKET_CHANNEL_UNSUBSCRIBE:
+        nxt_http_websocket_unsubscribe(task, r, &name);
+        break;
+
+    default:
+        nxt_alert(task, "unexpected websocket channel message type %d",
+                  cm->type);
+        break;
+    }
+}
+
+
+static nxt_int_t
+nxt_http_websocket_subscribe(nxt_task_t *task, nxt_http_request_t *r,
+    nxt_app_t *app, nxt_str_t *name)
+{
+    nxt_int_t                          ret;
+    nxt_event_engine_t                 *engine;
+    nxt_lvlhsh_query_t                 lhq;
+    nxt_http_websocket_channel_t       *channel;
+    nxt_http_websocket_subscription_t  *sub;
+
+    for (sub = r->ws_subscriptions; sub != NULL; sub = sub->next) {
+        if (sub->channel->app == app
+            && nxt_strstr_eq(&sub->channel->name, name))
+        {
+            return NXT_OK;
+        }
+    }
+
+    engine = task->thread->engine;
+
+    channel = nxt_http_websocket_channel_find(engine, app, name);
+
+    if (channel == NULL) {
+        channel = nxt_malloc(sizeof(nxt_http_websocket_channel_t)
+                             + name->length);
+        if (nxt_slow_path(channel == NULL)) {
+            return NXT_ERROR;
+        }
+
+        nxt_queue_init(&channel->subscriptions);
+
+        channel->app = app;
+        channel->publishing = 0;
+        channel->name.length = name->length;
+        channel->name.start = (u_char *) channel
+                              + sizeof(nxt_http_websocket_channel_t);
+        nxt_memcpy(channel->name.start, name->start, name->length);
+
+        lhq.key_hash = nxt_djb_hash(name->start, name->length);
+        lhq.key = channel->name;
+        lhq.value = channel;
+        lhq.replace = 0;
+        lhq.proto = &nxt_http_websocket_channel_proto;
+        lhq.pool = NULL;
+        lhq.data = app;
+
+        ret = nxt_lvlhsh_insert(&engine->websocket_channels, &lhq);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            nxt_free(channel);
+            return NXT_ERROR;
+        }
+
+        nxt_router_app_use(task, app, 1);
+    }
+
+    sub = nxt_mp_alloc(r->mem_pool, sizeof(nxt_http_websocket_subscription_t));
+    if (nxt_slow_path(sub == NULL)) {
+        if (nxt_queue_is_empty(&channel->subscriptions)) {
+            nxt_http_websocket_channel_delete(task, channel);
+        }
+
+        return NXT_ERROR;
+    }
+
+    sub->request = r;
+    sub->channel = channel;
+    sub->next = r->ws_subscriptions;
+    r->ws_subscriptions = sub;
+
+    nxt_queue_insert_tail(&channel->subscriptions, &sub->link);
+
+    nxt_debug(task, "websocket subscribe \"%V\"", name);
+
+    return NXT_OK;
+}
+
+
+static void
+nxt_http_websocket_unsubscribe(nxt_task_t *task, nxt_http_request_t *r,
+    nxt_str_t *name)
+{
+    nxt_http_websocket_subscription_t  *sub, **prev;
+
+    prev = &r->ws_subscriptions;
+
+    for (sub = r->ws_subscriptions; sub != NULL; sub = sub->next) {
+        if (nxt_strstr_eq(&sub->channel->name, name)) {
+            *prev = sub->next;
+
+            nxt_debug(task, "websocket unsubscribe \"%V\"", name);
+
+            nxt_http_websocket_subscription_free(task, r, sub);
+            return;
+        }
+
+        prev = &sub->next;
+    }
+}
+
+
+void
+nxt_http_websocket_channels_release(nxt_task_t *task, nxt_http_request_t *r)
+{
+    nxt_buf_t                          *b;
+    nxt_http_websocket_subscription_t  *sub, *next;
+
+    b = r->ws_published;
+
+    if (b != NULL) {
+        r->ws_published = NULL;
+        nxt_http_websocket_message_buf_completion(task, b, NULL);
+    }
+
+    sub = r->ws_subscriptions;
+    r->ws_subscriptions = NULL;
+
+    while (sub != NULL) {
+        next = sub->next;
+
+        nxt_http_websocket_subscription_free(task, r, sub);
+
+        sub = next;
+    }
+}
+
+
+static void
+nxt_http_websocket_subscription_free(nxt_task_t *task, nxt_http_request_t *r,
+    nxt_http_websocket_subscription_t *sub)
+{
+    nxt_http_websocket_channel_t  *channel;
+
+    channel = sub->channel;
+
+    nxt_queue_remove(&sub->link);
+    nxt_mp_free(r->mem_pool, sub);
+
+    if (nxt_queue_is_empty(&channel->subscriptions) && !channel->publishing) {
+        nxt_http_websocket_channel_delete(task, channel);
+    }
+}
+
+
+static nxt_http_websocket_channel_t *
+nxt_http_websocket_channel_find(nxt_event_engine_t *engine, nxt_app_t *app,
+    nxt_str_t *name)
+{
+    nxt_lvlhsh_query_t  lhq;
+
+    lhq.key_hash = nxt_djb_hash(name->start, name->length);
+    lhq.key = *name;
+    lhq.proto = &nxt_http_websocket_channel_proto;
+    lhq.data = app;
+
+    if (nxt_lvlhsh_find(&engine->websocket_channels, &lhq) == NXT_OK) {
+        return lhq.value;
+    }
+
+    return NULL;
+}
+
+
+static void
+nxt_http_websocket_channel_delete(nxt_task_t *task,
+    nxt_http_websocket_channel_t *channel)
+{
+    nxt_lvlhsh_query_t  lhq;
+
+    lhq.key = channel->name;
+    lhq.key_hash = nxt_djb_hash(lhq.key.start, lhq.key.length);
+    lhq.proto = &nxt_http_websocket_channel_proto;
+    lhq.pool = NULL;
+    lhq.data = channel->app;
+
+    (void) nxt_lvlhsh_delete(&task->thread->engine->websocket_channels, &lhq);
+
+    nxt_router_app_use(task, channel->app, -1);
+
+    nxt_free(channel);
+}
+
+
+static nxt_websocket_channel_msg_t *
+nxt_http_websocket_channel_msg(nxt_task_t *task, nxt_buf_t *b, size_t size,
+    nxt_str_t *name)
+{
+    nxt_websocket_channel_msg_t  *cm;
+
+    if (nxt_slow_path(b == NULL
+                      || b->next != NULL
+                      || (size_t) nxt_buf_mem_used_size(&b->mem) != size
+                      || size < sizeof(nxt_websocket_channel_msg_t)))
+    {
+        nxt_alert(task, "invalid websocket channel message");
+        return NULL;
+    }
+
+    cm = (nxt_websocket_channel_msg_t *) b->mem.pos;
+
+    if (nxt_slow_path(cm->name_length == 0
+                      || size < sizeof(nxt_websocket_channel_msg_t)
+                                + cm->name_length))
+    {
+        nxt_alert(task, "invalid websocket channel name length %d",
+                  cm->name_length);
+        return NULL;
+    }
+
+    name->length = cm->name_length;
+    name->start = b->mem.pos + sizeof(nxt_websocket_channel_msg_t);
+
+    return cm;
+}
+
+
+void
+nxt_http_websocket_publish(nxt_task_t *task, nxt_port_recv_msg_t *msg,
+    nxt_app_t *app, nxt_queue_t *engines)
+{
+    u_char                        *p;
+    size_t                        size, hsize;
+    uint64_t                      payload_len;
+    nxt_str_t                     name;
+    nxt_uint_t                    n;
+    nxt_event_engine_t            *engine;
+    nxt_websocket_channel_msg_t   *cm;
+    nxt_http_websocket_message_t  *wm;
+
+    cm = nxt_http_websocket_channel_msg(task, msg->buf, msg->size, &name);
+    if (nxt_slow_path(cm == NULL)) {
+        return;
+    }
+
+    if (nxt_slow_path(cm->type != NXT_WEBSOCKET_CHANNEL_PUBLISH)) {
+        nxt_alert(task, "unexpected websocket channel message type %d",
+                  cm->type);
+        return;
+    }
+
+    p = name.start + name.length;
+    size = msg->buf->mem.free - p;
+
+    if (nxt_slow_path(size < 2
+                      || size < nxt_websocket_frame_header_size(p)))
+    {
+        nxt_alert(task, "websocket publish frame too small: %uz", size);
+        return;
+    }
+
+    hsize = nxt_websocket_frame_header_size(p);
+    payload_len = nxt_websocket_frame_payload_len(p);
+
+    if (nxt_slow_path(payload_len != size - hsize)) {
+        nxt_alert(task, "websocket publish frame size mismatch: %uL of %uz",
+                  payload_len, size - hsize);
+        return;
+    }
+
+    n = 0;
+
+    nxt_queue_each(engine, engines, nxt_event_engine_t, link0) {
+        n++;
+    } nxt_queue_loop;
+
+    if (nxt_buf_is_port_mmap(msg->buf)) {
+        wm = nxt_malloc(sizeof(nxt_http_websocket_message_t)
+                        + n * sizeof(nxt_work_t));
+        if (nxt_slow_path(wm == NULL)) {
+            return;
+        }
+
+        /* Disable instant buffer completion by port. */
+        wm->buf = msg->buf;
+        msg->buf = NULL;
+
+        wm->channel = name;
+        wm->start = p;
+
+    } else {
+        wm = nxt_malloc(sizeof(nxt_http_websocket_message_t)
+                        + n * sizeof(nxt_work_t) + name.length + size);
+        if (nxt_slow_path(wm == NULL)) {
+            return;
+        }
+
+        wm->buf = NULL;
+
+        wm->channel.length = name.length;
+        wm->channel.start = (u_char *) &wm->work[n];
+        wm->start = nxt_cpymem(wm->channel.start, name.start, name.length);
+
+        nxt_memcpy(wm->start, p, size);
+    }
+
+    wm->app = app;
+    wm->end = wm->start + size;
+
+    nxt_router_app_use(task, app, 1);
+
+    /* The reference held while the message is posted to the engines. */
+    wm->count = 1;
+
+    n = 0;
+
+    nxt_queue_each(engine, engines, nxt_event_engine_t, link0) {
+        (void) nxt_atomic_fetch_add(&wm->count, 1);
+
+        wm->work[n].next = NULL;
+
+        nxt_work_set(&wm->work[n], nxt_http_websocket_publish_handler,
+                     &engine->task, wm, NULL);
+
+        nxt_event_engine_post(engine, &wm->work[n]);
+
+        n++;
+    } nxt_queue_loop;
+
+    nxt_debug(task, "websocket publish \"%V\" to %ui engines", &name, n);
+
+    nxt_http_websocket_message_release(task, wm);
+}
+
+
+static void
+nxt_http_websocket_publish_handler(nxt_task_t *task, void *obj, void *data)
+{
+    nxt_http_request_t                 *r;
+    nxt_queue_link_t                   *lnk, *next;
+    nxt_http_websocket_channel_t       *channel;
+    nxt_http_websocket_message_t       *wm;
+    nxt_http_websocket_subscription_t  *sub;
+
+    wm = obj;
+
+    channel = nxt_http_websocket_channel_find(task->thread->engine, wm->app,
+                                              &wm->channel);
+    if (channel == NULL) {
+        goto done;
+    }
+
+    /* A request may be closed while the frame is sent to it. */
+
+    channel->publishing = 1;
+
+    for (lnk = nxt_queue_first(&channel->subscriptions);
+         lnk != nxt_queue_tail(&channel->subscriptions);
+         lnk = next)
+    {
+        next = nxt_queue_next(lnk);
+
+        sub = nxt_queue_link_data(lnk, nxt_http_websocket_subscription_t,
+                                  link);
+        r = sub->request;
+
+        if (r->error || !r->header_sent) {
+            continue;
+        }
+
+        nxt_http_websocket_message_queue(task, r, wm);
+    }
+
+    channel->publishing = 0;
+
+    if (nxt_queue_is_empty(&channel->subscriptions)) {
+        nxt_http_websocket_channel_delete(task, channel);
+    }
+
+done:
+
+    nxt_http_websocket_message_release(task, wm);
+}
+
+
+static void
+nxt_http_websocket_message_queue(nxt_task_t *task, nxt_http_request_t *r,
+    nxt_http_websocket_message_t *wm)
+{
+    size_t     size;
+    nxt_buf_t  *b;
+
+    size = wm->end - wm->start;
+
+    if (nxt_slow_path(r->ws_published_size != 0
+                      && r->ws_published_size + size
+                         > NXT_HTTP_WS_PUBLISHED_MAX))
+    {
+        nxt_log(task, NXT_LOG_WARN, "websocket subscriber has %uz bytes of "
+                "published frames pending, closing connection",
+                r->ws_published_size);
+
+        nxt_http_request_error(&r->task, r, NXT_HTTP_INTERNAL_SERVER_ERROR);
+        return;
+    }
+
+    b = nxt_buf_mem_alloc(r->mem_pool, 0, 0);
+    if (nxt_slow_path(b == NULL)) {
+        return;
+    }
+
+    nxt_mp_retain(r->mem_pool);
+
+    r->ws_published_size += size;
+
+    b->mem.start = wm->start;
+    b->mem.pos = wm->start;
+    b->mem.free = wm->end;
+    b->mem.end = wm->end;
+
+    /* The completion handler takes the pool from the request. */
+    b->data = r;
+    b->completion_handler = nxt_http_websocket_message_buf_completion;
+    b->parent = wm;
+
+    (void) nxt_atomic_fetch_add(&wm->count, 1);
+
+    nxt_buf_chain_add(&r->ws_published, b);
+
+    nxt_http_websocket_published(task, r);
+
+    b = r->out;
+
+    if (b != NULL) {
+        r->out = NULL;
+        nxt_http_request_send(&r->task, r, b);
+    }
+}
+
+
+/*
+ * Follows the frames an application sends to a client to find the ends
+ * of its messages.  A frame header is always at the start of a buffer,
+ * and a frame may span several buffers.
+ */
+
+void
+nxt_http_websocket_frames(nxt_http_request_t *r, nxt_buf_t *b)
+{
+    u_char                  *p;
+    size_t                  size, hsize;
+    uint64_t                n;
+    nxt_websocket_header_t  *wsh;
+
+    for ( /* void */ ; b != NULL; b = b->next) {
+
+        if (!nxt_buf_is_mem(b)) {
+            continue;
+        }
+
+        p = b->mem.pos;
+
+        for ( ;; ) {
+            size = b->mem.free - p;
+
+            if (size == 0) {
+                break;
+            }
+
+            if (r->ws_out_rest == 0) {
+                wsh = (nxt_websocket_header_t *) p;
+
+                if (size < 2 || size < nxt_websocket_frame_header_size(wsh)) {
+                    break;
+                }
+
+                hsize = nxt_websocket_frame_header_size(wsh);
+
+                if ((wsh->opcode & NXT_WEBSOCKET_OP_CTRL) == 0) {
+                    r->ws_out_fragmented = !wsh->fin;
+                }
+
+                r->ws_out_rest = hsize + nxt_websocket_frame_payload_len(wsh);
+            }
+
+            n = nxt_min((uint64_t) size, r->ws_out_rest);
+
+            p += n;
+            r->ws_out_rest -= n;
+        }
+    }
+}
+
+
+/*
+ * Moves the queued published frames to the request output, if the
+ * application is between messages.  The frames are compressed if
+ * the permessage-deflate extension has been negotiated.  On failure
+ * the request is finalized.
+ */
+
+void
+nxt_http_websocket_published(nxt_task_t *task, nxt_http_request_t *r)
+{
+    nxt_buf_t  *b;
+
+    if (r->ws_out_rest != 0 || r->ws_out_fragmented) {
+        return;
+    }
+
+    b = r->ws_published;
+    r->ws_published = NULL;
+
+#if (NXT_HAVE_ZLIB)
+    if (r->ws_deflate != NULL) {
+        if (nxt_slow_path(nxt_http_websocket_deflate(task, r, &b) != NXT_OK)) {
+            return;
+        }
+    }
+#endif
+
+    if (b != NULL) {
+        nxt_buf_chain_add(&r->out, b);
+    }
+}
+
+
+static void
+nxt_http_websocket_message_buf_completion(nxt_task_t *task, void *obj,
+    void *data)
+{
+    nxt_mp_t                      *mp;
+    nxt_buf_t                     *b, *next;
+    nxt_http_request_t            *r;
+    nxt_http_websocket_message_t  *wm;
+
+    b = obj;
+
+    do {
+        next = b->next;
+        r = b->data;
+        wm = b->parent;
+
+        mp = r->mem_pool;
+        r->ws_published_size -= wm->end - wm->start;
+
+        nxt_http_websocket_message_release(task, wm);
+
+        nxt_mp_free(mp, b);
+        nxt_mp_release(mp);
+
+        b = next;
+    } while (b != NULL);
+}
+
+
+static void
+nxt_http_websocket_message_release(nxt_task_t *task,
+    nxt_http_websocket_message_t *wm)
+{
+    nxt_buf_t  *b;
+
+    if (nxt_atomic_fetch_add(&wm->count, -1) != 1) {
+        return;
+    }
+
+    b = wm->buf;
+
+    if (b != NULL) {
+        /* The completion is passed to the buffer's engine if needed. */
+        b->mem.pos = b->mem.free;
+        b->completion_handler(task, b, b->parent);
+    }
+
+    nxt_router_app_use(task, wm->app, -1);
+
+    nxt_free(wm);
+}
+
+
+static nxt_int_t
+nxt_http_websocket_channel_test(nxt_lvlhsh_query_t *lhq, void *data)
+{
+    nxt_http_websocket_channel_t  *channel;
+
+    channel = data;
+
+    if (channel->app == lhq->data
+        && nxt_strstr_eq(&lhq->key, &channel->name))
+    {
+        return NXT_OK;
+    }
+
+    return NXT_DECLINED;
+}
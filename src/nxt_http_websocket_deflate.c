@@ -0,0 +1,882 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+#include <nxt_router.h>
+#include <nxt_http.h>
+#include <nxt_websocket.h>
+#include <nxt_websocket_header.h>
+#include <zlib.h>
+
+
+/*
+ * The permessage-deflate extension (RFC 7692).  Client messages are
+ * inflated before they are passed to an application, and application
+ * messages are deflated before they are sent to a client, so applications
+ * always deal with uncompressed frames.
+ */
+
+#define NXT_HTTP_WS_DEFLATE_BUF_SIZE  8192
+
+/*
+ * The deflate state takes (1 << (window_bits + 2)) + (1 << (mem_level + 9))
+ * bytes, so the memory level is scaled down with the window: 32K for the
+ * default 4K window instead of 256K for the zlib defaults.
+ */
+#define nxt_http_ws_deflate_mem_level(window_bits)                            \
+    nxt_max((window_bits) - 7, 1)
+
+
+struct nxt_http_websocket_deflate_s {
+    z_stream               inflate;
+    z_stream               deflate;
+
+    nxt_mp_t               *mem_pool;
+
+    /* The compressed payload of the current application frame. */
+    nxt_buf_t              *out;
+    nxt_buf_t              *out_last;
+    nxt_buf_t              *out_prev;
+    size_t                 out_size;
+
+    /* The payload bytes left in the current application frame. */
+    uint64_t               rest;
+
+    size_t                 threshold;
+
+    uint8_t                window_bits;
+    /* The client window, 0 if the client cannot limit it. */
+    uint8_t                client_window_bits;
+    uint8_t                no_context_takeover;   /* 1 bit */
+    uint8_t                inflate_ready;         /* 1 bit */
+    uint8_t                deflate_ready;         /* 1 bit */
+
+    uint8_t                deflating;             /* 1 bit */
+
+    uint8_t                frame;                 /* 1 bit */
+    uint8_t                compress;              /* 1 bit */
+    uint8_t                fin;                   /* 1 bit */
+    uint8_t                rsv1;                  /* 1 bit */
+    uint8_t                opcode;
+};
+
+
+static nxt_int_t nxt_http_websocket_deflate_offer(
+    nxt_http_websocket_deflate_t *wd, u_char *p, u_char *end);
+static nxt_int_t nxt_http_websocket_deflate_param(
+    nxt_http_websocket_deflate_t *wd, u_char *p, u_char *end);
+static nxt_int_t nxt_http_websocket_inflate_buf(nxt_http_request_t *r,
+    nxt_http_websocket_deflate_t *wd, nxt_buf_t **out, nxt_buf_t **last,
+    size_t limit, uint64_t *size);
+static nxt_int_t nxt_http_websocket_deflate_run(nxt_task_t *task,
+    nxt_http_request_t *r, nxt_http_websocket_deflate_t *wd, u_char *data,
+    size_t size, int flush);
+static nxt_buf_t *nxt_http_websocket_deflate_frame(nxt_task_t *task,
+    nxt_http_request_t *r, nxt_http_websocket_deflate_t *wd);
+static void nxt_http_websocket_deflate_complete(nxt_task_t *task,
+    nxt_buf_t *b);
+static void *nxt_http_websocket_zalloc(void *opaque, u_int items, u_int size);
+static void nxt_http_websocket_zfree(void *opaque, void *address);
+
+
+static const u_char  nxt_http_websocket_deflate_tail[] = {
+    0x00, 0x00, 0xff, 0xff
+};
+
+
+nxt_int_t
+nxt_http_websocket_deflate_negotiate(nxt_http_request_t *r,
+    nxt_http_field_t *field, nxt_str_t *response)
+{
+    u_char                        *p, *end, *offer;
+    size_t                        n;
+    nxt_websocket_conf_t          *conf;
+    nxt_http_websocket_deflate_t  *wd;
+
+    conf = &r->conf->socket_conf->websocket_conf;
+
+    wd = nxt_mp_zget(r->mem_pool, sizeof(nxt_http_websocket_deflate_t));
+    if (nxt_slow_path(wd == NULL)) {
+        return NXT_ERROR;
+    }
+
+    p = field->value;
+    end = p + field->value_length;
+
+    /* The first acceptable offer is accepted. */
+
+    for ( ;; ) {
+        offer = memchr(p, ',', end - p);
+
+        if (offer == NULL) {
+            offer = end;
+        }
+
+        wd->window_bits = conf->deflate_window_bits;
+        wd->client_window_bits = 0;
+        wd->no_context_takeover = !conf->deflate_context_takeover;
+
+        if (nxt_http_websocket_deflate_offer(wd, p, offer) == NXT_OK) {
+            break;
+        }
+
+        if (offer == end) {
+            return NXT_OK;
+        }
+
+        p = offer + 1;
+    }
+
+    n = nxt_length("permessage-deflate")
+        + nxt_length("; server_max_window_bits=15")
+        + nxt_length("; server_no_context_takeover")
+        + nxt_length("; client_max_window_bits=15");
+
+    response->start = nxt_mp_nget(r->mem_pool, n);
+    if (nxt_slow_path(response->start == NULL)) {
+        return NXT_ERROR;
+    }
+
+    p = nxt_cpymem(response->start, "permessage-deflate",
+                   nxt_length("permessage-deflate"));
+
+    if (wd->window_bits < 15) {
+        p = nxt_sprintf(p, response->start + n,
+                        "; server_max_window_bits=%d", wd->window_bits);
+    }
+
+    if (wd->no_context_takeover) {
+        p = nxt_cpymem(p, "; server_no_context_takeover",
+                       nxt_length("; server_no_context_takeover"));
+    }
+
+    /*
+     * The client window is limited to the server one if the client
+     * allows it, so the inflate state is not larger than the deflate one.
+     */
+
+    if (wd->client_window_bits != 0) {
+        wd->client_window_bits = nxt_min(wd->client_window_bits,
+                                         conf->deflate_window_bits);
+
+        p = nxt_sprintf(p, response->start + n,
+                        "; client_max_window_bits=%d", wd->client_window_bits);
+
+    } else {
+        wd->client_window_bits = 15;
+    }
+
+    response->length = p - response->start;
+
+    wd->mem_pool = r->mem_pool;
+    wd->threshold = conf->deflate_threshold;
+
+    r->ws_deflate = wd;
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+nxt_http_websocket_deflate_offer(nxt_http_websocket_deflate_t *wd, u_char *p,
+    u_char *end)
+{
+    u_char  *param;
+
+    static const nxt_str_t  name = nxt_string("permessage-deflate");
+
+    param = memchr(p, ';', end - p);
+
+    if (param == NULL) {
+        param = end;
+    }
+
+    while (p < param && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+
+    if (param - p < (ssize_t) name.length
+        || nxt_memcasecmp(p, name.start, name.length) != 0)
+    {
+        return NXT_DECLINED;
+    }
+
+    for (p += name.length; p < param; p++) {
+        if (*p != ' ' && *p != '\t') {
+            return NXT_DECLINED;
+        }
+    }
+
+    while (param < end) {
+        p = param + 1;
+
+        param = memchr(p, ';', end - p);
+
+        if (param == NULL) {
+            param = end;
+        }
+
+        if (nxt_http_websocket_deflate_param(wd, p, param) != NXT_OK) {
+            return NXT_DECLINED;
+        }
+    }
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+nxt_http_websocket_deflate_param(nxt_http_websocket_deflate_t *wd, u_char *p,
+    u_char *end)
+{
+    u_char     *value;
+    size_t     length;
+    nxt_int_t  bits;
+
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+
+    while (end > p && (end[-1] == ' ' || end[-1] == '\t')) {
+        end--;
+    }
+
+    value = memchr(p, '=', end - p);
+
+    if (value != NULL) {
+        length = value - p;
+
+        while (length > 0 && (p[length - 1] == ' ' || p[length - 1] == '\t')) {
+            length--;
+        }
+
+        value++;
+
+        while (value < end && (*value == ' ' || *value == '\t')) {
+            value++;
+        }
+
+        if (end - value >= 2 && *value == '"' && end[-1] == '"') {
+            value++;
+            end--;
+        }
+
+        bits = nxt_int_parse(value, end - value);
+
+    } else {
+        length = end - p;
+        bits = -1;
+    }
+
+    if (length == nxt_length("server_no_context_takeover")
+        && nxt_memcasecmp(p, "server_no_context_takeover", length) == 0)
+    {
+        if (value != NULL) {
+            return NXT_DECLINED;
+        }
+
+        wd->no_context_takeover = 1;
+
+        return NXT_OK;
+    }
+
+    if (length == nxt_length("client_no_context_takeover")
+        && nxt_memcasecmp(p, "client_no_context_takeover", length) == 0)
+    {
+        /* Inflating with a retained context is compatible with it. */
+
+        return (value == NULL) ? NXT_OK : NXT_DECLINED;
+    }
+
+    if (length == nxt_length("server_max_window_bits")
+        && nxt_memcasecmp(p, "server_max_window_bits", length) == 0)
+    {
+        /* zlib cannot produce raw deflate data with 256-byte windows. */
+
+        if (bits < 9 || bits > 15) {
+            return NXT_DECLINED;
+        }
+
+        wd->window_bits = nxt_min(wd->window_bits, bits);
+
+        return NXT_OK;
+    }
+
+    if (length == nxt_length("client_max_window_bits")
+        && nxt_memcasecmp(p, "client_max_window_bits", length) == 0)
+    {
+        if (value == NULL) {
+            bits = 15;
+
+        } else if (bits < 8 || bits > 15) {
+            return NXT_DECLINED;
+        }
+
+        wd->client_window_bits = bits;
+
+        return NXT_OK;
+    }
+
+    return NXT_DECLINED;
+}
+
+
+/*
+ * Replaces the compressed client frame at the head of r->ws_frame with
+ * an unmasked frame holding the inflated payload.  NXT_DECLINED means that
+ * the data are corrupted or that the inflated payload exceeds the limit;
+ * *size is set to the inflated size in the latter case.
+ */
+
+nxt_int_t
+nxt_http_websocket_inflate(nxt_task_t *task, nxt_http_request_t *r,
+    size_t limit, uint64_t *size)
+{
+    int                           ret;
+    u_char                        *p;
+    size_t                        n;
+    uint8_t                       fin, opcode, mask[4];
+    uint64_t                      len, offset;
+    nxt_buf_t                     *b, *header, *out, *last, *next;
+    nxt_websocket_header_t        *wsh;
+    nxt_http_websocket_deflate_t  *wd;
+
+    wd = r->ws_deflate;
+    *size = 0;
+
+    if (!wd->inflate_ready) {
+        wd->inflate.zalloc = nxt_http_websocket_zalloc;
+        wd->inflate.zfree = nxt_http_websocket_zfree;
+        wd->inflate.opaque = wd->mem_pool;
+
+        ret = inflateInit2(&wd->inflate, -wd->client_window_bits);
+        if (nxt_slow_path(ret != Z_OK)) {
+            nxt_alert(task, "inflateInit2() failed: %d", ret);
+            return NXT_ERROR;
+        }
+
+        wd->inflate_ready = 1;
+    }
+
+    b = r->ws_frame;
+    wsh = (nxt_websocket_header_t *) b->mem.pos;
+
+    fin = wsh->fin;
+    opcode = wsh->opcode;
+    len = nxt_websocket_frame_payload_len(wsh);
+
+    b->mem.pos += nxt_websocket_frame_header_size(wsh);
+    nxt_memcpy(mask, b->mem.pos - 4, 4);
+
+    out = NULL;
+    last = NULL;
+
+    for (offset = 0; offset < len; offset += n) {
+        while (nxt_buf_mem_used_size(&b->mem) == 0) {
+            next = b->next;
+            b->next = NULL;
+
+            nxt_work_queue_add(&task->thread->engine->fast_work_queue,
+                               b->completion_handler, task, b, b->parent);
+
+            b = next;
+        }
+
+        p = b->mem.pos;
+        n = nxt_min(len - offset, (uint64_t) nxt_buf_mem_used_size(&b->mem));
+
+        nxt_websocket_unmask(p, n, mask, offset);
+
+        b->mem.pos += n;
+
+        wd->inflate.next_in = p;
+        wd->inflate.avail_in = n;
+
+        ret = nxt_http_websocket_inflate_buf(r, wd, &out, &last, limit, size);
+        if (ret != NXT_OK) {
+            goto fail;
+        }
+    }
+
+    if (fin) {
+        wd->inflate.next_in = (u_char *) nxt_http_websocket_deflate_tail;
+        wd->inflate.avail_in = sizeof(nxt_http_websocket_deflate_tail);
+
+        ret = nxt_http_websocket_inflate_buf(r, wd, &out, &last, limit, size);
+        if (ret != NXT_OK) {
+            goto fail;
+        }
+    }
+
+    if (nxt_buf_mem_used_size(&b->mem) == 0) {
+        next = b->next;
+        b->next = NULL;
+
+        nxt_work_queue_add(&task->thread->engine->fast_work_queue,
+                           b->completion_handler, task, b, b->parent);
+
+        b = next;
+    }
+
+    header = nxt_buf_mem_alloc(r->mem_pool, 10, 0);
+    if (nxt_slow_path(header == NULL)) {
+        ret = NXT_ERROR;
+        goto fail;
+    }
+
+    header->mem.start[0] = 0;
+    header->mem.start[1] = 0;
+
+    wsh = (nxt_websocket_header_t *) header->mem.start;
+    header->mem.free = nxt_websocket_frame_init(wsh, *size);
+
+    wsh->fin = fin;
+    wsh->opcode = opcode;
+
+    nxt_debug(task, "websocket inflate: %uL -> %uL", len, *size);
+
+    if (last != NULL) {
+        header->next = out;
+        last->next = b;
+
+    } else {
+        header->next = b;
+    }
+
+    r->ws_frame = header;
+
+    return NXT_OK;
+
+fail:
+
+    if (out != NULL) {
+        nxt_http_websocket_deflate_complete(task, out);
+    }
+
+    r->ws_frame = b;
+
+    return ret;
+}
+
+
+static nxt_int_t
+nxt_http_websocket_inflate_buf(nxt_http_request_t *r,
+    nxt_http_websocket_deflate_t *wd, nxt_buf_t **out, nxt_buf_t **last,
+    size_t limit, uint64_t *size)
+{
+    int        ret;
+    nxt_buf_t  *b;
+
+    for ( ;; ) {
+        b = *last;
+
+        if (b == NULL || nxt_buf_mem_free_size(&b->mem) == 0) {
+            b = nxt_buf_mem_alloc(r->mem_pool, NXT_HTTP_WS_DEFLATE_BUF_SIZE,
+                                  0);
+            if (nxt_slow_path(b == NULL)) {
+                return NXT_ERROR;
+            }
+
+            if (*last == NULL) {
+                *out = b;
+
+            } else {
+                (*last)->next = b;
+            }
+
+            *last = b;
+        }
+
+        wd->inflate.next_out = b->mem.free;
+        wd->inflate.avail_out = nxt_buf_mem_free_size(&b->mem);
+
+        ret = inflate(&wd->inflate, Z_SYNC_FLUSH);
+
+        *size += wd->inflate.next_out - b->mem.free;
+        b->mem.free = wd->inflate.next_out;
+
+        if (*size > limit) {
+            return NXT_DECLINED;
+        }
+
+        if (ret == Z_STREAM_END) {
+            /* A final block ends the stream, the data may go on. */
+            (void) inflateReset(&wd->inflate);
+
+        } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+            return NXT_DECLINED;
+        }
+
+        if (wd->inflate.avail_out != 0) {
+            if (wd->inflate.avail_in == 0) {
+                return NXT_OK;
+            }
+
+            if (ret == Z_BUF_ERROR) {
+                return NXT_DECLINED;
+            }
+        }
+    }
+}
+
+
+/*
+ * Deflates application frames of compressed messages.  An application
+ * passes frames in shared memory buffers, a frame header is always at
+ * the start of a buffer, and a frame may span several port messages.
+ * On failure the request is finalized.
+ */
+
+nxt_int_t
+nxt_http_websocket_deflate(nxt_task_t *task, nxt_http_request_t *r,
+    nxt_buf_t **chain)
+{
+    size_t                        used, hsize, n;
+    uint8_t                       opcode;
+    uint64_t                      len;
+    nxt_buf_t                     *in, *next, *out, **tail, *b;
+    nxt_bool_t                    passed;
+    nxt_websocket_header_t        *wsh;
+    nxt_http_websocket_deflate_t  *wd;
+
+    wd = r->ws_deflate;
+
+    out = NULL;
+    tail = &out;
+    passed = 0;
+
+    for (in = *chain; in != NULL; in = next) {
+        next = in->next;
+        in->next = NULL;
+
+        if (!nxt_buf_is_mem(in)) {
+            *tail = in;
+            tail = &in->next;
+            continue;
+        }
+
+        passed = 0;
+
+        for ( ;; ) {
+            used = nxt_buf_mem_used_size(&in->mem);
+
+            if (used == 0 && (!wd->frame || wd->rest != 0)) {
+                break;
+            }
+
+            if (!wd->frame) {
+                wsh = (nxt_websocket_header_t *) in->mem.pos;
+
+                if (nxt_slow_path(used < 2
+                                  || used
+                                     < nxt_websocket_frame_header_size(wsh)))
+                {
+                    nxt_alert(task, "websocket frame header is split");
+                    nxt_http_request_error(task, r,
+                                           NXT_HTTP_INTERNAL_SERVER_ERROR);
+                    goto fail;
+                }
+
+                hsize = nxt_websocket_frame_header_size(wsh);
+                len = nxt_websocket_frame_payload_len(wsh);
+                opcode = wsh->opcode;
+
+                wd->frame = 1;
+
+                if ((opcode & NXT_WEBSOCKET_OP_CTRL) != 0
+                    || (opcode == NXT_WEBSOCKET_OP_CONT && !wd->deflating)
+                    || (opcode != NXT_WEBSOCKET_OP_CONT
+                        && len < wd->threshold))
+                {
+                    wd->compress = 0;
+                    wd->rest = hsize + len;
+
+                    continue;
+                }
+
+                wd->compress = 1;
+                wd->rest = len;
+                wd->fin = wsh->fin;
+                wd->rsv1 = (opcode != NXT_WEBSOCKET_OP_CONT);
+                wd->opcode = opcode;
+                wd->deflating = !wsh->fin;
+
+                in->mem.pos += hsize;
+                used -= hsize;
+            }
+
+            n = nxt_min((uint64_t) used, wd->rest);
+
+            if (wd->compress) {
+                if (nxt_http_websocket_deflate_run(task, r, wd, in->mem.pos,
+                                                   n, Z_NO_FLUSH)
+                    != NXT_OK)
+                {
+                    goto fail;
+                }
+
+            } else if (n == used) {
+                *tail = in;
+                tail = &in->next;
+                passed = 1;
+
+            } else {
+                /* The frame ends inside the buffer. */
+
+                b = nxt_http_buf_mem(task, r, n);
+                if (nxt_slow_path(b == NULL)) {
+                    goto fail;
+                }
+
+                b->mem.free = nxt_cpymem(b->mem.free, in->mem.pos, n);
+
+                *tail = b;
+                tail = &b->next;
+            }
+
+            wd->rest -= n;
+
+            if (wd->rest == 0) {
+                wd->frame = 0;
+
+                if (wd->compress) {
+                    b = nxt_http_websocket_deflate_frame(task, r, wd);
+                    if (nxt_slow_path(b == NULL)) {
+                        goto fail;
+                    }
+
+                    *tail = b;
+
+                    while (b->next != NULL) {
+                        b = b->next;
+                    }
+
+                    tail = &b->next;
+                }
+            }
+
+            if (passed) {
+                break;
+            }
+
+            in->mem.pos += n;
+        }
+
+        if (!passed) {
+            nxt_http_websocket_deflate_complete(task, in);
+        }
+    }
+
+    *chain = out;
+
+    return NXT_OK;
+
+fail:
+
+    if (!passed) {
+        nxt_http_websocket_deflate_complete(task, in);
+    }
+
+    nxt_http_websocket_deflate_complete(task, next);
+    nxt_http_websocket_deflate_complete(task, out);
+
+    return NXT_ERROR;
+}
+
+
+static nxt_int_t
+nxt_http_websocket_deflate_run(nxt_task_t *task, nxt_http_request_t *r,
+    nxt_http_websocket_deflate_t *wd, u_char *data, size_t size, int flush)
+{
+    int        ret;
+    nxt_buf_t  *b;
+
+    if (!wd->deflate_ready) {
+        wd->deflate.zalloc = nxt_http_websocket_zalloc;
+        wd->deflate.zfree = nxt_http_websocket_zfree;
+        wd->deflate.opaque = wd->mem_pool;
+
+        ret = deflateInit2(&wd->deflate, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                           -wd->window_bits,
+                           nxt_http_ws_deflate_mem_level(wd->window_bits),
+                           Z_DEFAULT_STRATEGY);
+        if (nxt_slow_path(ret != Z_OK)) {
+            nxt_alert(task, "deflateInit2() failed: %d", ret);
+            goto fail;
+        }
+
+        wd->deflate_ready = 1;
+    }
+
+    wd->deflate.next_in = data;
+    wd->deflate.avail_in = size;
+
+    do {
+        b = wd->out_last;
+
+        if (b == NULL || nxt_buf_mem_free_size(&b->mem) == 0) {
+            /* nxt_http_buf_mem() finalizes the request on failure. */
+
+            b = nxt_http_buf_mem(task, r, NXT_HTTP_WS_DEFLATE_BUF_SIZE);
+            if (nxt_slow_path(b == NULL)) {
+                return NXT_ERROR;
+            }
+
+            if (wd->out_last == NULL) {
+                wd->out = b;
+
+            } else {
+                wd->out_last->next = b;
+            }
+
+            wd->out_prev = wd->out_last;
+            wd->out_last = b;
+        }
+
+        wd->deflate.next_out = b->mem.free;
+        wd->deflate.avail_out = nxt_buf_mem_free_size(&b->mem);
+
+        ret = deflate(&wd->deflate, flush);
+
+        if (nxt_slow_path(ret != Z_OK && ret != Z_BUF_ERROR)) {
+            nxt_alert(task, "deflate() failed: %d", ret);
+            goto fail;
+        }
+
+        wd->out_size += wd->deflate.next_out - b->mem.free;
+        b->mem.free = wd->deflate.next_out;
+
+    } while (wd->deflate.avail_in != 0 || wd->deflate.avail_out == 0);
+
+    return NXT_OK;
+
+fail:
+
+    nxt_http_request_error(task, r, NXT_HTTP_INTERNAL_SERVER_ERROR);
+
+    return NXT_ERROR;
+}
+
+
+static nxt_buf_t *
+nxt_http_websocket_deflate_frame(nxt_task_t *task, nxt_http_request_t *r,
+    nxt_http_websocket_deflate_t *wd)
+{
+    size_t                  n;
+    nxt_buf_t               *header, *b;
+    nxt_websocket_header_t  *wsh;
+
+    if (nxt_http_websocket_deflate_run(task, r, wd, NULL, 0, Z_SYNC_FLUSH)
+        != NXT_OK)
+    {
+        goto fail;
+    }
+
+    b = wd->out_last;
+
+    if (nxt_buf_mem_used_size(&b->mem) == 0 && wd->out_prev != NULL) {
+        wd->out_prev->next = NULL;
+        wd->out_last = wd->out_prev;
+        wd->out_prev = NULL;
+
+        nxt_http_websocket_deflate_complete(task, b);
+    }
+
+    if (wd->fin) {
+        /* The empty block ending a message is implied. */
+
+        b = wd->out_last;
+        n = nxt_min(4, nxt_buf_mem_used_size(&b->mem));
+
+        b->mem.free -= n;
+
+        if (n < 4) {
+            wd->out_prev->mem.free -= 4 - n;
+        }
+
+        wd->out_size -= 4;
+
+        if (wd->no_context_takeover) {
+            /* The state is not kept between messages. */
+            (void) deflateEnd(&wd->deflate);
+            wd->deflate_ready = 0;
+        }
+    }
+
+    header = nxt_http_buf_mem(task, r, 10);
+    if (nxt_slow_path(header == NULL)) {
+        goto fail;
+    }
+
+    header->mem.start[0] = 0;
+    header->mem.start[1] = 0;
+
+    wsh = (nxt_websocket_header_t *) header->mem.start;
+    header->mem.free = nxt_websocket_frame_init(wsh, wd->out_size);
+
+    wsh->fin = wd->fin;
+    wsh->rsv1 = wd->rsv1;
+    wsh->opcode = wd->opcode;
+
+    nxt_debug(task, "websocket deflate: %uz", wd->out_size);
+
+    header->next = wd->out;
+
+    wd->out = NULL;
+    wd->out_last = NULL;
+    wd->out_prev = NULL;
+    wd->out_size = 0;
+
+    return header;
+
+fail:
+
+    b = wd->out;
+
+    wd->out = NULL;
+    wd->out_last = NULL;
+    wd->out_prev = NULL;
+    wd->out_size = 0;
+
+    nxt_http_websocket_deflate_complete(task, b);
+
+    return NULL;
+}
+
+
+static void
+nxt_http_websocket_deflate_complete(nxt_task_t *task, nxt_buf_t *b)
+{
+    nxt_buf_t  *next;
+
+    while (b != NULL) {
+        next = b->next;
+        b->next = NULL;
+
+        /* The last buffer of a request is completed by request closing. */
+
+        if (nxt_buf_is_mem(b)) {
+            b->mem.pos = b->mem.free;
+
+            nxt_work_queue_add(&task->thread->engine->fast_work_queue,
+                               b->completion_handler, task, b, b->parent);
+        }
+
+        b = next;
+    }
+}
+
+
+static void *
+nxt_http_websocket_zalloc(void *opaque, u_int items, u_int size)
+{
+    return nxt_mp_alloc(opaque, items * size);
+}
+
+
+static void
+nxt_http_websocket_zfree(void *opaque, void *address)
+{
+    nxt_mp_free(opaque, address);
+}
@@ -8,19 +8,75 @@
 
 struct nxt_js_s {
     uint32_t            index;
-    njs_vm_t            *vm;
+    nxt_js_conf_t       *conf;
 };
 
 
+/*
+ * Started clones of the compiled VM are reused by requests, since cloning
+ * and starting a VM costs much more than a template call.  The compiled
+ * script also returns a function that restores the global object as it
+ * was after the start, so values set by templates do not leak to other
+ * requests; it is called when a clone is returned to the pool.  A clone
+ * is destroyed if the reset fails, and after a number of uses, since the
+ * memory allocated by calls is freed only with the VM.
+ *
+ * Each engine has its own pool, claimed by the engine on first use, so
+ * the pools are not locked.
+ */
+
+#define NXT_JS_VM_POOL_SIZE  16
+#define NXT_JS_VM_USES       64
+
+
+typedef struct {
+    nxt_atomic_t        owner;
+    nxt_uint_t          nidle;
+    nxt_js_cache_t      *idle;
+} nxt_js_vm_pool_t;
+
+
 struct nxt_js_conf_s {
     nxt_mp_t            *pool;
     njs_vm_t            *vm;
     njs_uint_t          protos;
     njs_external_t      *proto;
     nxt_array_t         *funcs;
+
+    nxt_uint_t          pool_size;
+    nxt_uint_t          npools;
+    nxt_js_vm_pool_t    *pools;
 };
 
 
+static nxt_int_t nxt_js_vm_get(nxt_js_conf_t *jcf, nxt_js_cache_t *cache);
+static nxt_int_t nxt_js_vm_clone(nxt_js_conf_t *jcf, nxt_js_cache_t *cache);
+static nxt_js_vm_pool_t *nxt_js_vm_pool(nxt_js_conf_t *jcf);
+static nxt_int_t nxt_js_vm_reset(nxt_js_cache_t *cache);
+
+
+/*
+ * The function returned after the templates: it deletes global properties
+ * added since the start and restores the changed ones.
+ */
+static nxt_str_t  nxt_js_reset_str = nxt_string(
+    "(function(g) {"
+    "    var saved = {};"
+    "    Object.getOwnPropertyNames(g).forEach(function(n) {"
+    "        saved[n] = g[n];"
+    "    });"
+    "    return function() {"
+    "        Object.getOwnPropertyNames(g).forEach(function(n) {"
+    "            if (!Object.prototype.hasOwnProperty.call(saved, n)) {"
+    "                delete g[n];"
+    "            } else if (g[n] !== saved[n]) {"
+    "                g[n] = saved[n];"
+    "            }"
+    "        });"
+    "    };"
+    "})(globalThis)");
+
+
 njs_int_t  nxt_js_proto_id;
 
 
@@ -50,6 +106,8 @@ nxt_js_conf_new(nxt_mp_t *mp)
         return NULL;
     }
 
+    jcf->pool_size = NXT_JS_VM_POOL_SIZE;
+
     return jcf;
 }
 
@@ -57,10 +115,32 @@ nxt_js_conf_new(nxt_mp_t *mp)
 void
 nxt_js_conf_release(nxt_js_conf_t *jcf)
 {
+    nxt_uint_t        i;
+    nxt_js_vm_pool_t  *vms;
+
+    for (i = 0; i < jcf->npools; i++) {
+        vms = &jcf->pools[i];
+
+        while (vms->nidle != 0) {
+            njs_vm_destroy(vms->idle[--vms->nidle].vm);
+        }
+
+        if (vms->idle != NULL) {
+            nxt_free(vms->idle);
+        }
+    }
+
     njs_vm_destroy(jcf->vm);
 }
 
 
+void
+nxt_js_set_pool_size(nxt_js_conf_t *jcf, nxt_uint_t size)
+{
+    jcf->pool_size = size;
+}
+
+
 void
 nxt_js_set_proto(nxt_js_conf_t *jcf, njs_external_t *proto, njs_uint_t n)
 {
@@ -113,7 +193,7 @@ nxt_js_add_tpl(nxt_js_conf_t *jcf, nxt_str_t *str, nxt_bool_t strz)
         return NULL;
     }
 
-    js->vm = jcf->vm;
+    js->conf = jcf;
 
     func = nxt_array_add(jcf->funcs);
     if (nxt_slow_path(func == NULL)) {
@@ -138,7 +218,7 @@ nxt_js_compile(nxt_js_conf_t *jcf)
     nxt_str_t   *func;
     nxt_uint_t  i;
 
-    size = 2;
+    size = 2 + nxt_js_reset_str.length;
     func = jcf->funcs->elts;
 
     for (i = 0; i < jcf->funcs->nelts; i++) {
@@ -160,6 +240,7 @@ nxt_js_compile(nxt_js_conf_t *jcf)
         *p++ = ',';
     }
 
+    p = nxt_cpymem(p, nxt_js_reset_str.start, nxt_js_reset_str.length);
     *p++ = ']';
 
     nxt_js_proto_id = njs_vm_external_prototype(jcf->vm, jcf->proto,
@@ -169,8 +250,26 @@ nxt_js_compile(nxt_js_conf_t *jcf)
     }
 
     ret = njs_vm_compile(jcf->vm, &start, p);
+    if (nxt_slow_path(ret != NJS_OK)) {
+        return NXT_ERROR;
+    }
 
-    return (ret == NJS_OK) ? NXT_OK : NXT_ERROR;
+    if (jcf->pool_size != 0) {
+        /*
+         * The main router engine and an engine per CPU, twice as many
+         * since engines of the previous configuration may still run.
+         * Engines beyond that use clones without a pool.
+         */
+        jcf->npools = 2 * (nxt_ncpu + 1);
+
+        jcf->pools = nxt_mp_zget(jcf->pool,
+                                 jcf->npools * sizeof(nxt_js_vm_pool_t));
+        if (nxt_slow_path(jcf->pools == NULL)) {
+            return NXT_ERROR;
+        }
+    }
+
+    return NXT_OK;
 }
 
 
@@ -213,7 +312,7 @@ nxt_js_call(nxt_task_t *task, nxt_js_cache_t *cache, nxt_js_t *js,
     njs_vm_t            *vm;
     njs_int_t           rc, ret;
     njs_str_t           res;
-    njs_value_t         *array, *value;
+    njs_value_t         *value;
     njs_function_t      *func;
     njs_opaque_value_t  opaque_value, arguments[6];
 
@@ -224,25 +323,15 @@ nxt_js_call(nxt_task_t *task, nxt_js_cache_t *cache, nxt_js_t *js,
     static const njs_str_t  headers_str = njs_str("headers");
     static const njs_str_t  cookies_str = njs_str("cookies");
 
-    vm = cache->vm;
-
-    if (vm == NULL) {
-        vm = njs_vm_clone(js->vm, ctx);
-        if (nxt_slow_path(vm == NULL)) {
+    if (cache->vm == NULL) {
+        ret = nxt_js_vm_get(js->conf, cache);
+        if (nxt_slow_path(ret != NXT_OK)) {
             return NXT_ERROR;
         }
-
-        ret = njs_vm_start(vm);
-        if (ret != NJS_OK) {
-            return NXT_ERROR;
-        }
-
-        array = njs_vm_retval(vm);
-
-        cache->vm = vm;
-        cache->array = *array;
     }
 
+    vm = cache->vm;
+
     value = njs_vm_array_prop(vm, &cache->array, js->index, &opaque_value);
     func = njs_value_function(value);
 
@@ -307,10 +396,146 @@ nxt_js_call(nxt_task_t *task, nxt_js_cache_t *cache, nxt_js_t *js,
 }
 
 
+static nxt_int_t
+nxt_js_vm_get(nxt_js_conf_t *jcf, nxt_js_cache_t *cache)
+{
+    nxt_js_vm_pool_t  *vms;
+
+    vms = nxt_js_vm_pool(jcf);
+
+    if (vms != NULL && vms->nidle != 0) {
+        *cache = vms->idle[--vms->nidle];
+        return NXT_OK;
+    }
+
+    return nxt_js_vm_clone(jcf, cache);
+}
+
+
+static nxt_int_t
+nxt_js_vm_clone(nxt_js_conf_t *jcf, nxt_js_cache_t *cache)
+{
+    njs_vm_t     *vm;
+    njs_int_t    ret;
+    njs_value_t  *array;
+
+    /*
+     * The request is passed to the template functions as an argument,
+     * so the clone is not bound to it and can be reused.
+     */
+
+    vm = njs_vm_clone(jcf->vm, NULL);
+    if (nxt_slow_path(vm == NULL)) {
+        return NXT_ERROR;
+    }
+
+    ret = njs_vm_start(vm);
+    if (ret != NJS_OK) {
+        njs_vm_destroy(vm);
+        return NXT_ERROR;
+    }
+
+    array = njs_vm_retval(vm);
+
+    cache->vm = vm;
+    cache->array = *array;
+    cache->conf = jcf;
+    cache->uses = 0;
+
+    return NXT_OK;
+}
+
+
+static nxt_js_vm_pool_t *
+nxt_js_vm_pool(nxt_js_conf_t *jcf)
+{
+    uintptr_t         owner;
+    nxt_uint_t        i;
+    nxt_thread_t      *thr;
+    nxt_js_vm_pool_t  *vms;
+
+    if (jcf->pools == NULL) {
+        return NULL;
+    }
+
+    thr = nxt_thread();
+
+    /* Threads without an engine, such as in tests, own a pool as well. */
+    owner = (thr->engine != NULL) ? (uintptr_t) thr->engine
+                                  : (uintptr_t) thr;
+
+    for (i = 0; i < jcf->npools; i++) {
+        vms = &jcf->pools[i];
+
+        if (vms->owner != owner
+            && (vms->owner != 0 || !nxt_atomic_cmp_set(&vms->owner, 0, owner)))
+        {
+            continue;
+        }
+
+        if (vms->idle == NULL) {
+            vms->idle = nxt_malloc(jcf->pool_size * sizeof(nxt_js_cache_t));
+            if (nxt_slow_path(vms->idle == NULL)) {
+                return NULL;
+            }
+        }
+
+        return vms;
+    }
+
+    return NULL;
+}
+
+
+static nxt_int_t
+nxt_js_vm_reset(nxt_js_cache_t *cache)
+{
+    njs_int_t           ret;
+    njs_value_t         *value;
+    njs_function_t      *func;
+    njs_opaque_value_t  opaque_value;
+
+    value = njs_vm_array_prop(cache->vm, &cache->array,
+                              cache->conf->funcs->nelts, &opaque_value);
+    if (nxt_slow_path(value == NULL)) {
+        return NXT_ERROR;
+    }
+
+    func = njs_value_function(value);
+    if (nxt_slow_path(func == NULL)) {
+        return NXT_ERROR;
+    }
+
+    ret = njs_vm_call(cache->vm, func, NULL, 0);
+
+    return (ret == NJS_OK) ? NXT_OK : NXT_ERROR;
+}
+
+
 void
 nxt_js_release(nxt_js_cache_t *cache)
 {
-    if (cache->vm != NULL) {
+    nxt_js_conf_t     *jcf;
+    nxt_js_vm_pool_t  *vms;
+
+    if (cache->vm == NULL) {
+        return;
+    }
+
+    jcf = cache->conf;
+
+    vms = nxt_js_vm_pool(jcf);
+
+    if (vms != NULL
+        && vms->nidle < jcf->pool_size
+        && ++cache->uses < NXT_JS_VM_USES
+        && nxt_js_vm_reset(cache) == NXT_OK)
+    {
+        vms->idle[vms->nidle++] = *cache;
+
+    } else {
         njs_vm_destroy(cache->vm);
     }
+
+    cache->vm = NULL;
 }
@@ -18,6 +18,8 @@ typedef struct nxt_js_conf_s  nxt_js_conf_t;
 typedef struct {
     njs_vm_t            *vm;
     njs_value_t         array;
+    nxt_js_conf_t       *conf;
+    nxt_uint_t          uses;
 } nxt_js_cache_t;
 
 
@@ -30,6 +32,7 @@ nxt_int_t nxt_js_test(nxt_js_conf_t *jcf, nxt_str_t *str, u_char *error);
 nxt_int_t nxt_js_call(nxt_task_t *task, nxt_js_cache_t *cache, nxt_js_t *js,
     nxt_str_t *str, void *ctx);
 void nxt_js_release(nxt_js_cache_t *cache);
+void nxt_js_set_pool_size(nxt_js_conf_t *jcf, nxt_uint_t size);
 
 
 extern njs_int_t  nxt_js_proto_id;
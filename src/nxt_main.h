@@ -32,6 +32,7 @@ typedef void (*nxt_work_handler_t)(nxt_task_t *task, void *obj, void *data);
 #include <nxt_clang.h>
 #include <nxt_types.h>
 #include <nxt_time.h>
+#include <nxt_atomic.h>
 #include <nxt_mp.h>
 #include <nxt_array.h>
 
@@ -47,7 +48,7 @@ typedef uint16_t                     nxt_port_id_t;
 #include <nxt_random.h>
 #include <nxt_string.h>
 #include <nxt_lvlhsh.h>
-#include <nxt_atomic.h>
+#include <nxt_flathsh.h>
 #include <nxt_spinlock.h>
 #include <nxt_work_queue.h>
 #include <nxt_log.h>
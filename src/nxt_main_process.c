@@ -592,6 +592,7 @@ static nxt_port_handlers_t  nxt_main_process_port_handlers = {
 #if (NXT_TLS)
     .cert_get         = nxt_cert_store_get_handler,
     .cert_delete      = nxt_cert_store_delete_handler,
+    .ocsp_get         = nxt_cert_ocsp_get_handler,
 #endif
     .access_log       = nxt_main_port_access_log_handler,
     .rpc_ready        = nxt_port_rpc_handler,
@@ -18,6 +18,13 @@
 #define NXT_MEM_ZONE_PAGE_USED      2
 
 
+/* The maximum number of chunks in a cache magazine. */
+#define NXT_MEM_ZONE_MAGAZINE_SIZE  32
+
+/* The maximum size of chunks in a cache magazine. */
+#define NXT_MEM_ZONE_MAGAZINE_MAX   (16 * 1024)
+
+
 typedef struct nxt_mem_zone_page_s  nxt_mem_zone_page_t;
 
 struct nxt_mem_zone_page_s {
@@ -83,10 +90,28 @@ struct nxt_mem_zone_s {
     u_char                 *start;
     u_char                 *end;
 
+    /* Marks chunks kept in thread caches, see nxt_mem_zone_cache_free(). */
+    uintptr_t              cookie;
+
+    uint32_t               nslots;
+
     nxt_mem_zone_slot_t    slots[];
 };
 
 
+typedef struct {
+    uint32_t               count;
+    uint32_t               max;
+    void                   *chunks[NXT_MEM_ZONE_MAGAZINE_SIZE];
+} nxt_mem_zone_magazine_t;
+
+
+struct nxt_mem_zone_cache_s {
+    nxt_mem_zone_t           *zone;
+    nxt_mem_zone_magazine_t  magazines[];
+};
+
+
 #define nxt_mem_zone_page_addr(zone, page)                                    \
     (void *) (zone->start + ((page - zone->pages) << zone->page_size_shift))
 
@@ -115,6 +140,10 @@ struct nxt_mem_zone_s {
     ((map[chunk / 8] & (0x80 >> (chunk & 7))) == 0)
 
 
+#define nxt_mem_zone_cache_cookie(zone, p)                                    \
+    ((zone)->cookie ^ (uintptr_t) (p))
+
+
 #define nxt_mem_zone_fresh_junk(p, size)                                      \
     nxt_memset((p), 0xA5, size)
 
@@ -146,6 +175,12 @@ static const char *nxt_mem_zone_free_chunk(nxt_mem_zone_t *zone,
     nxt_mem_zone_page_t *page, void *p);
 static void nxt_mem_zone_free_pages(nxt_mem_zone_t *zone,
     nxt_mem_zone_page_t *page, nxt_uint_t count);
+static void nxt_mem_zone_cache_refill(nxt_mem_zone_t *zone,
+    nxt_mem_zone_slot_t *slot, nxt_mem_zone_magazine_t *mag);
+static const char *nxt_mem_zone_cache_chunk_test(nxt_mem_zone_t *zone,
+    nxt_mem_zone_slot_t *slot, nxt_mem_zone_page_t *page, void *p);
+static void nxt_mem_zone_cache_drain(nxt_mem_zone_t *zone,
+    nxt_mem_zone_magazine_t *mag, nxt_uint_t n);
 
 
 static nxt_log_moderation_t  nxt_mem_zone_log_moderation = {
@@ -159,6 +194,7 @@ nxt_mem_zone_init(u_char *start, size_t zone_size, nxt_uint_t page_size)
 {
     uint32_t                   pages;
     nxt_uint_t                 n;
+    nxt_random_t               r;
     nxt_mem_zone_t             *zone;
     nxt_mem_zone_page_t        *page;
     nxt_mem_zone_free_block_t  *block;
@@ -178,8 +214,18 @@ nxt_mem_zone_init(u_char *start, size_t zone_size, nxt_uint_t page_size)
     /* The function returns address after all slots. */
     page = nxt_mem_zone_slots_init(zone, page_size);
 
+    zone->nslots = (nxt_mem_zone_slot_t *) page - zone->slots;
     zone->pages = page;
 
+    /*
+     * Pointers to the unused zone tail would be mapped to entries beyond
+     * the pages array, so they must be considered as out of zone.
+     */
+    zone->end = zone->start + ((size_t) pages << zone->page_size_shift);
+
+    nxt_random_init(&r);
+    zone->cookie = ((uintptr_t) nxt_random(&r) << 16 << 16) ^ nxt_random(&r);
+
     for (n = 0; n < pages; n++) {
         page[n].size = NXT_MEM_ZONE_PAGE_FRESH;
     }
@@ -796,7 +842,7 @@ nxt_mem_zone_free(nxt_mem_zone_t *zone, void *p)
             count = page->u.count;
 
             if (nxt_fast_path(count != 0)) {
-                nxt_mem_zone_free_junk(p, count * zone->page_size_mask + 1);
+                nxt_mem_zone_free_junk(p, count << zone->page_size_shift);
                 nxt_mem_zone_free_pages(zone, page, count);
                 err = NULL;
 
@@ -946,3 +992,284 @@ nxt_mem_zone_free_pages(nxt_mem_zone_t *zone, nxt_mem_zone_page_t *page,
     block->size = count;
     nxt_rbtree_insert(&zone->free_pages, &block->node);
 }
+
+
+nxt_mem_zone_cache_t *
+nxt_mem_zone_cache_create(nxt_mem_zone_t *zone)
+{
+    uint32_t              max;
+    nxt_uint_t            n;
+    nxt_mem_zone_cache_t  *cache;
+
+    cache = nxt_zalloc(sizeof(nxt_mem_zone_cache_t)
+                       + zone->nslots * sizeof(nxt_mem_zone_magazine_t));
+    if (nxt_slow_path(cache == NULL)) {
+        return NULL;
+    }
+
+    cache->zone = zone;
+
+    /*
+     * Limit a size of memory kept in each magazine, so idle caches
+     * of many threads and processes do not exhaust a shared zone.
+     */
+
+    for (n = 0; n < zone->nslots; n++) {
+        max = NXT_MEM_ZONE_MAGAZINE_MAX / zone->slots[n].size;
+        max = nxt_min(max, NXT_MEM_ZONE_MAGAZINE_SIZE);
+
+        cache->magazines[n].max = nxt_max(max, 2);
+    }
+
+    return cache;
+}
+
+
+void
+nxt_mem_zone_cache_destroy(nxt_mem_zone_cache_t *cache)
+{
+    nxt_mem_zone_cache_flush(cache);
+
+    nxt_free(cache);
+}
+
+
+void *
+nxt_mem_zone_cache_alloc(nxt_mem_zone_cache_t *cache, size_t size)
+{
+    void                     *p;
+    nxt_mem_zone_t           *zone;
+    nxt_mem_zone_slot_t      *slot;
+    nxt_mem_zone_magazine_t  *mag;
+
+    zone = cache->zone;
+
+    if (nxt_slow_path(size > zone->max_chunk_size)) {
+        return nxt_mem_zone_align(zone, 1, size);
+    }
+
+    for (slot = zone->slots; slot->size < size; slot++) { /* void */ }
+
+    mag = &cache->magazines[slot - zone->slots];
+
+    if (nxt_slow_path(mag->count == 0)) {
+        nxt_mem_zone_cache_refill(zone, slot, mag);
+
+        if (nxt_slow_path(mag->count == 0)) {
+            nxt_log_alert_moderate(&nxt_mem_zone_log_moderation,
+                      nxt_thread_log(),
+                      "nxt_mem_zone_cache_alloc(%uz) failed, not enough memory",
+                      size);
+            return NULL;
+        }
+    }
+
+    mag->count--;
+
+    p = mag->chunks[mag->count];
+    *(uintptr_t *) p = 0;
+
+    return p;
+}
+
+
+static void
+nxt_mem_zone_cache_refill(nxt_mem_zone_t *zone, nxt_mem_zone_slot_t *slot,
+    nxt_mem_zone_magazine_t *mag)
+{
+    void        *p;
+    nxt_uint_t  n;
+
+    n = mag->max / 2;
+
+    nxt_thread_spin_lock(&zone->lock);
+
+    do {
+        p = nxt_mem_zone_alloc_small(zone, slot, slot->size);
+
+        if (nxt_slow_path(p == NULL)) {
+            break;
+        }
+
+        *(uintptr_t *) p = nxt_mem_zone_cache_cookie(zone, p);
+
+        mag->chunks[mag->count++] = p;
+        n--;
+
+    } while (n != 0);
+
+    nxt_thread_spin_unlock(&zone->lock);
+}
+
+
+void
+nxt_mem_zone_cache_free(nxt_mem_zone_cache_t *cache, void *p)
+{
+    uint32_t                 size;
+    const char               *err;
+    nxt_mem_zone_t           *zone;
+    nxt_mem_zone_page_t      *page;
+    nxt_mem_zone_slot_t      *slot;
+    nxt_mem_zone_magazine_t  *mag;
+
+    zone = cache->zone;
+
+    if (nxt_slow_path((u_char *) p < zone->start
+                      || (u_char *) p >= zone->end))
+    {
+        nxt_mem_zone_free(zone, p);
+        return;
+    }
+
+    page = nxt_mem_zone_addr_page(zone, p);
+
+    /*
+     * The page chunk size cannot be changed without holding lock
+     * while the page has at least one allocated chunk.  Pointers
+     * to other pages are passed to the zone and are tested there.
+     */
+    size = page->size;
+
+    if (!nxt_mem_zone_page_is_chunked(page)) {
+        nxt_mem_zone_free(zone, p);
+        return;
+    }
+
+    for (slot = zone->slots; slot->size < size; slot++) { /* void */ }
+
+    err = nxt_mem_zone_cache_chunk_test(zone, slot, page, p);
+
+    if (nxt_slow_path(err != NULL)) {
+        nxt_thread_log_alert("nxt_mem_zone_cache_free(%p): %s", p, err);
+        return;
+    }
+
+    mag = &cache->magazines[slot - zone->slots];
+
+    if (nxt_slow_path(mag->count == mag->max)) {
+        nxt_mem_zone_cache_drain(zone, mag, mag->max / 2);
+    }
+
+    *(uintptr_t *) p = nxt_mem_zone_cache_cookie(zone, p);
+
+    mag->chunks[mag->count++] = p;
+}
+
+
+/*
+ * Chunks kept in thread caches remain allocated in the zone bitmaps,
+ * so they are marked with a per-zone random cookie xored with their
+ * address to detect double free of a cached chunk by any thread.
+ * The cookie is cleared when the chunk leaves a cache.
+ */
+
+static const char *
+nxt_mem_zone_cache_chunk_test(nxt_mem_zone_t *zone, nxt_mem_zone_slot_t *slot,
+    nxt_mem_zone_page_t *page, void *p)
+{
+    u_char    *map;
+    uint32_t  offset, chunk;
+
+    offset = (uintptr_t) p & zone->page_size_mask;
+
+    if (nxt_slow_path(offset < slot->start)) {
+        return "pointer to wrong chunk";
+    }
+
+    offset -= slot->start;
+    chunk = offset / slot->size;
+
+    if (nxt_slow_path(offset != chunk * slot->size)) {
+        return "pointer to wrong chunk";
+    }
+
+    if (nxt_mem_zone_page_bitmap(zone, slot)) {
+        map = (u_char *) ((uintptr_t) p & ~((uintptr_t) zone->page_size_mask));
+
+    } else {
+        map = page->u.map;
+    }
+
+    /*
+     * The bits of other chunks may be changed concurrently under
+     * the zone lock, but the bit of an allocated chunk is not.
+     */
+    if (nxt_slow_path(nxt_mem_zone_chunk_is_free(map, chunk))) {
+        return "chunk is already free";
+    }
+
+    if (nxt_slow_path(*(uintptr_t *) p == nxt_mem_zone_cache_cookie(zone, p)))
+    {
+        return "chunk is already free";
+    }
+
+    return NULL;
+}
+
+
+void
+nxt_mem_zone_cache_flush(nxt_mem_zone_cache_t *cache)
+{
+    nxt_uint_t               n;
+    nxt_mem_zone_magazine_t  *mag;
+
+    for (n = 0; n < cache->zone->nslots; n++) {
+        mag = &cache->magazines[n];
+
+        if (mag->count != 0) {
+            nxt_mem_zone_cache_drain(cache->zone, mag, mag->count);
+        }
+    }
+}
+
+
+/*
+ * The oldest chunks are returned to the zone, the most recently
+ * freed ones are kept in the magazine since they are likely hot
+ * in CPU cache.
+ */
+
+static void
+nxt_mem_zone_cache_drain(nxt_mem_zone_t *zone, nxt_mem_zone_magazine_t *mag,
+    nxt_uint_t n)
+{
+    void                 *p, *invalid;
+    nxt_uint_t           i;
+    const char           *err, *error;
+    nxt_mem_zone_page_t  *page;
+
+    error = NULL;
+    invalid = NULL;
+
+    nxt_thread_spin_lock(&zone->lock);
+
+    for (i = 0; i < n; i++) {
+        p = mag->chunks[i];
+        *(uintptr_t *) p = 0;
+
+        page = nxt_mem_zone_addr_page(zone, p);
+
+        if (nxt_fast_path(nxt_mem_zone_page_is_chunked(page))) {
+            err = nxt_mem_zone_free_chunk(zone, page, p);
+
+        } else {
+            err = "chunk is already free";
+        }
+
+        if (nxt_slow_path(err != NULL)) {
+            error = err;
+            invalid = p;
+        }
+    }
+
+    nxt_thread_spin_unlock(&zone->lock);
+
+    mag->count -= n;
+
+    nxt_memmove(mag->chunks, &mag->chunks[n], mag->count * sizeof(void *));
+
+    if (nxt_slow_path(error != NULL)) {
+        nxt_thread_log_alert("nxt_mem_zone_cache_free(%p): %s",
+                             invalid, error);
+    }
+}
@@ -8,7 +8,22 @@
 #define _NXT_MEM_ZONE_H_INCLUDED_
 
 
-typedef struct nxt_mem_zone_s  nxt_mem_zone_t;
+/*
+ * A zone may be placed in memory shared between processes.  The zone
+ * bookkeeping data contain absolute pointers, so the memory should be
+ * mapped at the same address in all processes, e.g. before fork().
+ */
+
+typedef struct nxt_mem_zone_s        nxt_mem_zone_t;
+
+/*
+ * A process-private per-thread cache of free zone chunks.  Small
+ * allocations and frees are served from the cache without the zone lock,
+ * the zone is accessed only in batches to refill or to drain the cache.
+ * A cache must be used by a single thread only.
+ */
+
+typedef struct nxt_mem_zone_cache_s  nxt_mem_zone_cache_t;
 
 
 NXT_EXPORT nxt_mem_zone_t *nxt_mem_zone_init(u_char *start, size_t zone_size,
@@ -24,5 +39,14 @@ NXT_EXPORT void *nxt_mem_zone_zalloc(nxt_mem_zone_t *zone, size_t size)
     NXT_MALLOC_LIKE;
 NXT_EXPORT void nxt_mem_zone_free(nxt_mem_zone_t *zone, void *p);
 
+NXT_EXPORT nxt_mem_zone_cache_t *nxt_mem_zone_cache_create(
+    nxt_mem_zone_t *zone);
+NXT_EXPORT void nxt_mem_zone_cache_destroy(nxt_mem_zone_cache_t *cache);
+NXT_EXPORT void *nxt_mem_zone_cache_alloc(nxt_mem_zone_cache_t *cache,
+    size_t size)
+    NXT_MALLOC_LIKE;
+NXT_EXPORT void nxt_mem_zone_cache_free(nxt_mem_zone_cache_t *cache, void *p);
+NXT_EXPORT void nxt_mem_zone_cache_flush(nxt_mem_zone_cache_t *cache);
+
 
 #endif /* _NXT_MEM_ZONE_H_INCLUDED_ */
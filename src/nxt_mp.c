@@ -117,6 +117,14 @@ struct nxt_mp_s {
 
     nxt_work_t           *cleanup;
 
+    nxt_mp_cache_t       *cache;
+    nxt_mp_t             *next;
+
+    /* The current page for non-freeable aligned allocations. */
+    nxt_mp_page_t        *get_page;
+    u_char               *get_free;
+    u_char               *get_end;
+
     /* Lists of nxt_mp_page_t. */
     nxt_queue_t          free_pages;
     nxt_queue_t          nget_pages;
@@ -145,12 +153,22 @@ struct nxt_mp_s {
     memset((p), 0x5A, size)
 
 
+/* The number of clusters kept by a pool returned to a cache. */
+#define NXT_MP_CACHE_CLUSTERS  2
+
+
+static void nxt_mp_reset(nxt_mp_t *mp);
+static void nxt_mp_cache_release(nxt_mp_cache_t *cache);
 #if !(NXT_DEBUG_MEMORY)
 static void *nxt_mp_alloc_small(nxt_mp_t *mp, size_t size);
 static void *nxt_mp_get_small(nxt_mp_t *mp, nxt_queue_t *pages, size_t size);
+static void *nxt_mp_get_partial(nxt_mp_t *mp, nxt_queue_t *pages,
+    size_t size);
+static void *nxt_mp_get_bump(nxt_mp_t *mp, size_t size);
 static nxt_mp_page_t *nxt_mp_alloc_page(nxt_mp_t *mp);
 static nxt_mp_block_t *nxt_mp_alloc_cluster(nxt_mp_t *mp);
 #endif
+static void nxt_mp_cluster_pages(nxt_mp_t *mp, nxt_mp_block_t *cluster);
 static void *nxt_mp_alloc_large(nxt_mp_t *mp, size_t alignment, size_t size,
     nxt_bool_t freeable);
 static intptr_t nxt_mp_rbtree_compare(nxt_rbtree_node_t *node1,
@@ -310,6 +328,7 @@ nxt_mp_destroy(nxt_mp_t *mp)
 {
     void               *p;
     nxt_work_t         *work, *next_work;
+    nxt_mp_cache_t     *cache;
     nxt_mp_block_t     *block;
     nxt_rbtree_node_t  *node, *next;
 
@@ -326,6 +345,25 @@ nxt_mp_destroy(nxt_mp_t *mp)
         mp->cleanup = next_work;
     }
 
+    cache = mp->cache;
+
+    if (cache != NULL) {
+
+        if (cache->count < cache->max && cache->thread == nxt_thread()) {
+            nxt_mp_reset(mp);
+
+            mp->next = cache->free;
+            cache->free = mp;
+            cache->count++;
+
+            nxt_mp_cache_release(cache);
+
+            return;
+        }
+
+        nxt_mp_cache_release(cache);
+    }
+
     next = nxt_rbtree_root(&mp->blocks);
 
     while (next != nxt_rbtree_sentinel(&mp->blocks)) {
@@ -346,6 +384,169 @@ nxt_mp_destroy(nxt_mp_t *mp)
 }
 
 
+static void
+nxt_mp_reset(nxt_mp_t *mp)
+{
+    void               *p;
+    uint32_t           pages;
+    nxt_uint_t         i, n;
+    nxt_queue_t        *chunk_pages;
+    nxt_mp_block_t     *block, *clusters[NXT_MP_CACHE_CLUSTERS];
+    nxt_rbtree_node_t  *node, *next;
+
+    n = 0;
+    next = nxt_rbtree_root(&mp->blocks);
+
+    while (next != nxt_rbtree_sentinel(&mp->blocks)) {
+
+        node = nxt_rbtree_destroy_next(&mp->blocks, &next);
+        block = (nxt_mp_block_t *) node;
+
+        if (block->type == NXT_MP_CLUSTER_BLOCK
+            && n < NXT_MP_CACHE_CLUSTERS)
+        {
+            clusters[n++] = block;
+            continue;
+        }
+
+        p = block->start;
+
+        if (block->type != NXT_MP_EMBEDDED_BLOCK) {
+            nxt_free(block);
+        }
+
+        nxt_free(p);
+    }
+
+    mp->retain = 1;
+
+    mp->get_page = NULL;
+    mp->get_free = NULL;
+    mp->get_end = NULL;
+
+    chunk_pages = mp->chunk_pages;
+    pages = mp->page_size_shift - mp->chunk_size_shift;
+
+    while (pages != 0) {
+        nxt_queue_init(chunk_pages);
+        chunk_pages++;
+        pages--;
+    }
+
+    nxt_queue_init(&mp->free_pages);
+    nxt_queue_init(&mp->nget_pages);
+    nxt_queue_init(&mp->get_pages);
+
+    nxt_rbtree_init(&mp->blocks, nxt_mp_rbtree_compare);
+
+    pages = mp->cluster_size >> mp->page_size_shift;
+
+    for (i = 0; i < n; i++) {
+        block = clusters[i];
+
+        nxt_memzero(block->pages, pages * sizeof(nxt_mp_page_t));
+
+        nxt_mp_cluster_pages(mp, block);
+    }
+
+    nxt_debug_alloc("mp %p reset, clusters: %ui", mp, n);
+}
+
+
+nxt_mp_cache_t *
+nxt_mp_cache_create(size_t cluster_size, size_t page_alignment,
+    size_t page_size, size_t min_chunk_size, nxt_uint_t max)
+{
+    nxt_mp_cache_t  *cache;
+
+    cache = nxt_zalloc(sizeof(nxt_mp_cache_t));
+
+    if (nxt_fast_path(cache != NULL)) {
+        cache->uses = 1;
+        cache->max = max;
+        cache->cluster_size = cluster_size;
+        cache->page_alignment = page_alignment;
+        cache->page_size = page_size;
+        cache->min_chunk_size = min_chunk_size;
+    }
+
+    return cache;
+}
+
+
+nxt_mp_t *
+nxt_mp_cache_get(nxt_mp_cache_t *cache)
+{
+    nxt_mp_t  *mp;
+
+    mp = cache->free;
+
+    if (mp != NULL) {
+        cache->free = mp->next;
+        cache->count--;
+        cache->reused++;
+
+        (void) nxt_atomic_fetch_add(&cache->uses, 1);
+
+        nxt_debug_alloc("mp %p reuse", mp);
+
+        return mp;
+    }
+
+    cache->thread = nxt_thread();
+
+    mp = nxt_mp_create(cache->cluster_size, cache->page_alignment,
+                       cache->page_size, cache->min_chunk_size);
+
+    if (nxt_fast_path(mp != NULL)) {
+        mp->cache = cache;
+        cache->created++;
+
+        (void) nxt_atomic_fetch_add(&cache->uses, 1);
+    }
+
+    return mp;
+}
+
+
+void
+nxt_mp_cache_destroy(nxt_mp_cache_t *cache)
+{
+    nxt_mp_t  *mp;
+
+    /* Pools still in use are not returned to the cache anymore. */
+    cache->max = 0;
+
+    while (cache->free != NULL) {
+        mp = cache->free;
+        cache->free = mp->next;
+
+        mp->cache = NULL;
+
+        nxt_mp_thread_adopt(mp);
+        nxt_mp_destroy(mp);
+    }
+
+    cache->count = 0;
+
+    nxt_mp_cache_release(cache);
+}
+
+
+static void
+nxt_mp_cache_release(nxt_mp_cache_t *cache)
+{
+    /*
+     * Pools in use may be destroyed by other threads, so the last one
+     * frees the cache if the owner has already destroyed it.
+     */
+
+    if (nxt_atomic_fetch_add(&cache->uses, -1) == 1) {
+        nxt_free(cache);
+    }
+}
+
+
 nxt_bool_t
 nxt_mp_test_sizes(size_t cluster_size, size_t page_alignment, size_t page_size,
     size_t min_chunk_size)
@@ -593,6 +794,33 @@ nxt_mp_alloc_small(nxt_mp_t *mp, size_t size)
 
 static void *
 nxt_mp_get_small(nxt_mp_t *mp, nxt_queue_t *pages, size_t size)
+{
+    u_char         *p;
+    nxt_mp_page_t  *page;
+
+    p = nxt_mp_get_partial(mp, pages, size);
+
+    if (p != NULL) {
+        return p;
+    }
+
+    page = nxt_mp_alloc_page(mp);
+
+    if (nxt_slow_path(page == NULL)) {
+        return page;
+    }
+
+    nxt_queue_insert_head(pages, &page->link);
+
+    page->size = 0xFF;
+    page->u.taken = size;
+
+    return nxt_mp_page_addr(mp, page);
+}
+
+
+static void *
+nxt_mp_get_partial(nxt_mp_t *mp, nxt_queue_t *pages, size_t size)
 {
     u_char            *p;
     uint32_t          available;
@@ -611,7 +839,12 @@ nxt_mp_get_small(nxt_mp_t *mp, nxt_queue_t *pages, size_t size)
         available = mp->page_size - page->u.taken;
 
         if (size <= available) {
-            goto found;
+            p = nxt_mp_page_addr(mp, page);
+
+            p += page->u.taken;
+            page->u.taken += size;
+
+            return p;
         }
 
         if (available == 0 || page->fails++ > 100) {
@@ -619,23 +852,52 @@ nxt_mp_get_small(nxt_mp_t *mp, nxt_queue_t *pages, size_t size)
         }
     }
 
+    return NULL;
+}
+
+
+/*
+ * Non-freeable aligned allocations are mostly small and short-lived,
+ * so they are taken from the current page by a bump pointer.  The page
+ * is moved to the get_pages list when a new current page is allocated,
+ * and its free space is used for allocations which do not fit the
+ * current page.
+ */
+
+static void *
+nxt_mp_get_bump(nxt_mp_t *mp, size_t size)
+{
+    u_char         *p;
+    nxt_mp_page_t  *page;
+
+    p = nxt_mp_get_partial(mp, &mp->get_pages, size);
+
+    if (p != NULL) {
+        return p;
+    }
+
     page = nxt_mp_alloc_page(mp);
 
     if (nxt_slow_path(page == NULL)) {
         return page;
     }
 
-    nxt_queue_insert_head(pages, &page->link);
-
     page->size = 0xFF;
-    page->u.taken = 0;
+    page->u.taken = mp->page_size;
+
+    if (mp->get_page != NULL) {
+        mp->get_page->u.taken = mp->page_size - (mp->get_end - mp->get_free);
 
-found:
+        if (mp->get_free != mp->get_end) {
+            nxt_queue_insert_head(&mp->get_pages, &mp->get_page->link);
+        }
+    }
 
     p = nxt_mp_page_addr(mp, page);
 
-    p += page->u.taken;
-    page->u.taken += size;
+    mp->get_page = page;
+    mp->get_free = p + size;
+    mp->get_end = p + mp->page_size;
 
     return p;
 }
@@ -688,6 +950,21 @@ nxt_mp_alloc_cluster(nxt_mp_t *mp)
         return NULL;
     }
 
+    nxt_mp_cluster_pages(mp, cluster);
+
+    return cluster;
+}
+
+#endif
+
+
+static void
+nxt_mp_cluster_pages(nxt_mp_t *mp, nxt_mp_block_t *cluster)
+{
+    nxt_uint_t  n;
+
+    n = mp->cluster_size >> mp->page_size_shift;
+
     n--;
     cluster->pages[n].number = n;
     nxt_queue_insert_head(&mp->free_pages, &cluster->pages[n].link);
@@ -700,12 +977,8 @@ nxt_mp_alloc_cluster(nxt_mp_t *mp)
     }
 
     nxt_rbtree_insert(&mp->blocks, &cluster->node);
-
-    return cluster;
 }
 
-#endif
-
 
 static void *
 nxt_mp_alloc_large(nxt_mp_t *mp, size_t alignment, size_t size,
@@ -1004,7 +1277,16 @@ nxt_mp_get(nxt_mp_t *mp, size_t size)
 
     if (size <= mp->page_size) {
         size = nxt_max(size, NXT_MAX_ALIGNMENT);
-        p = nxt_mp_get_small(mp, &mp->get_pages, size);
+
+        if (nxt_fast_path(size <= (size_t) (mp->get_end - mp->get_free))) {
+            nxt_mp_thread_assert(mp);
+
+            p = mp->get_free;
+            mp->get_free += size;
+
+        } else {
+            p = nxt_mp_get_bump(mp, size);
+        }
 
     } else {
         p = nxt_mp_alloc_large(mp, NXT_MAX_ALIGNMENT, size, 0);
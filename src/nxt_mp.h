@@ -27,6 +27,36 @@
 typedef struct nxt_mp_s  nxt_mp_t;
 
 
+/*
+ * Memory pool cache keeps destroyed pools of the same parameters with
+ * their first clusters, so short-lived pools, e.g. request pools, do not
+ * call malloc() and free() each time.  A cache must be used by one thread
+ * only, pools destroyed by other threads are freed as usual.  The number
+ * of idle pools in the cache is limited by the max field.  The cache
+ * itself is freed when it is destroyed and all its pools in use are
+ * destroyed too.
+ */
+typedef struct {
+    nxt_mp_t                     *free;
+    nxt_thread_t                 *thread;
+
+    uint32_t                     count;
+    uint32_t                     max;
+
+    /* The number of pools in use plus one for the cache owner. */
+    nxt_atomic_t                 uses;
+
+    uint32_t                     cluster_size;
+    uint32_t                     page_alignment;
+    uint32_t                     page_size;
+    uint32_t                     min_chunk_size;
+
+    /* Statistics. */
+    nxt_uint_t                   created;
+    nxt_uint_t                   reused;
+} nxt_mp_cache_t;
+
+
 /*
  * nxt_mp_create() creates a memory pool and sets the pool's retention
  * counter to 1.
@@ -41,6 +71,27 @@ NXT_EXPORT nxt_mp_t *nxt_mp_create(size_t cluster_size, size_t page_alignment,
  */
 NXT_EXPORT void nxt_mp_destroy(nxt_mp_t *mp);
 
+/*
+ * nxt_mp_cache_create() creates a cache of memory pools with
+ * the specified parameters.
+ */
+NXT_EXPORT nxt_mp_cache_t *nxt_mp_cache_create(size_t cluster_size,
+    size_t page_alignment, size_t page_size, size_t min_chunk_size,
+    nxt_uint_t max);
+
+/*
+ * nxt_mp_cache_get() returns an empty memory pool from the cache or
+ * creates a new one.  The pool returns to the cache on destruction.
+ */
+NXT_EXPORT nxt_mp_t *nxt_mp_cache_get(nxt_mp_cache_t *cache)
+    NXT_MALLOC_LIKE;
+
+/*
+ * nxt_mp_cache_destroy() destroys all idle memory pools of the cache.
+ * Pools still in use are freed on destruction as usual.
+ */
+NXT_EXPORT void nxt_mp_cache_destroy(nxt_mp_cache_t *cache);
+
 /*
  * nxt_mp_retain() increases memory pool retention counter.
  */
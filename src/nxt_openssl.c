@@ -16,6 +16,7 @@
 #include <openssl/x509v3.h>
 #include <openssl/bio.h>
 #include <openssl/evp.h>
+#include <openssl/ocsp.h>
 
 
 typedef struct {
@@ -25,9 +26,22 @@ typedef struct {
     int               ssl_error;
     uint8_t           times;      /* 2 bits */
     uint8_t           handshake;  /* 1 bit  */
+    uint8_t           offloaded;  /* 1 bit  */
+    uint8_t           shutdown;   /* 1 bit  */
 
     nxt_tls_conf_t    *conf;
     nxt_buf_mem_t     buffer;
+
+    /* The result of a handshake step run by a thread pool thread. */
+    int               ret;
+    nxt_err_t         err;
+    u_long            lib_err;
+    nxt_uint_t        error_level;
+    nxt_str_t         error;
+    nxt_nsec_t        offload_start;
+
+    nxt_job_t         job;
+    nxt_task_t        task;
 } nxt_openssl_conn_t;
 
 
@@ -74,6 +88,7 @@ static nxt_int_t nxt_tls_ticket_keys(nxt_task_t *task, SSL_CTX *ctx,
     nxt_tls_init_t *tls_init, nxt_mp_t *mp);
 static int nxt_tls_ticket_key_callback(SSL *s, unsigned char *name,
     unsigned char *iv, EVP_CIPHER_CTX *ectx,HMAC_CTX *hctx, int enc);
+static int nxt_openssl_ocsp_status(SSL *s, void *arg);
 #endif
 static void nxt_ssl_session_cache(SSL_CTX *ctx, size_t cache_size,
     time_t timeout);
@@ -87,17 +102,35 @@ static nxt_int_t nxt_openssl_servername(SSL *s, int *ad, void *arg);
 static nxt_tls_bundle_conf_t *nxt_openssl_find_ctx(nxt_tls_conf_t *conf,
     nxt_str_t *sn);
 static void nxt_openssl_server_free(nxt_task_t *task, nxt_tls_conf_t *conf);
+static nxt_int_t nxt_openssl_ocsp_check(nxt_task_t *task,
+    nxt_tls_bundle_conf_t *bundle, u_char *response, size_t size,
+    nxt_time_t *expires);
+static X509 *nxt_openssl_ocsp_issuer(X509 *cert, STACK_OF(X509) *chain);
 static void nxt_openssl_conn_init(nxt_task_t *task, nxt_tls_conf_t *conf,
     nxt_conn_t *c);
 static void nxt_openssl_conn_handshake(nxt_task_t *task, void *obj, void *data);
+static void nxt_openssl_conn_handshake_offload(nxt_task_t *task,
+    nxt_conn_t *c);
+static void nxt_openssl_conn_handshake_thread(nxt_task_t *task, void *obj,
+    void *data);
+static void nxt_openssl_conn_handshake_return(nxt_task_t *task, void *obj,
+    void *data);
+static void nxt_openssl_conn_handshake_result(nxt_task_t *task, nxt_conn_t *c,
+    int ret, nxt_int_t n, void *data);
 static ssize_t nxt_openssl_conn_io_recvbuf(nxt_conn_t *c, nxt_buf_t *b);
 static ssize_t nxt_openssl_conn_io_sendbuf(nxt_task_t *task, nxt_sendbuf_t *sb);
+#if (NXT_HAVE_OPENSSL_KTLS)
+static ssize_t nxt_openssl_conn_io_sendfile(nxt_task_t *task,
+    nxt_sendbuf_t *sb);
+#endif
 static ssize_t nxt_openssl_conn_io_send(nxt_task_t *task, nxt_sendbuf_t *sb,
     void *buf, size_t size);
 static void nxt_openssl_conn_io_shutdown(nxt_task_t *task, void *obj,
     void *data);
 static nxt_int_t nxt_openssl_conn_test_error(nxt_task_t *task, nxt_conn_t *c,
     int ret, nxt_err_t sys_err, nxt_openssl_io_t io);
+static nxt_int_t nxt_openssl_conn_ssl_error(nxt_task_t *task, nxt_conn_t *c,
+    nxt_err_t sys_err, u_long lib_err, nxt_openssl_io_t io);
 static void nxt_openssl_conn_io_shutdown_timeout(nxt_task_t *task, void *obj,
     void *data);
 static void nxt_cdecl nxt_openssl_conn_error(nxt_task_t *task,
@@ -111,6 +144,8 @@ const nxt_tls_lib_t  nxt_openssl_lib = {
 
     .server_init = nxt_openssl_server_init,
     .server_free = nxt_openssl_server_free,
+
+    .ocsp_check = nxt_openssl_ocsp_check,
 };
 
 
@@ -331,6 +366,16 @@ nxt_openssl_server_init(nxt_task_t *task, nxt_mp_t *mp,
     SSL_CTX_set_options(ctx, SSL_OP_IGNORE_UNEXPECTED_EOF);
 #endif
 
+#if (NXT_HAVE_OPENSSL_KTLS)
+    if (tls_init->ktls) {
+        /*
+         * OpenSSL passes the session keys to the kernel after handshake
+         * if the kernel and the negotiated cipher support it.
+         */
+        SSL_CTX_set_options(ctx, SSL_OP_ENABLE_KTLS);
+    }
+#endif
+
 #ifdef SSL_MODE_RELEASE_BUFFERS
 
     if (nxt_openssl_version >= 10001078) {
@@ -384,6 +429,11 @@ nxt_openssl_server_init(nxt_task_t *task, nxt_mp_t *mp,
     if (nxt_tls_ticket_keys(task, ctx, tls_init, mp) != NXT_OK) {
         goto fail;
     }
+
+    if (bundle->ocsp != NULL) {
+        SSL_CTX_set_tlsext_status_cb(ctx, nxt_openssl_ocsp_status);
+        SSL_CTX_set_tlsext_status_arg(ctx, bundle->ocsp);
+    }
 #endif
 
     SSL_CTX_set_options(ctx, SSL_OP_CIPHER_SERVER_PREFERENCE);
@@ -826,6 +876,54 @@ nxt_tls_ticket_key_callback(SSL *s, unsigned char *name, unsigned char *iv,
 
 #endif /* SSL_CTRL_SET_TLSEXT_TICKET_KEY_CB */
 
+
+/*
+ * The response is loaded and refreshed in the background, so the
+ * handshake gets whatever is cached now and is never blocked by I/O.
+ */
+
+static int
+nxt_openssl_ocsp_status(SSL *s, void *arg)
+{
+    u_char          *p;
+    size_t          size;
+    nxt_time_t      now;
+    nxt_tls_ocsp_t  *ocsp;
+
+    ocsp = arg;
+
+    p = NULL;
+    size = 0;
+    now = time(NULL);
+
+    nxt_thread_spin_lock(&ocsp->lock);
+
+    if (ocsp->response != NULL && now < ocsp->expires) {
+        size = ocsp->size;
+        p = OPENSSL_malloc(size);
+
+        if (nxt_fast_path(p != NULL)) {
+            nxt_memcpy(p, ocsp->response, size);
+        }
+    }
+
+    nxt_thread_spin_unlock(&ocsp->lock);
+
+    if (p == NULL) {
+        nxt_thread_log_debug("no valid OCSP response \"%V\"", &ocsp->path);
+        return SSL_TLSEXT_ERR_NOACK;
+    }
+
+    if (SSL_set_tlsext_status_ocsp_resp(s, p, size) == 0) {
+        OPENSSL_free(p);
+        return SSL_TLSEXT_ERR_NOACK;
+    }
+
+    nxt_thread_log_debug("OCSP response stapled, size: %uz", size);
+
+    return SSL_TLSEXT_ERR_OK;
+}
+
 #endif /* NXT_HAVE_OPENSSL_TLSEXT */
 
 
@@ -1029,6 +1127,7 @@ nxt_openssl_bundle_hash_insert(nxt_task_t *task, nxt_lvlhsh_t *lvlhsh,
 static nxt_int_t
 nxt_openssl_servername(SSL *s, int *ad, void *arg)
 {
+    u_char                 *start;
     nxt_str_t              str;
     nxt_uint_t             i;
     nxt_conn_t             *c;
@@ -1065,11 +1164,17 @@ nxt_openssl_servername(SSL *s, int *ad, void *arg)
 
     nxt_debug(c->socket.task, "tls with servername \"%s\"", servername);
 
-    str.start = nxt_mp_nget(c->mem_pool, str.length);
-    if (nxt_slow_path(str.start == NULL)) {
+    /*
+     * The callback may be called by a handshake thread pool thread,
+     * so the connection mem_pool is not used here.
+     */
+    start = nxt_malloc(str.length);
+    if (nxt_slow_path(start == NULL)) {
         return SSL_TLSEXT_ERR_ALERT_FATAL;
     }
 
+    str.start = start;
+
     nxt_memcpy_lowcase(str.start, (const u_char *) servername, str.length);
 
     tls = c->u.tls;
@@ -1093,14 +1198,16 @@ nxt_openssl_servername(SSL *s, int *ad, void *arg)
         nxt_debug(c->socket.task, "new tls context found for \"%V\": \"%V\" "
                                   "(old: \"%V\")", &str, &bundle->name,
                                   &conf->bundle->name);
+    }
 
-        if (bundle != conf->bundle) {
-            if (SSL_set_SSL_CTX(s, bundle->ctx) == NULL) {
-                nxt_openssl_log_error(c->socket.task, NXT_LOG_ALERT,
-                                      "SSL_set_SSL_CTX() failed");
+    nxt_free(start);
 
-                return SSL_TLSEXT_ERR_ALERT_FATAL;
-            }
+    if (bundle != NULL && bundle != conf->bundle) {
+        if (SSL_set_SSL_CTX(s, bundle->ctx) == NULL) {
+            nxt_openssl_log_error(c->socket.task, NXT_LOG_ALERT,
+                                  "SSL_set_SSL_CTX() failed");
+
+            return SSL_TLSEXT_ERR_ALERT_FATAL;
         }
     }
 
@@ -1142,6 +1249,11 @@ nxt_openssl_server_free(nxt_task_t *task, nxt_tls_conf_t *conf)
 
     do {
         SSL_CTX_free(bundle->ctx);
+
+        if (bundle->ocsp != NULL) {
+            nxt_free(bundle->ocsp->response);
+        }
+
         bundle = bundle->next;
     } while (bundle != NULL);
 
@@ -1157,6 +1269,172 @@ nxt_openssl_server_free(nxt_task_t *task, nxt_tls_conf_t *conf)
 }
 
 
+/*
+ * A response is stapled only if it is signed by the certificate issuer
+ * or its delegated responder, reports the "good" status of the bundle
+ * certificate, and is within its validity window.  The issuer has to be
+ * present in the bundle chain.
+ */
+
+#define NXT_OPENSSL_OCSP_LEEWAY  300
+
+
+static nxt_int_t
+nxt_openssl_ocsp_check(nxt_task_t *task, nxt_tls_bundle_conf_t *bundle,
+    u_char *response, size_t size, nxt_time_t *expires)
+{
+    int                   n, status, days, secs;
+    X509                  *cert, *issuer;
+    SSL_CTX               *ctx;
+    nxt_int_t             ret;
+    X509_STORE            *store;
+    OCSP_CERTID           *id;
+    OCSP_RESPONSE         *resp;
+    OCSP_BASICRESP        *basic;
+    STACK_OF(X509)        *chain;
+    const unsigned char   *p;
+    ASN1_GENERALIZEDTIME  *thisupd, *nextupd;
+
+    ret = NXT_ERROR;
+
+    id = NULL;
+    store = NULL;
+    basic = NULL;
+
+    p = response;
+
+    resp = d2i_OCSP_RESPONSE(NULL, &p, size);
+    if (resp == NULL) {
+        nxt_openssl_log_error(task, NXT_LOG_ERR,
+                              "d2i_OCSP_RESPONSE(\"%V\") failed",
+                              &bundle->name);
+        return NXT_ERROR;
+    }
+
+    n = OCSP_response_status(resp);
+
+    if (n != OCSP_RESPONSE_STATUS_SUCCESSFUL) {
+        nxt_log(task, NXT_LOG_ERR, "OCSP response for \"%V\" status: %s",
+                &bundle->name, OCSP_response_status_str(n));
+        goto done;
+    }
+
+    basic = OCSP_response_get1_basic(resp);
+    if (basic == NULL) {
+        nxt_openssl_log_error(task, NXT_LOG_ERR,
+                              "OCSP_response_get1_basic(\"%V\") failed",
+                              &bundle->name);
+        goto done;
+    }
+
+    ctx = bundle->ctx;
+    cert = SSL_CTX_get0_certificate(ctx);
+
+#ifdef SSL_CTX_get0_chain_certs
+    SSL_CTX_get0_chain_certs(ctx, &chain);
+#else
+    SSL_CTX_get_extra_chain_certs(ctx, &chain);
+#endif
+
+    issuer = nxt_openssl_ocsp_issuer(cert, chain);
+    if (issuer == NULL) {
+        nxt_log(task, NXT_LOG_ERR, "no issuer of \"%V\" certificate "
+                "in the chain to check OCSP response", &bundle->name);
+        goto done;
+    }
+
+    store = X509_STORE_new();
+    if (store == NULL || X509_STORE_add_cert(store, issuer) != 1) {
+        nxt_openssl_log_error(task, NXT_LOG_ALERT, "X509_STORE_new() failed");
+        goto done;
+    }
+
+    X509_STORE_set_flags(store, X509_V_FLAG_PARTIAL_CHAIN);
+
+    if (OCSP_basic_verify(basic, chain, store, 0) != 1) {
+        nxt_openssl_log_error(task, NXT_LOG_ERR,
+                              "OCSP_basic_verify(\"%V\") failed",
+                              &bundle->name);
+        goto done;
+    }
+
+    id = OCSP_cert_to_id(NULL, cert, issuer);
+    if (id == NULL) {
+        nxt_openssl_log_error(task, NXT_LOG_ALERT,
+                              "OCSP_cert_to_id() failed");
+        goto done;
+    }
+
+    if (OCSP_resp_find_status(basic, id, &status, NULL, NULL,
+                              &thisupd, &nextupd)
+        != 1)
+    {
+        nxt_log(task, NXT_LOG_ERR, "certificate \"%V\" is not found "
+                "in OCSP response", &bundle->name);
+        goto done;
+    }
+
+    if (status != V_OCSP_CERTSTATUS_GOOD) {
+        nxt_log(task, NXT_LOG_ERR, "OCSP response for \"%V\" "
+                "certificate status: %s", &bundle->name,
+                OCSP_cert_status_str(status));
+        goto done;
+    }
+
+    if (OCSP_check_validity(thisupd, nextupd, NXT_OPENSSL_OCSP_LEEWAY, -1)
+        != 1)
+    {
+        nxt_openssl_log_error(task, NXT_LOG_ERR,
+                              "OCSP response for \"%V\" is out of date",
+                              &bundle->name);
+        goto done;
+    }
+
+    if (nextupd == NULL) {
+        *expires = NXT_TIME_T_MAX;
+
+    } else {
+        if (ASN1_TIME_diff(&days, &secs, NULL, nextupd) != 1) {
+            nxt_openssl_log_error(task, NXT_LOG_ERR,
+                                  "invalid OCSP \"nextUpdate\" time for "
+                                  "\"%V\"", &bundle->name);
+            goto done;
+        }
+
+        *expires = time(NULL) + (nxt_time_t) days * 86400 + secs;
+    }
+
+    ret = NXT_OK;
+
+done:
+
+    OCSP_CERTID_free(id);
+    X509_STORE_free(store);
+    OCSP_BASICRESP_free(basic);
+    OCSP_RESPONSE_free(resp);
+
+    return ret;
+}
+
+
+static X509 *
+nxt_openssl_ocsp_issuer(X509 *cert, STACK_OF(X509) *chain)
+{
+    int   i;
+    X509  *issuer;
+
+    for (i = 0; i < sk_X509_num(chain); i++) {
+        issuer = sk_X509_value(chain, i);
+
+        if (X509_check_issued(issuer, cert) == X509_V_OK) {
+            return issuer;
+        }
+    }
+
+    return NULL;
+}
+
+
 static void
 nxt_openssl_conn_init(nxt_task_t *task, nxt_tls_conf_t *conf, nxt_conn_t *c)
 {
@@ -1206,6 +1484,8 @@ nxt_openssl_conn_init(nxt_task_t *task, nxt_tls_conf_t *conf, nxt_conn_t *c)
     c->io = &nxt_openssl_conn_io;
     c->sendfile = NXT_CONN_SENDFILE_OFF;
 
+    c->tls_start = nxt_thread_monotonic_time(task->thread);
+
     nxt_openssl_conn_handshake(task, c, c->socket.data);
 
     return;
@@ -1237,14 +1517,11 @@ nxt_openssl_conn_free(nxt_task_t *task, nxt_conn_t *c)
 static void
 nxt_openssl_conn_handshake(nxt_task_t *task, void *obj, void *data)
 {
-    int                     ret;
-    nxt_int_t               n;
-    nxt_err_t               err;
-    nxt_conn_t              *c;
-    nxt_work_queue_t        *wq;
-    nxt_work_handler_t      handler;
-    nxt_openssl_conn_t      *tls;
-    const nxt_conn_state_t  *state;
+    int                 ret;
+    nxt_int_t           n;
+    nxt_err_t           err;
+    nxt_conn_t          *c;
+    nxt_openssl_conn_t  *tls;
 
     c = obj;
 
@@ -1260,9 +1537,16 @@ nxt_openssl_conn_handshake(nxt_task_t *task, void *obj, void *data)
         return;
     }
 
+    if (tls->offloaded) {
+        return;
+    }
+
     nxt_debug(task, "openssl conn handshake: %d times", tls->times);
 
-    /* "tls->times == 1" is suitable to run SSL_do_handshake() in job. */
+    if (tls->conf->offload != NULL) {
+        nxt_openssl_conn_handshake_offload(task, c);
+        return;
+    }
 
     ret = SSL_do_handshake(tls->session);
 
@@ -1272,12 +1556,231 @@ nxt_openssl_conn_handshake(nxt_task_t *task, void *obj, void *data)
 
     nxt_debug(task, "SSL_do_handshake(%d): %d err:%d", c->socket.fd, ret, err);
 
+    n = NXT_OK;
+
+    if (ret <= 0) {
+        n = nxt_openssl_conn_test_error(task, c, ret, err,
+                                        NXT_OPENSSL_HANDSHAKE);
+
+        if (n == NXT_ERROR) {
+            nxt_openssl_conn_error(task, err, "SSL_do_handshake(%d) failed",
+                                   c->socket.fd);
+        }
+    }
+
+    nxt_openssl_conn_handshake_result(task, c, ret, n, data);
+}
+
+
+/*
+ * A handshake step is run by a thread pool thread, the connection socket
+ * events are blocked meanwhile and only mark the socket as ready.
+ */
+
+static void
+nxt_openssl_conn_handshake_offload(nxt_task_t *task, nxt_conn_t *c)
+{
+    nxt_event_engine_t  *engine;
+    nxt_openssl_conn_t  *tls;
+
+    tls = c->u.tls;
+    engine = task->thread->engine;
+
+    nxt_debug(task, "openssl conn handshake offload fd:%d", c->socket.fd);
+
+    tls->task = *c->socket.task;
+
+    nxt_job_init(&tls->job, sizeof(nxt_job_t));
+    nxt_job_set_name(&tls->job, "openssl handshake");
+
+    tls->job.task = &tls->task;
+    tls->job.data = tls;
+    tls->job.thread_pool = tls->conf->offload->thread_pool;
+    /* The step is run by the engine thread if the pool has failed. */
+    tls->job.abort_handler = nxt_openssl_conn_handshake_thread;
+
+    c->socket.read_ready = 0;
+    c->socket.write_ready = 0;
+
+    nxt_fd_event_block_read(engine, &c->socket);
+    nxt_fd_event_block_write(engine, &c->socket);
+
+    tls->offloaded = 1;
+    tls->offload_start = nxt_thread_monotonic_time(task->thread);
+
+    (void) nxt_atomic_fetch_add(&tls->conf->offload->queued, 1);
+
+    nxt_job_start(task, &tls->job, nxt_openssl_conn_handshake_thread);
+}
+
+
+static void
+nxt_openssl_conn_handshake_thread(nxt_task_t *task, void *obj, void *data)
+{
+    int                 ret;
+    u_char              *p, *end;
+    nxt_err_t           err;
+    nxt_openssl_conn_t  *tls;
+
+    tls = data;
+
+    /* The error queue is per thread, so it is inspected here. */
+
+    ERR_clear_error();
+
+    ret = SSL_do_handshake(tls->session);
+
+    err = (ret <= 0) ? nxt_socket_errno : 0;
+
+    nxt_debug(task, "SSL_do_handshake(%d): %d err:%d",
+              tls->conn->socket.fd, ret, err);
+
+    tls->ret = ret;
+    tls->err = err;
+    tls->lib_err = 0;
+
+    if (ret <= 0) {
+        tls->ssl_error = SSL_get_error(tls->session, ret);
+
+        if (tls->ssl_error == SSL_ERROR_SYSCALL) {
+            tls->lib_err = ERR_peek_error();
+        }
+
+        if (tls->ssl_error != SSL_ERROR_WANT_READ
+            && tls->ssl_error != SSL_ERROR_WANT_WRITE)
+        {
+            tls->error_level = nxt_openssl_log_error_level(err);
+
+            p = nxt_malloc(NXT_MAX_ERROR_STR);
+
+            if (p != NULL) {
+                end = p + NXT_MAX_ERROR_STR;
+                tls->error.start = p;
+
+                if (err != 0) {
+                    p = nxt_sprintf(p, end, " %E", err);
+                }
+
+                p = nxt_openssl_copy_error(p, end);
+
+                tls->error.length = p - tls->error.start;
+            }
+        }
+
+        ERR_clear_error();
+    }
+
+    /* The work may still link the next one of the thread pool queue. */
+    tls->job.work.next = NULL;
+
+    nxt_job_return(task, &tls->job, nxt_openssl_conn_handshake_return);
+}
+
+
+static void
+nxt_openssl_conn_handshake_return(nxt_task_t *task, void *obj, void *data)
+{
+    nxt_int_t           n;
+    nxt_msec_t          ms;
+    nxt_conn_t          *c;
+    nxt_tls_offload_t   *offload;
+    nxt_openssl_conn_t  *tls;
+
+    tls = data;
+    c = tls->conn;
+    task = c->socket.task;
+
+    nxt_debug(task, "openssl conn handshake return fd:%d", c->socket.fd);
+
+    tls->offloaded = 0;
+
+    offload = tls->conf->offload;
+
+    ms = (nxt_thread_monotonic_time(task->thread) - tls->offload_start)
+         / 1000000;
+
+    (void) nxt_atomic_fetch_add(&offload->queued, -1);
+    nxt_status_time_add(&offload->time, ms);
+
+    if (tls->shutdown) {
+        nxt_free(tls->error.start);
+        nxt_str_null(&tls->error);
+
+        nxt_openssl_conn_io_shutdown(task, c, NULL);
+        return;
+    }
+
+    n = NXT_OK;
+
+    if (tls->ret <= 0) {
+        nxt_debug(task, "SSL_get_error(): %d", tls->ssl_error);
+
+        if ((tls->ssl_error == SSL_ERROR_WANT_READ && c->socket.read_ready)
+            || (tls->ssl_error == SSL_ERROR_WANT_WRITE
+                && c->socket.write_ready))
+        {
+            /* The socket has become ready while the step was running. */
+            nxt_openssl_conn_handshake_offload(task, c);
+            return;
+        }
+    }
+
+    /*
+     * Readiness could be consumed by the step while the events were
+     * blocked, so the socket is assumed to be ready until EAGAIN.
+     */
+    c->socket.read_ready = 1;
+    c->socket.write_ready = 1;
+
+    if (tls->ret <= 0) {
+        n = nxt_openssl_conn_ssl_error(task, c, tls->err, tls->lib_err,
+                                       NXT_OPENSSL_HANDSHAKE);
+
+        if (n == NXT_ERROR) {
+            nxt_log(task, tls->error_level, "SSL_do_handshake(%d) failed%V",
+                    c->socket.fd, &tls->error);
+        }
+
+        nxt_free(tls->error.start);
+        nxt_str_null(&tls->error);
+    }
+
+    nxt_openssl_conn_handshake_result(task, c, tls->ret, n, c->socket.data);
+}
+
+
+static void
+nxt_openssl_conn_handshake_result(nxt_task_t *task, nxt_conn_t *c, int ret,
+    nxt_int_t n, void *data)
+{
+    nxt_work_queue_t        *wq;
+    nxt_work_handler_t      handler;
+    nxt_openssl_conn_t      *tls;
+    const nxt_conn_state_t  *state;
+
+    tls = c->u.tls;
+
     state = (c->read_state != NULL) ? c->read_state : c->write_state;
 
     if (ret > 0) {
         /* ret == 1, the handshake was successfully completed. */
         tls->handshake = 1;
 
+        c->tls_end = nxt_thread_monotonic_time(task->thread);
+
+        task->thread->engine->tls_conns_cnt++;
+
+#if (NXT_HAVE_OPENSSL_KTLS)
+        if (BIO_get_ktls_send(SSL_get_wbio(tls->session))) {
+            nxt_debug(task, "openssl conn ktls send fd:%d", c->socket.fd);
+
+            /* The kernel encrypts data, so files can be sent directly. */
+            c->sendfile = NXT_CONN_SENDFILE_ON;
+
+            task->thread->engine->ktls_conns_cnt++;
+        }
+#endif
+
         if (c->read_state != NULL) {
             if (state->io_read_handler != NULL || c->read != NULL) {
                 nxt_conn_read(task->thread->engine, c);
@@ -1297,8 +1800,6 @@ nxt_openssl_conn_handshake(nxt_task_t *task, void *obj, void *data)
         c->socket.read_handler = nxt_openssl_conn_handshake;
         c->socket.write_handler = nxt_openssl_conn_handshake;
 
-        n = nxt_openssl_conn_test_error(task, c, ret, err,
-                                        NXT_OPENSSL_HANDSHAKE);
         switch (n) {
 
         case NXT_AGAIN:
@@ -1314,9 +1815,6 @@ nxt_openssl_conn_handshake(nxt_task_t *task, void *obj, void *data)
 
         default:
         case NXT_ERROR:
-            nxt_openssl_conn_error(task, err, "SSL_do_handshake(%d) failed",
-                                   c->socket.fd);
-
             handler = state->error_handler;
             break;
         }
@@ -1375,10 +1873,70 @@ nxt_openssl_conn_io_sendbuf(nxt_task_t *task, nxt_sendbuf_t *sb)
         return 0;
     }
 
+#if (NXT_HAVE_OPENSSL_KTLS)
+    if (niov == 0 && nxt_buf_is_file(sb->buf)) {
+        return nxt_openssl_conn_io_sendfile(task, sb);
+    }
+#endif
+
     return nxt_openssl_conn_io_send(task, sb, iov.iov_base, iov.iov_len);
 }
 
 
+#if (NXT_HAVE_OPENSSL_KTLS)
+
+static ssize_t
+nxt_openssl_conn_io_sendfile(nxt_task_t *task, nxt_sendbuf_t *sb)
+{
+    size_t              size;
+    nxt_buf_t           *b;
+    nxt_err_t           err;
+    nxt_int_t           n;
+    nxt_conn_t          *c;
+    ossl_ssize_t        ret;
+    nxt_openssl_conn_t  *tls;
+
+    tls = sb->tls;
+    b = sb->buf;
+
+    size = nxt_min(b->file_end - b->file_pos, (nxt_off_t) sb->limit);
+
+    ret = SSL_sendfile(tls->session, b->file->fd, b->file_pos, size, 0);
+
+    err = (ret <= 0) ? nxt_socket_errno : 0;
+
+    nxt_debug(task, "SSL_sendfile(%d, %FD, @%O, %uz): %z err:%d",
+              sb->socket, b->file->fd, b->file_pos, size, ret, err);
+
+    if (ret > 0) {
+        if (ret < (ossl_ssize_t) size) {
+            sb->ready = 0;
+        }
+
+        return ret;
+    }
+
+    c = tls->conn;
+    c->socket.write_ready = sb->ready;
+
+    n = nxt_openssl_conn_test_error(task, c, (int) ret, err,
+                                    NXT_OPENSSL_WRITE);
+
+    sb->ready = c->socket.write_ready;
+
+    if (n == NXT_ERROR) {
+        sb->error = c->socket.error;
+        nxt_openssl_conn_error(task, err, "SSL_sendfile(%d, %FD, @%O, %uz) "
+                               "failed", sb->socket, b->file->fd, b->file_pos,
+                               size);
+    }
+
+    return n;
+}
+
+#endif
+
+
 static ssize_t
 nxt_openssl_conn_io_send(nxt_task_t *task, nxt_sendbuf_t *sb, void *buf,
     size_t size)
@@ -1442,6 +2000,12 @@ nxt_openssl_conn_io_shutdown(nxt_task_t *task, void *obj, void *data)
         return;
     }
 
+    if (tls->offloaded) {
+        /* Continued by nxt_openssl_conn_handshake_return(). */
+        tls->shutdown = 1;
+        return;
+    }
+
     s = tls->session;
 
     if (s == NULL || !tls->handshake) {
@@ -1553,6 +2117,26 @@ nxt_openssl_conn_test_error(nxt_task_t *task, nxt_conn_t *c, int ret,
 
     nxt_debug(task, "SSL_get_error(): %d", tls->ssl_error);
 
+    lib_err = 0;
+
+    if (tls->ssl_error == SSL_ERROR_SYSCALL) {
+        lib_err = ERR_peek_error();
+
+        nxt_debug(task, "ERR_peek_error(): %l", lib_err);
+    }
+
+    return nxt_openssl_conn_ssl_error(task, c, sys_err, lib_err, io);
+}
+
+
+static nxt_int_t
+nxt_openssl_conn_ssl_error(nxt_task_t *task, nxt_conn_t *c, nxt_err_t sys_err,
+    u_long lib_err, nxt_openssl_io_t io)
+{
+    nxt_openssl_conn_t  *tls;
+
+    tls = c->u.tls;
+
     switch (tls->ssl_error) {
 
     case SSL_ERROR_WANT_READ:
@@ -1582,10 +2166,6 @@ nxt_openssl_conn_test_error(nxt_task_t *task, nxt_conn_t *c, int ret,
         return NXT_AGAIN;
 
     case SSL_ERROR_SYSCALL:
-        lib_err = ERR_peek_error();
-
-        nxt_debug(task, "ERR_peek_error(): %l", lib_err);
-
         if (sys_err != 0 || lib_err != 0) {
             c->socket.error = sys_err;
             return NXT_ERROR;
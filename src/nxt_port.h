@@ -20,6 +20,7 @@ struct nxt_port_handlers_s {
     nxt_port_handler_t  conf_store;
     nxt_port_handler_t  cert_get;
     nxt_port_handler_t  cert_delete;
+    nxt_port_handler_t  ocsp_get;
     nxt_port_handler_t  access_log;
 
     /* File descriptor exchange. */
@@ -85,6 +86,7 @@ typedef enum {
     _NXT_PORT_MSG_CONF_STORE      = nxt_port_handler_idx(conf_store),
     _NXT_PORT_MSG_CERT_GET        = nxt_port_handler_idx(cert_get),
     _NXT_PORT_MSG_CERT_DELETE     = nxt_port_handler_idx(cert_delete),
+    _NXT_PORT_MSG_OCSP_GET        = nxt_port_handler_idx(ocsp_get),
     _NXT_PORT_MSG_ACCESS_LOG      = nxt_port_handler_idx(access_log),
 
     _NXT_PORT_MSG_CHANGE_FILE     = nxt_port_handler_idx(change_file),
@@ -126,6 +128,7 @@ typedef enum {
     NXT_PORT_MSG_CONF_STORE       = nxt_msg_last(_NXT_PORT_MSG_CONF_STORE),
     NXT_PORT_MSG_CERT_GET         = nxt_msg_last(_NXT_PORT_MSG_CERT_GET),
     NXT_PORT_MSG_CERT_DELETE      = nxt_msg_last(_NXT_PORT_MSG_CERT_DELETE),
+    NXT_PORT_MSG_OCSP_GET         = nxt_msg_last(_NXT_PORT_MSG_OCSP_GET),
     NXT_PORT_MSG_ACCESS_LOG       = nxt_msg_last(_NXT_PORT_MSG_ACCESS_LOG),
     NXT_PORT_MSG_CHANGE_FILE      = nxt_msg_last(_NXT_PORT_MSG_CHANGE_FILE),
     NXT_PORT_MSG_NEW_PORT         = nxt_msg_last(_NXT_PORT_MSG_NEW_PORT),
@@ -247,6 +250,8 @@ struct nxt_port_s {
 
     uint32_t            active_websockets;
     uint32_t            active_requests;
+    /* Requests dispatched to the port queue and not acknowledged yet. */
+    uint32_t            queued_requests;
 
     nxt_port_handler_t  handler;
     nxt_port_handler_t  *data;
@@ -28,9 +28,16 @@ typedef struct {
     uint32_t          spare_processes;
     nxt_msec_t        timeout;
     nxt_msec_t        idle_timeout;
+    nxt_msec_t        queue_timeout;
+    uint32_t          max_queue;
     nxt_conf_value_t  *limits_value;
     nxt_conf_value_t  *processes_value;
     nxt_conf_value_t  *targets_value;
+    nxt_conf_value_t  *dispatch_value;
+    nxt_conf_value_t  *autoscale_value;
+    uint32_t          requests;
+    uint32_t          dispatch_depth;
+    nxt_str_t         dispatch_key;
 } nxt_router_app_conf_t;
 
 
@@ -77,6 +84,25 @@ typedef struct {
 } nxt_app_joint_rpc_t;
 
 
+typedef struct {
+    nxt_app_t   *app;
+    nxt_int_t   target;
+    nxt_tstr_t  *key;
+} nxt_http_app_conf_t;
+
+
+typedef struct {
+    nxt_app_t   *app;
+    nxt_tstr_t  *key;
+} nxt_router_app_key_t;
+
+
+typedef struct {
+    nxt_http_app_conf_t  *conf;
+    nxt_str_t            key;
+} nxt_router_app_key_ctx_t;
+
+
 static nxt_int_t nxt_router_prefork(nxt_task_t *task, nxt_process_t *process,
     nxt_mp_t *mp);
 static nxt_int_t nxt_router_start(nxt_task_t *task, nxt_process_data_t *data);
@@ -99,11 +125,24 @@ static void nxt_router_remove_pid_handler(nxt_task_t *task,
 static nxt_router_temp_conf_t *nxt_router_temp_conf(nxt_task_t *task);
 static void nxt_router_conf_ready(nxt_task_t *task,
     nxt_router_temp_conf_t *tmcf);
+static void nxt_router_conf_free(nxt_task_t *task, nxt_router_conf_t *rtcf);
 static void nxt_router_conf_send(nxt_task_t *task,
     nxt_router_temp_conf_t *tmcf, nxt_port_msg_type_t type);
 
 static nxt_int_t nxt_router_conf_create(nxt_task_t *task,
     nxt_router_temp_conf_t *tmcf, u_char *start, u_char *end);
+static nxt_router_conf_t *nxt_router_conf_base(nxt_task_t *task,
+    nxt_router_temp_conf_t *tmcf, nxt_conf_value_t *root,
+    nxt_conf_value_t **prev_listeners);
+static void nxt_router_conf_share(nxt_router_conf_t *rtcf,
+    nxt_router_conf_t *base);
+static void nxt_router_conf_base_release(nxt_task_t *task,
+    nxt_router_conf_t *base);
+static nxt_bool_t nxt_router_conf_value_eq(nxt_mp_t *mp,
+    nxt_conf_value_t *value1, nxt_conf_value_t *value2);
+static nxt_int_t nxt_router_listener_keep(nxt_task_t *task,
+    nxt_router_temp_conf_t *tmcf, nxt_conf_value_t *prev_listeners,
+    nxt_str_t *name, nxt_conf_value_t *listener);
 static nxt_int_t nxt_router_conf_process_static(nxt_task_t *task,
     nxt_router_conf_t *rtcf, nxt_conf_value_t *conf);
 static nxt_http_forward_t *nxt_router_conf_forward(nxt_task_t *task,
@@ -112,6 +151,12 @@ static nxt_int_t nxt_router_conf_forward_header(nxt_mp_t *mp,
     nxt_conf_value_t *conf, nxt_http_forward_header_t *fh);
 
 static nxt_app_t *nxt_router_app_find(nxt_queue_t *queue, nxt_str_t *name);
+static nxt_app_scale_t *nxt_router_app_scale_create(nxt_mp_t *mp,
+    nxt_conf_value_t *conf);
+static nxt_uint_t nxt_router_app_scale(nxt_task_t *task, nxt_app_t *app,
+    nxt_msec_t now);
+static nxt_int_t nxt_router_app_keys_create(nxt_router_temp_conf_t *tmcf);
+static nxt_tstr_t *nxt_router_app_key(nxt_router_conf_t *rtcf, nxt_app_t *app);
 static nxt_int_t nxt_router_apps_hash_test(nxt_lvlhsh_query_t *lhq, void *data);
 static nxt_int_t nxt_router_apps_hash_add(nxt_router_conf_t *rtcf,
     nxt_app_t *app);
@@ -138,6 +183,14 @@ static void nxt_router_tls_rpc_handler(nxt_task_t *task,
 static nxt_int_t nxt_router_conf_tls_insert(nxt_router_temp_conf_t *tmcf,
     nxt_conf_value_t *value, nxt_socket_conf_t *skcf, nxt_tls_init_t *tls_init,
     nxt_bool_t last);
+static nxt_int_t nxt_router_tls_ocsp_create(nxt_mp_t *mp,
+    nxt_tls_bundle_conf_t *bundle, nxt_conf_value_t *conf);
+static void nxt_router_tls_ocsp_refresh(nxt_task_t *task,
+    nxt_router_t *router);
+static void nxt_router_tls_ocsp_timeout(nxt_task_t *task, void *obj,
+    void *data);
+static void nxt_router_tls_ocsp_handler(nxt_task_t *task,
+    nxt_port_recv_msg_t *msg, void *data);
 #endif
 static void nxt_router_app_rpc_create(nxt_task_t *task,
     nxt_router_temp_conf_t *tmcf, nxt_app_t *app);
@@ -194,6 +247,8 @@ static void nxt_router_listen_socket_close(nxt_task_t *task, void *obj,
     void *data);
 static void nxt_router_thread_exit_handler(nxt_task_t *task, void *obj,
     void *data);
+static void nxt_router_req_headers_acks_handler(nxt_task_t *task,
+    nxt_port_recv_msg_t *msg);
 static void nxt_router_req_headers_ack_handler(nxt_task_t *task,
     nxt_port_recv_msg_t *msg, nxt_request_rpc_data_t *req_rpc_data);
 static void nxt_router_listen_socket_release(nxt_task_t *task,
@@ -204,20 +259,34 @@ static void nxt_router_app_port_ready(nxt_task_t *task,
 static void nxt_router_app_port_error(nxt_task_t *task,
     nxt_port_recv_msg_t *msg, void *data);
 
-static void nxt_router_app_use(nxt_task_t *task, nxt_app_t *app, int i);
 static void nxt_router_app_unlink(nxt_task_t *task, nxt_app_t *app);
 
 static void nxt_router_app_port_release(nxt_task_t *task, nxt_app_t *app,
     nxt_port_t *port, nxt_apr_action_t action);
 static void nxt_router_app_port_get(nxt_task_t *task, nxt_app_t *app,
-    nxt_request_rpc_data_t *req_rpc_data);
+    nxt_request_rpc_data_t *req_rpc_data, nxt_str_t *key);
+static nxt_bool_t nxt_router_app_port_unidle(nxt_task_t *task, nxt_app_t *app,
+    nxt_port_t *port);
+static nxt_bool_t nxt_router_app_dispatch(nxt_task_t *task, nxt_app_t *app,
+    nxt_http_request_t *r, nxt_str_t *key);
+static nxt_port_t *nxt_router_app_dispatch_done(nxt_app_t *app,
+    nxt_http_request_t *r, nxt_pid_t pid);
+static void nxt_router_app_request(nxt_task_t *task, nxt_http_request_t *r,
+    nxt_http_app_conf_t *conf, nxt_str_t *key);
+static void nxt_router_app_key_ready(nxt_task_t *task, void *obj, void *data);
+static void nxt_router_app_key_error(nxt_task_t *task, void *obj, void *data);
+static void nxt_router_traffic_add(nxt_status_traffic_t *traffic,
+    nxt_http_request_t *r, nxt_msec_t time, nxt_off_t sent);
 static void nxt_router_http_request_error(nxt_task_t *task, void *obj,
     void *data);
 static void nxt_router_http_request_done(nxt_task_t *task, void *obj,
     void *data);
 
+static nxt_bool_t nxt_router_app_queue_full(nxt_app_t *app);
 static void nxt_router_app_prepare_request(nxt_task_t *task,
     nxt_request_rpc_data_t *req_rpc_data);
+static nxt_int_t nxt_router_app_dispatch_send(nxt_task_t *task,
+    nxt_request_rpc_data_t *req_rpc_data, void *msg, size_t size);
 static nxt_buf_t *nxt_router_prepare_msg(nxt_task_t *task,
     nxt_http_request_t *r, nxt_app_t *app, const nxt_str_t *prefix);
 
@@ -241,6 +310,8 @@ static void nxt_router_http_request_release_post(nxt_task_t *task,
 static void nxt_router_http_request_release(nxt_task_t *task, void *obj,
     void *data);
 static void nxt_router_oosm_handler(nxt_task_t *task, nxt_port_recv_msg_t *msg);
+static void nxt_router_websocket_publish_handler(nxt_task_t *task,
+    nxt_port_recv_msg_t *msg);
 static void nxt_router_get_port_handler(nxt_task_t *task,
     nxt_port_recv_msg_t *msg);
 static void nxt_router_get_mmap_handler(nxt_task_t *task,
@@ -264,20 +335,21 @@ static const nxt_str_t  *nxt_app_msg_prefix[] = {
 
 
 static const nxt_port_handlers_t  nxt_router_process_port_handlers = {
-    .quit         = nxt_signal_quit_handler,
-    .new_port     = nxt_router_new_port_handler,
-    .get_port     = nxt_router_get_port_handler,
-    .change_file  = nxt_port_change_log_file_handler,
-    .mmap         = nxt_port_mmap_handler,
-    .get_mmap     = nxt_router_get_mmap_handler,
-    .data         = nxt_router_conf_data_handler,
-    .app_restart  = nxt_router_app_restart_handler,
-    .status       = nxt_router_status_handler,
-    .remove_pid   = nxt_router_remove_pid_handler,
-    .access_log   = nxt_router_access_log_reopen_handler,
-    .rpc_ready    = nxt_port_rpc_handler,
-    .rpc_error    = nxt_port_rpc_handler,
-    .oosm         = nxt_router_oosm_handler,
+    .quit            = nxt_signal_quit_handler,
+    .new_port        = nxt_router_new_port_handler,
+    .get_port        = nxt_router_get_port_handler,
+    .change_file     = nxt_port_change_log_file_handler,
+    .mmap            = nxt_port_mmap_handler,
+    .get_mmap        = nxt_router_get_mmap_handler,
+    .data            = nxt_router_conf_data_handler,
+    .app_restart     = nxt_router_app_restart_handler,
+    .status          = nxt_router_status_handler,
+    .remove_pid      = nxt_router_remove_pid_handler,
+    .access_log      = nxt_router_access_log_reopen_handler,
+    .rpc_ready       = nxt_port_rpc_handler,
+    .rpc_error       = nxt_port_rpc_handler,
+    .oosm            = nxt_router_oosm_handler,
+    .websocket_frame = nxt_router_websocket_publish_handler,
 };
 
 
@@ -299,6 +371,7 @@ nxt_queue_t  pending_sockets;
 nxt_queue_t  updating_sockets;
 nxt_queue_t  keeping_sockets;
 nxt_queue_t  deleting_sockets;
+nxt_queue_t  unchanged_sockets;
 
 
 static nxt_int_t
@@ -313,10 +386,13 @@ nxt_router_prefork(nxt_task_t *task, nxt_process_t *process, nxt_mp_t *mp)
 static nxt_int_t
 nxt_router_start(nxt_task_t *task, nxt_process_data_t *data)
 {
-    nxt_int_t      ret;
-    nxt_port_t     *controller_port;
-    nxt_router_t   *router;
-    nxt_runtime_t  *rt;
+    nxt_int_t          ret;
+    nxt_port_t         *controller_port;
+    nxt_router_t       *router;
+    nxt_runtime_t      *rt;
+#if (NXT_TLS)
+    nxt_thread_pool_t  **tp;
+#endif
 
     rt = task->thread->runtime;
 
@@ -348,6 +424,21 @@ nxt_router_start(nxt_task_t *task, nxt_process_data_t *data)
     nxt_queue_init(&router->sockets);
     nxt_queue_init(&router->apps);
 
+    /* The main engine and an engine per listener thread. */
+    router->status_slots = nxt_ncpu + 1;
+
+#if (NXT_TLS)
+    /* The pool threads are created on demand. */
+    ret = nxt_runtime_thread_pool_create(task->thread, rt, nxt_ncpu,
+                                         60000 * 1000000LL);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    tp = rt->thread_pools->elts;
+    router->tls_offload.thread_pool = tp[rt->thread_pools->nelts - 1];
+#endif
+
     nxt_router = router;
 
     controller_port = rt->port_by_type[NXT_PROCESS_CONTROLLER];
@@ -581,13 +672,22 @@ nxt_request_rpc_data_unlink(nxt_task_t *task,
     nxt_request_rpc_data_t *req_rpc_data)
 {
     nxt_app_t           *app;
+    nxt_port_t          *port;
+    nxt_msec_t          service;
     nxt_bool_t          unlinked;
+    nxt_app_status_t    *status;
     nxt_http_request_t  *r;
 
     nxt_router_msg_cancel(task, req_rpc_data);
 
     app = req_rpc_data->app;
 
+    if (req_rpc_data->dispatch_port != NULL) {
+        nxt_port_use(task, req_rpc_data->dispatch_port, -1);
+
+        req_rpc_data->dispatch_port = NULL;
+    }
+
     if (req_rpc_data->app_port != NULL) {
         nxt_router_app_port_release(task, app, req_rpc_data->app_port,
                                     req_rpc_data->apr_action);
@@ -600,6 +700,10 @@ nxt_request_rpc_data_unlink(nxt_task_t *task,
     if (r != NULL) {
         r->timer_data = NULL;
 
+        if (req_rpc_data->apr_action == NXT_APR_GOT_RESPONSE) {
+            r->app_end = nxt_thread_monotonic_time(task->thread);
+        }
+
         nxt_router_http_request_release_post(task, r);
 
         r->req_rpc_data = NULL;
@@ -613,15 +717,38 @@ nxt_request_rpc_data_unlink(nxt_task_t *task,
             if (r->app_link.next != NULL) {
                 nxt_queue_remove(&r->app_link);
                 r->app_link.next = NULL;
+                app->waiting_requests--;
 
                 unlinked = 1;
             }
 
+            port = nxt_router_app_dispatch_done(app, r, 0);
+
+            if (req_rpc_data->acked_at != 0
+                && req_rpc_data->apr_action == NXT_APR_GOT_RESPONSE)
+            {
+                service = task->thread->engine->timers.now
+                          - req_rpc_data->acked_at;
+
+                status = nxt_router_status(task, app->status);
+
+                nxt_status_time_add(&status->service_time, service);
+
+                if (app->scale != NULL) {
+                    app->scale->service_avg += service
+                                           - (app->scale->service_avg >> 3);
+                }
+            }
+
             nxt_thread_mutex_unlock(&app->mutex);
 
             if (unlinked) {
                 nxt_mp_release(r->mem_pool);
             }
+
+            if (port != NULL) {
+                nxt_port_use(task, port, -1);
+            }
         }
     }
 
@@ -739,6 +866,7 @@ nxt_router_conf_data_handler(nxt_task_t *task, nxt_port_recv_msg_t *msg)
     size_t                  size;
     nxt_int_t               ret;
     nxt_port_t              *port;
+    nxt_monotonic_time_t    now;
     nxt_router_temp_conf_t  *tmcf;
 
     port = nxt_runtime_port_find(task->thread->runtime,
@@ -750,6 +878,7 @@ nxt_router_conf_data_handler(nxt_task_t *task, nxt_port_recv_msg_t *msg)
     }
 
     p = MAP_FAILED;
+    tmcf = NULL;
 
     /*
      * Ancient compilers like gcc 4.8.5 on CentOS 7 wants 'size' to be
@@ -757,11 +886,6 @@ nxt_router_conf_data_handler(nxt_task_t *task, nxt_port_recv_msg_t *msg)
      */
     size = 0;
 
-    tmcf = nxt_router_temp_conf(task);
-    if (nxt_slow_path(tmcf == NULL)) {
-        goto fail;
-    }
-
     if (nxt_slow_path(msg->fd[0] == -1)) {
         nxt_alert(task, "conf_data_handler: invalid shm fd");
         goto fail;
@@ -786,6 +910,33 @@ nxt_router_conf_data_handler(nxt_task_t *task, nxt_port_recv_msg_t *msg)
 
     nxt_debug(task, "conf_data_handler(%uz): %*s", size, size, p);
 
+    nxt_monotonic_time(&now);
+
+    if (nxt_str_eq(&nxt_router->conf, p, size)) {
+        nxt_debug(task, "conf_data_handler: configuration is unchanged");
+
+        nxt_router->reloads_unchanged++;
+
+        nxt_port_socket_write(task, port, NXT_PORT_MSG_RPC_READY_LAST, -1,
+                              msg->port_msg.stream, 0, NULL);
+        goto cleanup;
+    }
+
+    tmcf = nxt_router_temp_conf(task);
+    if (nxt_slow_path(tmcf == NULL)) {
+        goto fail;
+    }
+
+    tmcf->conf.start = nxt_malloc(size);
+    if (nxt_slow_path(tmcf->conf.start == NULL)) {
+        goto fail;
+    }
+
+    nxt_memcpy(tmcf->conf.start, p, size);
+    tmcf->conf.length = size;
+
+    tmcf->start = now.monotonic;
+
     tmcf->router_conf->router = nxt_router;
     tmcf->stream = msg->port_msg.stream;
     tmcf->port = port;
@@ -925,15 +1076,24 @@ nxt_router_app_restart_handler(nxt_task_t *task, nxt_port_recv_msg_t *msg)
 static void
 nxt_router_status_handler(nxt_task_t *task, nxt_port_recv_msg_t *msg)
 {
-    u_char               *p;
-    size_t               alloc;
-    nxt_app_t            *app;
-    nxt_buf_t            *b;
-    nxt_uint_t           type;
-    nxt_port_t           *port;
-    nxt_status_app_t     *app_stat;
-    nxt_event_engine_t   *engine;
-    nxt_status_report_t  *report;
+    u_char                 *p;
+    size_t                 alloc;
+    uint32_t               i, k, s, slots, steps, nroutes;
+    nxt_str_t              *name;
+    nxt_app_t              *app;
+    nxt_buf_t              *b;
+    nxt_uint_t             type;
+    nxt_port_t             *port;
+    nxt_sockaddr_t         *sa;
+    nxt_status_app_t       *app_stat;
+    nxt_socket_conf_t      *skcf;
+    nxt_router_conf_t      *rtcf;
+    nxt_http_routes_t      *routes;
+    nxt_event_engine_t     *engine;
+    nxt_status_route_t     *route_stat;
+    nxt_status_report_t    *report;
+    nxt_status_traffic_t   *traffic, *step_traffic;
+    nxt_status_listener_t  *listener;
 
     port = nxt_runtime_port_find(task->thread->runtime,
                                  msg->port_msg.pid,
@@ -951,6 +1111,30 @@ nxt_router_status_handler(nxt_task_t *task, nxt_port_recv_msg_t *msg)
 
     } nxt_queue_loop;
 
+    nxt_queue_each(skcf, &nxt_router->sockets, nxt_socket_conf_t, link) {
+
+        alloc += sizeof(nxt_status_listener_t)
+                 + skcf->listen->sockaddr->length;
+
+    } nxt_queue_loop;
+
+    rtcf = nxt_router->router_conf;
+    routes = (rtcf != NULL) ? rtcf->routes : NULL;
+
+    /*
+     * The report is sent in a single message, so its size grows
+     * with the total number of route steps.
+     */
+
+    nroutes = 0;
+
+    while (nxt_http_routes_status(routes, nroutes, &name, &steps) == NXT_OK) {
+        alloc += sizeof(nxt_status_route_t) + name->length
+                 + steps * sizeof(nxt_status_traffic_t);
+
+        nroutes++;
+    }
+
     b = nxt_buf_mem_alloc(port->mem_pool, alloc, 0);
     if (nxt_slow_path(b == NULL)) {
         type = NXT_PORT_MSG_RPC_ERROR;
@@ -967,15 +1151,31 @@ nxt_router_status_handler(nxt_task_t *task, nxt_port_recv_msg_t *msg)
         report->accepted_conns += engine->accepted_conns_cnt;
         report->idle_conns += engine->idle_conns_cnt;
         report->closed_conns += engine->closed_conns_cnt;
+        report->tls_conns += engine->tls_conns_cnt;
+        report->ktls_conns += engine->ktls_conns_cnt;
         report->requests += engine->requests_cnt;
 
     } nxt_queue_loop;
 
+#if (NXT_TLS)
+    report->tls_handshakes_queued = nxt_router->tls_offload.queued;
+    report->tls_handshake_time = nxt_router->tls_offload.time;
+#endif
+
+    report->reloads = nxt_router->reloads;
+    report->reloads_unchanged = nxt_router->reloads_unchanged;
+    report->reload_time = nxt_router->reload_time;
+    report->reload_max_time = nxt_router->reload_max_time;
+
+    slots = nxt_router->status_slots;
+
     report->apps_count = 0;
     app_stat = report->apps;
     p = b->mem.end;
 
     nxt_queue_each(app, &nxt_router->apps, nxt_app_t, link) {
+        nxt_memzero(app_stat, sizeof(nxt_status_app_t));
+
         p -= app->name.length;
 
         nxt_memcpy(p, app->name.start, app->name.length);
@@ -988,10 +1188,101 @@ nxt_router_status_handler(nxt_task_t *task, nxt_port_recv_msg_t *msg)
         app_stat->processes = app->processes;
         app_stat->idle_processes = app->idle_processes;
 
+        app_stat->dispatch = (app->dispatch_depth != 0);
+        app_stat->dispatch_direct = app->dispatch_direct;
+        app_stat->dispatch_contended = app->dispatch_contended;
+        app_stat->dispatch_stolen = app->dispatch_stolen;
+
+        app_stat->autoscale = (app->scale != NULL);
+
+        if (app->scale != NULL) {
+            app_stat->scale_target = app->scale->target;
+            app_stat->scale_ups = app->scale->ups;
+            app_stat->scale_downs = app->scale->downs;
+            app_stat->scale_queue_time = app->scale->queue_avg >> 3;
+            app_stat->scale_service_time = app->scale->service_avg >> 3;
+        }
+
+        for (s = 0; s < slots; s++) {
+            nxt_status_traffic_sum(&app_stat->traffic, &app->status[s].traffic);
+            nxt_status_time_sum(&app_stat->queue_time,
+                                &app->status[s].queue_time);
+            nxt_status_time_sum(&app_stat->service_time,
+                                &app->status[s].service_time);
+        }
+
         report->apps_count++;
         app_stat++;
     } nxt_queue_loop;
 
+    listener = (nxt_status_listener_t *) app_stat;
+    report->listeners = (nxt_status_listener_t *) ((u_char *) listener
+                                                   - b->mem.pos);
+
+    nxt_queue_each(skcf, &nxt_router->sockets, nxt_socket_conf_t, link) {
+        sa = skcf->listen->sockaddr;
+
+        p -= sa->length;
+
+        nxt_memcpy(p, nxt_sockaddr_start(sa), sa->length);
+
+        listener->name.length = sa->length;
+
+        /* Wildcard IPv4 listeners are configured as "*:port". */
+
+        if (sa->u.sockaddr.sa_family == AF_INET
+            && sa->u.sockaddr_in.sin_addr.s_addr == INADDR_ANY)
+        {
+            p += nxt_length("0.0.0.0") - 1;
+            *p = '*';
+
+            listener->name.length -= nxt_length("0.0.0.0") - 1;
+        }
+
+        listener->name.start = (u_char *) (p - b->mem.pos);
+
+        nxt_memzero(&listener->traffic, sizeof(nxt_status_traffic_t));
+
+        for (s = 0; s < slots; s++) {
+            nxt_status_traffic_sum(&listener->traffic, &skcf->traffic[s]);
+        }
+
+        report->listeners_count++;
+        listener++;
+    } nxt_queue_loop;
+
+    route_stat = (nxt_status_route_t *) listener;
+    report->routes = (nxt_status_route_t *) ((u_char *) route_stat
+                                             - b->mem.pos);
+    report->routes_count = nroutes;
+
+    traffic = (nxt_status_traffic_t *) (route_stat + nroutes);
+
+    for (i = 0; i < nroutes; i++, route_stat++) {
+        (void) nxt_http_routes_status(routes, i, &name, &steps);
+
+        p -= name->length;
+
+        nxt_memcpy(p, name->start, name->length);
+
+        route_stat->name.length = name->length;
+        route_stat->name.start = (u_char *) (p - b->mem.pos);
+
+        route_stat->steps = steps;
+        route_stat->traffic = (nxt_status_traffic_t *) ((u_char *) traffic
+                                                        - b->mem.pos);
+
+        for (k = 0; k < steps; k++, traffic++) {
+            step_traffic = nxt_http_route_traffic(routes, i, k);
+
+            nxt_memzero(traffic, sizeof(nxt_status_traffic_t));
+
+            for (s = 0; s < slots; s++) {
+                nxt_status_traffic_sum(traffic, &step_traffic[s]);
+            }
+        }
+    }
+
     type = NXT_PORT_MSG_RPC_READY_LAST;
 
 fail:
@@ -1095,6 +1386,7 @@ nxt_router_temp_conf(nxt_task_t *task)
     nxt_queue_init(&updating_sockets);
     nxt_queue_init(&keeping_sockets);
     nxt_queue_init(&deleting_sockets);
+    nxt_queue_init(&unchanged_sockets);
 
 #if (NXT_TLS)
     nxt_queue_init(&tmcf->tls);
@@ -1115,6 +1407,8 @@ nxt_router_temp_conf(nxt_task_t *task)
         nxt_tstr_state_release(rtcf->tstr_state);
     }
 
+    nxt_http_limits_release(rtcf);
+
     nxt_mp_destroy(mp);
 
     return NULL;
@@ -1132,6 +1426,18 @@ nxt_router_app_can_start(nxt_app_t *app)
 nxt_inline nxt_bool_t
 nxt_router_app_need_start(nxt_app_t *app)
 {
+    /*
+     * The autoscaler target is applied on top of the demand based rule,
+     * so requests are never left queued with no process to take them
+     * until the next evaluation.
+     */
+    if (app->scale != NULL
+        && app->active_requests != 0
+        && app->processes + app->pending_processes < app->scale->target)
+    {
+        return 1;
+    }
+
     return (app->active_requests
               > app->port_hash_count + app->pending_processes)
            || (app->spare_processes
@@ -1224,6 +1530,7 @@ nxt_router_conf_apply(nxt_task_t *task, void *obj, void *data)
 
     nxt_queue_add(&router->sockets, &updating_sockets);
     nxt_queue_add(&router->sockets, &creating_sockets);
+    nxt_queue_add(&router->sockets, &unchanged_sockets);
 
     if (router->access_log != rtcf->access_log) {
         nxt_router_access_log_use(&router->lock, rtcf->access_log);
@@ -1260,7 +1567,9 @@ static void
 nxt_router_conf_ready(nxt_task_t *task, nxt_router_temp_conf_t *tmcf)
 {
     uint32_t               count;
-    nxt_router_conf_t      *rtcf;
+    nxt_router_t           *router;
+    nxt_router_conf_t      *rtcf, *prev;
+    nxt_monotonic_time_t   now;
     nxt_thread_spinlock_t  *lock;
 
     nxt_debug(task, "temp conf %p count: %D", tmcf, tmcf->count);
@@ -1273,25 +1582,80 @@ nxt_router_conf_ready(nxt_task_t *task, nxt_router_temp_conf_t *tmcf)
 
     rtcf = tmcf->router_conf;
 
-    lock = &rtcf->router->lock;
+    router = rtcf->router;
+
+    if (router->conf.start != NULL) {
+        nxt_free(router->conf.start);
+    }
+
+    router->conf = tmcf->conf;
+
+#if (NXT_TLS)
+    nxt_router_tls_ocsp_refresh(task, router);
+#endif
+
+    nxt_monotonic_time(&now);
+
+    router->reloads++;
+    router->reload_time = (now.monotonic - tmcf->start) / 1000000;
+    router->reload_max_time = nxt_max(router->reload_max_time,
+                                      router->reload_time);
+
+    /*
+     * The router holds the current configuration even without listeners,
+     * and releases the previous one.
+     */
+
+    prev = router->router_conf;
+    router->router_conf = rtcf;
+
+    lock = &router->lock;
 
     nxt_thread_spin_lock(lock);
 
-    count = rtcf->count;
+    rtcf->count++;
+
+    count = (prev != NULL) ? --prev->count : 1;
 
     nxt_thread_spin_unlock(lock);
 
-    nxt_debug(task, "rtcf %p: %D", rtcf, count);
+    nxt_debug(task, "rtcf %p: %D", rtcf, rtcf->count);
 
     if (count == 0) {
-        nxt_router_apps_hash_use(task, rtcf, -1);
+        nxt_router_conf_free(task, prev);
+    }
+
+    nxt_mp_release(tmcf->mem_pool);
+}
+
+
+static void
+nxt_router_conf_free(nxt_task_t *task, nxt_router_conf_t *rtcf)
+{
+    nxt_router_conf_t  *base;
+
+    nxt_debug(task, "old router conf is destroyed");
+
+    nxt_router_apps_hash_use(task, rtcf, -1);
+
+    nxt_router_access_log_release(task, &rtcf->router->lock,
+                                  rtcf->access_log);
 
-        nxt_router_access_log_release(task, lock, rtcf->access_log);
+    base = rtcf->base;
 
-        nxt_mp_destroy(rtcf->mem_pool);
+    if (base == NULL) {
+        nxt_tstr_state_release(rtcf->tstr_state);
+
+        nxt_http_limits_release(rtcf);
     }
 
-    nxt_mp_release(tmcf->mem_pool);
+    nxt_mp_thread_adopt(rtcf->mem_pool);
+
+    nxt_mp_destroy(rtcf->mem_pool);
+
+    if (base != NULL) {
+        nxt_router_conf_base_release(task, base);
+    }
 }
 
 
@@ -1333,6 +1697,7 @@ nxt_router_conf_error(nxt_task_t *task, nxt_router_temp_conf_t *tmcf)
 
     nxt_queue_add(&router->sockets, &keeping_sockets);
     nxt_queue_add(&router->sockets, &deleting_sockets);
+    nxt_queue_add(&router->sockets, &unchanged_sockets);
 
     nxt_queue_add(&router->apps, &tmcf->previous);
 
@@ -1340,8 +1705,27 @@ nxt_router_conf_error(nxt_task_t *task, nxt_router_temp_conf_t *tmcf)
 
     nxt_router_access_log_release(task, &router->lock, rtcf->access_log);
 
+    if (rtcf->base == NULL) {
+        nxt_http_limits_release(rtcf);
+
+    } else {
+        nxt_router_conf_base_release(task, rtcf->base);
+    }
+
     nxt_mp_destroy(rtcf->mem_pool);
 
+    /*
+     * The previous configuration may be partially replaced,
+     * so the next one is applied even if it is the same.
+     */
+
+    if (router->conf.start != NULL) {
+        nxt_free(router->conf.start);
+        nxt_str_null(&router->conf);
+    }
+
+    nxt_free(tmcf->conf.start);
+
     nxt_router_conf_send(task, tmcf, NXT_PORT_MSG_RPC_ERROR);
 
     nxt_mp_release(tmcf->mem_pool);
@@ -1399,6 +1783,12 @@ static nxt_conf_map_t  nxt_router_app_conf[] = {
         NXT_CONF_MAP_PTR,
         offsetof(nxt_router_app_conf_t, targets_value),
     },
+
+    {
+        nxt_string("dispatch"),
+        NXT_CONF_MAP_PTR,
+        offsetof(nxt_router_app_conf_t, dispatch_value),
+    },
 };
 
 
@@ -1408,6 +1798,39 @@ static nxt_conf_map_t  nxt_router_app_limits_conf[] = {
         NXT_CONF_MAP_MSEC,
         offsetof(nxt_router_app_conf_t, timeout),
     },
+
+    {
+        nxt_string("requests"),
+        NXT_CONF_MAP_INT32,
+        offsetof(nxt_router_app_conf_t, requests),
+    },
+
+    {
+        nxt_string("max_queue"),
+        NXT_CONF_MAP_INT32,
+        offsetof(nxt_router_app_conf_t, max_queue),
+    },
+
+    {
+        nxt_string("queue_timeout"),
+        NXT_CONF_MAP_MSEC,
+        offsetof(nxt_router_app_conf_t, queue_timeout),
+    },
+};
+
+
+static nxt_conf_map_t  nxt_router_app_dispatch_conf[] = {
+    {
+        nxt_string("depth"),
+        NXT_CONF_MAP_INT32,
+        offsetof(nxt_router_app_conf_t, dispatch_depth),
+    },
+
+    {
+        nxt_string("key"),
+        NXT_CONF_MAP_STR,
+        offsetof(nxt_router_app_conf_t, dispatch_key),
+    },
 };
 
 
@@ -1429,6 +1852,12 @@ static nxt_conf_map_t  nxt_router_app_processes_conf[] = {
         NXT_CONF_MAP_MSEC,
         offsetof(nxt_router_app_conf_t, idle_timeout),
     },
+
+    {
+        nxt_string("autoscale"),
+        NXT_CONF_MAP_PTR,
+        offsetof(nxt_router_app_conf_t, autoscale_value),
+    },
 };
 
 
@@ -1538,6 +1967,27 @@ static nxt_conf_map_t  nxt_router_websocket_conf[] = {
 };
 
 
+static nxt_conf_map_t  nxt_router_ws_deflate_conf[] = {
+    {
+        nxt_string("window_bits"),
+        NXT_CONF_MAP_INT32,
+        offsetof(nxt_websocket_conf_t, deflate_window_bits),
+    },
+
+    {
+        nxt_string("context_takeover"),
+        NXT_CONF_MAP_INT8,
+        offsetof(nxt_websocket_conf_t, deflate_context_takeover),
+    },
+
+    {
+        nxt_string("threshold"),
+        NXT_CONF_MAP_SIZE,
+        offsetof(nxt_websocket_conf_t, deflate_threshold),
+    },
+};
+
+
 static nxt_int_t
 nxt_router_conf_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
     u_char *start, u_char *end)
@@ -1547,7 +1997,7 @@ nxt_router_conf_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
     nxt_mp_t                    *mp, *app_mp;
     uint32_t                    next, next_target;
     nxt_int_t                   ret;
-    nxt_str_t                   name, target;
+    nxt_str_t                   name, target, app_conf;
     nxt_app_t                   *app, *prev;
     nxt_str_t                   *t, *s, *targets;
     nxt_uint_t                  n, i;
@@ -1559,10 +2009,11 @@ nxt_router_conf_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
     nxt_conf_value_t            *certificate;
 #endif
     nxt_conf_value_t            *root, *conf, *http, *value, *websocket;
+    nxt_conf_value_t            *deflate;
     nxt_conf_value_t            *applications, *application;
-    nxt_conf_value_t            *listeners, *listener;
+    nxt_conf_value_t            *listeners, *listener, *prev_listeners;
     nxt_socket_conf_t           *skcf;
-    nxt_router_conf_t           *rtcf;
+    nxt_router_conf_t           *rtcf, *base;
     nxt_http_routes_t           *routes;
     nxt_event_engine_t          *engine;
     nxt_app_lang_module_t       *lang;
@@ -1580,9 +2031,14 @@ nxt_router_conf_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
     static nxt_str_t  conf_cache_path = nxt_string("/tls/session/cache_size");
     static nxt_str_t  conf_timeout_path = nxt_string("/tls/session/timeout");
     static nxt_str_t  conf_tickets = nxt_string("/tls/session/tickets");
+    static nxt_str_t  conf_ktls_path = nxt_string("/tls/ktls");
+    static nxt_str_t  conf_async_path = nxt_string("/tls/async_handshake");
+    static nxt_str_t  conf_ocsp_path = nxt_string("/tls/ocsp");
 #endif
     static nxt_str_t  static_path = nxt_string("/settings/http/static");
     static nxt_str_t  websocket_path = nxt_string("/settings/http/websocket");
+    static nxt_str_t  deflate_path =
+                   nxt_string("/settings/http/websocket/permessage_deflate");
     static nxt_str_t  forwarded_path = nxt_string("/forwarded");
     static nxt_str_t  client_ip_path = nxt_string("/client_ip");
 
@@ -1606,11 +2062,18 @@ nxt_router_conf_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
         rtcf->threads = nxt_ncpu;
     }
 
-    conf = nxt_conf_get_path(root, &static_path);
+    base = nxt_router_conf_base(task, tmcf, root, &prev_listeners);
 
-    ret = nxt_router_conf_process_static(task, rtcf, conf);
-    if (nxt_slow_path(ret != NXT_OK)) {
-        return NXT_ERROR;
+    if (base != NULL) {
+        nxt_router_conf_share(rtcf, base);
+
+    } else {
+        conf = nxt_conf_get_path(root, &static_path);
+
+        ret = nxt_router_conf_process_static(task, rtcf, conf);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return NXT_ERROR;
+        }
     }
 
     router = rtcf->router;
@@ -1631,36 +2094,27 @@ nxt_router_conf_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
 
             size = nxt_conf_json_length(application, NULL);
 
-            app_mp = nxt_mp_create(4096, 128, 1024, 64);
-            if (nxt_slow_path(app_mp == NULL)) {
-                goto fail;
-            }
+            /*
+             * The application configuration is printed to the temporary
+             * pool first, so unchanged applications are reused without
+             * creating a memory pool for them.
+             */
 
-            app = nxt_mp_get(app_mp, sizeof(nxt_app_t) + name.length + size);
-            if (app == NULL) {
-                goto app_fail;
+            app_conf.start = nxt_mp_nget(tmcf->mem_pool, size);
+            if (nxt_slow_path(app_conf.start == NULL)) {
+                goto fail;
             }
 
-            nxt_memzero(app, sizeof(nxt_app_t));
-
-            app->mem_pool = app_mp;
-
-            app->name.start = nxt_pointer_to(app, sizeof(nxt_app_t));
-            app->conf.start = nxt_pointer_to(app, sizeof(nxt_app_t)
-                                                  + name.length);
-
-            p = nxt_conf_json_print(app->conf.start, application, NULL);
-            app->conf.length = p - app->conf.start;
+            p = nxt_conf_json_print(app_conf.start, application, NULL);
+            app_conf.length = p - app_conf.start;
 
-            nxt_assert(app->conf.length <= size);
+            nxt_assert(app_conf.length <= size);
 
-            nxt_debug(task, "application conf \"%V\"", &app->conf);
+            nxt_debug(task, "application conf \"%V\"", &app_conf);
 
             prev = nxt_router_app_find(&router->apps, &name);
 
-            if (prev != NULL && nxt_strstr_eq(&app->conf, &prev->conf)) {
-                nxt_mp_destroy(app_mp);
-
+            if (prev != NULL && nxt_strstr_eq(&app_conf, &prev->conf)) {
                 nxt_queue_remove(&prev->link);
                 nxt_queue_insert_tail(&tmcf->previous, &prev->link);
 
@@ -1672,14 +2126,49 @@ nxt_router_conf_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
                 continue;
             }
 
-            apcf.processes = 1;
-            apcf.max_processes = 1;
-            apcf.spare_processes = 0;
-            apcf.timeout = 0;
-            apcf.idle_timeout = 15000;
+            app_mp = nxt_mp_create(4096, 128, 1024, 64);
+            if (nxt_slow_path(app_mp == NULL)) {
+                goto fail;
+            }
+
+            app = nxt_mp_get(app_mp, sizeof(nxt_app_t) + name.length
+                                     + app_conf.length);
+            if (app == NULL) {
+                goto app_fail;
+            }
+
+            nxt_memzero(app, sizeof(nxt_app_t));
+
+            app->mem_pool = app_mp;
+
+            app->status = nxt_mp_zget(app_mp, nxt_router->status_slots
+                                              * sizeof(nxt_app_status_t));
+            if (nxt_slow_path(app->status == NULL)) {
+                goto app_fail;
+            }
+
+            app->name.start = nxt_pointer_to(app, sizeof(nxt_app_t));
+            app->conf.start = nxt_pointer_to(app, sizeof(nxt_app_t)
+                                                  + name.length);
+
+            nxt_memcpy(app->conf.start, app_conf.start, app_conf.length);
+            app->conf.length = app_conf.length;
+
+            apcf.processes = 1;
+            apcf.max_processes = 1;
+            apcf.spare_processes = 0;
+            apcf.timeout = 0;
+            apcf.idle_timeout = 15000;
+            apcf.queue_timeout = 0;
+            apcf.max_queue = 0;
             apcf.limits_value = NULL;
             apcf.processes_value = NULL;
             apcf.targets_value = NULL;
+            apcf.dispatch_value = NULL;
+            apcf.autoscale_value = NULL;
+            apcf.requests = 0;
+            apcf.dispatch_depth = 1;
+            nxt_str_null(&apcf.dispatch_key);
 
             app_joint = nxt_malloc(sizeof(nxt_app_joint_t));
             if (nxt_slow_path(app_joint == NULL)) {
@@ -1753,6 +2242,36 @@ nxt_router_conf_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
                 targets = NULL;
             }
 
+            if (apcf.dispatch_value != NULL) {
+                ret = nxt_conf_map_object(mp, apcf.dispatch_value,
+                                      nxt_router_app_dispatch_conf,
+                                      nxt_nitems(nxt_router_app_dispatch_conf),
+                                      &apcf);
+                if (ret != NXT_OK) {
+                    nxt_alert(task, "application dispatch map error");
+                    goto app_fail;
+                }
+
+                /*
+                 * Processes count the requests limit only for requests
+                 * taken from the shared queue.
+                 */
+                if (apcf.requests != 0) {
+                    nxt_log(task, NXT_LOG_WARN, "application \"%V\": "
+                            "\"dispatch\" is ignored with the requests limit",
+                            &name);
+
+                    apcf.dispatch_value = NULL;
+
+                } else if (apcf.dispatch_key.length != 0) {
+                    s = nxt_str_dup(app_mp, &app->dispatch_key,
+                                    &apcf.dispatch_key);
+                    if (nxt_slow_path(s == NULL)) {
+                        goto app_fail;
+                    }
+                }
+            }
+
             nxt_debug(task, "application type: %V", &apcf.type);
             nxt_debug(task, "application processes: %D", apcf.processes);
             nxt_debug(task, "application request timeout: %M", apcf.timeout);
@@ -1786,9 +2305,25 @@ nxt_router_conf_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
                                          ? apcf.spare_processes : 1;
             app->timeout = apcf.timeout;
             app->idle_timeout = apcf.idle_timeout;
+            app->queue_timeout = apcf.queue_timeout;
+            app->max_queue = apcf.max_queue;
 
             app->targets = targets;
 
+            if (apcf.dispatch_value != NULL) {
+                app->dispatch_depth = apcf.dispatch_depth;
+            }
+
+            if (apcf.autoscale_value != NULL) {
+                app->scale = nxt_router_app_scale_create(app_mp,
+                                                         apcf.autoscale_value);
+                if (nxt_slow_path(app->scale == NULL)) {
+                    goto app_fail;
+                }
+
+                app->scale->target = nxt_max(app->spare_processes, 1);
+            }
+
             engine = task->thread->engine;
 
             app->engine = engine;
@@ -1850,6 +2385,15 @@ nxt_router_conf_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
         }
     }
 
+    if (base != NULL) {
+        goto listeners;
+    }
+
+    ret = nxt_router_app_keys_create(tmcf);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        goto fail;
+    }
+
     conf = nxt_conf_get_path(root, &routes_path);
     if (nxt_fast_path(conf != NULL)) {
         routes = nxt_http_routes_create(task, tmcf, conf);
@@ -1865,6 +2409,8 @@ nxt_router_conf_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
         return ret;
     }
 
+listeners:
+
     http = nxt_conf_get_path(root, &http_path);
 #if 0
     if (http == NULL) {
@@ -1874,6 +2420,7 @@ nxt_router_conf_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
 #endif
 
     websocket = nxt_conf_get_path(root, &websocket_path);
+    deflate = nxt_conf_get_path(root, &deflate_path);
 
     listeners = nxt_conf_get_path(root, &listeners_path);
 
@@ -1886,6 +2433,14 @@ nxt_router_conf_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
                 break;
             }
 
+            if (base != NULL
+                && nxt_router_listener_keep(task, tmcf, prev_listeners, &name,
+                                            listener)
+                   == NXT_OK)
+            {
+                continue;
+            }
+
             skcf = nxt_router_socket_conf(task, tmcf, &name);
             if (skcf == NULL) {
                 goto fail;
@@ -1924,6 +2479,9 @@ nxt_router_conf_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
             skcf->websocket_conf.max_frame_size = 1024 * 1024;
             skcf->websocket_conf.read_timeout = 60 * 1000;
             skcf->websocket_conf.keepalive_interval = 30 * 1000;
+            skcf->websocket_conf.deflate_threshold = 256;
+            skcf->websocket_conf.deflate_context_takeover = 1;
+            skcf->websocket_conf.deflate_window_bits = 12;
 
             nxt_str_null(&skcf->body_temp_path);
 
@@ -1948,6 +2506,19 @@ nxt_router_conf_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
                 }
             }
 
+            if (deflate != NULL) {
+                skcf->websocket_conf.deflate = 1;
+
+                ret = nxt_conf_map_object(mp, deflate,
+                                        nxt_router_ws_deflate_conf,
+                                        nxt_nitems(nxt_router_ws_deflate_conf),
+                                        &skcf->websocket_conf);
+                if (ret != NXT_OK) {
+                    nxt_alert(task, "websocket deflate map error");
+                    goto fail;
+                }
+            }
+
             t = &skcf->body_temp_path;
 
             if (t->length == 0) {
@@ -2001,6 +2572,17 @@ nxt_router_conf_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
                 tls_init->tickets_conf = nxt_conf_get_path(listener,
                                                            &conf_tickets);
 
+                value = nxt_conf_get_path(listener, &conf_ktls_path);
+                tls_init->ktls = (value != NULL
+                                  && nxt_conf_get_boolean(value));
+
+                value = nxt_conf_get_path(listener, &conf_async_path);
+                tls_init->async_handshake = (value != NULL
+                                             && nxt_conf_get_boolean(value));
+
+                tls_init->ocsp_conf = nxt_conf_get_path(listener,
+                                                        &conf_ocsp_path);
+
                 n = nxt_conf_array_elements_count_or_1(certificate);
 
                 for (i = 0; i < n; i++) {
@@ -2036,6 +2618,17 @@ nxt_router_conf_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
         }
     }
 
+    if (base != NULL) {
+        /*
+         * Listeners with templates in "pass" are never built on the base,
+         * so the template state of the new configuration is not needed.
+         */
+        nxt_tstr_state_release(rtcf->tstr_state);
+        rtcf->tstr_state = base->tstr_state;
+
+        goto done;
+    }
+
     ret = nxt_http_routes_resolve(task, tmcf);
     if (nxt_slow_path(ret != NXT_OK)) {
         goto fail;
@@ -2055,6 +2648,8 @@ nxt_router_conf_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
         goto fail;
     }
 
+done:
+
     nxt_queue_add(&deleting_sockets, &router->sockets);
     nxt_queue_init(&router->sockets);
 
@@ -2078,6 +2673,249 @@ nxt_router_conf_create(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
 }
 
 
+/*
+ * A configuration that differs from the current one only in listeners
+ * shares the routes, upstreams, templates, access log, static settings,
+ * and application keys of the current one, and keeps its unchanged
+ * listeners along with their engine joints.  Changed and new listeners
+ * are built as usual, but only if their "pass" has no templates, since
+ * templates are compiled into the shared state.  Any other change
+ * rebuilds the configuration in full, still reusing unchanged
+ * applications.
+ */
+
+static nxt_router_conf_t *
+nxt_router_conf_base(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
+    nxt_conf_value_t *root, nxt_conf_value_t **prev_listeners)
+{
+    uint32_t           next;
+    nxt_str_t          name, pass;
+    nxt_uint_t         n;
+    nxt_router_t       *router;
+    nxt_conf_value_t   *prev_root, *value, *prev, *listeners;
+    nxt_router_conf_t  *base;
+
+    static nxt_str_t  listeners_name = nxt_string("listeners");
+    static nxt_str_t  pass_path = nxt_string("/pass");
+
+    router = tmcf->router_conf->router;
+    base = router->router_conf;
+
+    if (base == NULL || router->conf.start == NULL) {
+        return NULL;
+    }
+
+    prev_root = nxt_conf_json_parse(tmcf->mem_pool, router->conf.start,
+                                    router->conf.start + router->conf.length,
+                                    NULL);
+    if (nxt_slow_path(prev_root == NULL)) {
+        return NULL;
+    }
+
+    n = 0;
+    next = 0;
+
+    for ( ;; ) {
+        value = nxt_conf_next_object_member(root, &name, &next);
+        if (value == NULL) {
+            break;
+        }
+
+        if (nxt_strstr_eq(&name, &listeners_name)) {
+            continue;
+        }
+
+        prev = nxt_conf_get_object_member(prev_root, &name, NULL);
+
+        if (prev == NULL
+            || !nxt_router_conf_value_eq(tmcf->mem_pool, value, prev))
+        {
+            return NULL;
+        }
+
+        n++;
+    }
+
+    *prev_listeners = nxt_conf_get_object_member(prev_root, &listeners_name,
+                                                 NULL);
+
+    if (nxt_conf_object_members_count(prev_root)
+        != n + (*prev_listeners != NULL))
+    {
+        return NULL;
+    }
+
+    listeners = nxt_conf_get_object_member(root, &listeners_name, NULL);
+
+    if (listeners != NULL) {
+        next = 0;
+
+        for ( ;; ) {
+            value = nxt_conf_next_object_member(listeners, &name, &next);
+            if (value == NULL) {
+                break;
+            }
+
+            prev = (*prev_listeners != NULL)
+                   ? nxt_conf_get_object_member(*prev_listeners, &name, NULL)
+                   : NULL;
+
+            if (prev != NULL
+                && nxt_router_conf_value_eq(tmcf->mem_pool, value, prev))
+            {
+                continue;
+            }
+
+            value = nxt_conf_get_path(value, &pass_path);
+
+            if (value != NULL) {
+                nxt_conf_get_string(value, &pass);
+
+                if (nxt_is_tstr(&pass)) {
+                    return NULL;
+                }
+            }
+        }
+    }
+
+    if (base->base != NULL) {
+        base = base->base;
+    }
+
+    nxt_debug(task, "router conf shares base %p", base);
+
+    return base;
+}
+
+
+static void
+nxt_router_conf_share(nxt_router_conf_t *rtcf, nxt_router_conf_t *base)
+{
+    nxt_thread_spinlock_t  *lock;
+
+    rtcf->base = base;
+
+    rtcf->routes = base->routes;
+    rtcf->upstreams = base->upstreams;
+    rtcf->mtypes_hash = base->mtypes_hash;
+    rtcf->access_log = base->access_log;
+    rtcf->log_format = base->log_format;
+    rtcf->dispatch_keys = base->dispatch_keys;
+    rtcf->limits = base->limits;
+
+    lock = &rtcf->router->lock;
+
+    nxt_thread_spin_lock(lock);
+
+    base->count++;
+
+    nxt_thread_spin_unlock(lock);
+
+    nxt_router_access_log_use(lock, rtcf->access_log);
+}
+
+
+static void
+nxt_router_conf_base_release(nxt_task_t *task, nxt_router_conf_t *base)
+{
+    uint32_t               count;
+    nxt_thread_spinlock_t  *lock;
+
+    lock = &base->router->lock;
+
+    nxt_thread_spin_lock(lock);
+
+    count = --base->count;
+
+    nxt_thread_spin_unlock(lock);
+
+    nxt_debug(task, "base rtcf %p: %D", base, count);
+
+    if (count == 0) {
+        nxt_router_conf_free(task, base);
+    }
+}
+
+
+static nxt_bool_t
+nxt_router_conf_value_eq(nxt_mp_t *mp, nxt_conf_value_t *value1,
+    nxt_conf_value_t *value2)
+{
+    size_t  size;
+    u_char  *p1, *p2, *end1, *end2;
+
+    size = nxt_conf_json_length(value1, NULL);
+
+    if (size != nxt_conf_json_length(value2, NULL)) {
+        return 0;
+    }
+
+    p1 = nxt_mp_nget(mp, size);
+    p2 = nxt_mp_nget(mp, size);
+
+    if (nxt_slow_path(p1 == NULL || p2 == NULL)) {
+        return 0;
+    }
+
+    end1 = nxt_conf_json_print(p1, value1, NULL);
+    end2 = nxt_conf_json_print(p2, value2, NULL);
+
+    return (end1 - p1 == end2 - p2 && memcmp(p1, p2, end1 - p1) == 0);
+}
+
+
+static nxt_int_t
+nxt_router_listener_keep(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
+    nxt_conf_value_t *prev_listeners, nxt_str_t *name,
+    nxt_conf_value_t *listener)
+{
+    nxt_router_t       *router;
+    nxt_sockaddr_t     *sa;
+    nxt_conf_value_t   *prev;
+    nxt_queue_link_t   *qlk;
+    nxt_socket_conf_t  *skcf;
+
+    if (prev_listeners == NULL) {
+        return NXT_DECLINED;
+    }
+
+    prev = nxt_conf_get_object_member(prev_listeners, name, NULL);
+
+    if (prev == NULL
+        || !nxt_router_conf_value_eq(tmcf->mem_pool, listener, prev))
+    {
+        return NXT_DECLINED;
+    }
+
+    sa = nxt_sockaddr_parse(tmcf->mem_pool, name);
+    if (nxt_slow_path(sa == NULL)) {
+        return NXT_DECLINED;
+    }
+
+    sa->type = SOCK_STREAM;
+
+    router = tmcf->router_conf->router;
+
+    for (qlk = nxt_queue_first(&router->sockets);
+         qlk != nxt_queue_tail(&router->sockets);
+         qlk = nxt_queue_next(qlk))
+    {
+        skcf = nxt_queue_link_data(qlk, nxt_socket_conf_t, link);
+
+        if (nxt_sockaddr_cmp(skcf->listen->sockaddr, sa)) {
+            nxt_queue_remove(qlk);
+            nxt_queue_insert_tail(&unchanged_sockets, qlk);
+
+            nxt_debug(task, "router listener \"%V\" is unchanged", name);
+
+            return NXT_OK;
+        }
+    }
+
+    return NXT_DECLINED;
+}
+
+
 #if (NXT_TLS)
 
 static nxt_int_t
@@ -2306,38 +3144,263 @@ nxt_router_app_find(nxt_queue_t *queue, nxt_str_t *name)
 }
 
 
-static nxt_int_t
-nxt_router_app_queue_init(nxt_task_t *task, nxt_port_t *port)
+static nxt_app_scale_t *
+nxt_router_app_scale_create(nxt_mp_t *mp, nxt_conf_value_t *conf)
 {
-    void       *mem;
-    nxt_int_t  fd;
+    nxt_app_scale_t   *scale;
+    nxt_conf_value_t  *value;
 
-    fd = nxt_shm_open(task, sizeof(nxt_app_queue_t));
-    if (nxt_slow_path(fd == -1)) {
-        return NXT_ERROR;
+    static nxt_str_t  queue_time_str = nxt_string("queue_time");
+    static nxt_str_t  service_time_str = nxt_string("service_time");
+    static nxt_str_t  cooldown_str = nxt_string("cooldown");
+    static nxt_str_t  step_up_str = nxt_string("step_up");
+    static nxt_str_t  step_down_str = nxt_string("step_down");
+
+    scale = nxt_mp_zget(mp, sizeof(nxt_app_scale_t));
+    if (nxt_slow_path(scale == NULL)) {
+        return NULL;
     }
 
-    mem = nxt_mem_mmap(NULL, sizeof(nxt_app_queue_t),
-                       PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-    if (nxt_slow_path(mem == MAP_FAILED)) {
-        nxt_fd_close(fd);
+    scale->queue_time = 100;
+    scale->service_time = 0;
+    scale->cooldown = 5000;
+    scale->step_up = 1;
+    scale->step_down = 1;
 
-        return NXT_ERROR;
+    value = nxt_conf_get_object_member(conf, &queue_time_str, NULL);
+    if (value != NULL) {
+        scale->queue_time = nxt_conf_get_number(value) * 1000;
     }
 
-    nxt_app_queue_init(mem);
+    value = nxt_conf_get_object_member(conf, &service_time_str, NULL);
+    if (value != NULL) {
+        scale->service_time = nxt_conf_get_number(value) * 1000;
+    }
 
-    port->queue_fd = fd;
-    port->queue = mem;
+    value = nxt_conf_get_object_member(conf, &cooldown_str, NULL);
+    if (value != NULL) {
+        scale->cooldown = nxt_conf_get_number(value) * 1000;
+    }
 
-    return NXT_OK;
+    value = nxt_conf_get_object_member(conf, &step_up_str, NULL);
+    if (value != NULL) {
+        scale->step_up = nxt_conf_get_number(value);
+    }
+
+    value = nxt_conf_get_object_member(conf, &step_down_str, NULL);
+    if (value != NULL) {
+        scale->step_down = nxt_conf_get_number(value);
+    }
+
+    return scale;
 }
 
 
-static nxt_int_t
-nxt_router_port_queue_init(nxt_task_t *task, nxt_port_t *port)
+/*
+ * Re-evaluates the number of application processes once per cool-down
+ * period.  The target grows by "step_up" while the average queue wait
+ * (or service time, if its target is set) is above the target, and shrinks
+ * by "step_down" while the queue wait stays below half of the target and
+ * the processes are underused: the number of busy processes is estimated
+ * as the request rate multiplied by the average service time.  The target
+ * never drops below "spare" processes or a single process.
+ *
+ * Returns the number of processes to start.  Must be called with
+ * app->mutex locked.
+ */
+static nxt_uint_t
+nxt_router_app_scale(nxt_task_t *task, nxt_app_t *app, nxt_msec_t now)
 {
-    void       *mem;
+    uint32_t            current, target, busy;
+    nxt_uint_t          n;
+    nxt_msec_t          elapsed, queue_time, service_time, oldest;
+    nxt_nsec_t          start;
+    nxt_app_scale_t     *scale;
+    nxt_http_request_t  *r;
+
+    scale = app->scale;
+
+    elapsed = now - scale->last;
+
+    if (elapsed < scale->cooldown) {
+        return 0;
+    }
+
+    queue_time = (scale->requests != 0) ? scale->queue_avg >> 3 : 0;
+    service_time = scale->service_avg >> 3;
+
+    /*
+     * Requests wait without producing samples while all processes are
+     * busy, so the wait of the oldest request is taken into account too.
+     */
+    if (!nxt_queue_is_empty(&app->ack_waiting_req)) {
+        r = nxt_queue_link_data(nxt_queue_first(&app->ack_waiting_req),
+                                nxt_http_request_t, app_link);
+
+        start = nxt_thread_monotonic_time(task->thread);
+        oldest = (start > r->queue_start)
+                 ? (start - r->queue_start) / 1000000 : 0;
+
+        queue_time = nxt_max(queue_time, oldest);
+    }
+
+    current = app->processes + app->pending_processes;
+    target = scale->target;
+
+    if (queue_time > scale->queue_time
+        || (scale->service_time != 0 && scale->requests != 0
+            && service_time > scale->service_time))
+    {
+        target = nxt_min(nxt_max(target, current) + scale->step_up,
+                         app->max_processes);
+
+        if (target > scale->target) {
+            scale->ups++;
+
+            nxt_log(task, NXT_LOG_NOTICE, "app \"%V\" scale up to %uD "
+                    "processes: queue time %M ms, service time %M ms",
+                    &app->name, target, queue_time, service_time);
+        }
+
+    } else if (queue_time <= scale->queue_time / 2
+               && target > nxt_max(app->spare_processes, 1))
+    {
+        busy = ((uint64_t) scale->requests * service_time + elapsed - 1)
+               / elapsed;
+
+        target = (target > scale->step_down) ? target - scale->step_down : 0;
+        busy = nxt_max(busy, app->spare_processes);
+        target = nxt_max(target, nxt_max(busy, 1));
+
+        if (target < scale->target) {
+            scale->downs++;
+
+            nxt_log(task, NXT_LOG_NOTICE, "app \"%V\" scale down to %uD "
+                    "processes: queue time %M ms, service time %M ms",
+                    &app->name, target, queue_time, service_time);
+        }
+    }
+
+    scale->target = target;
+    scale->last = now;
+    scale->requests = 0;
+
+    n = 0;
+
+    while (app->processes + app->pending_processes < target
+           && nxt_router_app_can_start(app))
+    {
+        app->pending_processes++;
+        n++;
+    }
+
+    return n;
+}
+
+
+static nxt_int_t
+nxt_router_app_keys_create(nxt_router_temp_conf_t *tmcf)
+{
+    nxt_app_t             *app;
+    nxt_queue_t           *queues[2];
+    nxt_uint_t            i;
+    nxt_router_conf_t     *rtcf;
+    nxt_router_app_key_t  *ak;
+
+    rtcf = tmcf->router_conf;
+
+    queues[0] = &tmcf->apps;
+    queues[1] = &tmcf->previous;
+
+    for (i = 0; i < 2; i++) {
+
+        nxt_queue_each(app, queues[i], nxt_app_t, link) {
+
+            if (app->dispatch_key.length == 0) {
+                continue;
+            }
+
+            if (rtcf->dispatch_keys == NULL) {
+                rtcf->dispatch_keys = nxt_array_create(rtcf->mem_pool, 4,
+                                                 sizeof(nxt_router_app_key_t));
+                if (nxt_slow_path(rtcf->dispatch_keys == NULL)) {
+                    return NXT_ERROR;
+                }
+            }
+
+            ak = nxt_array_add(rtcf->dispatch_keys);
+            if (nxt_slow_path(ak == NULL)) {
+                return NXT_ERROR;
+            }
+
+            ak->app = app;
+            ak->key = nxt_tstr_compile(rtcf->tstr_state, &app->dispatch_key,
+                                       0);
+            if (nxt_slow_path(ak->key == NULL)) {
+                return NXT_ERROR;
+            }
+
+        } nxt_queue_loop;
+    }
+
+    return NXT_OK;
+}
+
+
+static nxt_tstr_t *
+nxt_router_app_key(nxt_router_conf_t *rtcf, nxt_app_t *app)
+{
+    nxt_uint_t            i;
+    nxt_router_app_key_t  *ak;
+
+    if (rtcf->dispatch_keys == NULL) {
+        return NULL;
+    }
+
+    ak = rtcf->dispatch_keys->elts;
+
+    for (i = 0; i < rtcf->dispatch_keys->nelts; i++) {
+        if (ak[i].app == app) {
+            return ak[i].key;
+        }
+    }
+
+    return NULL;
+}
+
+
+static nxt_int_t
+nxt_router_app_queue_init(nxt_task_t *task, nxt_port_t *port)
+{
+    void       *mem;
+    nxt_int_t  fd;
+
+    fd = nxt_shm_open(task, sizeof(nxt_app_queue_t));
+    if (nxt_slow_path(fd == -1)) {
+        return NXT_ERROR;
+    }
+
+    mem = nxt_mem_mmap(NULL, sizeof(nxt_app_queue_t),
+                       PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (nxt_slow_path(mem == MAP_FAILED)) {
+        nxt_fd_close(fd);
+
+        return NXT_ERROR;
+    }
+
+    nxt_app_queue_init(mem);
+
+    port->queue_fd = fd;
+    port->queue = mem;
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+nxt_router_port_queue_init(nxt_task_t *task, nxt_port_t *port)
+{
+    void       *mem;
     nxt_int_t  fd;
 
     fd = nxt_shm_open(task, sizeof(nxt_port_queue_t));
@@ -2413,7 +3476,7 @@ nxt_router_apps_hash_add(nxt_router_conf_t *rtcf, nxt_app_t *app)
     lhq.proto = &nxt_router_apps_hash_proto;
     lhq.pool = rtcf->mem_pool;
 
-    switch (nxt_lvlhsh_insert(&rtcf->apps_hash, &lhq)) {
+    switch (nxt_flathsh_insert(&rtcf->apps_hash, &lhq)) {
 
     case NXT_OK:
         return NXT_OK;
@@ -2437,7 +3500,7 @@ nxt_router_apps_hash_get(nxt_router_conf_t *rtcf, nxt_str_t *name)
     lhq.key = *name;
     lhq.proto = &nxt_router_apps_hash_proto;
 
-    if (nxt_lvlhsh_find(&rtcf->apps_hash, &lhq) != NXT_OK) {
+    if (nxt_flathsh_find(&rtcf->apps_hash, &lhq) != NXT_OK) {
         return NULL;
     }
 
@@ -2448,13 +3511,13 @@ nxt_router_apps_hash_get(nxt_router_conf_t *rtcf, nxt_str_t *name)
 static void
 nxt_router_apps_hash_use(nxt_task_t *task, nxt_router_conf_t *rtcf, int i)
 {
-    nxt_app_t          *app;
-    nxt_lvlhsh_each_t  lhe;
+    nxt_app_t           *app;
+    nxt_flathsh_each_t  fhe;
 
-    nxt_lvlhsh_each_init(&lhe, &nxt_router_apps_hash_proto);
+    nxt_flathsh_each_init(&fhe, &nxt_router_apps_hash_proto);
 
     for ( ;; ) {
-        app = nxt_lvlhsh_each(&rtcf->apps_hash, &lhe);
+        app = nxt_flathsh_each(&rtcf->apps_hash, &fhe);
 
         if (app == NULL) {
             break;
@@ -2465,12 +3528,6 @@ nxt_router_apps_hash_use(nxt_task_t *task, nxt_router_conf_t *rtcf, int i)
 }
 
 
-typedef struct {
-    nxt_app_t  *app;
-    nxt_int_t  target;
-} nxt_http_app_conf_t;
-
-
 nxt_int_t
 nxt_router_application_init(nxt_router_conf_t *rtcf, nxt_str_t *name,
     nxt_str_t *target, nxt_http_action_t *action)
@@ -2494,6 +3551,7 @@ nxt_router_application_init(nxt_router_conf_t *rtcf, nxt_str_t *name,
     action->u.conf = conf;
 
     conf->app = app;
+    conf->key = nxt_router_app_key(rtcf, app);
 
     if (target != NULL && target->length != 0) {
         targets = app->targets;
@@ -2537,6 +3595,13 @@ nxt_router_socket_conf(nxt_task_t *task, nxt_router_temp_conf_t *tmcf,
         return NULL;
     }
 
+    skcf->traffic = nxt_mp_zget(tmcf->router_conf->mem_pool,
+                                nxt_router->status_slots
+                                * sizeof(nxt_status_traffic_t));
+    if (nxt_slow_path(skcf->traffic == NULL)) {
+        return NULL;
+    }
+
     size = nxt_sockaddr_size(sa);
 
     ret = nxt_router_listen_socket_find(tmcf, skcf, sa);
@@ -2609,6 +3674,8 @@ nxt_router_listen_socket_find(nxt_router_temp_conf_t *tmcf,
 
         if (nxt_sockaddr_cmp(skcf->listen->sockaddr, sa)) {
             nskcf->listen = skcf->listen;
+            nxt_memcpy(nskcf->traffic, skcf->traffic,
+                       router->status_slots * sizeof(nxt_status_traffic_t));
 
             nxt_queue_remove(qlk);
             nxt_queue_insert_tail(&keeping_sockets, qlk);
@@ -2823,6 +3890,10 @@ nxt_router_tls_rpc_handler(nxt_task_t *task, nxt_port_recv_msg_t *msg,
 
     tls->tls_init->conf = tlscf;
 
+    if (tls->tls_init->async_handshake) {
+        tlscf->offload = &nxt_router->tls_offload;
+    }
+
     bundle = nxt_mp_get(mp, sizeof(nxt_tls_bundle_conf_t));
     if (nxt_slow_path(bundle == NULL)) {
         goto fail;
@@ -2833,9 +3904,17 @@ nxt_router_tls_rpc_handler(nxt_task_t *task, nxt_port_recv_msg_t *msg,
     }
 
     bundle->chain_file = msg->fd[0];
+    bundle->ocsp = NULL;
     bundle->next = tlscf->bundle;
     tlscf->bundle = bundle;
 
+    if (tls->tls_init->ocsp_conf != NULL) {
+        ret = nxt_router_tls_ocsp_create(mp, bundle, tls->tls_init->ocsp_conf);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            goto fail;
+        }
+    }
+
     ret = task->thread->runtime->tls->server_init(task, mp, tls->tls_init,
                                                   tls->last);
     if (nxt_slow_path(ret != NXT_OK)) {
@@ -2851,6 +3930,224 @@ nxt_router_tls_rpc_handler(nxt_task_t *task, nxt_port_recv_msg_t *msg,
     nxt_router_conf_error(task, tmcf);
 }
 
+
+static nxt_int_t
+nxt_router_tls_ocsp_create(nxt_mp_t *mp, nxt_tls_bundle_conf_t *bundle,
+    nxt_conf_value_t *conf)
+{
+    nxt_str_t         path;
+    nxt_conf_value_t  *value;
+    nxt_tls_ocsp_t    *ocsp;
+
+    static nxt_str_t  responses_path = nxt_string("/responses");
+    static nxt_str_t  refresh_path = nxt_string("/refresh");
+
+    value = nxt_conf_get_path(conf, &responses_path);
+    if (value == NULL) {
+        return NXT_OK;
+    }
+
+    value = nxt_conf_get_object_member(value, &bundle->name, NULL);
+    if (value == NULL) {
+        return NXT_OK;
+    }
+
+    ocsp = nxt_mp_zget(mp, sizeof(nxt_tls_ocsp_t));
+    if (nxt_slow_path(ocsp == NULL)) {
+        return NXT_ERROR;
+    }
+
+    nxt_conf_get_string(value, &path);
+
+    if (nxt_slow_path(nxt_str_dup(mp, &ocsp->path, &path) == NULL)) {
+        return NXT_ERROR;
+    }
+
+    value = nxt_conf_get_path(conf, &refresh_path);
+
+    ocsp->refresh = (value != NULL) ? nxt_conf_get_number(value) * 1000
+                                    : 3600 * 1000;
+
+    bundle->ocsp = ocsp;
+
+    return NXT_OK;
+}
+
+
+/*
+ * OCSP responses are read by the main process and requested again
+ * by a timer of the router main engine.  Responses are matched with
+ * bundles by file path, so a reply arriving after reconfiguration
+ * updates the bundles of the current configuration only.
+ */
+
+static void
+nxt_router_tls_ocsp_refresh(nxt_task_t *task, nxt_router_t *router)
+{
+    nxt_str_t              *path;
+    nxt_msec_t             refresh;
+    nxt_timer_t            *timer;
+    nxt_tls_ocsp_t         *ocsp;
+    nxt_socket_conf_t      *skcf;
+    nxt_event_engine_t     *engine;
+    nxt_tls_bundle_conf_t  *bundle;
+
+    refresh = 0;
+    engine = task->thread->engine;
+
+    nxt_queue_each(skcf, &router->sockets, nxt_socket_conf_t, link) {
+
+        if (skcf->tls == NULL) {
+            continue;
+        }
+
+        for (bundle = skcf->tls->bundle;
+             bundle != NULL;
+             bundle = bundle->next)
+        {
+            ocsp = bundle->ocsp;
+
+            if (ocsp == NULL) {
+                continue;
+            }
+
+            if (refresh == 0 || ocsp->refresh < refresh) {
+                refresh = ocsp->refresh;
+            }
+
+            path = nxt_malloc(sizeof(nxt_str_t) + ocsp->path.length);
+            if (nxt_slow_path(path == NULL)) {
+                continue;
+            }
+
+            path->length = ocsp->path.length;
+            path->start = nxt_pointer_to(path, sizeof(nxt_str_t));
+            nxt_memcpy(path->start, ocsp->path.start, path->length);
+
+            nxt_debug(task, "OCSP response \"%V\" request", path);
+
+            nxt_cert_ocsp_get(task, path, engine->mem_pool,
+                              nxt_router_tls_ocsp_handler, path);
+        }
+
+    } nxt_queue_loop;
+
+    timer = &router->ocsp_timer;
+
+    if (refresh == 0) {
+        nxt_timer_disable(engine, timer);
+        return;
+    }
+
+    timer->work_queue = &engine->fast_work_queue;
+    timer->handler = nxt_router_tls_ocsp_timeout;
+    timer->task = &engine->task;
+    timer->log = engine->task.log;
+
+    nxt_timer_add(engine, timer, refresh);
+}
+
+
+static void
+nxt_router_tls_ocsp_timeout(nxt_task_t *task, void *obj, void *data)
+{
+    nxt_timer_t  *timer;
+
+    timer = obj;
+
+    nxt_router_tls_ocsp_refresh(task,
+                                nxt_timer_data(timer, nxt_router_t,
+                                               ocsp_timer));
+}
+
+
+static void
+nxt_router_tls_ocsp_handler(nxt_task_t *task, nxt_port_recv_msg_t *msg,
+    void *data)
+{
+    u_char                 *p, *q, *old;
+    size_t                 size;
+    nxt_buf_t              *b;
+    nxt_str_t              *path;
+    nxt_int_t              ret;
+    nxt_time_t             expires;
+    nxt_tls_ocsp_t         *ocsp;
+    nxt_socket_conf_t      *skcf;
+    nxt_tls_bundle_conf_t  *bundle;
+
+    path = data;
+
+    /* A previously loaded response is kept if the file cannot be read. */
+
+    if (msg == NULL || msg->port_msg.type == _NXT_PORT_MSG_RPC_ERROR) {
+        nxt_log(task, NXT_LOG_WARN, "OCSP response \"%V\" is not updated",
+                path);
+        goto done;
+    }
+
+    size = 0;
+
+    for (b = msg->buf; b != NULL; b = b->next) {
+        size += nxt_buf_mem_used_size(&b->mem);
+    }
+
+    nxt_debug(task, "OCSP response \"%V\" loaded, size: %uz", path, size);
+
+    nxt_queue_each(skcf, &nxt_router->sockets, nxt_socket_conf_t, link) {
+
+        if (skcf->tls == NULL) {
+            continue;
+        }
+
+        for (bundle = skcf->tls->bundle;
+             bundle != NULL;
+             bundle = bundle->next)
+        {
+            ocsp = bundle->ocsp;
+
+            if (ocsp == NULL || !nxt_strstr_eq(&ocsp->path, path)) {
+                continue;
+            }
+
+            p = nxt_malloc(size);
+            if (nxt_slow_path(p == NULL)) {
+                continue;
+            }
+
+            q = p;
+
+            for (b = msg->buf; b != NULL; b = b->next) {
+                q = nxt_cpymem(q, b->mem.pos, nxt_buf_mem_used_size(&b->mem));
+            }
+
+            ret = task->thread->runtime->tls->ocsp_check(task, bundle, p, size,
+                                                         &expires);
+            if (ret != NXT_OK) {
+                nxt_log(task, NXT_LOG_WARN, "OCSP response \"%V\" "
+                        "is not updated", path);
+                nxt_free(p);
+                continue;
+            }
+
+            nxt_thread_spin_lock(&ocsp->lock);
+
+            old = ocsp->response;
+            ocsp->response = p;
+            ocsp->size = size;
+            ocsp->expires = expires;
+
+            nxt_thread_spin_unlock(&ocsp->lock);
+
+            nxt_free(old);
+        }
+
+    } nxt_queue_loop;
+
+done:
+
+    nxt_free(path);
+}
+
 #endif
 
 
@@ -3087,6 +4384,12 @@ nxt_router_engines_create(nxt_task_t *task, nxt_router_t *router,
             return NXT_ERROR;
         }
 
+        /*
+         * Listener threads are never more than CPUs, otherwise
+         * the status counters of some engines would be shared.
+         */
+        recf->engine->status_slot = 1 + n % (router->status_slots - 1);
+
         ret = nxt_router_engine_conf_create(tmcf, recf);
         if (nxt_slow_path(ret != NXT_OK)) {
             return ret;
@@ -3406,7 +4709,8 @@ static nxt_port_handlers_t  nxt_router_app_port_handlers = {
     .mmap            = nxt_port_mmap_handler,
     .data            = nxt_port_rpc_handler,
     .oosm            = nxt_router_oosm_handler,
-    .req_headers_ack = nxt_port_rpc_handler,
+    .req_headers_ack = nxt_router_req_headers_acks_handler,
+    .websocket_frame = nxt_port_rpc_handler,
 };
 
 
@@ -3792,17 +5096,7 @@ nxt_router_conf_release(nxt_task_t *task, nxt_socket_conf_joint_t *joint)
     /* TODO remove engine->port */
 
     if (rtcf != NULL) {
-        nxt_debug(task, "old router conf is destroyed");
-
-        nxt_router_apps_hash_use(task, rtcf, -1);
-
-        nxt_router_access_log_release(task, lock, rtcf->access_log);
-
-        nxt_tstr_state_release(rtcf->tstr_state);
-
-        nxt_mp_thread_adopt(rtcf->mem_pool);
-
-        nxt_mp_destroy(rtcf->mem_pool);
+        nxt_router_conf_free(task, rtcf);
     }
 }
 
@@ -3877,6 +5171,12 @@ nxt_router_response_ready_handler(nxt_task_t *task, nxt_port_recv_msg_t *msg,
         return;
     }
 
+    if (msg->port_msg.type == _NXT_PORT_MSG_WEBSOCKET) {
+        nxt_http_websocket_channel_handler(task, r, app, msg);
+
+        return;
+    }
+
     b = (msg->size == 0) ? NULL : msg->buf;
 
     if (msg->port_msg.last != 0) {
@@ -3886,6 +5186,10 @@ nxt_router_response_ready_handler(nxt_task_t *task, nxt_port_recv_msg_t *msg,
 
         req_rpc_data->rpc_cancel = 0;
 
+        if (r->ws_subscriptions != NULL || r->ws_published != NULL) {
+            nxt_http_websocket_channels_release(task, r);
+        }
+
         if (req_rpc_data->apr_action == NXT_APR_REQUEST_FAILED) {
             req_rpc_data->apr_action = NXT_APR_GOT_RESPONSE;
         }
@@ -3910,7 +5214,30 @@ nxt_router_response_ready_handler(nxt_task_t *task, nxt_port_recv_msg_t *msg,
     }
 
     if (r->header_sent) {
-        nxt_buf_chain_add(&r->out, b);
+        if (r->state == &nxt_http_websocket) {
+            nxt_http_websocket_frames(r, b);
+        }
+
+#if (NXT_HAVE_ZLIB)
+        if (r->ws_deflate != NULL && r->state == &nxt_http_websocket) {
+            ret = nxt_http_websocket_deflate(task, r, &b);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                nxt_request_rpc_data_unlink(task, req_rpc_data);
+                return;
+            }
+
+            if (b == NULL) {
+                return;
+            }
+        }
+#endif
+
+        nxt_buf_chain_add(&r->out, b);
+
+        if (r->ws_published != NULL) {
+            nxt_http_websocket_published(task, r);
+        }
+
         nxt_http_request_send_body(task, r, NULL);
 
     } else {
@@ -4030,6 +5357,38 @@ nxt_router_response_ready_handler(nxt_task_t *task, nxt_port_recv_msg_t *msg,
 }
 
 
+/*
+ * An application acknowledges several requests taken from the shared queue
+ * with one message: streams after the first one are passed in the body.
+ */
+static void
+nxt_router_req_headers_acks_handler(nxt_task_t *task, nxt_port_recv_msg_t *msg)
+{
+    u_char    *p, *end;
+    uint32_t  stream;
+
+    nxt_port_rpc_handler(task, msg);
+
+    if (msg->size < sizeof(uint32_t) || msg->buf == NULL) {
+        return;
+    }
+
+    stream = msg->port_msg.stream;
+
+    p = msg->buf->mem.pos;
+    end = p + msg->size - msg->size % sizeof(uint32_t);
+
+    while (p < end) {
+        nxt_memcpy(&msg->port_msg.stream, p, sizeof(uint32_t));
+        p += sizeof(uint32_t);
+
+        nxt_port_rpc_handler(task, msg);
+    }
+
+    msg->port_msg.stream = stream;
+}
+
+
 static void
 nxt_router_req_headers_ack_handler(nxt_task_t *task,
     nxt_port_recv_msg_t *msg, nxt_request_rpc_data_t *req_rpc_data)
@@ -4037,9 +5396,11 @@ nxt_router_req_headers_ack_handler(nxt_task_t *task,
     int                 res;
     nxt_app_t           *app;
     nxt_buf_t           *b;
-    nxt_bool_t          start_process, unlinked;
-    nxt_port_t          *app_port, *main_app_port, *idle_port;
-    nxt_queue_link_t    *idle_lnk;
+    nxt_bool_t          unlinked;
+    nxt_uint_t          start_process;
+    nxt_msec_t          now;
+    nxt_port_t          *app_port, *main_app_port, *dispatch_port;
+    nxt_app_status_t    *status;
     nxt_http_request_t  *r;
 
     nxt_debug(task, "stream #%uD: got ack from %PI:%d",
@@ -4060,10 +5421,13 @@ nxt_router_req_headers_ack_handler(nxt_task_t *task,
     if (r->app_link.next != NULL) {
         nxt_queue_remove(&r->app_link);
         r->app_link.next = NULL;
+        app->waiting_requests--;
 
         unlinked = 1;
     }
 
+    dispatch_port = nxt_router_app_dispatch_done(app, r, msg->port_msg.pid);
+
     app_port = nxt_port_hash_find(&app->port_hash, msg->port_msg.pid,
                                   msg->port_msg.reply_port);
     if (nxt_slow_path(app_port == NULL)) {
@@ -4075,45 +5439,38 @@ nxt_router_req_headers_ack_handler(nxt_task_t *task,
             nxt_mp_release(r->mem_pool);
         }
 
+        if (dispatch_port != NULL) {
+            nxt_port_use(task, dispatch_port, -1);
+        }
+
         return;
     }
 
     main_app_port = app_port->main_app_port;
 
-    if (nxt_queue_chk_remove(&main_app_port->idle_link)) {
-        app->idle_processes--;
-
-        nxt_debug(task, "app '%V' move port %PI:%d out of %s (ack)",
-                  &app->name, main_app_port->pid, main_app_port->id,
-                  (main_app_port->idle_start ? "idle_ports" : "spare_ports"));
+    if (nxt_router_app_port_unidle(task, app, main_app_port)
+        && nxt_router_app_can_start(app)
+        && nxt_router_app_need_start(app))
+    {
+        app->pending_processes++;
+        start_process = 1;
+    }
 
-        /* Check port was in 'spare_ports' using idle_start field. */
-        if (main_app_port->idle_start == 0
-            && app->idle_processes >= app->spare_processes)
-        {
-            /*
-             * If there is a vacant space in spare ports,
-             * move the last idle to spare_ports.
-             */
-            nxt_assert(!nxt_queue_is_empty(&app->idle_ports));
+    now = task->thread->engine->timers.now;
 
-            idle_lnk = nxt_queue_last(&app->idle_ports);
-            idle_port = nxt_queue_link_data(idle_lnk, nxt_port_t, idle_link);
-            nxt_queue_remove(idle_lnk);
+    req_rpc_data->acked_at = now;
+    r->app_start = nxt_thread_monotonic_time(task->thread);
 
-            nxt_queue_insert_tail(&app->spare_ports, idle_lnk);
+    status = nxt_router_status(task, app->status);
 
-            idle_port->idle_start = 0;
+    nxt_status_time_add(&status->queue_time, now - req_rpc_data->queued_at);
 
-            nxt_debug(task, "app '%V' move port %PI:%d from idle_ports "
-                      "to spare_ports",
-                      &app->name, idle_port->pid, idle_port->id);
-        }
+    if (app->scale != NULL) {
+        app->scale->queue_avg += (now - req_rpc_data->queued_at)
+                                 - (app->scale->queue_avg >> 3);
+        app->scale->requests++;
 
-        if (nxt_router_app_can_start(app) && nxt_router_app_need_start(app)) {
-            app->pending_processes++;
-            start_process = 1;
-        }
+        start_process += nxt_router_app_scale(task, app, now);
     }
 
     main_app_port->active_requests++;
@@ -4126,8 +5483,13 @@ nxt_router_req_headers_ack_handler(nxt_task_t *task,
         nxt_mp_release(r->mem_pool);
     }
 
-    if (start_process) {
+    if (dispatch_port != NULL) {
+        nxt_port_use(task, dispatch_port, -1);
+    }
+
+    while (start_process != 0) {
         nxt_router_start_app_process(task, app);
+        start_process--;
     }
 
     nxt_port_use(task, req_rpc_data->app_port, -1);
@@ -4165,6 +5527,9 @@ nxt_router_req_headers_ack_handler(nxt_task_t *task,
         r->timer.handler = nxt_router_app_timeout;
         r->timer_data = req_rpc_data;
         nxt_timer_add(task->thread->engine, &r->timer, app->timeout);
+
+    } else if (app->queue_timeout != 0) {
+        nxt_timer_disable(task->thread->engine, &r->timer);
     }
 }
 
@@ -4376,6 +5741,7 @@ nxt_router_app_port_error(nxt_task_t *task, nxt_port_recv_msg_t *msg,
 
         nxt_queue_remove(link);
         link->next = NULL;
+        app->waiting_requests--;
     }
 
     nxt_thread_mutex_unlock(&app->mutex);
@@ -4396,6 +5762,7 @@ nxt_router_app_port_error(nxt_task_t *task, nxt_port_recv_msg_t *msg,
 
             nxt_queue_remove(link);
             link->next = NULL;
+            app->waiting_requests--;
         }
 
         nxt_thread_mutex_unlock(&app->mutex);
@@ -4441,7 +5808,7 @@ nxt_router_app_get_port_for_quit(nxt_task_t *task, nxt_app_t *app)
 }
 
 
-static void
+void
 nxt_router_app_use(nxt_task_t *task, nxt_app_t *app, int i)
 {
     int  c;
@@ -4537,6 +5904,7 @@ nxt_router_app_port_release(nxt_task_t *task, nxt_app_t *app, nxt_port_t *port,
     if (main_app_port->pair[1] != -1
         && main_app_port->active_requests == 0
         && main_app_port->active_websockets == 0
+        && main_app_port->queued_requests == 0
         && main_app_port->idle_link.next == NULL)
     {
         if (app->idle_processes == app->spare_processes
@@ -4591,10 +5959,12 @@ nxt_router_app_port_release(nxt_task_t *task, nxt_app_t *app, nxt_port_t *port,
 void
 nxt_router_app_port_close(nxt_task_t *task, nxt_port_t *port)
 {
-    nxt_app_t         *app;
-    nxt_bool_t        unchain, start_process;
-    nxt_port_t        *idle_port;
-    nxt_queue_link_t  *idle_lnk;
+    int                 n;
+    nxt_app_t           *app;
+    nxt_bool_t          unchain, start_process;
+    nxt_port_t          *idle_port;
+    nxt_queue_link_t    *idle_lnk, *lnk, *next;
+    nxt_http_request_t  *r;
 
     app = port->app;
 
@@ -4630,6 +6000,33 @@ nxt_router_app_port_close(nxt_task_t *task, nxt_port_t *port)
 
     unchain = nxt_queue_chk_remove(&port->app_link);
 
+    /* Requests left in the process queue will never be acknowledged. */
+
+    n = 0;
+
+    if (port->queued_requests != 0) {
+        lnk = nxt_queue_first(&app->ack_waiting_req);
+
+        while (lnk != nxt_queue_tail(&app->ack_waiting_req)) {
+            next = nxt_queue_next(lnk);
+            r = nxt_queue_link_data(lnk, nxt_http_request_t, app_link);
+
+            if (r->app_port == port) {
+                nxt_queue_remove(lnk);
+                lnk->next = NULL;
+                app->waiting_requests--;
+
+                (void) nxt_router_app_dispatch_done(app, r, 0);
+
+                nxt_event_engine_post(r->engine, &r->err_work);
+
+                n++;
+            }
+
+            lnk = next;
+        }
+    }
+
     if (nxt_queue_chk_remove(&port->idle_link)) {
         app->idle_processes--;
 
@@ -4670,6 +6067,10 @@ nxt_router_app_port_close(nxt_task_t *task, nxt_port_t *port)
 
     nxt_debug(task, "app '%V' pid %PI closed", &app->name, port->pid);
 
+    if (n != 0) {
+        nxt_port_use(task, port, -n);
+    }
+
     if (unchain) {
         nxt_port_use(task, port, -1);
     }
@@ -4684,14 +6085,16 @@ static void
 nxt_router_adjust_idle_timer(nxt_task_t *task, void *obj, void *data)
 {
     nxt_app_t           *app;
+    nxt_uint_t          start_process;
     nxt_bool_t          queued;
     nxt_port_t          *port;
-    nxt_msec_t          timeout, threshold;
+    nxt_msec_t          timeout, threshold, scale_timeout;
     nxt_queue_link_t    *lnk;
     nxt_event_engine_t  *engine;
 
     app = obj;
     queued = (data == app);
+    start_process = 0;
 
     nxt_debug(task, "nxt_router_adjust_idle_timer: app \"%V\", queued %b",
               &app->name, queued);
@@ -4713,6 +6116,10 @@ nxt_router_adjust_idle_timer(nxt_task_t *task, void *obj, void *data)
               &app->name,
               (int) app->idle_processes, (int) app->spare_processes);
 
+    if (app->scale != NULL) {
+        start_process = nxt_router_app_scale(task, app, engine->timers.now);
+    }
+
     while (app->idle_processes > app->spare_processes) {
 
         nxt_assert(!nxt_queue_is_empty(&app->idle_ports));
@@ -4720,7 +6127,25 @@ nxt_router_adjust_idle_timer(nxt_task_t *task, void *obj, void *data)
         lnk = nxt_queue_first(&app->idle_ports);
         port = nxt_queue_link_data(lnk, nxt_port_t, idle_link);
 
-        timeout = port->idle_start + app->idle_timeout;
+        if (app->scale != NULL) {
+            /*
+             * The autoscaler supersedes "idle_timeout": idle processes
+             * above the target are stopped at once unless requests are
+             * still waiting, the rest are kept until the next evaluation.
+             */
+            if (app->processes <= app->scale->target
+                || app->waiting_requests != 0)
+            {
+                timeout = nxt_max(app->scale->last + app->scale->cooldown,
+                                  threshold + 1);
+                break;
+            }
+
+            timeout = 0;
+
+        } else {
+            timeout = port->idle_start + app->idle_timeout;
+        }
 
         nxt_debug(task, "app '%V' pid %PI, start %M, timeout %M, threshold %M",
                   &app->name, port->pid,
@@ -4757,6 +6182,17 @@ nxt_router_adjust_idle_timer(nxt_task_t *task, void *obj, void *data)
         nxt_thread_mutex_lock(&app->mutex);
     }
 
+    /* The autoscaler is re-evaluated periodically while there is load. */
+
+    if (app->scale != NULL && app->active_requests != 0) {
+        scale_timeout = nxt_max(app->scale->last + app->scale->cooldown,
+                                threshold + 1);
+
+        if (timeout <= threshold || scale_timeout < timeout) {
+            timeout = scale_timeout;
+        }
+    }
+
     nxt_thread_mutex_unlock(&app->mutex);
 
     if (timeout > threshold) {
@@ -4766,6 +6202,11 @@ nxt_router_adjust_idle_timer(nxt_task_t *task, void *obj, void *data)
         nxt_timer_disable(engine, &app->joint->idle_timer);
     }
 
+    while (start_process != 0) {
+        nxt_router_start_app_process(task, app);
+        start_process--;
+    }
+
     if (queued) {
         nxt_router_app_use(task, app, -1);
     }
@@ -4895,13 +6336,16 @@ nxt_router_free_app(nxt_task_t *task, void *obj, void *data)
 
 static void
 nxt_router_app_port_get(nxt_task_t *task, nxt_app_t *app,
-    nxt_request_rpc_data_t *req_rpc_data)
+    nxt_request_rpc_data_t *req_rpc_data, nxt_str_t *key)
 {
-    nxt_bool_t          start_process;
+    nxt_bool_t          start_process, adjust_idle_timer;
     nxt_port_t          *port;
     nxt_http_request_t  *r;
 
     start_process = 0;
+    adjust_idle_timer = 0;
+
+    r = req_rpc_data->request;
 
     nxt_thread_mutex_lock(&app->mutex);
 
@@ -4910,21 +6354,42 @@ nxt_router_app_port_get(nxt_task_t *task, nxt_app_t *app,
 
     app->active_requests++;
 
+    if (app->dispatch_depth != 0 && nxt_router_app_dispatch(task, app, r, key))
+    {
+        req_rpc_data->dispatch_port = r->app_port;
+        nxt_port_inc_use(r->app_port);
+    }
+
     if (nxt_router_app_can_start(app) && nxt_router_app_need_start(app)) {
         app->pending_processes++;
         start_process = 1;
     }
 
-    r = req_rpc_data->request;
-
     /*
      * Put request into application-wide list to be able to cancel request
      * if something goes wrong with application processes.
      */
     nxt_queue_insert_tail(&app->ack_waiting_req, &r->app_link);
+    app->waiting_requests++;
+
+    /* The first waiting request starts the autoscaler evaluation timer. */
+
+    if (app->scale != NULL
+        && app->waiting_requests == 1
+        && app->adjust_idle_work.data == NULL)
+    {
+        adjust_idle_timer = 1;
+        app->adjust_idle_work.data = app;
+        app->adjust_idle_work.next = NULL;
+    }
 
     nxt_thread_mutex_unlock(&app->mutex);
 
+    if (adjust_idle_timer) {
+        nxt_router_app_use(task, app, 1);
+        nxt_event_engine_post(app->engine, &app->adjust_idle_work);
+    }
+
     /*
      * Retain request memory pool while request is linked in ack_waiting_req
      * to guarantee request structure memory is accessble.
@@ -4933,6 +6398,8 @@ nxt_router_app_port_get(nxt_task_t *task, nxt_app_t *app,
 
     req_rpc_data->app_port = port;
     req_rpc_data->apr_action = NXT_APR_REQUEST_FAILED;
+    req_rpc_data->queued_at = task->thread->engine->timers.now;
+    req_rpc_data->acked_at = 0;
 
     if (start_process) {
         nxt_router_start_app_process(task, app);
@@ -4940,18 +6407,312 @@ nxt_router_app_port_get(nxt_task_t *task, nxt_app_t *app,
 }
 
 
+/*
+ * Moves the port out of idle or spare ports when it gets a request.
+ * Must be called with app->mutex locked.
+ */
+static nxt_bool_t
+nxt_router_app_port_unidle(nxt_task_t *task, nxt_app_t *app, nxt_port_t *port)
+{
+    nxt_port_t        *idle_port;
+    nxt_queue_link_t  *idle_lnk;
+
+    if (!nxt_queue_chk_remove(&port->idle_link)) {
+        return 0;
+    }
+
+    app->idle_processes--;
+
+    nxt_debug(task, "app '%V' move port %PI:%d out of %s",
+              &app->name, port->pid, port->id,
+              (port->idle_start ? "idle_ports" : "spare_ports"));
+
+    /* Check port was in 'spare_ports' using idle_start field. */
+    if (port->idle_start == 0
+        && app->idle_processes >= app->spare_processes)
+    {
+        /*
+         * If there is a vacant space in spare ports,
+         * move the last idle to spare_ports.
+         */
+        nxt_assert(!nxt_queue_is_empty(&app->idle_ports));
+
+        idle_lnk = nxt_queue_last(&app->idle_ports);
+        idle_port = nxt_queue_link_data(idle_lnk, nxt_port_t, idle_link);
+        nxt_queue_remove(idle_lnk);
+
+        nxt_queue_insert_tail(&app->spare_ports, idle_lnk);
+
+        idle_port->idle_start = 0;
+
+        nxt_debug(task, "app '%V' move port %PI:%d from idle_ports "
+                  "to spare_ports",
+                  &app->name, idle_port->pid, idle_port->id);
+    }
+
+    return 1;
+}
+
+
+/*
+ * Chooses an application process for the request: the least loaded one,
+ * or the one with the highest random weight for the request key.  If the
+ * process already has "depth" requests, the request goes to the shared
+ * queue, where it is taken by the first process that becomes available.
+ * Must be called with app->mutex locked.
+ */
+static nxt_bool_t
+nxt_router_app_dispatch(nxt_task_t *task, nxt_app_t *app,
+    nxt_http_request_t *r, nxt_str_t *key)
+{
+    uint32_t    hash, load, weight, max;
+    nxt_port_t  *port, *best;
+
+    struct {
+        uint32_t    hash;
+        nxt_pid_t   pid;
+    } rnd;
+
+    best = NULL;
+    load = 0;
+    max = 0;
+    hash = (key != NULL) ? nxt_murmur_hash2(key->start, key->length) : 0;
+
+    nxt_memzero(&rnd, sizeof(rnd));
+
+    nxt_queue_each(port, &app->ports, nxt_port_t, app_link) {
+
+        if (port->queue == NULL) {
+            continue;
+        }
+
+        if (key != NULL) {
+            rnd.hash = hash;
+            rnd.pid = port->pid;
+
+            weight = nxt_murmur_hash2(&rnd, sizeof(rnd));
+
+            if (best == NULL || weight > max) {
+                best = port;
+                max = weight;
+            }
+
+        } else {
+            weight = port->active_requests + port->queued_requests;
+
+            if (best == NULL || weight < load) {
+                best = port;
+                load = weight;
+            }
+        }
+
+    } nxt_queue_loop;
+
+    if (best == NULL) {
+        return 0;
+    }
+
+    load = best->active_requests + best->queued_requests;
+
+    r->app_pid = best->pid;
+
+    if (load >= app->dispatch_depth) {
+        app->dispatch_contended++;
+        return 0;
+    }
+
+    (void) nxt_router_app_port_unidle(task, app, best);
+
+    best->queued_requests++;
+    nxt_port_inc_use(best);
+
+    r->app_port = best;
+
+    app->dispatch_direct++;
+
+    return 1;
+}
+
+
+/*
+ * Drops per-process dispatch state of the request; the caller releases
+ * the returned port after app->mutex is unlocked.
+ */
+static nxt_port_t *
+nxt_router_app_dispatch_done(nxt_app_t *app, nxt_http_request_t *r,
+    nxt_pid_t pid)
+{
+    nxt_port_t  *port;
+
+    port = r->app_port;
+
+    if (port != NULL) {
+        port->queued_requests--;
+        r->app_port = NULL;
+
+    } else if (r->app_pid != 0 && pid != 0 && r->app_pid != pid) {
+        app->dispatch_stolen++;
+    }
+
+    r->app_pid = 0;
+
+    return port;
+}
+
+
 void
 nxt_router_process_http_request(nxt_task_t *task, nxt_http_request_t *r,
     nxt_http_action_t *action)
 {
+    nxt_int_t                 ret;
+    nxt_router_conf_t         *rtcf;
+    nxt_http_app_conf_t       *conf;
+    nxt_router_app_key_ctx_t  *ctx;
+
+    conf = action->u.conf;
+
+    if (conf->key == NULL || conf->app->dispatch_depth == 0) {
+        nxt_router_app_request(task, r, conf, NULL);
+        return;
+    }
+
+    ctx = nxt_mp_get(r->mem_pool, sizeof(nxt_router_app_key_ctx_t));
+    if (nxt_slow_path(ctx == NULL)) {
+        goto fail;
+    }
+
+    ctx->conf = conf;
+
+    rtcf = r->conf->socket_conf->router_conf;
+
+    ret = nxt_tstr_query_init(&r->tstr_query, rtcf->tstr_state, &r->tstr_cache,
+                              r, r->mem_pool);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        goto fail;
+    }
+
+    nxt_tstr_query(task, r->tstr_query, conf->key, &ctx->key);
+    nxt_tstr_query_resolve(task, r->tstr_query, ctx,
+                           nxt_router_app_key_ready, nxt_router_app_key_error);
+    return;
+
+fail:
+
+    nxt_http_request_error(task, r, NXT_HTTP_INTERNAL_SERVER_ERROR);
+}
+
+
+void
+nxt_router_http_request_stats(nxt_task_t *task, nxt_http_request_t *r)
+{
+    nxt_off_t             sent;
+    nxt_app_t             *app;
+    nxt_msec_t            time;
+    nxt_status_traffic_t  *traffic;
+
+    time = (nxt_thread_monotonic_time(task->thread) - r->start_time) / 1000000;
+
+    sent = 0;
+
+    if (nxt_fast_path(r->proto.any != NULL)) {
+        sent = nxt_http_proto[r->protocol].body_bytes_sent(task, r->proto);
+    }
+
+    traffic = nxt_router_status(task, r->conf->socket_conf->traffic);
+
+    nxt_router_traffic_add(traffic, r, time, sent);
+
+    if (r->route_traffic != NULL) {
+        traffic = nxt_router_status(task, r->route_traffic);
+
+        nxt_router_traffic_add(traffic, r, time, sent);
+    }
+
+    app = r->app;
+
+    if (app != NULL) {
+        r->app = NULL;
+
+        traffic = &nxt_router_status(task, app->status)->traffic;
+
+        nxt_router_traffic_add(traffic, r, time, sent);
+
+        nxt_router_app_use(task, app, -1);
+    }
+}
+
+
+static void
+nxt_router_traffic_add(nxt_status_traffic_t *traffic, nxt_http_request_t *r,
+    nxt_msec_t time, nxt_off_t sent)
+{
+    nxt_uint_t  class;
+
+    if (r->content_length_n > 0) {
+        traffic->bytes_in += r->content_length_n;
+    }
+
+    if (sent > 0) {
+        traffic->bytes_out += sent;
+    }
+
+    class = r->status / 100;
+
+    if (class >= 1 && class <= 5) {
+        traffic->responses[class - 1]++;
+    }
+
+    nxt_status_time_add(&traffic->time, time);
+}
+
+
+static void
+nxt_router_app_key_ready(nxt_task_t *task, void *obj, void *data)
+{
+    nxt_http_request_t        *r;
+    nxt_router_app_key_ctx_t  *ctx;
+
+    r = obj;
+    ctx = data;
+
+    nxt_debug(task, "app dispatch key: \"%V\"", &ctx->key);
+
+    nxt_router_app_request(task, r, ctx->conf, &ctx->key);
+}
+
+
+static void
+nxt_router_app_key_error(nxt_task_t *task, void *obj, void *data)
+{
+    nxt_http_request_t  *r;
+
+    r = obj;
+
+    nxt_http_request_error(task, r, NXT_HTTP_INTERNAL_SERVER_ERROR);
+}
+
+
+static void
+nxt_router_app_request(nxt_task_t *task, nxt_http_request_t *r,
+    nxt_http_app_conf_t *conf, nxt_str_t *key)
+{
+    nxt_app_t               *app;
     nxt_event_engine_t      *engine;
-    nxt_http_app_conf_t     *conf;
     nxt_request_rpc_data_t  *req_rpc_data;
 
-    conf = action->u.conf;
     engine = task->thread->engine;
 
+    app = conf->app;
+
+    if (app->max_queue != 0 && nxt_router_app_queue_full(app)) {
+        nxt_debug(task, "app '%V' queue is full", &app->name);
+
+        nxt_http_request_error(task, r, NXT_HTTP_SERVICE_UNAVAILABLE);
+        return;
+    }
+
     r->app_target = conf->target;
+    r->queue_start = nxt_thread_monotonic_time(task->thread);
 
     req_rpc_data = nxt_port_rpc_register_handler_ex(task, engine->port,
                                           nxt_router_response_ready_handler,
@@ -4989,6 +6750,11 @@ nxt_router_process_http_request(nxt_task_t *task, nxt_http_request_t *r,
 
     nxt_router_app_use(task, conf->app, 1);
 
+    if (r->app == NULL) {
+        r->app = app;
+        nxt_router_app_use(task, app, 1);
+    }
+
     req_rpc_data->request = r;
     r->req_rpc_data = req_rpc_data;
 
@@ -4996,8 +6762,31 @@ nxt_router_process_http_request(nxt_task_t *task, nxt_http_request_t *r,
         r->last->completion_handler = nxt_router_http_request_done;
     }
 
-    nxt_router_app_port_get(task, conf->app, req_rpc_data);
+    nxt_router_app_port_get(task, conf->app, req_rpc_data, key);
     nxt_router_app_prepare_request(task, req_rpc_data);
+
+    /* The timer is replaced by the response timeout on acknowledgement. */
+
+    if (app->queue_timeout != 0 && r->req_rpc_data != NULL) {
+        r->timer.handler = nxt_router_app_timeout;
+        r->timer_data = req_rpc_data;
+        nxt_timer_add(engine, &r->timer, app->queue_timeout);
+    }
+}
+
+
+static nxt_bool_t
+nxt_router_app_queue_full(nxt_app_t *app)
+{
+    nxt_bool_t  full;
+
+    nxt_thread_mutex_lock(&app->mutex);
+
+    full = (app->waiting_requests >= app->max_queue);
+
+    nxt_thread_mutex_unlock(&app->mutex);
+
+    return full;
 }
 
 
@@ -5109,19 +6898,32 @@ nxt_router_app_prepare_request(nxt_task_t *task,
     msg.mm.chunk_id = nxt_port_mmap_chunk_id(hdr, buf->mem.pos);
     msg.mm.size = nxt_buf_used_size(buf);
 
-    res = nxt_app_queue_send(port->queue, &msg, sizeof(msg),
-                             req_rpc_data->stream, &notify,
-                             &req_rpc_data->msg_info.tracking_cookie);
-    if (nxt_fast_path(res == NXT_OK)) {
-        if (notify != 0) {
-            (void) nxt_port_socket_write(task, port,
-                                         NXT_PORT_MSG_READ_QUEUE,
-                                         -1, req_rpc_data->stream,
-                                         reply_port->id, NULL);
+    res = NXT_AGAIN;
 
-        } else {
-            nxt_debug(task, "queue is not empty");
+    if (req_rpc_data->dispatch_port != NULL) {
+        res = nxt_router_app_dispatch_send(task, req_rpc_data, &msg,
+                                           sizeof(msg));
+    }
+
+    if (res != NXT_OK) {
+        res = nxt_app_queue_send(port->queue, &msg, sizeof(msg),
+                                 req_rpc_data->stream, &notify,
+                                 &req_rpc_data->msg_info.tracking_cookie);
+
+        if (nxt_fast_path(res == NXT_OK)) {
+            if (notify != 0) {
+                (void) nxt_port_socket_write(task, port,
+                                             NXT_PORT_MSG_READ_QUEUE,
+                                             -1, req_rpc_data->stream,
+                                             reply_port->id, NULL);
+
+            } else {
+                nxt_debug(task, "queue is not empty");
+            }
         }
+    }
+
+    if (nxt_fast_path(res == NXT_OK)) {
 
         buf->is_port_mmap_sent = 1;
         buf->mem.pos = buf->mem.free;
@@ -5136,6 +6938,56 @@ nxt_router_app_prepare_request(nxt_task_t *task,
 }
 
 
+static nxt_int_t
+nxt_router_app_dispatch_send(nxt_task_t *task,
+    nxt_request_rpc_data_t *req_rpc_data, void *msg, size_t size)
+{
+    int                 notify;
+    nxt_int_t           res;
+    nxt_app_t           *app;
+    nxt_port_t          *port, *queued_port;
+    nxt_http_request_t  *r;
+
+    port = req_rpc_data->dispatch_port;
+    req_rpc_data->dispatch_port = NULL;
+
+    res = nxt_port_queue_send(port->queue, msg, size, &notify);
+
+    if (nxt_fast_path(res == NXT_OK)) {
+        nxt_debug(task, "stream #%uD: dispatched to %PI",
+                  req_rpc_data->stream, port->pid);
+
+        if (notify != 0) {
+            (void) nxt_port_socket_write(task, port, NXT_PORT_MSG_READ_QUEUE,
+                                         -1, req_rpc_data->stream, 0, NULL);
+        }
+
+        nxt_port_use(task, port, -1);
+
+        return NXT_OK;
+    }
+
+    /* The process queue is full, fall back to the shared queue. */
+
+    app = req_rpc_data->app;
+    r = req_rpc_data->request;
+
+    nxt_thread_mutex_lock(&app->mutex);
+
+    queued_port = nxt_router_app_dispatch_done(app, r, 0);
+
+    nxt_thread_mutex_unlock(&app->mutex);
+
+    if (queued_port != NULL) {
+        nxt_port_use(task, queued_port, -1);
+    }
+
+    nxt_port_use(task, port, -1);
+
+    return NXT_AGAIN;
+}
+
+
 struct nxt_fields_iter_s {
     nxt_list_part_t   *part;
     nxt_http_field_t  *field;
@@ -5244,6 +7096,17 @@ nxt_router_prepare_msg(nxt_task_t *task, nxt_http_request_t *r,
 
     req->content_length = content_length;
 
+    if (app->queue_timeout != 0) {
+        req->deadline = task->thread->engine->timers.now + app->queue_timeout;
+
+        if (req->deadline == 0) {
+            req->deadline = 1;
+        }
+
+    } else {
+        req->deadline = 0;
+    }
+
     p = (u_char *) (req->fields + fields_count);
 
     nxt_debug(task, "fields_count=%d", (int) fields_count);
@@ -5509,6 +7372,30 @@ nxt_router_http_request_release(nxt_task_t *task, void *obj, void *data)
 }
 
 
+static void
+nxt_router_websocket_publish_handler(nxt_task_t *task,
+    nxt_port_recv_msg_t *msg)
+{
+    nxt_port_t  *port;
+
+    /*
+     * Channels are scoped per application, the application is taken from
+     * the main port of the sending process.  It is safe to access
+     * 'runtime->ports' hash because the router port is processed in
+     * main thread.
+     */
+    port = nxt_runtime_port_find(task->thread->runtime, msg->port_msg.pid, 0);
+
+    if (nxt_slow_path(port == NULL || port->app == NULL)) {
+        nxt_alert(task, "websocket publish from not application process %PI",
+                  msg->port_msg.pid);
+        return;
+    }
+
+    nxt_http_websocket_publish(task, msg, port->app, &nxt_router->engines);
+}
+
+
 static void
 nxt_router_oosm_handler(nxt_task_t *task, nxt_port_recv_msg_t *msg)
 {
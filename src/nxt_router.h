@@ -14,14 +14,18 @@
 
 typedef struct nxt_http_request_s  nxt_http_request_t;
 #include <nxt_application.h>
+#include <nxt_status.h>
 
 
 typedef struct nxt_http_action_s        nxt_http_action_t;
 typedef struct nxt_http_routes_s        nxt_http_routes_t;
 typedef struct nxt_http_forward_s       nxt_http_forward_t;
+typedef struct nxt_http_limit_s         nxt_http_limit_t;
+typedef struct nxt_http_limit_entry_s   nxt_http_limit_entry_t;
 typedef struct nxt_upstream_s           nxt_upstream_t;
 typedef struct nxt_upstreams_s          nxt_upstreams_t;
 typedef struct nxt_router_access_log_s  nxt_router_access_log_t;
+typedef struct nxt_router_conf_s        nxt_router_conf_t;
 
 
 #define NXT_HTTP_ACTION_ERROR  ((nxt_http_action_t *) -1)
@@ -35,10 +39,26 @@ typedef struct {
     nxt_queue_t              apps;     /* of nxt_app_t */
 
     nxt_router_access_log_t  *access_log;
+
+    nxt_str_t                conf;  /* last applied configuration */
+    nxt_router_conf_t        *router_conf;  /* current configuration */
+
+    /* The number of status counter copies, one per router engine. */
+    uint32_t                 status_slots;
+
+    uint64_t                 reloads;
+    uint64_t                 reloads_unchanged;
+    nxt_msec_t               reload_time;
+    nxt_msec_t               reload_max_time;
+
+#if (NXT_TLS)
+    nxt_tls_offload_t        tls_offload;
+    nxt_timer_t              ocsp_timer;
+#endif
 } nxt_router_t;
 
 
-typedef struct {
+struct nxt_router_conf_s {
     uint32_t                 count;
     uint32_t                 threads;
 
@@ -46,15 +66,25 @@ typedef struct {
     nxt_tstr_state_t         *tstr_state;
 
     nxt_router_t             *router;
+
+    /*
+     * The configuration whose routes, upstreams, templates, and static
+     * settings are shared, if only listeners have been changed since.
+     */
+    nxt_router_conf_t        *base;
+
     nxt_http_routes_t        *routes;
     nxt_upstreams_t          *upstreams;
 
-    nxt_lvlhsh_t             mtypes_hash;
-    nxt_lvlhsh_t             apps_hash;
+    nxt_flathsh_t            mtypes_hash;
+    nxt_flathsh_t            apps_hash;
 
     nxt_router_access_log_t  *access_log;
     nxt_tstr_t               *log_format;
-} nxt_router_conf_t;
+
+    nxt_array_t              *dispatch_keys;  /* of nxt_router_app_key_t */
+    nxt_array_t              *limits;         /* of nxt_http_limit_t * */
+};
 
 
 typedef struct {
@@ -81,6 +111,9 @@ typedef struct {
     uint32_t               stream;
     uint32_t               count;
 
+    nxt_str_t              conf;
+    nxt_nsec_t             start;
+
     nxt_event_engine_t     *engine;
     nxt_port_t             *port;
     nxt_array_t            *engines;
@@ -104,6 +137,33 @@ typedef struct {
 } nxt_app_joint_t;
 
 
+typedef struct {
+    nxt_status_traffic_t   traffic;
+    nxt_status_time_t      queue_time;
+    nxt_status_time_t      service_time;
+} nxt_app_status_t;
+
+
+typedef struct {
+    nxt_msec_t             queue_time;
+    nxt_msec_t             service_time;
+    nxt_msec_t             cooldown;
+    uint32_t               step_up;
+    uint32_t               step_down;
+
+    uint32_t               target;
+    uint32_t               requests;
+    nxt_msec_t             last;
+
+    /* Moving averages scaled by 8. */
+    nxt_msec_t             queue_avg;
+    nxt_msec_t             service_avg;
+
+    uint64_t               ups;
+    uint64_t               downs;
+} nxt_app_scale_t;
+
+
 struct nxt_app_s {
     nxt_thread_mutex_t     mutex;       /* Protects ports queue. */
     nxt_queue_t            ports;       /* of nxt_port_t.app_link */
@@ -119,6 +179,7 @@ struct nxt_app_s {
     uint32_t               port_hash_count;
 
     uint32_t               active_requests;
+    uint32_t               waiting_requests; /* in ack_waiting_req */
     uint32_t               pending_processes;
     uint32_t               processes;
     uint32_t               idle_processes;
@@ -130,8 +191,22 @@ struct nxt_app_s {
     uint32_t               generation;
     uint32_t               proto_port_requests;
 
+    /* Per-process queue depth, 0 if requests go to the shared queue only. */
+    uint32_t               dispatch_depth;
+    nxt_str_t              dispatch_key;
+
+    uint64_t               dispatch_direct;
+    uint64_t               dispatch_contended;
+    uint64_t               dispatch_stolen;
+
     nxt_msec_t             timeout;
     nxt_msec_t             idle_timeout;
+    nxt_msec_t             queue_timeout;
+    uint32_t               max_queue;
+
+    nxt_app_scale_t        *scale;
+
+    nxt_app_status_t       *status;  /* per router engine */
 
     nxt_str_t              *targets;
 
@@ -157,6 +232,11 @@ typedef struct {
     size_t                 max_frame_size;
     nxt_msec_t             read_timeout;
     nxt_msec_t             keepalive_interval;
+
+    size_t                 deflate_threshold;
+    uint32_t               deflate_window_bits;
+    uint8_t                deflate;                   /* 1 bit */
+    uint8_t                deflate_context_takeover;  /* 1 bit */
 } nxt_websocket_conf_t;
 
 
@@ -202,6 +282,12 @@ typedef struct {
     nxt_http_forward_t     *forwarded;
     nxt_http_forward_t     *client_ip;
 
+    /*
+     * Per router engine, carried over to the listener configuration
+     * that replaces this one.
+     */
+    nxt_status_traffic_t   *traffic;
+
 #if (NXT_TLS)
     nxt_tls_conf_t         *tls;
 #endif
@@ -232,9 +318,15 @@ struct nxt_router_access_log_s {
 };
 
 
+#define nxt_router_status(task, counters)                                     \
+    (&(counters)[(task)->thread->engine->status_slot])
+
+
 void nxt_router_process_http_request(nxt_task_t *task, nxt_http_request_t *r,
     nxt_http_action_t *action);
 void nxt_router_app_port_close(nxt_task_t *task, nxt_port_t *port);
+void nxt_router_app_use(nxt_task_t *task, nxt_app_t *app, int i);
+void nxt_router_http_request_stats(nxt_task_t *task, nxt_http_request_t *r);
 nxt_int_t nxt_router_application_init(nxt_router_conf_t *rtcf, nxt_str_t *name,
     nxt_str_t *target, nxt_http_action_t *action);
 void nxt_router_listen_event_release(nxt_task_t *task, nxt_listen_event_t *lev,
@@ -28,11 +28,15 @@ typedef struct {
     nxt_app_t               *app;
 
     nxt_port_t              *app_port;
+    nxt_port_t              *dispatch_port;
     nxt_apr_action_t        apr_action;
 
     nxt_http_request_t      *request;
     nxt_msg_info_t          msg_info;
 
+    nxt_msec_t              queued_at;
+    nxt_msec_t              acked_at;
+
     nxt_bool_t              rpc_cancel;
 } nxt_request_rpc_data_t;
 
@@ -8,33 +8,163 @@
 #include <nxt_status.h>
 
 
+typedef struct {
+    nxt_str_t         labels;
+    nxt_conf_value_t  *value;
+} nxt_status_metrics_obj_t;
+
+
+typedef struct {
+    nxt_mp_t          *mp;
+    nxt_conf_value_t  *status;
+    nxt_buf_t         *out;
+    nxt_buf_t         *last;
+} nxt_status_metrics_ctx_t;
+
+
+static nxt_int_t nxt_status_traffic_set(nxt_conf_value_t *obj, uint32_t n,
+    nxt_status_traffic_t *traffic, nxt_status_time_t *queue,
+    nxt_status_time_t *service, nxt_mp_t *mp);
+static nxt_conf_value_t *nxt_status_time_get(nxt_status_time_t *time,
+    nxt_mp_t *mp);
+static nxt_conf_value_t *nxt_status_routes_get(nxt_status_report_t *report,
+    nxt_mp_t *mp);
+static nxt_array_t *nxt_status_metrics_objects(nxt_conf_value_t *status,
+    nxt_str_t *scope, const char *label, nxt_mp_t *mp);
+static nxt_int_t nxt_status_metrics_label(nxt_mp_t *mp, nxt_str_t *labels,
+    const char *label, nxt_str_t *value, nxt_int_t step);
+static nxt_int_t nxt_status_metrics_traffic(nxt_status_metrics_ctx_t *ctx,
+    const char *scope, nxt_array_t *objs);
+static nxt_int_t nxt_status_metrics_time(nxt_status_metrics_ctx_t *ctx,
+    const char *scope, const char *name, nxt_str_t *path, nxt_array_t *objs);
+static nxt_int_t nxt_status_metrics_counter(nxt_status_metrics_ctx_t *ctx,
+    const char *type, const char *name, const char *extra, nxt_str_t *path,
+    nxt_array_t *objs);
+static nxt_int_t nxt_status_metrics_printf(nxt_status_metrics_ctx_t *ctx,
+    size_t size, const char *fmt, ...);
+
+
+/* Upper bounds of the latency buckets in milliseconds, the last is +Inf. */
+
+static const nxt_msec_t  nxt_status_time_bounds[NXT_STATUS_TIME_BUCKETS - 1] =
+{
+    5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000,
+};
+
+
+static nxt_str_t  nxt_status_time_buckets[NXT_STATUS_TIME_BUCKETS] = {
+    nxt_string("5"),
+    nxt_string("10"),
+    nxt_string("25"),
+    nxt_string("50"),
+    nxt_string("100"),
+    nxt_string("250"),
+    nxt_string("500"),
+    nxt_string("1000"),
+    nxt_string("2500"),
+    nxt_string("5000"),
+    nxt_string("10000"),
+    nxt_string("+Inf"),
+};
+
+
+void
+nxt_status_time_add(nxt_status_time_t *time, nxt_msec_t ms)
+{
+    nxt_uint_t  i;
+
+    for (i = 0; i < NXT_STATUS_TIME_BUCKETS - 1; i++) {
+        if (ms <= nxt_status_time_bounds[i]) {
+            break;
+        }
+    }
+
+    time->count[i]++;
+    time->sum += ms;
+}
+
+
+void
+nxt_status_time_sum(nxt_status_time_t *sum, nxt_status_time_t *time)
+{
+    nxt_uint_t  i;
+
+    for (i = 0; i < NXT_STATUS_TIME_BUCKETS; i++) {
+        sum->count[i] += time->count[i];
+    }
+
+    sum->sum += time->sum;
+}
+
+
+void
+nxt_status_traffic_sum(nxt_status_traffic_t *sum,
+    nxt_status_traffic_t *traffic)
+{
+    nxt_uint_t  i;
+
+    sum->bytes_in += traffic->bytes_in;
+    sum->bytes_out += traffic->bytes_out;
+
+    for (i = 0; i < 5; i++) {
+        sum->responses[i] += traffic->responses[i];
+    }
+
+    nxt_status_time_sum(&sum->time, &traffic->time);
+}
+
+
 nxt_conf_value_t *
 nxt_status_get(nxt_status_report_t *report, nxt_mp_t *mp)
 {
     size_t            i;
+    uint32_t          n;
     nxt_str_t         name;
     nxt_int_t         ret;
-    nxt_status_app_t  *app;
-    nxt_conf_value_t  *status, *obj, *apps, *app_obj;
+    nxt_status_app_t       *app;
+    nxt_conf_value_t       *status, *obj, *apps, *app_obj, *listeners, *value;
+    nxt_status_listener_t  *listener;
 
     static nxt_str_t conns_str = nxt_string("connections");
     static nxt_str_t acc_str = nxt_string("accepted");
     static nxt_str_t active_str = nxt_string("active");
     static nxt_str_t idle_str = nxt_string("idle");
     static nxt_str_t closed_str = nxt_string("closed");
+    static nxt_str_t tls_str = nxt_string("tls");
+    static nxt_str_t ktls_str = nxt_string("ktls");
+    static nxt_str_t handshakes_str = nxt_string("tls_handshakes");
+    static nxt_str_t queued_str = nxt_string("queued");
+    static nxt_str_t latency_str = nxt_string("latency");
     static nxt_str_t reqs_str = nxt_string("requests");
     static nxt_str_t total_str = nxt_string("total");
     static nxt_str_t apps_str = nxt_string("applications");
     static nxt_str_t procs_str = nxt_string("processes");
     static nxt_str_t run_str = nxt_string("running");
     static nxt_str_t start_str = nxt_string("starting");
+    static nxt_str_t dispatch_str = nxt_string("dispatch");
+    static nxt_str_t direct_str = nxt_string("direct");
+    static nxt_str_t contended_str = nxt_string("contended");
+    static nxt_str_t stolen_str = nxt_string("stolen");
+    static nxt_str_t autoscale_str = nxt_string("autoscale");
+    static nxt_str_t target_str = nxt_string("target");
+    static nxt_str_t up_str = nxt_string("up");
+    static nxt_str_t down_str = nxt_string("down");
+    static nxt_str_t queue_time_str = nxt_string("queue_time");
+    static nxt_str_t service_time_str = nxt_string("service_time");
+    static nxt_str_t config_str = nxt_string("configuration");
+    static nxt_str_t reloads_str = nxt_string("reloads");
+    static nxt_str_t unchanged_str = nxt_string("unchanged");
+    static nxt_str_t last_time_str = nxt_string("last_time");
+    static nxt_str_t max_time_str = nxt_string("max_time");
+    static nxt_str_t listeners_str = nxt_string("listeners");
+    static nxt_str_t routes_str = nxt_string("routes");
 
-    status = nxt_conf_create_object(mp, 3);
+    status = nxt_conf_create_object(mp, 6);
     if (nxt_slow_path(status == NULL)) {
         return NULL;
     }
 
-    obj = nxt_conf_create_object(mp, 4);
+    obj = nxt_conf_create_object(mp, 7);
     if (nxt_slow_path(obj == NULL)) {
         return NULL;
     }
@@ -47,6 +177,25 @@ nxt_status_get(nxt_status_report_t *report, nxt_mp_t *mp)
                                                   - report->idle_conns, 1);
     nxt_conf_set_member_integer(obj, &idle_str, report->idle_conns, 2);
     nxt_conf_set_member_integer(obj, &closed_str, report->closed_conns, 3);
+    nxt_conf_set_member_integer(obj, &tls_str, report->tls_conns, 4);
+    nxt_conf_set_member_integer(obj, &ktls_str, report->ktls_conns, 5);
+
+    value = nxt_conf_create_object(mp, 2);
+    if (nxt_slow_path(value == NULL)) {
+        return NULL;
+    }
+
+    nxt_conf_set_member(obj, &handshakes_str, value, 6);
+
+    nxt_conf_set_member_integer(value, &queued_str,
+                                report->tls_handshakes_queued, 0);
+
+    obj = nxt_status_time_get(&report->tls_handshake_time, mp);
+    if (nxt_slow_path(obj == NULL)) {
+        return NULL;
+    }
+
+    nxt_conf_set_member(value, &latency_str, obj, 1);
 
     obj = nxt_conf_create_object(mp, 1);
     if (nxt_slow_path(obj == NULL)) {
@@ -57,6 +206,57 @@ nxt_status_get(nxt_status_report_t *report, nxt_mp_t *mp)
 
     nxt_conf_set_member_integer(obj, &total_str, report->requests, 0);
 
+    obj = nxt_conf_create_object(mp, 4);
+    if (nxt_slow_path(obj == NULL)) {
+        return NULL;
+    }
+
+    nxt_conf_set_member(status, &config_str, obj, 3);
+
+    nxt_conf_set_member_integer(obj, &reloads_str, report->reloads, 0);
+    nxt_conf_set_member_integer(obj, &unchanged_str,
+                                report->reloads_unchanged, 1);
+    nxt_conf_set_member_integer(obj, &last_time_str, report->reload_time, 2);
+    nxt_conf_set_member_integer(obj, &max_time_str,
+                                report->reload_max_time, 3);
+
+    listeners = nxt_conf_create_object(mp, report->listeners_count);
+    if (nxt_slow_path(listeners == NULL)) {
+        return NULL;
+    }
+
+    nxt_conf_set_member(status, &listeners_str, listeners, 4);
+
+    listener = nxt_pointer_to(report, (uintptr_t) report->listeners);
+
+    for (i = 0; i < report->listeners_count; i++, listener++) {
+        obj = nxt_conf_create_object(mp, 3);
+        if (nxt_slow_path(obj == NULL)) {
+            return NULL;
+        }
+
+        name.length = listener->name.length;
+        name.start = nxt_pointer_to(report, (uintptr_t) listener->name.start);
+
+        ret = nxt_conf_set_member_dup(listeners, mp, &name, obj, i);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return NULL;
+        }
+
+        ret = nxt_status_traffic_set(obj, 0, &listener->traffic, NULL, NULL,
+                                     mp);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return NULL;
+        }
+    }
+
+    obj = nxt_status_routes_get(report, mp);
+    if (nxt_slow_path(obj == NULL)) {
+        return NULL;
+    }
+
+    nxt_conf_set_member(status, &routes_str, obj, 5);
+
     apps = nxt_conf_create_object(mp, report->apps_count);
     if (nxt_slow_path(apps == NULL)) {
         return NULL;
@@ -67,7 +267,8 @@ nxt_status_get(nxt_status_report_t *report, nxt_mp_t *mp)
     for (i = 0; i < report->apps_count; i++) {
         app = &report->apps[i];
 
-        app_obj = nxt_conf_create_object(mp, 2);
+        app_obj = nxt_conf_create_object(mp, 5 + app->dispatch
+                                             + app->autoscale);
         if (nxt_slow_path(app_obj == NULL)) {
             return NULL;
         }
@@ -99,7 +300,744 @@ nxt_status_get(nxt_status_report_t *report, nxt_mp_t *mp)
         nxt_conf_set_member(app_obj, &reqs_str, obj, 1);
 
         nxt_conf_set_member_integer(obj, &active_str, app->active_requests, 0);
+
+        ret = nxt_status_traffic_set(app_obj, 2, &app->traffic,
+                                     &app->queue_time, &app->service_time, mp);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return NULL;
+        }
+
+        n = 5;
+
+        if (app->dispatch) {
+            obj = nxt_conf_create_object(mp, 3);
+            if (nxt_slow_path(obj == NULL)) {
+                return NULL;
+            }
+
+            nxt_conf_set_member(app_obj, &dispatch_str, obj, n++);
+
+            nxt_conf_set_member_integer(obj, &direct_str,
+                                        app->dispatch_direct, 0);
+            nxt_conf_set_member_integer(obj, &contended_str,
+                                        app->dispatch_contended, 1);
+            nxt_conf_set_member_integer(obj, &stolen_str,
+                                        app->dispatch_stolen, 2);
+        }
+
+        if (app->autoscale) {
+            obj = nxt_conf_create_object(mp, 5);
+            if (nxt_slow_path(obj == NULL)) {
+                return NULL;
+            }
+
+            nxt_conf_set_member(app_obj, &autoscale_str, obj, n);
+
+            nxt_conf_set_member_integer(obj, &target_str,
+                                        app->scale_target, 0);
+            nxt_conf_set_member_integer(obj, &up_str, app->scale_ups, 1);
+            nxt_conf_set_member_integer(obj, &down_str, app->scale_downs, 2);
+            nxt_conf_set_member_integer(obj, &queue_time_str,
+                                        app->scale_queue_time, 3);
+            nxt_conf_set_member_integer(obj, &service_time_str,
+                                        app->scale_service_time, 4);
+        }
     }
 
     return status;
 }
+
+
+static nxt_int_t
+nxt_status_traffic_set(nxt_conf_value_t *obj, uint32_t n,
+    nxt_status_traffic_t *traffic, nxt_status_time_t *queue,
+    nxt_status_time_t *service, nxt_mp_t *mp)
+{
+    uint32_t          i;
+    nxt_conf_value_t  *value, *time;
+
+    static nxt_str_t responses_str = nxt_string("responses");
+    static nxt_str_t bytes_str = nxt_string("bytes");
+    static nxt_str_t in_str = nxt_string("in");
+    static nxt_str_t out_str = nxt_string("out");
+    static nxt_str_t latency_str = nxt_string("latency");
+    static nxt_str_t queue_str = nxt_string("queue");
+    static nxt_str_t service_str = nxt_string("service");
+    static nxt_str_t total_str = nxt_string("total");
+
+    static nxt_str_t  class_str[] = {
+        nxt_string("1xx"),
+        nxt_string("2xx"),
+        nxt_string("3xx"),
+        nxt_string("4xx"),
+        nxt_string("5xx"),
+    };
+
+    value = nxt_conf_create_object(mp, 5);
+    if (nxt_slow_path(value == NULL)) {
+        return NXT_ERROR;
+    }
+
+    nxt_conf_set_member(obj, &responses_str, value, n);
+
+    for (i = 0; i < 5; i++) {
+        nxt_conf_set_member_integer(value, &class_str[i],
+                                    traffic->responses[i], i);
+    }
+
+    value = nxt_conf_create_object(mp, 2);
+    if (nxt_slow_path(value == NULL)) {
+        return NXT_ERROR;
+    }
+
+    nxt_conf_set_member(obj, &bytes_str, value, n + 1);
+
+    nxt_conf_set_member_integer(value, &in_str, traffic->bytes_in, 0);
+    nxt_conf_set_member_integer(value, &out_str, traffic->bytes_out, 1);
+
+    value = nxt_conf_create_object(mp, (queue != NULL) ? 3 : 1);
+    if (nxt_slow_path(value == NULL)) {
+        return NXT_ERROR;
+    }
+
+    nxt_conf_set_member(obj, &latency_str, value, n + 2);
+
+    i = 0;
+
+    if (queue != NULL) {
+        time = nxt_status_time_get(queue, mp);
+        if (nxt_slow_path(time == NULL)) {
+            return NXT_ERROR;
+        }
+
+        nxt_conf_set_member(value, &queue_str, time, i++);
+
+        time = nxt_status_time_get(service, mp);
+        if (nxt_slow_path(time == NULL)) {
+            return NXT_ERROR;
+        }
+
+        nxt_conf_set_member(value, &service_str, time, i++);
+    }
+
+    time = nxt_status_time_get(&traffic->time, mp);
+    if (nxt_slow_path(time == NULL)) {
+        return NXT_ERROR;
+    }
+
+    nxt_conf_set_member(value, &total_str, time, i);
+
+    return NXT_OK;
+}
+
+
+static nxt_conf_value_t *
+nxt_status_time_get(nxt_status_time_t *time, nxt_mp_t *mp)
+{
+    uint64_t          count;
+    nxt_uint_t        i;
+    nxt_conf_value_t  *obj, *buckets;
+
+    static nxt_str_t count_str = nxt_string("count");
+    static nxt_str_t sum_str = nxt_string("sum");
+    static nxt_str_t buckets_str = nxt_string("buckets");
+
+    obj = nxt_conf_create_object(mp, 3);
+    if (nxt_slow_path(obj == NULL)) {
+        return NULL;
+    }
+
+    buckets = nxt_conf_create_object(mp, NXT_STATUS_TIME_BUCKETS);
+    if (nxt_slow_path(buckets == NULL)) {
+        return NULL;
+    }
+
+    count = 0;
+
+    for (i = 0; i < NXT_STATUS_TIME_BUCKETS; i++) {
+        count += time->count[i];
+
+        nxt_conf_set_member_integer(buckets, &nxt_status_time_buckets[i],
+                                    count, i);
+    }
+
+    nxt_conf_set_member_integer(obj, &count_str, count, 0);
+    nxt_conf_set_member_integer(obj, &sum_str, time->sum, 1);
+    nxt_conf_set_member(obj, &buckets_str, buckets, 2);
+
+    return obj;
+}
+
+
+/*
+ * Route steps are reported in the form of the "routes" configuration:
+ * an array of steps or an object of named arrays.
+ */
+
+static nxt_conf_value_t *
+nxt_status_routes_get(nxt_status_report_t *report, nxt_mp_t *mp)
+{
+    size_t                i;
+    uint32_t              step;
+    nxt_int_t             ret;
+    nxt_str_t             name;
+    nxt_conf_value_t      *routes, *steps, *obj;
+    nxt_status_route_t    *route;
+    nxt_status_traffic_t  *traffic;
+
+    route = nxt_pointer_to(report, (uintptr_t) report->routes);
+
+    if (report->routes_count == 1 && route->name.length == 0) {
+        routes = NULL;
+
+    } else {
+        routes = nxt_conf_create_object(mp, report->routes_count);
+        if (nxt_slow_path(routes == NULL)) {
+            return NULL;
+        }
+    }
+
+    for (i = 0; i < report->routes_count; i++, route++) {
+        steps = nxt_conf_create_array(mp, route->steps);
+        if (nxt_slow_path(steps == NULL)) {
+            return NULL;
+        }
+
+        traffic = nxt_pointer_to(report, (uintptr_t) route->traffic);
+
+        for (step = 0; step < route->steps; step++) {
+            obj = nxt_conf_create_object(mp, 3);
+            if (nxt_slow_path(obj == NULL)) {
+                return NULL;
+            }
+
+            nxt_conf_set_element(steps, step, obj);
+
+            ret = nxt_status_traffic_set(obj, 0, &traffic[step], NULL, NULL,
+                                         mp);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return NULL;
+            }
+        }
+
+        if (routes == NULL) {
+            return steps;
+        }
+
+        name.length = route->name.length;
+        name.start = nxt_pointer_to(report, (uintptr_t) route->name.start);
+
+        ret = nxt_conf_set_member_dup(routes, mp, &name, steps, i);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return NULL;
+        }
+    }
+
+    return routes;
+}
+
+
+/*
+ * The Prometheus text exposition format of the status.  Metric families
+ * must not be interleaved, so each family is printed for all objects of
+ * a scope before the next one.
+ */
+
+nxt_buf_t *
+nxt_status_metrics(nxt_conf_value_t *status, nxt_mp_t *mp)
+{
+    nxt_int_t                 ret;
+    nxt_array_t               *listeners, *routes, *apps, *root;
+    nxt_status_metrics_obj_t  *obj;
+    nxt_status_metrics_ctx_t  ctx;
+
+    static nxt_str_t listeners_str = nxt_string("listeners");
+    static nxt_str_t routes_str = nxt_string("routes");
+    static nxt_str_t apps_str = nxt_string("applications");
+
+    static nxt_str_t accepted_path = nxt_string("/connections/accepted");
+    static nxt_str_t active_path = nxt_string("/connections/active");
+    static nxt_str_t idle_path = nxt_string("/connections/idle");
+    static nxt_str_t closed_path = nxt_string("/connections/closed");
+    static nxt_str_t tls_path = nxt_string("/connections/tls");
+    static nxt_str_t ktls_path = nxt_string("/connections/ktls");
+    static nxt_str_t queued_path =
+                            nxt_string("/connections/tls_handshakes/queued");
+    static nxt_str_t handshake_path =
+                            nxt_string("/connections/tls_handshakes/latency");
+    static nxt_str_t requests_path = nxt_string("/requests/total");
+    static nxt_str_t reloads_path = nxt_string("/configuration/reloads");
+    static nxt_str_t running_path = nxt_string("/processes/running");
+    static nxt_str_t starting_path = nxt_string("/processes/starting");
+    static nxt_str_t procs_idle_path = nxt_string("/processes/idle");
+    static nxt_str_t req_active_path = nxt_string("/requests/active");
+    static nxt_str_t queue_path = nxt_string("/latency/queue");
+    static nxt_str_t service_path = nxt_string("/latency/service");
+
+    listeners = nxt_status_metrics_objects(status, &listeners_str,
+                                           "listener", mp);
+    routes = nxt_status_metrics_objects(status, &routes_str, "route", mp);
+    apps = nxt_status_metrics_objects(status, &apps_str, "application", mp);
+
+    if (nxt_slow_path(listeners == NULL || routes == NULL || apps == NULL)) {
+        return NULL;
+    }
+
+    /* The unlabeled status root for histograms. */
+
+    root = nxt_array_create(mp, 1, sizeof(nxt_status_metrics_obj_t));
+    if (nxt_slow_path(root == NULL)) {
+        return NULL;
+    }
+
+    obj = nxt_array_add(root);
+    if (nxt_slow_path(obj == NULL)) {
+        return NULL;
+    }
+
+    obj->value = status;
+    nxt_str_set(&obj->labels, "");
+
+    ctx.mp = mp;
+    ctx.status = status;
+    ctx.out = NULL;
+    ctx.last = NULL;
+
+    ret = nxt_status_metrics_counter(&ctx, "counter",
+                                     "unit_connections_accepted_total", NULL,
+                                     &accepted_path, NULL);
+    ret |= nxt_status_metrics_counter(&ctx, "gauge",
+                                      "unit_connections_active", NULL,
+                                      &active_path, NULL);
+    ret |= nxt_status_metrics_counter(&ctx, "gauge",
+                                      "unit_connections_idle", NULL,
+                                      &idle_path, NULL);
+    ret |= nxt_status_metrics_counter(&ctx, "counter",
+                                      "unit_connections_closed_total", NULL,
+                                      &closed_path, NULL);
+    ret |= nxt_status_metrics_counter(&ctx, "counter",
+                                      "unit_connections_tls_total", NULL,
+                                      &tls_path, NULL);
+    ret |= nxt_status_metrics_counter(&ctx, "counter",
+                                      "unit_connections_ktls_total", NULL,
+                                      &ktls_path, NULL);
+    ret |= nxt_status_metrics_counter(&ctx, "gauge",
+                                      "unit_connections_tls_handshakes_queued",
+                                      NULL, &queued_path, NULL);
+    ret |= nxt_status_metrics_time(&ctx, "connections", "tls_handshake",
+                                   &handshake_path, root);
+    ret |= nxt_status_metrics_counter(&ctx, "counter",
+                                      "unit_requests_total", NULL,
+                                      &requests_path, NULL);
+    ret |= nxt_status_metrics_counter(&ctx, "counter",
+                                      "unit_configuration_reloads_total",
+                                      NULL, &reloads_path, NULL);
+
+    ret |= nxt_status_metrics_traffic(&ctx, "listener", listeners);
+    ret |= nxt_status_metrics_traffic(&ctx, "route", routes);
+    ret |= nxt_status_metrics_traffic(&ctx, "application", apps);
+
+    ret |= nxt_status_metrics_time(&ctx, "application", "queue", &queue_path,
+                                   apps);
+    ret |= nxt_status_metrics_time(&ctx, "application", "service",
+                                   &service_path, apps);
+
+    ret |= nxt_status_metrics_counter(&ctx, "gauge",
+                                      "unit_application_processes",
+                                      "state=\"running\"", &running_path,
+                                      apps);
+    ret |= nxt_status_metrics_counter(&ctx, NULL,
+                                      "unit_application_processes",
+                                      "state=\"starting\"", &starting_path,
+                                      apps);
+    ret |= nxt_status_metrics_counter(&ctx, NULL,
+                                      "unit_application_processes",
+                                      "state=\"idle\"", &procs_idle_path,
+                                      apps);
+    ret |= nxt_status_metrics_counter(&ctx, "gauge",
+                                      "unit_application_requests_active",
+                                      NULL, &req_active_path, apps);
+
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return NULL;
+    }
+
+    return ctx.out;
+}
+
+
+static nxt_array_t *
+nxt_status_metrics_objects(nxt_conf_value_t *status, nxt_str_t *scope,
+    const char *label, nxt_mp_t *mp)
+{
+    uint32_t                  i, k, next, n;
+    nxt_str_t                 name;
+    nxt_int_t                 ret;
+    nxt_array_t               *objs;
+    nxt_conf_value_t          *value, *member, *steps;
+    nxt_status_metrics_obj_t  *obj;
+
+    objs = nxt_array_create(mp, 8, sizeof(nxt_status_metrics_obj_t));
+    if (nxt_slow_path(objs == NULL)) {
+        return NULL;
+    }
+
+    value = nxt_conf_get_object_member(status, scope, NULL);
+    if (value == NULL) {
+        return objs;
+    }
+
+    nxt_str_null(&name);
+
+    if (nxt_conf_type(value) == NXT_CONF_ARRAY) {
+        /* The unnamed route. */
+        n = 1;
+
+    } else {
+        n = nxt_conf_object_members_count(value);
+    }
+
+    next = 0;
+
+    for (i = 0; i < n; i++) {
+        if (nxt_conf_type(value) == NXT_CONF_ARRAY) {
+            member = value;
+
+        } else {
+            member = nxt_conf_next_object_member(value, &name, &next);
+        }
+
+        if (nxt_conf_type(member) != NXT_CONF_ARRAY) {
+            obj = nxt_array_add(objs);
+            if (nxt_slow_path(obj == NULL)) {
+                return NULL;
+            }
+
+            obj->value = member;
+
+            ret = nxt_status_metrics_label(mp, &obj->labels, label, &name, -1);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return NULL;
+            }
+
+            continue;
+        }
+
+        steps = member;
+
+        for (k = 0; k < nxt_conf_array_elements_count(steps); k++) {
+            obj = nxt_array_add(objs);
+            if (nxt_slow_path(obj == NULL)) {
+                return NULL;
+            }
+
+            obj->value = nxt_conf_get_array_element(steps, k);
+
+            ret = nxt_status_metrics_label(mp, &obj->labels, label, &name, k);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return NULL;
+            }
+        }
+    }
+
+    return objs;
+}
+
+
+static nxt_int_t
+nxt_status_metrics_label(nxt_mp_t *mp, nxt_str_t *labels, const char *label,
+    nxt_str_t *value, nxt_int_t step)
+{
+    u_char      *p, ch;
+    size_t      size;
+    nxt_uint_t  i;
+
+    size = nxt_strlen(label) + 2 * value->length
+           + nxt_length("=\"\",step=\"\"") + NXT_INT_T_LEN;
+
+    p = nxt_mp_nget(mp, size);
+    if (nxt_slow_path(p == NULL)) {
+        return NXT_ERROR;
+    }
+
+    labels->start = p;
+
+    p = nxt_sprintf(p, p + size, "%s=\"", label);
+
+    for (i = 0; i < value->length; i++) {
+        ch = value->start[i];
+
+        if (ch == '"' || ch == '\\') {
+            *p++ = '\\';
+
+        } else if (ch == '\n') {
+            *p++ = '\\';
+            ch = 'n';
+        }
+
+        *p++ = ch;
+    }
+
+    *p++ = '"';
+
+    if (step >= 0) {
+        p = nxt_sprintf(p, labels->start + size, ",step=\"%i\"", step);
+    }
+
+    labels->length = p - labels->start;
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+nxt_status_metrics_traffic(nxt_status_metrics_ctx_t *ctx, const char *scope,
+    nxt_array_t *objs)
+{
+    u_char      name[64];
+    nxt_int_t   ret;
+    nxt_uint_t  i;
+
+    static nxt_str_t in_path = nxt_string("/bytes/in");
+    static nxt_str_t out_path = nxt_string("/bytes/out");
+    static nxt_str_t total_path = nxt_string("/latency/total");
+
+    static nxt_str_t  class_path[] = {
+        nxt_string("/responses/1xx"),
+        nxt_string("/responses/2xx"),
+        nxt_string("/responses/3xx"),
+        nxt_string("/responses/4xx"),
+        nxt_string("/responses/5xx"),
+    };
+
+    static const char  *class_label[] = {
+        "code=\"1xx\"",
+        "code=\"2xx\"",
+        "code=\"3xx\"",
+        "code=\"4xx\"",
+        "code=\"5xx\"",
+    };
+
+    if (objs->nelts == 0) {
+        return NXT_OK;
+    }
+
+    *nxt_sprintf(name, name + sizeof(name) - 1, "unit_%s_responses_total",
+                 scope) = '\0';
+
+    ret = NXT_OK;
+
+    for (i = 0; i < 5; i++) {
+        ret |= nxt_status_metrics_counter(ctx, (i == 0) ? "counter" : NULL,
+                                          (char *) name, class_label[i],
+                                          &class_path[i], objs);
+    }
+
+    *nxt_sprintf(name, name + sizeof(name) - 1,
+                 "unit_%s_received_bytes_total", scope) = '\0';
+
+    ret |= nxt_status_metrics_counter(ctx, "counter", (char *) name, NULL,
+                                      &in_path, objs);
+
+    *nxt_sprintf(name, name + sizeof(name) - 1, "unit_%s_sent_bytes_total",
+                 scope) = '\0';
+
+    ret |= nxt_status_metrics_counter(ctx, "counter", (char *) name, NULL,
+                                      &out_path, objs);
+
+    ret |= nxt_status_metrics_time(ctx, scope, "request", &total_path, objs);
+
+    return ret;
+}
+
+
+static nxt_int_t
+nxt_status_metrics_time(nxt_status_metrics_ctx_t *ctx, const char *scope,
+    const char *name, nxt_str_t *path, nxt_array_t *objs)
+{
+    size_t                    size;
+    uint64_t                  count, sum;
+    uint32_t                  next;
+    nxt_int_t                 ret;
+    nxt_str_t                 le;
+    nxt_msec_t                ms;
+    nxt_uint_t                i, k;
+    const char                *sep, *lb, *rb;
+    nxt_conf_value_t          *time, *buckets, *value;
+    nxt_status_metrics_obj_t  *obj;
+
+    static nxt_str_t count_str = nxt_string("count");
+    static nxt_str_t sum_str = nxt_string("sum");
+    static nxt_str_t buckets_str = nxt_string("buckets");
+
+    if (objs->nelts == 0) {
+        return NXT_OK;
+    }
+
+    ret = nxt_status_metrics_printf(ctx, 256,
+                                    "# TYPE unit_%s_%s_duration_seconds "
+                                    "histogram\n", scope, name);
+
+    obj = objs->elts;
+
+    for (i = 0; i < objs->nelts; i++) {
+        time = nxt_conf_get_path(obj[i].value, path);
+        if (time == NULL) {
+            continue;
+        }
+
+        if (obj[i].labels.length != 0) {
+            sep = ",";
+            lb = "{";
+            rb = "}";
+
+        } else {
+            sep = "";
+            lb = "";
+            rb = "";
+        }
+
+        buckets = nxt_conf_get_object_member(time, &buckets_str, NULL);
+        next = 0;
+
+        for (k = 0; k < NXT_STATUS_TIME_BUCKETS; k++) {
+            value = nxt_conf_next_object_member(buckets, &le, &next);
+            if (nxt_slow_path(value == NULL)) {
+                break;
+            }
+
+            count = nxt_conf_get_number(value);
+
+            size = 256 + obj[i].labels.length;
+
+            if (k < NXT_STATUS_TIME_BUCKETS - 1) {
+                ms = nxt_status_time_bounds[k];
+
+                ret |= nxt_status_metrics_printf(ctx, size,
+                                          "unit_%s_%s_duration_seconds_bucket"
+                                          "{%V%sle=\"%M.%03M\"} %uL\n",
+                                          scope, name, &obj[i].labels, sep,
+                                          ms / 1000, ms % 1000, count);
+
+            } else {
+                ret |= nxt_status_metrics_printf(ctx, size,
+                                          "unit_%s_%s_duration_seconds_bucket"
+                                          "{%V%sle=\"+Inf\"} %uL\n",
+                                          scope, name, &obj[i].labels, sep,
+                                          count);
+            }
+        }
+
+        value = nxt_conf_get_object_member(time, &sum_str, NULL);
+        sum = (value != NULL) ? nxt_conf_get_number(value) : 0;
+
+        value = nxt_conf_get_object_member(time, &count_str, NULL);
+        count = (value != NULL) ? nxt_conf_get_number(value) : 0;
+
+        ret |= nxt_status_metrics_printf(ctx, 256 + 2 * obj[i].labels.length,
+                                         "unit_%s_%s_duration_seconds_sum"
+                                         "%s%V%s %uL.%03uL\n"
+                                         "unit_%s_%s_duration_seconds_count"
+                                         "%s%V%s %uL\n",
+                                         scope, name, lb, &obj[i].labels, rb,
+                                         sum / 1000, sum % 1000,
+                                         scope, name, lb, &obj[i].labels, rb,
+                                         count);
+    }
+
+    return ret;
+}
+
+
+/*
+ * A family of objs values at the path or, if objs is NULL, a single
+ * top-level value.  The type line is omitted if the type is NULL.
+ */
+
+static nxt_int_t
+nxt_status_metrics_counter(nxt_status_metrics_ctx_t *ctx, const char *type,
+    const char *name, const char *extra, nxt_str_t *path, nxt_array_t *objs)
+{
+    size_t                    size;
+    uint64_t                  n;
+    nxt_int_t                 ret;
+    nxt_uint_t                i;
+    nxt_conf_value_t          *value;
+    nxt_status_metrics_obj_t  *obj;
+
+    ret = NXT_OK;
+
+    if (objs != NULL && objs->nelts == 0) {
+        return ret;
+    }
+
+    if (type != NULL) {
+        ret = nxt_status_metrics_printf(ctx, 256, "# TYPE %s %s\n",
+                                        name, type);
+    }
+
+    if (objs == NULL) {
+        /* The path is relative to the status root. */
+        value = nxt_conf_get_path(ctx->status, path);
+
+        n = (value != NULL) ? nxt_conf_get_number(value) : 0;
+
+        return ret | nxt_status_metrics_printf(ctx, 256, "%s %uL\n", name, n);
+    }
+
+    obj = objs->elts;
+
+    for (i = 0; i < objs->nelts; i++) {
+        value = nxt_conf_get_path(obj[i].value, path);
+        if (value == NULL) {
+            continue;
+        }
+
+        n = nxt_conf_get_number(value);
+        size = 256 + obj[i].labels.length;
+
+        if (extra != NULL) {
+            ret |= nxt_status_metrics_printf(ctx, size, "%s{%V,%s} %uL\n",
+                                             name, &obj[i].labels, extra, n);
+
+        } else {
+            ret |= nxt_status_metrics_printf(ctx, size, "%s{%V} %uL\n",
+                                             name, &obj[i].labels, n);
+        }
+    }
+
+    return ret;
+}
+
+
+static nxt_int_t
+nxt_status_metrics_printf(nxt_status_metrics_ctx_t *ctx, size_t size,
+    const char *fmt, ...)
+{
+    va_list    args;
+    nxt_buf_t  *b;
+
+    b = ctx->last;
+
+    if (b == NULL || (size_t) (b->mem.end - b->mem.free) < size) {
+        b = nxt_buf_mem_alloc(ctx->mp, nxt_max(size, 4096), 0);
+        if (nxt_slow_path(b == NULL)) {
+            return NXT_ERROR;
+        }
+
+        if (ctx->last != NULL) {
+            ctx->last->next = b;
+
+        } else {
+            ctx->out = b;
+        }
+
+        ctx->last = b;
+    }
+
+    va_start(args, fmt);
+    b->mem.free = nxt_vsprintf(b->mem.free, b->mem.end, fmt, args);
+    va_end(args);
+
+    return NXT_OK;
+}
@@ -7,27 +7,98 @@
 #define _NXT_STATUS_H_INCLUDED_
 
 
+#define NXT_STATUS_TIME_BUCKETS  12
+
+
+/*
+ * Each router engine updates its own copy of counters without atomic
+ * operations, the report holds the sum of all copies.  Buckets are not
+ * cumulative.
+ */
+
+typedef struct {
+    uint64_t              count[NXT_STATUS_TIME_BUCKETS];
+    uint64_t              sum;  /* msec */
+} nxt_status_time_t;
+
+
+typedef struct {
+    uint64_t              bytes_in;
+    uint64_t              bytes_out;
+    uint64_t              responses[5];  /* 1xx ... 5xx */
+    nxt_status_time_t     time;
+} nxt_status_traffic_t;
+
+
 typedef struct {
-    nxt_str_t         name;
-    uint32_t          active_requests;
-    uint32_t          pending_processes;
-    uint32_t          processes;
-    uint32_t          idle_processes;
+    nxt_str_t             name;
+    nxt_status_traffic_t  traffic;
+} nxt_status_listener_t;
+
+
+typedef struct {
+    nxt_str_t             name;
+    uint32_t              steps;
+    nxt_status_traffic_t  *traffic;
+} nxt_status_route_t;
+
+
+typedef struct {
+    nxt_str_t             name;
+    uint32_t              active_requests;
+    uint32_t              pending_processes;
+    uint32_t              processes;
+    uint32_t              idle_processes;
+
+    uint8_t               dispatch;  /* 1 bit */
+    uint64_t              dispatch_direct;
+    uint64_t              dispatch_contended;
+    uint64_t              dispatch_stolen;
+
+    uint8_t               autoscale;  /* 1 bit */
+    uint32_t              scale_target;
+    uint64_t              scale_ups;
+    uint64_t              scale_downs;
+    nxt_msec_t            scale_queue_time;
+    nxt_msec_t            scale_service_time;
+
+    nxt_status_traffic_t  traffic;
+    nxt_status_time_t     queue_time;
+    nxt_status_time_t     service_time;
 } nxt_status_app_t;
 
 
 typedef struct {
-    uint64_t          accepted_conns;
-    uint64_t          idle_conns;
-    uint64_t          closed_conns;
-    uint64_t          requests;
+    uint64_t               accepted_conns;
+    uint64_t               idle_conns;
+    uint64_t               closed_conns;
+    uint64_t               tls_conns;
+    uint64_t               ktls_conns;
+    uint64_t               tls_handshakes_queued;
+    nxt_status_time_t      tls_handshake_time;
+    uint64_t               requests;
+
+    uint64_t               reloads;
+    uint64_t               reloads_unchanged;
+    nxt_msec_t             reload_time;
+    nxt_msec_t             reload_max_time;
+
+    size_t                 listeners_count;
+    nxt_status_listener_t  *listeners;
+    size_t                 routes_count;
+    nxt_status_route_t     *routes;
 
-    size_t            apps_count;
-    nxt_status_app_t  apps[];
+    size_t                 apps_count;
+    nxt_status_app_t       apps[];
 } nxt_status_report_t;
 
 
+void nxt_status_time_add(nxt_status_time_t *time, nxt_msec_t ms);
+void nxt_status_time_sum(nxt_status_time_t *sum, nxt_status_time_t *time);
+void nxt_status_traffic_sum(nxt_status_traffic_t *sum,
+    nxt_status_traffic_t *traffic);
 nxt_conf_value_t *nxt_status_get(nxt_status_report_t *report, nxt_mp_t *mp);
+nxt_buf_t *nxt_status_metrics(nxt_conf_value_t *status, nxt_mp_t *mp);
 
 
 #endif /* _NXT_STATUS_H_INCLUDED_ */
@@ -9,6 +9,7 @@
 
 
 #include <nxt_conf.h>
+#include <nxt_status.h>
 
 
 /*
@@ -41,6 +42,11 @@ typedef struct {
                                       nxt_bool_t last);
     void                          (*server_free)(nxt_task_t *task,
                                       nxt_tls_conf_t *conf);
+
+    nxt_int_t                     (*ocsp_check)(nxt_task_t *task,
+                                      nxt_tls_bundle_conf_t *bundle,
+                                      u_char *response, size_t size,
+                                      nxt_time_t *expires);
 } nxt_tls_lib_t;
 
 
@@ -51,12 +57,46 @@ typedef struct {
 } nxt_tls_bundle_hash_item_t;
 
 
+/*
+ * Handshake steps are run by a thread pool shared by all listeners
+ * with asynchronous handshake, so the engine threads are not blocked
+ * by private key operations.
+ */
+
+typedef struct {
+    nxt_thread_pool_t             *thread_pool;
+
+    nxt_atomic_uint_t             queued;
+    nxt_status_time_t             time;
+} nxt_tls_offload_t;
+
+
+/*
+ * A stapled OCSP response is replaced by the router main thread
+ * and copied by the engine threads while handshakes are running.
+ * The response is stapled until its "nextUpdate" time.
+ */
+
+typedef struct {
+    nxt_thread_spinlock_t         lock;
+
+    u_char                        *response;
+    size_t                        size;
+    nxt_time_t                    expires;
+
+    nxt_str_t                     path;
+    nxt_msec_t                    refresh;
+} nxt_tls_ocsp_t;
+
+
 struct nxt_tls_bundle_conf_s {
     void                          *ctx;
 
     nxt_fd_t                      chain_file;
     nxt_str_t                     name;
 
+    nxt_tls_ocsp_t                *ocsp;
+
     nxt_tls_bundle_conf_t         *next;
 };
 
@@ -72,6 +112,8 @@ struct nxt_tls_conf_s {
 
     const nxt_tls_lib_t           *lib;
 
+    nxt_tls_offload_t             *offload;
+
     char                          *ciphers;
 
     char                          *ca_certificate;
@@ -87,8 +129,12 @@ struct nxt_tls_init_s {
     nxt_time_t                    timeout;
     nxt_conf_value_t              *conf_cmds;
     nxt_conf_value_t              *tickets_conf;
+    nxt_conf_value_t              *ocsp_conf;
 
     nxt_tls_conf_t                *conf;
+
+    uint8_t                       ktls;             /* 1 bit */
+    uint8_t                       async_handshake;  /* 1 bit */
 };
 
 
@@ -69,6 +69,11 @@ nxt_tstr_state_new(nxt_mp_t *mp, nxt_bool_t test)
         return NULL;
     }
 
+    state->var_slots = nxt_array_create(mp, 4, sizeof(uint32_t));
+    if (nxt_slow_path(state->var_slots == NULL)) {
+        return NULL;
+    }
+
 #if (NXT_HAVE_NJS)
     state->jcf = nxt_js_conf_new(mp);
     if (nxt_slow_path(state->jcf == NULL)) {
@@ -134,7 +139,8 @@ nxt_tstr_compile(nxt_tstr_state_t *state, nxt_str_t *str,
             tstr->type = NXT_TSTR_VAR;
 
             tstr->u.var = nxt_var_compile(&tstr->str, state->pool,
-                                          state->var_fields);
+                                          state->var_fields,
+                                          state->var_slots);
             if (nxt_slow_path(tstr->u.var == NULL)) {
                 return NULL;
             }
@@ -241,6 +247,10 @@ nxt_tstr_query_init(nxt_tstr_query_t **query_p, nxt_tstr_state_t *state,
     query->cache = cache;
     query->ctx = ctx;
 
+    if (cache->var.values == NULL) {
+        cache->var.nvalues = state->var_slots->nelts;
+    }
+
     *query_p = query;
 
     return NXT_OK;
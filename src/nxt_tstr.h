@@ -16,6 +16,7 @@ typedef struct nxt_tstr_query_s  nxt_tstr_query_t;
 typedef struct {
     nxt_mp_t            *pool;
     nxt_array_t         *var_fields;
+    nxt_array_t         *var_slots;
 #if (NXT_HAVE_NJS)
     nxt_js_conf_t       *jcf;
 #endif
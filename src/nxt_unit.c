@@ -24,6 +24,13 @@
 #define NXT_UNIT_LOCAL_BUF_SIZE  \
     (NXT_UNIT_MAX_PLAIN_SIZE + sizeof(nxt_port_msg_t))
 
+/* Maximum number of requests taken from the shared queue per wakeup. */
+#define NXT_UNIT_SHARED_BATCH    16
+
+/* Number of streams acknowledged by a message that fits the port queue. */
+#define NXT_UNIT_ACK_STREAMS                                                  \
+    (1 + (NXT_PORT_QUEUE_MSG_SIZE - sizeof(nxt_port_msg_t)) / sizeof(uint32_t))
+
 enum {
     NXT_QUIT_NORMAL   = 0,
     NXT_QUIT_GRACEFUL = 1,
@@ -36,6 +43,7 @@ typedef struct nxt_unit_process_s               nxt_unit_process_t;
 typedef struct nxt_unit_mmap_buf_s              nxt_unit_mmap_buf_t;
 typedef struct nxt_unit_recv_msg_s              nxt_unit_recv_msg_t;
 typedef struct nxt_unit_read_buf_s              nxt_unit_read_buf_t;
+typedef struct nxt_unit_req_batch_s             nxt_unit_req_batch_t;
 typedef struct nxt_unit_ctx_impl_s              nxt_unit_ctx_impl_t;
 typedef struct nxt_unit_port_impl_s             nxt_unit_port_impl_t;
 typedef struct nxt_unit_request_info_impl_s     nxt_unit_request_info_impl_t;
@@ -61,17 +69,22 @@ static int nxt_unit_read_env(nxt_unit_port_t *ready_port,
 static int nxt_unit_ready(nxt_unit_ctx_t *ctx, int ready_fd, uint32_t stream,
     int queue_fd);
 static int nxt_unit_process_msg(nxt_unit_ctx_t *ctx, nxt_unit_read_buf_t *rbuf,
-    nxt_unit_request_info_t **preq);
+    nxt_unit_request_info_t **preq, nxt_unit_req_batch_t *batch);
 static int nxt_unit_process_new_port(nxt_unit_ctx_t *ctx,
     nxt_unit_recv_msg_t *recv_msg);
 static int nxt_unit_ctx_ready(nxt_unit_ctx_t *ctx);
 static int nxt_unit_process_req_headers(nxt_unit_ctx_t *ctx,
-    nxt_unit_recv_msg_t *recv_msg, nxt_unit_request_info_t **preq);
+    nxt_unit_recv_msg_t *recv_msg, nxt_unit_request_info_t **preq,
+    nxt_unit_req_batch_t *batch);
 static int nxt_unit_process_req_body(nxt_unit_ctx_t *ctx,
     nxt_unit_recv_msg_t *recv_msg);
 static int nxt_unit_request_check_response_port(nxt_unit_request_info_t *req,
     nxt_unit_port_id_t *port_id);
-static int nxt_unit_send_req_headers_ack(nxt_unit_request_info_t *req);
+static int nxt_unit_request_expired(nxt_unit_request_info_t *req);
+static int nxt_unit_send_req_headers_ack(nxt_unit_request_info_t **req,
+    uint32_t n);
+static void nxt_unit_process_req_batch(nxt_unit_ctx_t *ctx,
+    nxt_unit_req_batch_t *batch);
 static int nxt_unit_process_websocket(nxt_unit_ctx_t *ctx,
     nxt_unit_recv_msg_t *recv_msg);
 static int nxt_unit_process_shm_ack(nxt_unit_ctx_t *ctx);
@@ -88,6 +101,11 @@ static nxt_unit_mmap_buf_t *nxt_unit_mmap_buf_get(nxt_unit_ctx_t *ctx);
 static void nxt_unit_mmap_buf_release(nxt_unit_mmap_buf_t *mmap_buf);
 static int nxt_unit_mmap_buf_send(nxt_unit_request_info_t *req,
     nxt_unit_mmap_buf_t *mmap_buf, int last);
+static int nxt_unit_mmap_buf_send_msg(nxt_unit_ctx_t *ctx,
+    nxt_unit_port_t *port, uint32_t stream, uint8_t type,
+    nxt_unit_mmap_buf_t *mmap_buf, int last);
+static int nxt_unit_websocket_channel_send(nxt_unit_request_info_t *req,
+    uint8_t type, const char *channel, uint8_t channel_length);
 static void nxt_unit_mmap_buf_free(nxt_unit_mmap_buf_t *mmap_buf);
 static void nxt_unit_free_outgoing_buf(nxt_unit_mmap_buf_t *mmap_buf);
 static nxt_unit_read_buf_t *nxt_unit_read_buf_get(nxt_unit_ctx_t *ctx);
@@ -284,6 +302,17 @@ struct nxt_unit_read_buf_s {
 };
 
 
+/*
+ * Requests taken from the shared queue in one go; their headers are
+ * acknowledged together and handlers are called after that.
+ */
+struct nxt_unit_req_batch_s {
+    uint32_t                      nreq;
+    uint8_t                       handle[NXT_UNIT_SHARED_BATCH];
+    nxt_unit_request_info_t       *req[NXT_UNIT_SHARED_BATCH];
+};
+
+
 struct nxt_unit_ctx_impl_s {
     nxt_unit_ctx_t                ctx;
 
@@ -971,7 +1000,7 @@ nxt_unit_ready(nxt_unit_ctx_t *ctx, int ready_fd, uint32_t stream, int queue_fd)
 
 static int
 nxt_unit_process_msg(nxt_unit_ctx_t *ctx, nxt_unit_read_buf_t *rbuf,
-    nxt_unit_request_info_t **preq)
+    nxt_unit_request_info_t **preq, nxt_unit_req_batch_t *batch)
 {
     int                  rc;
     pid_t                pid;
@@ -1110,7 +1139,7 @@ nxt_unit_process_msg(nxt_unit_ctx_t *ctx, nxt_unit_read_buf_t *rbuf,
         break;
 
     case _NXT_PORT_MSG_REQ_HEADERS:
-        rc = nxt_unit_process_req_headers(ctx, &recv_msg, preq);
+        rc = nxt_unit_process_req_headers(ctx, &recv_msg, preq, batch);
         break;
 
     case _NXT_PORT_MSG_REQ_BODY:
@@ -1282,7 +1311,7 @@ nxt_unit_ctx_ready(nxt_unit_ctx_t *ctx)
 
 static int
 nxt_unit_process_req_headers(nxt_unit_ctx_t *ctx, nxt_unit_recv_msg_t *recv_msg,
-    nxt_unit_request_info_t **preq)
+    nxt_unit_request_info_t **preq, nxt_unit_req_batch_t *batch)
 {
     int                           res;
     nxt_unit_impl_t               *lib;
@@ -1368,11 +1397,26 @@ nxt_unit_process_req_headers(nxt_unit_ctx_t *ctx, nxt_unit_recv_msg_t *recv_msg,
     }
 
     if (nxt_fast_path(res == NXT_UNIT_OK)) {
-        res = nxt_unit_send_req_headers_ack(req);
-        if (nxt_slow_path(res == NXT_UNIT_ERROR)) {
+        if (nxt_slow_path(nxt_unit_request_expired(req))) {
             nxt_unit_request_done(req, NXT_UNIT_ERROR);
 
-            return NXT_UNIT_ERROR;
+            return NXT_UNIT_OK;
+        }
+
+        if (batch != NULL && batch->nreq < NXT_UNIT_SHARED_BATCH) {
+            batch->req[batch->nreq] = req;
+            batch->handle[batch->nreq] = 0;
+            batch->nreq++;
+
+        } else {
+            batch = NULL;
+
+            res = nxt_unit_send_req_headers_ack(&req, 1);
+            if (nxt_slow_path(res == NXT_UNIT_ERROR)) {
+                nxt_unit_request_done(req, NXT_UNIT_ERROR);
+
+                return NXT_UNIT_ERROR;
+            }
         }
 
         lib = nxt_container_of(ctx->unit, nxt_unit_impl_t, unit);
@@ -1384,6 +1428,10 @@ nxt_unit_process_req_headers(nxt_unit_ctx_t *ctx, nxt_unit_recv_msg_t *recv_msg,
             if (nxt_slow_path(res != NXT_UNIT_OK)) {
                 nxt_unit_req_warn(req, "failed to add request to hash");
 
+                if (batch != NULL) {
+                    batch->nreq--;
+                }
+
                 nxt_unit_request_done(req, NXT_UNIT_ERROR);
 
                 return NXT_UNIT_ERROR;
@@ -1398,7 +1446,10 @@ nxt_unit_process_req_headers(nxt_unit_ctx_t *ctx, nxt_unit_recv_msg_t *recv_msg,
             }
         }
 
-        if (preq == NULL) {
+        if (batch != NULL) {
+            batch->handle[batch->nreq - 1] = 1;
+
+        } else if (preq == NULL) {
             lib->callbacks.request_handler(req);
 
         } else {
@@ -1463,6 +1514,38 @@ nxt_unit_process_req_body(nxt_unit_ctx_t *ctx, nxt_unit_recv_msg_t *recv_msg)
 }
 
 
+/*
+ * The router sets the deadline when the application has "queue_timeout";
+ * by then the client already got 503, so the request is dropped unhandled.
+ */
+static int
+nxt_unit_request_expired(nxt_unit_request_info_t *req)
+{
+    uint32_t             now;
+    struct timespec      ts;
+    nxt_unit_request_t  *r;
+
+    r = req->request;
+
+    if (r->deadline == 0) {
+        return 0;
+    }
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    now = (uint64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+
+    if ((int32_t) (now - r->deadline) < 0) {
+        return 0;
+    }
+
+    nxt_unit_req_debug(req, "deadline expired %"PRIu32" ms ago",
+                       now - r->deadline);
+
+    return 1;
+}
+
+
 static int
 nxt_unit_request_check_response_port(nxt_unit_request_info_t *req,
     nxt_unit_port_id_t *port_id)
@@ -1587,29 +1670,47 @@ nxt_unit_request_check_response_port(nxt_unit_request_info_t *req,
 }
 
 
+/*
+ * Acknowledges up to NXT_UNIT_ACK_STREAMS requests with the same response
+ * port: the first stream is in the message header, the rest follow it.
+ */
 static int
-nxt_unit_send_req_headers_ack(nxt_unit_request_info_t *req)
+nxt_unit_send_req_headers_ack(nxt_unit_request_info_t **req, uint32_t n)
 {
+    size_t                        size;
     ssize_t                       res;
-    nxt_port_msg_t                msg;
+    uint32_t                      i;
     nxt_unit_impl_t               *lib;
     nxt_unit_ctx_impl_t           *ctx_impl;
     nxt_unit_request_info_impl_t  *req_impl;
 
-    lib = nxt_container_of(req->ctx->unit, nxt_unit_impl_t, unit);
-    ctx_impl = nxt_container_of(req->ctx, nxt_unit_ctx_impl_t, ctx);
-    req_impl = nxt_container_of(req, nxt_unit_request_info_impl_t, req);
+    struct {
+        nxt_port_msg_t            msg;
+        uint32_t                  stream[NXT_UNIT_ACK_STREAMS - 1];
+    } m;
 
-    memset(&msg, 0, sizeof(nxt_port_msg_t));
+    lib = nxt_container_of(req[0]->ctx->unit, nxt_unit_impl_t, unit);
+    ctx_impl = nxt_container_of(req[0]->ctx, nxt_unit_ctx_impl_t, ctx);
+    req_impl = nxt_container_of(req[0], nxt_unit_request_info_impl_t, req);
 
-    msg.stream = req_impl->stream;
-    msg.pid = lib->pid;
-    msg.reply_port = ctx_impl->read_port->id.id;
-    msg.type = _NXT_PORT_MSG_REQ_HEADERS_ACK;
+    memset(&m.msg, 0, sizeof(nxt_port_msg_t));
 
-    res = nxt_unit_port_send(req->ctx, req->response_port,
-                             &msg, sizeof(msg), NULL);
-    if (nxt_slow_path(res != sizeof(msg))) {
+    m.msg.stream = req_impl->stream;
+    m.msg.pid = lib->pid;
+    m.msg.reply_port = ctx_impl->read_port->id.id;
+    m.msg.type = _NXT_PORT_MSG_REQ_HEADERS_ACK;
+
+    for (i = 1; i < n; i++) {
+        req_impl = nxt_container_of(req[i], nxt_unit_request_info_impl_t, req);
+
+        m.stream[i - 1] = req_impl->stream;
+    }
+
+    size = sizeof(nxt_port_msg_t) + (n - 1) * sizeof(uint32_t);
+
+    res = nxt_unit_port_send(req[0]->ctx, req[0]->response_port,
+                             &m, size, NULL);
+    if (nxt_slow_path(res != (ssize_t) size)) {
         return NXT_UNIT_ERROR;
     }
 
@@ -1617,6 +1718,69 @@ nxt_unit_send_req_headers_ack(nxt_unit_request_info_t *req)
 }
 
 
+static void
+nxt_unit_process_req_batch(nxt_unit_ctx_t *ctx, nxt_unit_req_batch_t *batch)
+{
+    int                      res;
+    uint32_t                 i, j, n, nready;
+    nxt_unit_impl_t          *lib;
+    nxt_unit_port_t          *port;
+    nxt_unit_request_info_t  *req[NXT_UNIT_ACK_STREAMS];
+    nxt_unit_request_info_t  *ready[NXT_UNIT_SHARED_BATCH];
+
+    nready = 0;
+
+    for (i = 0; i < batch->nreq; i++) {
+        if (batch->req[i] == NULL) {
+            continue;
+        }
+
+        port = batch->req[i]->response_port;
+        n = 0;
+
+        for (j = i; j < batch->nreq && n < NXT_UNIT_ACK_STREAMS; j++) {
+            if (batch->req[j] != NULL
+                && batch->req[j]->response_port == port)
+            {
+                req[n++] = batch->req[j];
+            }
+        }
+
+        nxt_unit_debug(ctx, "port{%d,%d} ack %d request(s)",
+                       (int) port->id.pid, (int) port->id.id, (int) n);
+
+        res = nxt_unit_send_req_headers_ack(req, n);
+
+        for (j = i; n > 0; j++) {
+            if (batch->req[j] == NULL
+                || batch->req[j]->response_port != port)
+            {
+                continue;
+            }
+
+            n--;
+
+            if (nxt_slow_path(res != NXT_UNIT_OK)) {
+                nxt_unit_request_done(batch->req[j], NXT_UNIT_ERROR);
+
+            } else if (batch->handle[j]) {
+                ready[nready++] = batch->req[j];
+            }
+
+            batch->req[j] = NULL;
+        }
+    }
+
+    batch->nreq = 0;
+
+    lib = nxt_container_of(ctx->unit, nxt_unit_impl_t, unit);
+
+    for (i = 0; i < nready; i++) {
+        lib->callbacks.request_handler(ready[i]);
+    }
+}
+
+
 static int
 nxt_unit_process_websocket(nxt_unit_ctx_t *ctx, nxt_unit_recv_msg_t *recv_msg)
 {
@@ -2627,33 +2791,45 @@ nxt_unit_buf_send_done(nxt_unit_buf_t *buf)
 static int
 nxt_unit_mmap_buf_send(nxt_unit_request_info_t *req,
     nxt_unit_mmap_buf_t *mmap_buf, int last)
+{
+    nxt_unit_request_info_impl_t  *req_impl;
+
+    req_impl = nxt_container_of(req, nxt_unit_request_info_impl_t, req);
+
+    return nxt_unit_mmap_buf_send_msg(req->ctx, req->response_port,
+                                      req_impl->stream, _NXT_PORT_MSG_DATA,
+                                      mmap_buf, last);
+}
+
+
+static int
+nxt_unit_mmap_buf_send_msg(nxt_unit_ctx_t *ctx, nxt_unit_port_t *port,
+    uint32_t stream, uint8_t type, nxt_unit_mmap_buf_t *mmap_buf, int last)
 {
     struct {
         nxt_port_msg_t       msg;
         nxt_port_mmap_msg_t  mmap_msg;
     } m;
 
-    int                           rc;
-    u_char                        *last_used, *first_free;
-    ssize_t                       res;
-    nxt_chunk_id_t                first_free_chunk;
-    nxt_unit_buf_t                *buf;
-    nxt_unit_impl_t               *lib;
-    nxt_port_mmap_header_t        *hdr;
-    nxt_unit_request_info_impl_t  *req_impl;
+    int                     rc;
+    u_char                  *last_used, *first_free;
+    ssize_t                 res;
+    nxt_chunk_id_t          first_free_chunk;
+    nxt_unit_buf_t          *buf;
+    nxt_unit_impl_t         *lib;
+    nxt_port_mmap_header_t  *hdr;
 
-    lib = nxt_container_of(req->ctx->unit, nxt_unit_impl_t, unit);
-    req_impl = nxt_container_of(req, nxt_unit_request_info_impl_t, req);
+    lib = nxt_container_of(ctx->unit, nxt_unit_impl_t, unit);
 
     buf = &mmap_buf->buf;
     hdr = mmap_buf->hdr;
 
     m.mmap_msg.size = buf->free - buf->start;
 
-    m.msg.stream = req_impl->stream;
+    m.msg.stream = stream;
     m.msg.pid = lib->pid;
     m.msg.reply_port = 0;
-    m.msg.type = _NXT_PORT_MSG_DATA;
+    m.msg.type = type;
     m.msg.last = last != 0;
     m.msg.mmap = hdr != NULL && m.mmap_msg.size > 0;
     m.msg.nf = 0;
@@ -2666,14 +2842,13 @@ nxt_unit_mmap_buf_send(nxt_unit_request_info_t *req,
         m.mmap_msg.chunk_id = nxt_port_mmap_chunk_id(hdr,
                                                      (u_char *) buf->start);
 
-        nxt_unit_debug(req->ctx, "#%"PRIu32": send mmap: (%d,%d,%d)",
-                       req_impl->stream,
+        nxt_unit_debug(ctx, "#%"PRIu32": send mmap: (%d,%d,%d)",
+                       stream,
                        (int) m.mmap_msg.mmap_id,
                        (int) m.mmap_msg.chunk_id,
                        (int) m.mmap_msg.size);
 
-        res = nxt_unit_port_send(req->ctx, req->response_port, &m, sizeof(m),
-                                 NULL);
+        res = nxt_unit_port_send(ctx, port, &m, sizeof(m), NULL);
         if (nxt_slow_path(res != sizeof(m))) {
             goto free_buf;
         }
@@ -2702,29 +2877,28 @@ nxt_unit_mmap_buf_send(nxt_unit_request_info_t *req,
         nxt_atomic_fetch_add(&lib->outgoing.allocated_chunks,
                             (int) m.mmap_msg.chunk_id - (int) first_free_chunk);
 
-        nxt_unit_debug(req->ctx, "allocated_chunks %d",
+        nxt_unit_debug(ctx, "allocated_chunks %d",
                        (int) lib->outgoing.allocated_chunks);
 
     } else {
         if (nxt_slow_path(mmap_buf->plain_ptr == NULL
                           || mmap_buf->plain_ptr > buf->start - sizeof(m.msg)))
         {
-            nxt_unit_alert(req->ctx,
+            nxt_unit_alert(ctx,
                            "#%"PRIu32": failed to send plain memory buffer"
                            ": no space reserved for message header",
-                           req_impl->stream);
+                           stream);
 
             goto free_buf;
         }
 
         memcpy(buf->start - sizeof(m.msg), &m.msg, sizeof(m.msg));
 
-        nxt_unit_debug(req->ctx, "#%"PRIu32": send plain: %d",
-                       req_impl->stream,
+        nxt_unit_debug(ctx, "#%"PRIu32": send plain: %d",
+                       stream,
                        (int) (sizeof(m.msg) + m.mmap_msg.size));
 
-        res = nxt_unit_port_send(req->ctx, req->response_port,
-                                 buf->start - sizeof(m.msg),
+        res = nxt_unit_port_send(ctx, port, buf->start - sizeof(m.msg),
                                  m.mmap_msg.size + sizeof(m.msg), NULL);
 
         if (nxt_slow_path(res != (ssize_t) (m.mmap_msg.size + sizeof(m.msg)))) {
@@ -3411,27 +3585,152 @@ nxt_unit_websocket_sendv(nxt_unit_request_info_t *req, uint8_t opcode,
 }
 
 
+int
+nxt_unit_websocket_subscribe(nxt_unit_request_info_t *req,
+    const char *channel, uint8_t channel_length)
+{
+    return nxt_unit_websocket_channel_send(req,
+                                           NXT_WEBSOCKET_CHANNEL_SUBSCRIBE,
+                                           channel, channel_length);
+}
+
+
+int
+nxt_unit_websocket_unsubscribe(nxt_unit_request_info_t *req,
+    const char *channel, uint8_t channel_length)
+{
+    return nxt_unit_websocket_channel_send(req,
+                                           NXT_WEBSOCKET_CHANNEL_UNSUBSCRIBE,
+                                           channel, channel_length);
+}
+
+
+static int
+nxt_unit_websocket_channel_send(nxt_unit_request_info_t *req, uint8_t type,
+    const char *channel, uint8_t channel_length)
+{
+    size_t                        size;
+    ssize_t                       res;
+    nxt_unit_impl_t               *lib;
+    nxt_unit_request_info_impl_t  *req_impl;
+
+    struct {
+        nxt_port_msg_t               msg;
+        nxt_websocket_channel_msg_t  channel;
+        char                         name[255];
+    } m;
+
+    if (nxt_slow_path(channel_length == 0)) {
+        nxt_unit_req_warn(req, "websocket channel name is empty");
+
+        return NXT_UNIT_ERROR;
+    }
+
+    lib = nxt_container_of(req->ctx->unit, nxt_unit_impl_t, unit);
+    req_impl = nxt_container_of(req, nxt_unit_request_info_impl_t, req);
+
+    memset(&m.msg, 0, sizeof(nxt_port_msg_t));
+
+    m.msg.stream = req_impl->stream;
+    m.msg.pid = lib->pid;
+    m.msg.type = _NXT_PORT_MSG_WEBSOCKET;
+
+    m.channel.type = type;
+    m.channel.name_length = channel_length;
+
+    memcpy(m.name, channel, channel_length);
+
+    size = sizeof(nxt_port_msg_t) + sizeof(nxt_websocket_channel_msg_t)
+           + channel_length;
+
+    res = nxt_unit_port_send(req->ctx, req->response_port, &m, size, NULL);
+    if (nxt_slow_path(res != (ssize_t) size)) {
+        return NXT_UNIT_ERROR;
+    }
+
+    return NXT_UNIT_OK;
+}
+
+
+int
+nxt_unit_websocket_publish(nxt_unit_ctx_t *ctx, const char *channel,
+    uint8_t channel_length, uint8_t opcode, const void *start, size_t size)
+{
+    int                          rc;
+    size_t                       buf_size;
+    nxt_unit_buf_t               *buf;
+    nxt_unit_impl_t              *lib;
+    nxt_unit_mmap_buf_t          mmap_buf;
+    nxt_websocket_header_t       *wh;
+    nxt_websocket_channel_msg_t  *cm;
+    char                         local_buf[NXT_UNIT_LOCAL_BUF_SIZE];
+
+    lib = nxt_container_of(ctx->unit, nxt_unit_impl_t, unit);
+
+    if (nxt_slow_path(channel_length == 0)) {
+        nxt_unit_warn(ctx, "websocket channel name is empty");
+
+        return NXT_UNIT_ERROR;
+    }
+
+    /* The router fans out only frames sent in a single buffer. */
+
+    buf_size = sizeof(nxt_websocket_channel_msg_t) + channel_length
+               + 10 + size;
+
+    if (nxt_slow_path(buf_size > PORT_MMAP_DATA_SIZE)) {
+        nxt_unit_warn(ctx, "websocket publish frame too large: %d",
+                      (int) size);
+
+        return NXT_UNIT_ERROR;
+    }
+
+    rc = nxt_unit_get_outgoing_buf(ctx, lib->router_port, buf_size, buf_size,
+                                   &mmap_buf, local_buf);
+    if (nxt_slow_path(rc != NXT_UNIT_OK)) {
+        return rc;
+    }
+
+    buf = &mmap_buf.buf;
+
+    cm = (void *) buf->free;
+    cm->type = NXT_WEBSOCKET_CHANNEL_PUBLISH;
+    cm->name_length = channel_length;
+
+    buf->free = nxt_cpymem(buf->free + sizeof(nxt_websocket_channel_msg_t),
+                           channel, channel_length);
+
+    buf->free[0] = 0;
+    buf->free[1] = 0;
+
+    wh = (void *) buf->free;
+
+    buf->free = nxt_websocket_frame_init(wh, size);
+    wh->fin = 1;
+    wh->opcode = opcode;
+
+    buf->free = nxt_cpymem(buf->free, start, size);
+
+    return nxt_unit_mmap_buf_send_msg(ctx, lib->router_port, 0,
+                                      _NXT_PORT_MSG_WEBSOCKET, &mmap_buf, 0);
+}
+
+
 ssize_t
 nxt_unit_websocket_read(nxt_unit_websocket_frame_t *ws, void *dst,
     size_t size)
 {
-    ssize_t   res;
-    uint8_t   *b;
-    uint64_t  i, d;
+    ssize_t  res;
 
     res = nxt_unit_buf_read(&ws->content_buf, &ws->content_length,
                             dst, size);
 
-    if (ws->mask == NULL) {
+    if (ws->mask == NULL || res <= 0) {
         return res;
     }
 
-    b = dst;
-    d = (ws->payload_len - ws->content_length - res) % 4;
-
-    for (i = 0; i < (uint64_t) res; i++) {
-        b[i] ^= ws->mask[ (i + d) % 4 ];
-    }
+    nxt_websocket_unmask(dst, res, ws->mask,
+                         ws->payload_len - ws->content_length - res);
 
     return res;
 }
@@ -4589,7 +4888,7 @@ nxt_unit_run_once_impl(nxt_unit_ctx_t *ctx)
         return rc;
     }
 
-    rc = nxt_unit_process_msg(ctx, rbuf, NULL);
+    rc = nxt_unit_process_msg(ctx, rbuf, NULL, NULL);
     if (nxt_slow_path(rc == NXT_UNIT_ERROR)) {
         return NXT_UNIT_ERROR;
     }
@@ -4762,7 +5061,7 @@ nxt_unit_process_pending_rbuf(nxt_unit_ctx_t *ctx)
     nxt_queue_each(rbuf, &pending_rbuf, nxt_unit_read_buf_t, link) {
 
         if (nxt_fast_path(rc != NXT_UNIT_ERROR)) {
-            rc = nxt_unit_process_msg(&ctx_impl->ctx, rbuf, NULL);
+            rc = nxt_unit_process_msg(&ctx_impl->ctx, rbuf, NULL, NULL);
 
         } else {
             nxt_unit_read_buf_release(ctx, rbuf);
@@ -4812,7 +5111,13 @@ nxt_unit_process_ready_req(nxt_unit_ctx_t *ctx)
 
         req = &req_impl->req;
 
-        res = nxt_unit_send_req_headers_ack(req);
+        if (nxt_slow_path(nxt_unit_request_expired(req))) {
+            nxt_unit_request_done(req, NXT_UNIT_ERROR);
+
+            continue;
+        }
+
+        res = nxt_unit_send_req_headers_ack(&req, 1);
         if (nxt_slow_path(res != NXT_UNIT_OK)) {
             nxt_unit_request_done(req, NXT_UNIT_ERROR);
 
@@ -4873,7 +5178,7 @@ nxt_unit_run_ctx(nxt_unit_ctx_t *ctx)
             goto retry;
         }
 
-        rc = nxt_unit_process_msg(ctx, rbuf, NULL);
+        rc = nxt_unit_process_msg(ctx, rbuf, NULL, NULL);
         if (nxt_slow_path(rc == NXT_UNIT_ERROR)) {
             break;
         }
@@ -4951,36 +5256,71 @@ nxt_unit_is_quit(nxt_unit_read_buf_t *rbuf)
 int
 nxt_unit_run_shared(nxt_unit_ctx_t *ctx)
 {
-    int                  rc;
-    nxt_unit_impl_t      *lib;
-    nxt_unit_read_buf_t  *rbuf;
+    int                   rc;
+    uint32_t              i, n;
+    nxt_unit_impl_t       *lib;
+    nxt_unit_read_buf_t   *rbuf[NXT_UNIT_SHARED_BATCH];
+    nxt_unit_req_batch_t  batch;
 
     nxt_unit_ctx_use(ctx);
 
     lib = nxt_container_of(ctx->unit, nxt_unit_impl_t, unit);
 
     rc = NXT_UNIT_OK;
+    batch.nreq = 0;
 
     while (nxt_fast_path(nxt_unit_chk_ready(ctx))) {
-        rbuf = nxt_unit_read_buf_get(ctx);
-        if (nxt_slow_path(rbuf == NULL)) {
+        rbuf[0] = nxt_unit_read_buf_get(ctx);
+        if (nxt_slow_path(rbuf[0] == NULL)) {
             rc = NXT_UNIT_ERROR;
             break;
         }
 
     retry:
 
-        rc = nxt_unit_shared_port_recv(ctx, lib->shared_port, rbuf);
+        rc = nxt_unit_shared_port_recv(ctx, lib->shared_port, rbuf[0]);
         if (rc == NXT_UNIT_AGAIN) {
             goto retry;
         }
 
         if (nxt_slow_path(rc == NXT_UNIT_ERROR)) {
-            nxt_unit_read_buf_release(ctx, rbuf);
+            nxt_unit_read_buf_release(ctx, rbuf[0]);
             break;
         }
 
-        rc = nxt_unit_process_msg(ctx, rbuf, NULL);
+        /* Take the rest of already queued requests without waiting. */
+
+        for (n = 1; n < NXT_UNIT_SHARED_BATCH; n++) {
+            if (!nxt_unit_chk_ready(ctx)) {
+                break;
+            }
+
+            rbuf[n] = nxt_unit_read_buf_get(ctx);
+            if (nxt_slow_path(rbuf[n] == NULL)) {
+                break;
+            }
+
+            if (nxt_unit_app_queue_recv(ctx, lib->shared_port, rbuf[n])
+                != NXT_UNIT_OK)
+            {
+                nxt_unit_read_buf_release(ctx, rbuf[n]);
+                break;
+            }
+        }
+
+        nxt_unit_debug(ctx, "shared queue batch %d", (int) n);
+
+        for (i = 0; i < n; i++) {
+            if (nxt_fast_path(rc != NXT_UNIT_ERROR)) {
+                rc = nxt_unit_process_msg(ctx, rbuf[i], NULL, &batch);
+
+            } else {
+                nxt_unit_read_buf_release(ctx, rbuf[i]);
+            }
+        }
+
+        nxt_unit_process_req_batch(ctx, &batch);
+
         if (nxt_slow_path(rc == NXT_UNIT_ERROR)) {
             break;
         }
@@ -5021,7 +5361,7 @@ nxt_unit_dequeue_request(nxt_unit_ctx_t *ctx)
         goto done;
     }
 
-    (void) nxt_unit_process_msg(ctx, rbuf, &req);
+    (void) nxt_unit_process_msg(ctx, rbuf, &req, NULL);
 
 done:
 
@@ -5076,7 +5416,7 @@ nxt_unit_process_port_msg_impl(nxt_unit_ctx_t *ctx, nxt_unit_port_t *port)
         return rc;
     }
 
-    rc = nxt_unit_process_msg(ctx, rbuf, NULL);
+    rc = nxt_unit_process_msg(ctx, rbuf, NULL, NULL);
     if (nxt_slow_path(rc == NXT_UNIT_ERROR)) {
         return NXT_UNIT_ERROR;
     }
@@ -325,6 +325,21 @@ int nxt_unit_websocket_send(nxt_unit_request_info_t *req, uint8_t opcode,
 int nxt_unit_websocket_sendv(nxt_unit_request_info_t *req, uint8_t opcode,
     uint8_t last, const struct iovec *iov, int iovcnt);
 
+/*
+ * Frames published to a channel are sent by the router to every WebSocket
+ * connection subscribed to it; the payload is passed to the router once.
+ * Channels are scoped per application, and a published frame is sent to
+ * a connection only between the messages the application sends to it.
+ */
+int nxt_unit_websocket_subscribe(nxt_unit_request_info_t *req,
+    const char *channel, uint8_t channel_length);
+
+int nxt_unit_websocket_unsubscribe(nxt_unit_request_info_t *req,
+    const char *channel, uint8_t channel_length);
+
+int nxt_unit_websocket_publish(nxt_unit_ctx_t *ctx, const char *channel,
+    uint8_t channel_length, uint8_t opcode, const void *start, size_t size);
+
 ssize_t nxt_unit_websocket_read(nxt_unit_websocket_frame_t *ws, void *dst,
     size_t size);
 
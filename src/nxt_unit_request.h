@@ -47,6 +47,9 @@ struct nxt_unit_request_s {
     nxt_unit_sptr_t       query;
     nxt_unit_sptr_t       preread_content;
 
+    /* Monotonic time in milliseconds, 0 if the request has no deadline. */
+    uint32_t              deadline;
+
     nxt_unit_field_t      fields[];
 };
 
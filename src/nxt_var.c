@@ -6,8 +6,15 @@
 #include <nxt_main.h>
 
 
+/*
+ * A compiled template is a list of variables, each preceded by the length
+ * of the constant text before it.  The constant parts are joined in the
+ * raw data, so the template is produced by a run of copies into a single
+ * buffer whose size is the sum of the constant length and the values.
+ */
+
 struct nxt_var_s {
-    size_t              length;
+    size_t              length;  /* of the constant parts */
     nxt_uint_t          vars;
     u_char              data[];
 
@@ -20,8 +27,8 @@ struct nxt_var_s {
 
 typedef struct {
     uint32_t            index;
-    uint32_t            length;
-    uint32_t            position;
+    uint32_t            slot;
+    uint32_t            prefix;
 } nxt_var_sub_t;
 
 
@@ -55,9 +62,10 @@ static nxt_var_decl_t *nxt_var_decl_get(nxt_str_t *name, nxt_array_t *fields,
 static nxt_var_field_t *nxt_var_field_add(nxt_array_t *fields, nxt_str_t *name,
     uint32_t hash);
 
-static nxt_int_t nxt_var_cache_test(nxt_lvlhsh_query_t *lhq, void *data);
+static nxt_int_t nxt_var_slot_get(nxt_array_t *slots, uint32_t index,
+    uint32_t *slot);
 static nxt_str_t *nxt_var_cache_value(nxt_task_t *task, nxt_var_cache_t *cache,
-    uint32_t index, void *ctx);
+    nxt_var_sub_t *sub, void *ctx);
 
 static u_char *nxt_var_next_part(u_char *start, u_char *end, nxt_str_t *part);
 
@@ -69,13 +77,6 @@ static const nxt_lvlhsh_proto_t  nxt_var_hash_proto  nxt_aligned(64) = {
     nxt_lvlhsh_free,
 };
 
-static const nxt_lvlhsh_proto_t  nxt_var_cache_proto  nxt_aligned(64) = {
-    NXT_LVLHSH_DEFAULT,
-    nxt_var_cache_test,
-    nxt_mp_lvlhsh_alloc,
-    nxt_mp_lvlhsh_free,
-};
-
 
 static nxt_lvlhsh_t       nxt_var_hash;
 static uint32_t           nxt_var_count;
@@ -223,54 +224,68 @@ nxt_var_field_get(nxt_array_t *fields, uint16_t index)
 
 
 static nxt_int_t
-nxt_var_cache_test(nxt_lvlhsh_query_t *lhq, void *data)
+nxt_var_slot_get(nxt_array_t *slots, uint32_t index, uint32_t *slot)
 {
+    uint32_t    *p;
+    nxt_uint_t  i;
+
+    p = slots->elts;
+
+    for (i = 0; i < slots->nelts; i++) {
+        if (p[i] == index) {
+            *slot = i;
+            return NXT_OK;
+        }
+    }
+
+    p = nxt_array_add(slots);
+    if (nxt_slow_path(p == NULL)) {
+        return NXT_ERROR;
+    }
+
+    *p = index;
+    *slot = slots->nelts - 1;
+
     return NXT_OK;
 }
 
 
 static nxt_str_t *
-nxt_var_cache_value(nxt_task_t *task, nxt_var_cache_t *cache, uint32_t index,
-    void *ctx)
+nxt_var_cache_value(nxt_task_t *task, nxt_var_cache_t *cache,
+    nxt_var_sub_t *sub, void *ctx)
 {
-    nxt_int_t           ret;
-    nxt_str_t           *value;
-    nxt_lvlhsh_query_t  lhq;
+    size_t     size;
+    nxt_int_t  ret;
+    nxt_str_t  *value;
+
+    if (nxt_slow_path(sub->slot >= cache->nvalues)) {
+        return NULL;
+    }
 
-    value = cache->spare;
+    if (cache->values == NULL) {
+        size = cache->nvalues * (sizeof(nxt_str_t) + sizeof(uint8_t));
 
-    if (value == NULL) {
-        value = nxt_mp_zget(cache->pool, sizeof(nxt_str_t));
-        if (nxt_slow_path(value == NULL)) {
+        cache->values = nxt_mp_zget(cache->pool, size);
+        if (nxt_slow_path(cache->values == NULL)) {
             return NULL;
         }
 
-        cache->spare = value;
+        cache->evaluated = (uint8_t *) &cache->values[cache->nvalues];
     }
 
-    lhq.key_hash = nxt_murmur_hash2_uint32(&index);
-    lhq.replace = 0;
-    lhq.key.length = sizeof(uint32_t);
-    lhq.key.start = (u_char *) &index;
-    lhq.value = value;
-    lhq.proto = &nxt_var_cache_proto;
-    lhq.pool = cache->pool;
-
-    ret = nxt_lvlhsh_insert(&cache->hash, &lhq);
-    if (nxt_slow_path(ret == NXT_ERROR)) {
-        return NULL;
-    }
+    value = &cache->values[sub->slot];
 
-    if (ret == NXT_OK) {
-        ret = nxt_var_index[index >> 16](task, value, ctx, index & 0xffff);
+    if (!cache->evaluated[sub->slot]) {
+        ret = nxt_var_index[sub->index >> 16](task, value, ctx,
+                                              sub->index & 0xffff);
         if (nxt_slow_path(ret != NXT_OK)) {
             return NULL;
         }
 
-        cache->spare = NULL;
+        cache->evaluated[sub->slot] = 1;
     }
 
-    return lhq.value;
+    return value;
 }
 
 
@@ -327,11 +342,12 @@ nxt_var_index_init(void)
 
 
 nxt_var_t *
-nxt_var_compile(nxt_str_t *str, nxt_mp_t *mp, nxt_array_t *fields)
+nxt_var_compile(nxt_str_t *str, nxt_mp_t *mp, nxt_array_t *fields,
+    nxt_array_t *slots)
 {
-    u_char          *p, *end, *next, *src;
-    size_t          size;
-    uint32_t        index;
+    u_char          *p, *end, *next, *dst, *last;
+    size_t          size, length;
+    uint32_t        index, slot;
     nxt_var_t       *var;
     nxt_str_t       part;
     nxt_uint_t      n;
@@ -339,38 +355,41 @@ nxt_var_compile(nxt_str_t *str, nxt_mp_t *mp, nxt_array_t *fields)
     nxt_var_decl_t  *decl;
 
     n = 0;
+    length = str->length;
 
     p = str->start;
     end = p + str->length;
 
     while (p < end) {
-        p = nxt_var_next_part(p, end, &part);
-        if (nxt_slow_path(p == NULL)) {
+        next = nxt_var_next_part(p, end, &part);
+        if (nxt_slow_path(next == NULL)) {
             return NULL;
         }
 
         if (part.start != NULL) {
+            length -= next - p;
             n++;
         }
+
+        p = next;
     }
 
-    size = sizeof(nxt_var_t) + n * sizeof(nxt_var_sub_t) + str->length;
+    size = sizeof(nxt_var_t) + n * sizeof(nxt_var_sub_t) + length;
 
     var = nxt_mp_get(mp, size);
     if (nxt_slow_path(var == NULL)) {
         return NULL;
     }
 
-    var->length = str->length;
+    var->length = length;
     var->vars = n;
 
     subs = nxt_var_subs(var);
-    src = nxt_var_raw_start(var);
-
-    nxt_memcpy(src, str->start, str->length);
+    dst = nxt_var_raw_start(var);
 
     n = 0;
     p = str->start;
+    last = p;
 
     while (p < end) {
         next = nxt_var_next_part(p, end, &part);
@@ -381,9 +400,18 @@ nxt_var_compile(nxt_str_t *str, nxt_mp_t *mp, nxt_array_t *fields)
                 return NULL;
             }
 
+            if (nxt_slow_path(nxt_var_slot_get(slots, index, &slot)
+                              != NXT_OK))
+            {
+                return NULL;
+            }
+
             subs[n].index = index;
-            subs[n].length = next - p;
-            subs[n].position = p - str->start;
+            subs[n].slot = slot;
+            subs[n].prefix = p - last;
+
+            dst = nxt_cpymem(dst, last, p - last);
+            last = next;
 
             n++;
         }
@@ -391,6 +419,8 @@ nxt_var_compile(nxt_str_t *str, nxt_mp_t *mp, nxt_array_t *fields)
         p = next;
     }
 
+    nxt_memcpy(dst, last, end - last);
+
     return var;
 }
 
@@ -507,40 +537,39 @@ nxt_int_t
 nxt_var_interpreter(nxt_task_t *task, nxt_var_cache_t *cache, nxt_var_t *var,
     nxt_str_t *str, void *ctx, nxt_bool_t logging)
 {
-    u_char         *p, *src;
-    size_t         length, last, next;
-    nxt_str_t      *value, **part;
+    u_char         *p, *src, *end;
+    size_t         length;
+    nxt_str_t      *value;
     nxt_uint_t     i;
-    nxt_array_t    parts;
     nxt_var_sub_t  *subs;
 
-    nxt_memzero(&parts, sizeof(nxt_array_t));
-    nxt_array_init(&parts, cache->pool, sizeof(nxt_str_t *));
-
     subs = nxt_var_subs(var);
 
     length = var->length;
+    value = NULL;
 
     for (i = 0; i < var->vars; i++) {
-        value = nxt_var_cache_value(task, cache, subs[i].index, ctx);
+        value = nxt_var_cache_value(task, cache, &subs[i], ctx);
         if (nxt_slow_path(value == NULL)) {
             return NXT_ERROR;
         }
 
-        part = nxt_array_add(&parts);
-        if (nxt_slow_path(part == NULL)) {
-            return NXT_ERROR;
-        }
-
-        *part = value;
-
-        length += value->length - subs[i].length;
+        length += value->length;
 
         if (logging && value->start == NULL) {
             length += 1;
         }
     }
 
+    /* A single variable without any text needs no copy. */
+
+    if (var->vars == 1 && var->length == 0
+        && !(logging && value->start == NULL))
+    {
+        *str = *value;
+        return NXT_OK;
+    }
+
     p = nxt_mp_nget(cache->pool, length);
     if (nxt_slow_path(p == NULL)) {
         return NXT_ERROR;
@@ -549,30 +578,24 @@ nxt_var_interpreter(nxt_task_t *task, nxt_var_cache_t *cache, nxt_var_t *var,
     str->length = length;
     str->start = p;
 
-    part = parts.elts;
     src = nxt_var_raw_start(var);
-
-    last = 0;
+    end = src + var->length;
 
     for (i = 0; i < var->vars; i++) {
-        next = subs[i].position;
+        p = nxt_cpymem(p, src, subs[i].prefix);
+        src += subs[i].prefix;
 
-        if (next != last) {
-            p = nxt_cpymem(p, &src[last], next - last);
-        }
+        /* All the values are already evaluated and cached. */
+        value = &cache->values[subs[i].slot];
 
-        p = nxt_cpymem(p, part[i]->start, part[i]->length);
+        p = nxt_cpymem(p, value->start, value->length);
 
-        if (logging && part[i]->start == NULL) {
+        if (logging && value->start == NULL) {
             *p++ = '-';
         }
-
-        last = next + subs[i].length;
     }
 
-    if (last != var->length) {
-        p = nxt_cpymem(p, &src[last], var->length - last);
-    }
+    nxt_memcpy(p, src, end - src);
 
     return NXT_OK;
 }
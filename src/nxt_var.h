@@ -32,10 +32,16 @@ typedef struct {
 } nxt_var_field_t;
 
 
+/*
+ * The values of the variables evaluated for a request are cached in slots
+ * numbered densely by nxt_var_compile() for each configuration.
+ */
+
 typedef struct {
     nxt_mp_t                *pool;
-    nxt_lvlhsh_t            hash;
-    nxt_str_t               *spare;
+    nxt_str_t               *values;
+    uint8_t                 *evaluated;
+    uint32_t                nvalues;
 } nxt_var_cache_t;
 
 
@@ -44,7 +50,8 @@ nxt_int_t nxt_var_index_init(void);
 
 nxt_var_field_t *nxt_var_field_get(nxt_array_t *fields, uint16_t index);
 
-nxt_var_t *nxt_var_compile(nxt_str_t *str, nxt_mp_t *mp, nxt_array_t *fields);
+nxt_var_t *nxt_var_compile(nxt_str_t *str, nxt_mp_t *mp, nxt_array_t *fields,
+    nxt_array_t *slots);
 nxt_int_t nxt_var_test(nxt_str_t *str, nxt_array_t *fields, u_char *error);
 
 nxt_int_t nxt_var_interpreter(nxt_task_t *task, nxt_var_cache_t *cache,
@@ -120,3 +120,54 @@ nxt_websocket_frame_init(void *data, uint64_t payload_len)
     nxt_hton64(h->payload_len_, payload_len);
     return p + 10;
 }
+
+
+/*
+ * Applies the mask to the payload data starting at the "offset" byte of
+ * the payload.  The data are processed by machine words after aligning
+ * the pointer, with the mask replicated to the word width.
+ */
+
+void
+nxt_websocket_unmask(void *data, size_t size, const uint8_t *mask,
+    uint64_t offset)
+{
+    u_char      *p, *end;
+    uint8_t     k[8];
+    uint64_t    m, *w, *wend;
+    nxt_uint_t  i;
+
+    p = data;
+    end = p + size;
+
+    while (p < end && ((uintptr_t) p & (sizeof(uint64_t) - 1)) != 0) {
+        *p++ ^= mask[offset++ % 4];
+    }
+
+    for (i = 0; i < 8; i++) {
+        k[i] = mask[(offset + i) % 4];
+    }
+
+    nxt_memcpy(&m, k, sizeof(uint64_t));
+
+    w = (uint64_t *) p;
+    wend = w + (end - p) / sizeof(uint64_t);
+
+    while (wend - w >= 4) {
+        w[0] ^= m;
+        w[1] ^= m;
+        w[2] ^= m;
+        w[3] ^= m;
+        w += 4;
+    }
+
+    while (w < wend) {
+        *w++ ^= m;
+    }
+
+    p = (u_char *) w;
+
+    for (i = 0; p < end; i++) {
+        *p++ ^= k[i];
+    }
+}
@@ -12,10 +12,29 @@ enum {
 };
 
 
+enum {
+    NXT_WEBSOCKET_CHANNEL_SUBSCRIBE = 0,
+    NXT_WEBSOCKET_CHANNEL_UNSUBSCRIBE,
+    NXT_WEBSOCKET_CHANNEL_PUBLISH,
+};
+
+
+/*
+ * The header of channel messages sent by applications to the router.
+ * It is followed by the channel name and, for publishing, by the frame.
+ */
+typedef struct {
+    uint8_t  type;
+    uint8_t  name_length;
+} nxt_websocket_channel_msg_t;
+
+
 NXT_EXPORT size_t nxt_websocket_frame_header_size(const void *data);
 NXT_EXPORT uint64_t nxt_websocket_frame_payload_len(const void *data);
 NXT_EXPORT void *nxt_websocket_frame_init(void *data, uint64_t payload_len);
 NXT_EXPORT void nxt_websocket_accept(u_char *accept, const void *key);
+NXT_EXPORT void nxt_websocket_unmask(void *data, size_t size,
+    const uint8_t *mask, uint64_t offset);
 
 
 #endif  /* _NXT_WEBSOCKET_H_INCLUDED_ */
@@ -0,0 +1,272 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+#include <nxt_main.h>
+#include <nxt_conf.h>
+#include "nxt_tests.h"
+
+
+typedef struct {
+    nxt_str_t   json;
+    nxt_str_t   result;  /* nxt_null_string if the parsing must fail */
+} nxt_conf_json_test_t;
+
+
+static nxt_int_t nxt_conf_json_test_bench(nxt_thread_t *thr, nxt_uint_t n);
+static u_char *nxt_conf_json_test_generate(nxt_mp_t *mp, nxt_uint_t n,
+    size_t *size);
+
+
+static nxt_conf_json_test_t  nxt_conf_json_tests[] = {
+    { nxt_string("{}"), nxt_string("{}") },
+    { nxt_string(" [ ] "), nxt_string("[]") },
+    { nxt_string("null"), nxt_string("null") },
+    { nxt_string("-1.5e3"), nxt_string("-1.5e3") },
+    { nxt_string("\"\\u0041\\n\\ud83d\\ude00\""),
+      nxt_string("\"A\\n\xf0\x9f\x98\x80\"") },
+    { nxt_string("{\"b\": 1, \"a\": [true, false, null], \"c\": {}}"),
+      nxt_string("{\"b\":1,\"a\":[true,false,null],\"c\":{}}") },
+    { nxt_string("// comment\n{ /* x */ \"a\" : \"long string value\" }"),
+      nxt_string("{\"a\":\"long string value\"}") },
+    { nxt_string("{\"a\":[1,2,],}"), nxt_string("{\"a\":[1,2]}") },
+    { nxt_string("[[[[[[1]]]]], {\"a\": {\"b\": {\"c\": [2, 3]}}}]"),
+      nxt_string("[[[[[[1]]]]],{\"a\":{\"b\":{\"c\":[2,3]}}}]") },
+    { nxt_string("{\"k0\":0,\"k1\":1,\"k2\":2,\"k3\":3,\"k4\":4,\"k5\":5,"
+                 "\"k6\":6,\"k7\":7,\"k8\":8,\"k9\":9,\"k10\":10,\"k11\":11,"
+                 "\"k12\":12,\"k13\":13,\"k14\":14,\"k15\":15,\"k16\":16,"
+                 "\"k17\":17,\"k18\":18,\"k19\":19}"),
+      nxt_string("{\"k0\":0,\"k1\":1,\"k2\":2,\"k3\":3,\"k4\":4,\"k5\":5,"
+                 "\"k6\":6,\"k7\":7,\"k8\":8,\"k9\":9,\"k10\":10,\"k11\":11,"
+                 "\"k12\":12,\"k13\":13,\"k14\":14,\"k15\":15,\"k16\":16,"
+                 "\"k17\":17,\"k18\":18,\"k19\":19}") },
+
+    { nxt_string(""), nxt_null_string },
+    { nxt_string("[1 2]"), nxt_null_string },
+    { nxt_string("{\"a\":1,\"a\":2}"), nxt_null_string },
+    { nxt_string("{\"k0\":0,\"k1\":1,\"k2\":2,\"k3\":3,\"k4\":4,\"k5\":5,"
+                 "\"k6\":6,\"k7\":7,\"k8\":8,\"k9\":9,\"k10\":10,\"k11\":11,"
+                 "\"k12\":12,\"k13\":13,\"k14\":14,\"k15\":15,\"k16\":16,"
+                 "\"k17\":17,\"k18\":18,\"k3\":19}"),
+      nxt_null_string },
+    { nxt_string("{\"a\":{\"b\":[1,{\"c\":}]}}"), nxt_null_string },
+    { nxt_string("[\"\\x\"]"), nxt_null_string },
+    { nxt_string("{} {}"), nxt_null_string },
+    { nxt_string("[1, /* unterminated"), nxt_null_string },
+};
+
+
+nxt_int_t
+nxt_conf_json_test(nxt_thread_t *thr)
+{
+    u_char                 *p, buf[1024];
+    nxt_mp_t               *mp;
+    nxt_uint_t             i;
+    nxt_conf_value_t       *value;
+    nxt_conf_json_error_t  error;
+    nxt_conf_json_test_t   *test;
+
+    nxt_thread_time_update(thr);
+    nxt_log_error(NXT_LOG_NOTICE, thr->log, "conf json test started");
+
+    for (i = 0; i < nxt_nitems(nxt_conf_json_tests); i++) {
+        test = &nxt_conf_json_tests[i];
+
+        mp = nxt_mp_create(1024, 128, 256, 32);
+        if (mp == NULL) {
+            return NXT_ERROR;
+        }
+
+        nxt_memzero(&error, sizeof(nxt_conf_json_error_t));
+
+        value = nxt_conf_json_parse(mp, test->json.start,
+                                    test->json.start + test->json.length,
+                                    &error);
+
+        if (test->result.start == NULL) {
+            if (value != NULL || error.pos == NULL) {
+                nxt_log_alert(thr->log, "conf json test #%ui failed: "
+                              "\"%V\" must not be parsed", i, &test->json);
+                return NXT_ERROR;
+            }
+
+            nxt_mp_destroy(mp);
+            continue;
+        }
+
+        if (value == NULL) {
+            nxt_log_alert(thr->log, "conf json test #%ui failed: "
+                          "\"%V\" is not parsed: %s", i, &test->json,
+                          error.detail);
+            return NXT_ERROR;
+        }
+
+        p = nxt_conf_json_print(buf, value, NULL);
+
+        if (!nxt_str_eq(&test->result, buf, (size_t) (p - buf))) {
+            nxt_log_alert(thr->log, "conf json test #%ui failed: "
+                          "\"%*s\" instead of \"%V\"",
+                          i, (size_t) (p - buf), buf, &test->result);
+            return NXT_ERROR;
+        }
+
+        nxt_mp_destroy(mp);
+    }
+
+    nxt_log_error(NXT_LOG_NOTICE, thr->log, "conf json test passed");
+
+    if (nxt_conf_json_test_bench(thr, 10) != NXT_OK) {
+        return NXT_ERROR;
+    }
+
+    if (nxt_conf_json_test_bench(thr, 1000) != NXT_OK) {
+        return NXT_ERROR;
+    }
+
+    return nxt_conf_json_test_bench(thr, 20000);
+}
+
+
+static nxt_int_t
+nxt_conf_json_test_bench(nxt_thread_t *thr, nxt_uint_t n)
+{
+    u_char                 *json, *p;
+    size_t                 size;
+    nxt_mp_t               *mp, *gen_mp;
+    nxt_nsec_t             start, end;
+    nxt_uint_t             i, runs;
+    nxt_conf_value_t       *value;
+    nxt_conf_json_error_t  error;
+
+    gen_mp = nxt_mp_create(1024, 128, 256, 32);
+    if (gen_mp == NULL) {
+        return NXT_ERROR;
+    }
+
+    json = nxt_conf_json_test_generate(gen_mp, n, &size);
+    if (json == NULL) {
+        return NXT_ERROR;
+    }
+
+    runs = nxt_max(16 * 1024 * 1024 / size, 1);
+
+    nxt_thread_time_update(thr);
+    start = nxt_thread_monotonic_time(thr);
+
+    for (i = 0; i < runs; i++) {
+        mp = nxt_mp_create(1024, 128, 256, 32);
+        if (mp == NULL) {
+            return NXT_ERROR;
+        }
+
+        value = nxt_conf_json_parse(mp, json, json + size, &error);
+
+        if (value == NULL) {
+            nxt_log_alert(thr->log, "conf json benchmark failed: %s",
+                          error.detail);
+            return NXT_ERROR;
+        }
+
+        nxt_mp_destroy(mp);
+    }
+
+    nxt_thread_time_update(thr);
+    end = nxt_thread_monotonic_time(thr);
+
+    /* The generated configuration must survive a print and parse cycle. */
+
+    mp = nxt_mp_create(1024, 128, 256, 32);
+    if (mp == NULL) {
+        return NXT_ERROR;
+    }
+
+    value = nxt_conf_json_parse(mp, json, json + size, &error);
+    if (value == NULL) {
+        return NXT_ERROR;
+    }
+
+    p = nxt_mp_nget(mp, size);
+    if (p == NULL) {
+        return NXT_ERROR;
+    }
+
+    if (nxt_conf_json_print(p, value, NULL) - p != (ssize_t) size
+        || memcmp(p, json, size) != 0)
+    {
+        nxt_log_alert(thr->log, "conf json benchmark: "
+                      "the printed configuration differs");
+        return NXT_ERROR;
+    }
+
+    nxt_mp_destroy(mp);
+    nxt_mp_destroy(gen_mp);
+
+    nxt_log_error(NXT_LOG_NOTICE, thr->log,
+                  "conf json parse of %uz bytes x %ui: %0.3fs, %0.1f MB/s",
+                  size, runs, (end - start) / 1000000000.0,
+                  (double) size * runs / (1024 * 1024)
+                  / ((end - start) / 1000000000.0));
+
+    return NXT_OK;
+}
+
+
+/*
+ * A configuration with n applications, n routes, and n / 10 listeners
+ * printed in the compact form, so it can be compared with the output of
+ * nxt_conf_json_print().
+ */
+
+static u_char *
+nxt_conf_json_test_generate(nxt_mp_t *mp, nxt_uint_t n, size_t *size)
+{
+    u_char      *json, *p;
+    nxt_uint_t  i, k;
+
+    json = nxt_mp_nget(mp, 1024 * n + 256);
+    if (json == NULL) {
+        return NULL;
+    }
+
+    p = nxt_cpymem(json, "{\"listeners\":{", 14);
+
+    for (i = 0; i < n / 10 + 1; i++) {
+        p = nxt_sprintf(p, p + 128, "%s\"127.0.0.1:%ui\":"
+                        "{\"pass\":\"routes/r%ui\"}",
+                        i == 0 ? "" : ",", 8000 + i, i);
+    }
+
+    p = nxt_cpymem(p, "},\"routes\":[", 12);
+
+    for (i = 0; i < n; i++) {
+        p = nxt_sprintf(p, p + 256, "%s{\"match\":{\"uri\":[\"/api/v%ui/*\","
+                        "\"!/api/v%ui/internal/*\"],\"method\":\"GET\","
+                        "\"headers\":{\"X-Tenant\":\"tenant-%ui\"}},"
+                        "\"action\":{\"pass\":\"applications/app-%ui\"}}",
+                        i == 0 ? "" : ",", i, i, i % 97, i);
+    }
+
+    p = nxt_cpymem(p, "],\"applications\":{", 18);
+
+    for (i = 0; i < n; i++) {
+        p = nxt_sprintf(p, p + 256, "%s\"app-%ui\":{\"type\":\"python 3\","
+                        "\"processes\":{\"max\":%ui,\"spare\":1,"
+                        "\"idle_timeout\":20},\"path\":\"/srv/app-%ui\","
+                        "\"module\":\"wsgi\",\"environment\":{",
+                        i == 0 ? "" : ",", i, 2 + i % 8, i);
+
+        for (k = 0; k < 6; k++) {
+            p = nxt_sprintf(p, p + 64, "%s\"VAR_%ui\":\"value \\\"%ui\\\"\"",
+                            k == 0 ? "" : ",", k, i * k);
+        }
+
+        p = nxt_cpymem(p, "}}", 2);
+    }
+
+    p = nxt_cpymem(p, "}}", 2);
+
+    *size = p - json;
+
+    return json;
+}
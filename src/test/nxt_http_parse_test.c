@@ -50,7 +50,10 @@ typedef struct {
 static nxt_int_t nxt_http_parse_test_run(nxt_http_request_parse_t *rp,
     nxt_str_t *request);
 static nxt_int_t nxt_http_parse_test_bench(nxt_thread_t *thr,
-    nxt_str_t *request, nxt_lvlhsh_t *hash, const char *name, nxt_uint_t n);
+    nxt_str_t *request, nxt_flathsh_t *hash, const char *name, nxt_uint_t n);
+static nxt_int_t nxt_http_parse_test_field_id(nxt_thread_t *thr);
+static nxt_int_t nxt_http_parse_test_dispatch_bench(nxt_thread_t *thr,
+    nxt_str_t *request, const char *name, nxt_uint_t n);
 static nxt_int_t nxt_http_parse_test_request_line(nxt_http_request_parse_t *rp,
     nxt_http_parse_test_data_t *data,
     nxt_str_t *request, nxt_log_t *log);
@@ -370,7 +373,42 @@ static nxt_http_field_proc_t  nxt_http_test_fields[] = {
 };
 
 
-static nxt_lvlhsh_t  nxt_http_test_fields_hash;
+static nxt_flathsh_t  nxt_http_test_fields_hash;
+
+
+/* In nxt_http_field_id_t order. */
+static nxt_http_field_proc_t  nxt_http_test_known_fields[] = {
+    { nxt_string("Connection"),
+      &nxt_http_test_header_return, NXT_OK },
+    { nxt_string("Upgrade"),
+      &nxt_http_test_header_return, NXT_OK },
+    { nxt_string("Sec-WebSocket-Key"),
+      &nxt_http_test_header_return, NXT_OK },
+    { nxt_string("Sec-WebSocket-Version"),
+      &nxt_http_test_header_return, NXT_OK },
+    { nxt_string("Sec-WebSocket-Extensions"),
+      &nxt_http_test_header_return, NXT_OK },
+    { nxt_string("Transfer-Encoding"),
+      &nxt_http_test_header_return, NXT_OK },
+    { nxt_string("Host"),
+      &nxt_http_test_header_return, NXT_OK },
+    { nxt_string("Cookie"),
+      &nxt_http_test_header_return, NXT_OK },
+    { nxt_string("Referer"),
+      &nxt_http_test_header_return, NXT_OK },
+    { nxt_string("User-Agent"),
+      &nxt_http_test_header_return, NXT_OK },
+    { nxt_string("Content-Type"),
+      &nxt_http_test_header_return, NXT_OK },
+    { nxt_string("Content-Length"),
+      &nxt_http_test_header_return, NXT_OK },
+    { nxt_string("Authorization"),
+      &nxt_http_test_header_return, NXT_OK },
+    { nxt_string("Server"),
+      &nxt_http_test_header_return, NXT_OK },
+    { nxt_string("Date"),
+      &nxt_http_test_header_return, NXT_OK },
+};
 
 
 static nxt_http_field_proc_t  nxt_http_test_bench_fields[] = {
@@ -532,6 +570,7 @@ nxt_http_parse_test(nxt_thread_t *thr)
     nxt_int_t                   rc;
     nxt_uint_t                  i, colls, lvl_colls;
     nxt_lvlhsh_t                hash;
+    nxt_flathsh_t               fields_hash;
     nxt_http_request_parse_t    rp;
     nxt_http_parse_test_case_t  *test;
 
@@ -582,6 +621,10 @@ nxt_http_parse_test(nxt_thread_t *thr)
         nxt_mp_destroy(mp_temp);
     }
 
+    if (nxt_http_parse_test_field_id(thr) != NXT_OK) {
+        return NXT_ERROR;
+    }
+
     nxt_log_error(NXT_LOG_NOTICE, thr->log, "http parse test passed");
 
     nxt_memzero(&hash, sizeof(nxt_lvlhsh_t));
@@ -602,23 +645,37 @@ nxt_http_parse_test(nxt_thread_t *thr)
                   "http parse test hash collisions %ui out of %uz, level: %ui",
                   colls, nxt_nitems(nxt_http_test_bench_fields), lvl_colls);
 
-    nxt_memzero(&hash, sizeof(nxt_lvlhsh_t));
+    nxt_flathsh_init(&fields_hash);
 
-    rc = nxt_http_fields_hash(&hash, nxt_http_test_bench_fields,
+    rc = nxt_http_fields_hash(&fields_hash, nxt_http_test_bench_fields,
                               nxt_nitems(nxt_http_test_bench_fields));
     if (rc != NXT_OK) {
         return NXT_ERROR;
     }
 
     if (nxt_http_parse_test_bench(thr, &nxt_http_test_simple_request,
-                                  &hash, "simple", 1000000)
+                                  &fields_hash, "simple", 1000000)
         != NXT_OK)
     {
         return NXT_ERROR;
     }
 
     if (nxt_http_parse_test_bench(thr, &nxt_http_test_big_request,
-                                  &hash, "big", 100000)
+                                  &fields_hash, "big", 100000)
+        != NXT_OK)
+    {
+        return NXT_ERROR;
+    }
+
+    if (nxt_http_parse_test_dispatch_bench(thr, &nxt_http_test_simple_request,
+                                           "simple", 1000000)
+        != NXT_OK)
+    {
+        return NXT_ERROR;
+    }
+
+    if (nxt_http_parse_test_dispatch_bench(thr, &nxt_http_test_big_request,
+                                           "big", 1000000)
         != NXT_OK)
     {
         return NXT_ERROR;
@@ -651,7 +708,7 @@ nxt_http_parse_test_run(nxt_http_request_parse_t *rp, nxt_str_t *request)
 
 static nxt_int_t
 nxt_http_parse_test_bench(nxt_thread_t *thr, nxt_str_t *request,
-    nxt_lvlhsh_t *hash, const char *name, nxt_uint_t n)
+    nxt_flathsh_t *hash, const char *name, nxt_uint_t n)
 {
     nxt_mp_t                  *mp;
     nxt_nsec_t                start, end;
@@ -712,6 +769,184 @@ nxt_http_parse_test_bench(nxt_thread_t *thr, nxt_str_t *request,
 }
 
 
+static nxt_int_t
+nxt_http_parse_test_field_id(nxt_thread_t *thr)
+{
+    u_char               ch, buf[32];
+    nxt_str_t            *name;
+    nxt_uint_t           i, j;
+    nxt_http_field_id_t  id;
+
+    static nxt_str_t  unknown[] = {
+        nxt_string(""),
+        nxt_string("Accept"),
+        nxt_string("Hostx"),
+        nxt_string("Dat"),
+        nxt_string("Cookie2"),
+        nxt_string("X-Real-IP"),
+        nxt_string("Content-Typf"),
+        nxt_string("Sec-WebSocket-Kez"),
+        nxt_string("Content-Encoding"),
+    };
+
+    for (i = 0; i < nxt_nitems(nxt_http_test_known_fields); i++) {
+        name = &nxt_http_test_known_fields[i].name;
+
+        for (j = 0; j < name->length; j++) {
+            ch = nxt_lowcase(name->start[j]);
+
+            if (j % 2 == 0 && ch >= 'a' && ch <= 'z') {
+                ch -= 'a' - 'A';
+            }
+
+            buf[j] = ch;
+        }
+
+        id = nxt_http_field_id(name->start, name->length);
+
+        if (id != i + 1 || nxt_http_field_id(buf, name->length) != id) {
+            nxt_log_alert(thr->log, "http parse field id test failed: "
+                          "\"%V\" id:%d (expected: %ui)", name, id, i + 1);
+            return NXT_ERROR;
+        }
+
+        /* The same length and first character, other last character. */
+
+        buf[name->length - 1] ^= 0x01;
+
+        if (nxt_http_field_id(buf, name->length) != NXT_HTTP_FIELD_UNKNOWN) {
+            nxt_log_alert(thr->log, "http parse field id test failed: "
+                          "\"%*s\" is not unknown",
+                          name->length, buf);
+            return NXT_ERROR;
+        }
+    }
+
+    for (i = 0; i < nxt_nitems(unknown); i++) {
+        id = nxt_http_field_id(unknown[i].start, unknown[i].length);
+
+        if (id != NXT_HTTP_FIELD_UNKNOWN) {
+            nxt_log_alert(thr->log, "http parse field id test failed: "
+                          "\"%V\" id:%d (expected: unknown)",
+                          &unknown[i], id);
+            return NXT_ERROR;
+        }
+    }
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+nxt_http_parse_test_dispatch_bench(nxt_thread_t *thr, nxt_str_t *request,
+    const char *name, nxt_uint_t n)
+{
+    nxt_mp_t                   *mp;
+    nxt_int_t                  ret;
+    nxt_uint_t                 i, nfields;
+    nxt_nsec_t                 start, hash_time, switch_time;
+    nxt_buf_mem_t              buf;
+    nxt_flathsh_t              hash;
+    nxt_http_field_t           *field;
+    nxt_http_request_parse_t   rp;
+    nxt_http_field_dispatch_t  table[NXT_HTTP_FIELD_KNOWN];
+
+    ret = NXT_ERROR;
+
+    nxt_flathsh_init(&hash);
+
+    if (nxt_http_fields_hash(&hash, nxt_http_test_known_fields,
+                             nxt_nitems(nxt_http_test_known_fields))
+        != NXT_OK)
+    {
+        return NXT_ERROR;
+    }
+
+    nxt_memzero(table, sizeof(table));
+
+    for (i = 0; i < nxt_nitems(nxt_http_test_known_fields); i++) {
+        table[i + 1].handler = nxt_http_test_known_fields[i].handler;
+        table[i + 1].data = nxt_http_test_known_fields[i].data;
+    }
+
+    mp = nxt_mp_create(1024, 128, 256, 32);
+    if (mp == NULL) {
+        return NXT_ERROR;
+    }
+
+    nxt_memzero(&rp, sizeof(nxt_http_request_parse_t));
+
+    if (nxt_http_parse_request_init(&rp, mp) != NXT_OK) {
+        goto done;
+    }
+
+    buf.start = request->start;
+    buf.end = request->start + request->length;
+    buf.pos = buf.start;
+    buf.free = buf.end;
+
+    if (nxt_http_parse_request(&rp, &buf) != NXT_DONE) {
+        nxt_log_alert(thr->log, "http parse %s request dispatch bench failed "
+                                "while parsing", name);
+        goto done;
+    }
+
+    nfields = 0;
+
+    nxt_list_each(field, rp.fields) {
+        nfields++;
+    } nxt_list_loop;
+
+    nxt_thread_time_update(thr);
+    start = nxt_thread_monotonic_time(thr);
+
+    for (i = 0; nxt_fast_path(i < n); i++) {
+        if (nxt_slow_path(nxt_http_fields_process(rp.fields, &hash, NULL)
+                          != NXT_OK))
+        {
+            goto done;
+        }
+    }
+
+    nxt_thread_time_update(thr);
+    hash_time = nxt_thread_monotonic_time(thr) - start;
+
+    start = nxt_thread_monotonic_time(thr);
+
+    for (i = 0; nxt_fast_path(i < n); i++) {
+        if (nxt_slow_path(nxt_http_fields_dispatch(rp.fields, table, NULL)
+                          != NXT_OK))
+        {
+            goto done;
+        }
+    }
+
+    nxt_thread_time_update(thr);
+    switch_time = nxt_thread_monotonic_time(thr) - start;
+
+    nxt_log_error(NXT_LOG_NOTICE, thr->log,
+                  "http parse %s request dispatch bench: %ui fields, "
+                  "hash %.1f ns, switch %.1f ns per field",
+                  name, nfields,
+                  (double) hash_time / ((double) n * nfields),
+                  (double) switch_time / ((double) n * nfields));
+
+    ret = NXT_OK;
+
+done:
+
+    nxt_mp_destroy(mp);
+
+    while (nxt_flathsh_retrieve(&hash, &nxt_http_fields_hash_proto, NULL)
+           != NULL)
+    {
+        /* void */
+    }
+
+    return ret;
+}
+
+
 static nxt_int_t
 nxt_http_parse_test_request_line(nxt_http_request_parse_t *rp,
     nxt_http_parse_test_data_t *data, nxt_str_t *request, nxt_log_t *log)
@@ -0,0 +1,221 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+#include <nxt_main.h>
+#include "nxt_tests.h"
+
+
+static nxt_int_t nxt_js_pool_test_bench(nxt_thread_t *thr,
+    nxt_uint_t pool_size, nxt_uint_t runs);
+static nxt_int_t nxt_js_pool_test_reset(nxt_thread_t *thr);
+static njs_int_t nxt_js_pool_test_prop(njs_vm_t *vm, njs_object_prop_t *prop,
+    njs_value_t *value, njs_value_t *setval, njs_value_t *retval);
+
+
+#define NXT_JS_POOL_TEST_PROP(prop)                                           \
+    {                                                                         \
+        .flags = NJS_EXTERN_PROPERTY,                                         \
+        .name.string = njs_str(prop),                                         \
+        .enumerable = 1,                                                      \
+        .u.property = {                                                       \
+            .handler = nxt_js_pool_test_prop,                                 \
+        }                                                                     \
+    }
+
+
+static njs_external_t  nxt_js_pool_test_proto[] = {
+    NXT_JS_POOL_TEST_PROP("uri"),
+    NXT_JS_POOL_TEST_PROP("host"),
+    NXT_JS_POOL_TEST_PROP("remoteAddr"),
+    NXT_JS_POOL_TEST_PROP("args"),
+    NXT_JS_POOL_TEST_PROP("headers"),
+    NXT_JS_POOL_TEST_PROP("cookies"),
+};
+
+
+static nxt_str_t  nxt_js_pool_test_ctx = nxt_string("/index.html");
+
+
+nxt_int_t
+nxt_js_pool_test(nxt_thread_t *thr)
+{
+    nxt_thread_time_update(thr);
+    nxt_log_error(NXT_LOG_NOTICE, thr->log, "js pool test started");
+
+    if (nxt_js_pool_test_bench(thr, 0, 10000) != NXT_OK) {
+        return NXT_ERROR;
+    }
+
+    if (nxt_js_pool_test_bench(thr, 64, 10000) != NXT_OK) {
+        return NXT_ERROR;
+    }
+
+    if (nxt_js_pool_test_reset(thr) != NXT_OK) {
+        return NXT_ERROR;
+    }
+
+    nxt_log_error(NXT_LOG_NOTICE, thr->log, "js pool test passed");
+
+    return NXT_OK;
+}
+
+
+static nxt_int_t
+nxt_js_pool_test_bench(nxt_thread_t *thr, nxt_uint_t pool_size,
+    nxt_uint_t runs)
+{
+    nxt_mp_t        *mp;
+    nxt_js_t        *js;
+    nxt_str_t       res;
+    nxt_nsec_t      start, end;
+    nxt_uint_t      i;
+    nxt_js_conf_t   *jcf;
+    nxt_js_cache_t  cache;
+
+    static nxt_str_t  tpl = nxt_string("`${host}${uri}?${1 + 2}`");
+    static nxt_str_t  expect = nxt_string("/index.html/index.html?3");
+
+    mp = nxt_mp_create(1024, 128, 256, 32);
+    if (mp == NULL) {
+        return NXT_ERROR;
+    }
+
+    jcf = nxt_js_conf_new(mp);
+    if (jcf == NULL) {
+        return NXT_ERROR;
+    }
+
+    nxt_js_set_proto(jcf, nxt_js_pool_test_proto,
+                     njs_nitems(nxt_js_pool_test_proto));
+    nxt_js_set_pool_size(jcf, pool_size);
+
+    js = nxt_js_add_tpl(jcf, &tpl, 0);
+    if (js == NULL) {
+        return NXT_ERROR;
+    }
+
+    if (nxt_js_compile(jcf) != NXT_OK) {
+        nxt_log_alert(thr->log, "js pool test: template is not compiled");
+        return NXT_ERROR;
+    }
+
+    nxt_memzero(&cache, sizeof(nxt_js_cache_t));
+
+    nxt_thread_time_update(thr);
+    start = nxt_thread_monotonic_time(thr);
+
+    for (i = 0; i < runs; i++) {
+        if (nxt_js_call(thr->task, &cache, js, &res, &nxt_js_pool_test_ctx)
+            != NXT_OK)
+        {
+            nxt_log_alert(thr->log, "js pool test: call #%ui failed", i);
+            return NXT_ERROR;
+        }
+
+        if (!nxt_strstr_eq(&res, &expect)) {
+            nxt_log_alert(thr->log, "js pool test: \"%V\" instead of \"%V\"",
+                          &res, &expect);
+            return NXT_ERROR;
+        }
+
+        nxt_js_release(&cache);
+    }
+
+    nxt_thread_time_update(thr);
+    end = nxt_thread_monotonic_time(thr);
+
+    nxt_js_conf_release(jcf);
+    nxt_mp_destroy(mp);
+
+    nxt_log_error(NXT_LOG_NOTICE, thr->log,
+                  "js template calls with pool size %ui: %ui in %0.3fs, "
+                  "%0.0f calls/s", pool_size, runs,
+                  (end - start) / 1000000000.0,
+                  runs / ((end - start) / 1000000000.0));
+
+    return NXT_OK;
+}
+
+
+/* A global set by a template must not be seen by the next user of a VM. */
+
+static nxt_int_t
+nxt_js_pool_test_reset(nxt_thread_t *thr)
+{
+    nxt_mp_t        *mp;
+    nxt_js_t        *js;
+    nxt_str_t       res;
+    nxt_uint_t      i;
+    nxt_js_conf_t   *jcf;
+    nxt_js_cache_t  cache;
+
+    static nxt_str_t  tpl = nxt_string("`${[typeof globalThis.leak,"
+                                       " globalThis.leak = uri][0]}`");
+    static nxt_str_t  expect = nxt_string("undefined");
+
+    mp = nxt_mp_create(1024, 128, 256, 32);
+    if (mp == NULL) {
+        return NXT_ERROR;
+    }
+
+    jcf = nxt_js_conf_new(mp);
+    if (jcf == NULL) {
+        return NXT_ERROR;
+    }
+
+    nxt_js_set_proto(jcf, nxt_js_pool_test_proto,
+                     njs_nitems(nxt_js_pool_test_proto));
+    nxt_js_set_pool_size(jcf, 1);
+
+    js = nxt_js_add_tpl(jcf, &tpl, 0);
+    if (js == NULL) {
+        return NXT_ERROR;
+    }
+
+    if (nxt_js_compile(jcf) != NXT_OK) {
+        nxt_log_alert(thr->log, "js pool test: template is not compiled");
+        return NXT_ERROR;
+    }
+
+    nxt_memzero(&cache, sizeof(nxt_js_cache_t));
+
+    for (i = 0; i < 3; i++) {
+        if (nxt_js_call(thr->task, &cache, js, &res, &nxt_js_pool_test_ctx)
+            != NXT_OK)
+        {
+            nxt_log_alert(thr->log, "js pool test: reset call #%ui failed", i);
+            return NXT_ERROR;
+        }
+
+        if (!nxt_strstr_eq(&res, &expect)) {
+            nxt_log_alert(thr->log, "js pool test: global leaked: \"%V\"",
+                          &res);
+            return NXT_ERROR;
+        }
+
+        nxt_js_release(&cache);
+    }
+
+    nxt_js_conf_release(jcf);
+    nxt_mp_destroy(mp);
+
+    return NXT_OK;
+}
+
+
+static njs_int_t
+nxt_js_pool_test_prop(njs_vm_t *vm, njs_object_prop_t *prop,
+    njs_value_t *value, njs_value_t *setval, njs_value_t *retval)
+{
+    nxt_str_t  *str;
+
+    str = njs_vm_external(vm, nxt_js_proto_id, value);
+    if (str == NULL) {
+        njs_value_undefined_set(retval);
+        return NJS_DECLINED;
+    }
+
+    return njs_vm_value_string_set(vm, retval, str->start, str->length);
+}
@@ -261,3 +261,401 @@ nxt_lvlhsh_test(nxt_thread_t *thr, nxt_uint_t n, nxt_bool_t use_pool)
 
     return NXT_OK;
 }
+
+
+static nxt_int_t
+nxt_flathsh_test_add(nxt_flathsh_t *fh, const nxt_lvlhsh_proto_t *proto,
+    void *pool, uintptr_t key)
+{
+    nxt_lvlhsh_query_t  lhq;
+
+    lhq.key_hash = key;
+    lhq.replace = 0;
+    lhq.key.length = sizeof(uintptr_t);
+    lhq.key.start = (u_char *) &key;
+    lhq.value = (void *) key;
+    lhq.proto = proto;
+    lhq.pool = pool;
+
+    switch (nxt_flathsh_insert(fh, &lhq)) {
+
+    case NXT_OK:
+        return NXT_OK;
+
+    case NXT_DECLINED:
+        nxt_thread_log_alert("flathsh test failed: "
+                             "key %p is already in hash", key);
+        /* Fall through. */
+    default:
+        return NXT_ERROR;
+    }
+}
+
+
+static nxt_int_t
+nxt_flathsh_test_get(nxt_flathsh_t *fh, const nxt_lvlhsh_proto_t *proto,
+    uintptr_t key, nxt_bool_t found)
+{
+    nxt_int_t           ret;
+    nxt_lvlhsh_query_t  lhq;
+
+    lhq.key_hash = key;
+    lhq.key.length = sizeof(uintptr_t);
+    lhq.key.start = (u_char *) &key;
+    lhq.proto = proto;
+
+    ret = nxt_flathsh_find(fh, &lhq);
+
+    if (found) {
+        if (ret == NXT_OK && key == (uintptr_t) lhq.value) {
+            return NXT_OK;
+        }
+
+        nxt_thread_log_alert("flathsh test failed: "
+                             "key %p not found in hash", key);
+        return NXT_ERROR;
+    }
+
+    if (ret == NXT_DECLINED) {
+        return NXT_OK;
+    }
+
+    nxt_thread_log_alert("flathsh test failed: "
+                         "deleted key %p found in hash", key);
+    return NXT_ERROR;
+}
+
+
+static nxt_int_t
+nxt_flathsh_test_delete(nxt_flathsh_t *fh, const nxt_lvlhsh_proto_t *proto,
+    void *pool, uintptr_t key)
+{
+    nxt_int_t           ret;
+    nxt_lvlhsh_query_t  lhq;
+
+    lhq.key_hash = key;
+    lhq.key.length = sizeof(uintptr_t);
+    lhq.key.start = (u_char *) &key;
+    lhq.proto = proto;
+    lhq.pool = pool;
+
+    ret = nxt_flathsh_delete(fh, &lhq);
+
+    if (ret != NXT_OK) {
+        nxt_thread_log_alert("flathsh test failed: "
+                             "key %p not found in hash", key);
+    }
+
+    return ret;
+}
+
+
+nxt_int_t
+nxt_flathsh_test(nxt_thread_t *thr, nxt_uint_t n, nxt_bool_t use_pool)
+{
+    void                      *value;
+    uint32_t                  key;
+    nxt_mp_t                  *mp;
+    nxt_nsec_t                start, end;
+    nxt_uint_t                i, round;
+    nxt_flathsh_t             fh;
+    nxt_flathsh_each_t        fhe;
+    const nxt_lvlhsh_proto_t  *proto;
+
+    nxt_thread_time_update(thr);
+    start = nxt_thread_monotonic_time(thr);
+
+    if (use_pool) {
+        mp = nxt_mp_create(4096, 128, 1024, 32);
+        if (mp == NULL) {
+            return NXT_ERROR;
+        }
+
+        nxt_log_error(NXT_LOG_NOTICE, thr->log,
+                      "flathsh test started: %uD pool", n);
+        proto = &pool_proto;
+
+    } else {
+        nxt_log_error(NXT_LOG_NOTICE, thr->log,
+                      "flathsh test started: %uD malloc", n);
+        proto = &malloc_proto;
+        mp = NULL;
+    }
+
+    nxt_flathsh_init(&fh);
+
+    key = 0;
+    for (i = 0; i < n; i++) {
+        key = nxt_murmur_hash2(&key, sizeof(uint32_t));
+
+        if (nxt_flathsh_test_add(&fh, proto, mp, key) != NXT_OK) {
+            nxt_log_error(NXT_LOG_NOTICE, thr->log,
+                          "flathsh add test failed at %ui", i);
+            return NXT_ERROR;
+        }
+    }
+
+    /*
+     * Delete and insert every other key twice to test
+     * reuse of deleted slots and rehashing.
+     */
+
+    for (round = 0; round < 2; round++) {
+        key = 0;
+        for (i = 0; i < n; i++) {
+            key = nxt_murmur_hash2(&key, sizeof(uint32_t));
+
+            if (i % 2 == 1
+                && nxt_flathsh_test_delete(&fh, proto, mp, key) != NXT_OK)
+            {
+                return NXT_ERROR;
+            }
+        }
+
+        key = 0;
+        for (i = 0; i < n; i++) {
+            key = nxt_murmur_hash2(&key, sizeof(uint32_t));
+
+            if (nxt_flathsh_test_get(&fh, proto, key, i % 2 == 0) != NXT_OK) {
+                return NXT_ERROR;
+            }
+        }
+
+        key = 0;
+        for (i = 0; i < n; i++) {
+            key = nxt_murmur_hash2(&key, sizeof(uint32_t));
+
+            if (i % 2 == 1
+                && nxt_flathsh_test_add(&fh, proto, mp, key) != NXT_OK)
+            {
+                return NXT_ERROR;
+            }
+        }
+    }
+
+    key = 0;
+    for (i = 0; i < n; i++) {
+        key = nxt_murmur_hash2(&key, sizeof(uint32_t));
+
+        if (nxt_flathsh_test_get(&fh, proto, key, 1) != NXT_OK) {
+            return NXT_ERROR;
+        }
+    }
+
+    nxt_flathsh_each_init(&fhe, proto);
+
+    for (i = 0; i < n + 1; i++) {
+        if (nxt_flathsh_each(&fh, &fhe) == NULL) {
+            break;
+        }
+    }
+
+    if (i != n) {
+        nxt_log_error(NXT_LOG_NOTICE, thr->log,
+                      "flathsh each test failed at %ui of %ui", i, n);
+        return NXT_ERROR;
+    }
+
+    for (i = 0; i < n; i++) {
+        value = nxt_flathsh_peek(&fh, proto);
+
+        if (value == NULL) {
+            break;
+        }
+
+        key = (uintptr_t) value;
+
+        if (nxt_flathsh_test_delete(&fh, proto, mp, key) != NXT_OK) {
+            return NXT_ERROR;
+        }
+    }
+
+    if (i != n || !nxt_flathsh_is_empty(&fh)) {
+        nxt_log_error(NXT_LOG_NOTICE, thr->log,
+                      "flathsh peek test failed at %ui of %ui", i, n);
+        return NXT_ERROR;
+    }
+
+    key = 0;
+    for (i = 0; i < n; i++) {
+        key = nxt_murmur_hash2(&key, sizeof(uint32_t));
+
+        if (nxt_flathsh_test_add(&fh, proto, mp, key) != NXT_OK) {
+            nxt_log_error(NXT_LOG_NOTICE, thr->log,
+                          "flathsh add test failed at %ui", i);
+            return NXT_ERROR;
+        }
+    }
+
+    for (i = 0; i < n; i++) {
+        value = nxt_flathsh_retrieve(&fh, proto, mp);
+
+        if (value == NULL) {
+            break;
+        }
+    }
+
+    if (i != n || !nxt_flathsh_is_empty(&fh)) {
+        nxt_log_error(NXT_LOG_NOTICE, thr->log,
+                      "flathsh retrieve test failed at %ui of %ui", i, n);
+        return NXT_ERROR;
+    }
+
+    if (mp != NULL) {
+        if (!nxt_mp_is_empty(mp)) {
+            nxt_log_error(NXT_LOG_NOTICE, thr->log, "mem pool is not empty");
+            return NXT_ERROR;
+        }
+
+        nxt_mp_destroy(mp);
+    }
+
+    nxt_thread_time_update(thr);
+    end = nxt_thread_monotonic_time(thr);
+
+    nxt_log_error(NXT_LOG_NOTICE, thr->log, "flathsh test passed: %0.3fs",
+                  (end - start) / 1000000000.0);
+
+    return NXT_OK;
+}
+
+
+/*
+ * Compares build and lookup of the same keys in lvlhsh and flathsh.
+ * The build time per key includes destruction of the previous table.
+ * The keys are looked up in random order to defeat CPU caches as
+ * it happens with real world tables larger than the caches.
+ */
+
+nxt_int_t
+nxt_lvlhsh_bench(nxt_thread_t *thr, nxt_uint_t n, nxt_uint_t lookups)
+{
+    uint32_t            *keys;
+    uintptr_t           key;
+    nxt_int_t           ret;
+    nxt_uint_t          i, run, runs;
+    nxt_nsec_t          start, lvl_build, lvl_find, flat_build, flat_find;
+    nxt_lvlhsh_t        lh;
+    nxt_flathsh_t       fh;
+    nxt_lvlhsh_query_t  lhq;
+
+    keys = nxt_malloc(n * sizeof(uint32_t));
+    if (keys == NULL) {
+        return NXT_ERROR;
+    }
+
+    keys[0] = nxt_murmur_hash2(&n, sizeof(nxt_uint_t));
+
+    for (i = 1; i < n; i++) {
+        keys[i] = nxt_murmur_hash2(&keys[i - 1], sizeof(uint32_t));
+    }
+
+    ret = NXT_ERROR;
+
+    nxt_lvlhsh_init(&lh);
+    nxt_flathsh_init(&fh);
+
+    /* Small tables are built repeatedly to be measurable. */
+
+    runs = nxt_max(1000 * 1000 / n, 1);
+
+    nxt_thread_time_update(thr);
+    start = nxt_thread_monotonic_time(thr);
+
+    for (run = 0; run < runs; run++) {
+
+        while (nxt_lvlhsh_retrieve(&lh, &malloc_proto, NULL) != NULL) {
+            /* void */
+        }
+
+        for (i = 0; i < n; i++) {
+            if (nxt_lvlhsh_test_add(&lh, &malloc_proto, NULL, keys[i])
+                != NXT_OK)
+            {
+                goto done;
+            }
+        }
+    }
+
+    nxt_thread_time_update(thr);
+    lvl_build = nxt_thread_monotonic_time(thr) - start;
+
+    start = nxt_thread_monotonic_time(thr);
+
+    for (run = 0; run < runs; run++) {
+
+        while (nxt_flathsh_retrieve(&fh, &malloc_proto, NULL) != NULL) {
+            /* void */
+        }
+
+        for (i = 0; i < n; i++) {
+            if (nxt_flathsh_test_add(&fh, &malloc_proto, NULL, keys[i])
+                != NXT_OK)
+            {
+                goto done;
+            }
+        }
+    }
+
+    nxt_thread_time_update(thr);
+    flat_build = nxt_thread_monotonic_time(thr) - start;
+
+    lhq.key.length = sizeof(uintptr_t);
+    lhq.key.start = (u_char *) &key;
+    lhq.proto = &malloc_proto;
+
+    start = nxt_thread_monotonic_time(thr);
+
+    for (i = 0; i < lookups; i++) {
+        key = keys[(i * 7919) % n];
+        lhq.key_hash = key;
+
+        if (nxt_slow_path(nxt_lvlhsh_find(&lh, &lhq) != NXT_OK)) {
+            goto done;
+        }
+    }
+
+    nxt_thread_time_update(thr);
+    lvl_find = nxt_thread_monotonic_time(thr) - start;
+
+    start = nxt_thread_monotonic_time(thr);
+
+    for (i = 0; i < lookups; i++) {
+        key = keys[(i * 7919) % n];
+        lhq.key_hash = key;
+
+        if (nxt_slow_path(nxt_flathsh_find(&fh, &lhq) != NXT_OK)) {
+            goto done;
+        }
+    }
+
+    nxt_thread_time_update(thr);
+    flat_find = nxt_thread_monotonic_time(thr) - start;
+
+    nxt_log_error(NXT_LOG_NOTICE, thr->log,
+                  "lvlhsh bench %7ui keys: build lvlhsh %5.1f ns, "
+                  "flathsh %5.1f ns; find lvlhsh %5.1f ns, flathsh %5.1f ns",
+                  n, (double) lvl_build / (n * runs),
+                  (double) flat_build / (n * runs),
+                  (double) lvl_find / lookups, (double) flat_find / lookups);
+
+    ret = NXT_OK;
+
+done:
+
+    if (ret != NXT_OK) {
+        nxt_log_alert(thr->log, "lvlhsh bench failed");
+    }
+
+    while (nxt_lvlhsh_retrieve(&lh, &malloc_proto, NULL) != NULL) {
+        /* void */
+    }
+
+    while (nxt_flathsh_retrieve(&fh, &malloc_proto, NULL) != NULL) {
+        /* void */
+    }
+
+    nxt_free(keys);
+
+    return ret;
+}
@@ -8,6 +8,27 @@
 #include "nxt_tests.h"
 
 
+#define NXT_MEM_ZONE_BENCH_SIZE   (64 * 1024 * 1024)
+#define NXT_MEM_ZONE_BENCH_LIVE   32
+
+
+typedef struct {
+    nxt_mem_zone_t  *zone;
+    nxt_uint_t      nops;
+    nxt_uint_t      id;
+    nxt_bool_t      cached;
+    nxt_atomic_t    *failed;
+} nxt_mem_zone_bench_t;
+
+
+static double nxt_mem_zone_bench_run(nxt_thread_t *thr, u_char *start,
+    nxt_uint_t nprocs, nxt_uint_t nthreads, nxt_uint_t nops,
+    nxt_bool_t cached);
+static void nxt_mem_zone_bench_process(nxt_mem_zone_bench_t *mb,
+    nxt_uint_t nthreads);
+static void nxt_mem_zone_bench_thread(void *data);
+
+
 nxt_int_t
 nxt_mem_zone_test(nxt_thread_t *thr, nxt_uint_t runs, nxt_uint_t nblocks,
     size_t max_size)
@@ -72,3 +93,354 @@ nxt_mem_zone_test(nxt_thread_t *thr, nxt_uint_t runs, nxt_uint_t nblocks,
 
     return NXT_OK;
 }
+
+
+/*
+ * A double free of a chunk through a thread cache must be rejected
+ * whether the chunk is already in the same cache or in another one,
+ * otherwise the chunk would be returned twice by later allocations.
+ */
+
+nxt_int_t
+nxt_mem_zone_cache_test(nxt_thread_t *thr)
+{
+    void                  *start, *a, *b, *x, *y;
+    nxt_int_t             ret;
+    nxt_mem_zone_t        *zone;
+    nxt_mem_zone_cache_t  *cache1, *cache2;
+    const size_t          page_size = 4096, zone_size = 1024 * 1024;
+
+    nxt_thread_time_update(thr);
+    nxt_log_error(NXT_LOG_NOTICE, thr->log, "mem zone cache test started");
+
+    start = nxt_memalign(page_size, zone_size);
+    if (start == NULL) {
+        return NXT_ERROR;
+    }
+
+    ret = NXT_ERROR;
+    cache1 = NULL;
+    cache2 = NULL;
+
+    zone = nxt_mem_zone_init(start, zone_size, page_size);
+    if (zone == NULL) {
+        goto done;
+    }
+
+    cache1 = nxt_mem_zone_cache_create(zone);
+    cache2 = nxt_mem_zone_cache_create(zone);
+
+    if (cache1 == NULL || cache2 == NULL) {
+        goto done;
+    }
+
+    a = nxt_mem_zone_cache_alloc(cache1, 64);
+    b = nxt_mem_zone_cache_alloc(cache1, 64);
+
+    if (a == NULL || b == NULL || a == b) {
+        goto done;
+    }
+
+    nxt_mem_zone_cache_free(cache1, a);
+
+    /* Both are rejected with alerts. */
+    nxt_mem_zone_cache_free(cache1, a);
+    nxt_mem_zone_cache_free(cache2, a);
+
+    nxt_mem_zone_cache_flush(cache2);
+
+    x = nxt_mem_zone_cache_alloc(cache1, 64);
+    y = nxt_mem_zone_cache_alloc(cache1, 64);
+
+    if (x != a || y == a || y == b) {
+        nxt_log_alert(thr->log, "mem zone cache test failed: "
+                      "double free is not detected");
+        goto done;
+    }
+
+    nxt_mem_zone_cache_free(cache1, x);
+    nxt_mem_zone_cache_free(cache1, y);
+    nxt_mem_zone_cache_free(cache1, b);
+
+    nxt_log_error(NXT_LOG_NOTICE, thr->log, "mem zone cache test passed");
+
+    ret = NXT_OK;
+
+done:
+
+    if (cache1 != NULL) {
+        nxt_mem_zone_cache_destroy(cache1);
+    }
+
+    if (cache2 != NULL) {
+        nxt_mem_zone_cache_destroy(cache2);
+    }
+
+    nxt_free(start);
+
+    return ret;
+}
+
+
+nxt_int_t
+nxt_mem_zone_bench(nxt_thread_t *thr, nxt_uint_t nops)
+{
+    u_char      *start;
+    double      locked, cached;
+    nxt_int_t   ret;
+    nxt_uint_t  nprocs, nthreads;
+
+    nxt_thread_time_update(thr);
+    nxt_log_error(NXT_LOG_NOTICE, thr->log, "mem zone bench started");
+
+    start = mmap(NULL, NXT_MEM_ZONE_BENCH_SIZE, PROT_READ | PROT_WRITE,
+                 MAP_ANON | MAP_SHARED, -1, 0);
+
+    if (start == MAP_FAILED) {
+        nxt_log_alert(thr->log, "mmap(%d) failed %E",
+                      NXT_MEM_ZONE_BENCH_SIZE, nxt_errno);
+        return NXT_ERROR;
+    }
+
+    ret = NXT_ERROR;
+
+    for (nprocs = 2; nprocs <= 8; nprocs *= 2) {
+        for (nthreads = 1; nthreads <= 64; nthreads *= 4) {
+
+            locked = nxt_mem_zone_bench_run(thr, start, nprocs, nthreads,
+                                            nops, 0);
+            if (locked < 0) {
+                goto done;
+            }
+
+            cached = nxt_mem_zone_bench_run(thr, start, nprocs, nthreads,
+                                            nops, 1);
+            if (cached < 0) {
+                goto done;
+            }
+
+            nxt_log_error(NXT_LOG_NOTICE, thr->log,
+                          "mem zone bench %ui processes, %2ui threads: "
+                          "locked %9.0f ops/sec, cached %9.0f ops/sec",
+                          nprocs, nthreads, locked, cached);
+        }
+    }
+
+    nxt_log_error(NXT_LOG_NOTICE, thr->log, "mem zone bench passed");
+
+    ret = NXT_OK;
+
+done:
+
+    munmap(start, NXT_MEM_ZONE_BENCH_SIZE);
+
+    return ret;
+}
+
+
+/*
+ * The zone is placed in shared memory and all processes and threads
+ * allocate and free chunks concurrently.  The total number of operations
+ * is divided among all threads.  Returns operations per second or -1
+ * on failure.
+ */
+
+static double
+nxt_mem_zone_bench_run(nxt_thread_t *thr, u_char *start, nxt_uint_t nprocs,
+    nxt_uint_t nthreads, nxt_uint_t nops, nxt_bool_t cached)
+{
+    int                   status;
+    pid_t                 pid;
+    nxt_uint_t            n, ok;
+    nxt_nsec_t            begin, elapsed;
+    nxt_atomic_t          *failed;
+    nxt_mem_zone_bench_t  mb;
+
+    failed = (nxt_atomic_t *) start;
+    *failed = 0;
+
+    mb.zone = nxt_mem_zone_init(start + 64, NXT_MEM_ZONE_BENCH_SIZE - 64,
+                                4096);
+    if (mb.zone == NULL) {
+        return -1;
+    }
+
+    mb.nops = nops / (nprocs * nthreads);
+    mb.cached = cached;
+    mb.failed = failed;
+
+    nxt_thread_time_update(thr);
+    begin = nxt_thread_monotonic_time(thr);
+
+    for (n = 0; n < nprocs; n++) {
+        mb.id = n * nthreads;
+
+        pid = fork();
+
+        if (pid == 0) {
+            nxt_mem_zone_bench_process(&mb, nthreads);
+            exit(0);
+        }
+
+        if (pid == -1) {
+            nxt_log_alert(thr->log, "fork() failed %E", nxt_errno);
+            (void) nxt_atomic_fetch_add(failed, 1);
+            nprocs = n;
+            break;
+        }
+    }
+
+    ok = 1;
+
+    for (n = 0; n < nprocs; n++) {
+        if (wait(&status) == -1 || status != 0) {
+            ok = 0;
+        }
+    }
+
+    nxt_thread_time_update(thr);
+    elapsed = nxt_thread_monotonic_time(thr) - begin;
+
+    if (!ok || *failed != 0) {
+        nxt_log_alert(thr->log, "mem zone bench failed: %ui processes, "
+                      "%ui threads, cached:%d",
+                      nprocs, nthreads, (int) cached);
+        return -1;
+    }
+
+    return (double) mb.nops * nprocs * nthreads * 1000000000
+           / nxt_max(elapsed, 1);
+}
+
+
+static void
+nxt_mem_zone_bench_process(nxt_mem_zone_bench_t *mb, nxt_uint_t nthreads)
+{
+    nxt_uint_t            n;
+    nxt_thread_link_t     *link;
+    nxt_thread_handle_t   *handles;
+    nxt_mem_zone_bench_t  *mbs;
+
+    handles = nxt_malloc(nthreads * sizeof(nxt_thread_handle_t));
+    mbs = nxt_malloc(nthreads * sizeof(nxt_mem_zone_bench_t));
+
+    if (handles == NULL || mbs == NULL) {
+        exit(1);
+    }
+
+    for (n = 0; n < nthreads; n++) {
+        mbs[n] = *mb;
+        mbs[n].id = mb->id + n;
+
+        link = nxt_zalloc(sizeof(nxt_thread_link_t));
+        if (link == NULL) {
+            exit(1);
+        }
+
+        link->start = nxt_mem_zone_bench_thread;
+        link->work.data = &mbs[n];
+
+        if (nxt_thread_create(&handles[n], link) != NXT_OK) {
+            exit(1);
+        }
+    }
+
+    for (n = 0; n < nthreads; n++) {
+        nxt_thread_wait(handles[n]);
+    }
+}
+
+
+static void
+nxt_mem_zone_bench_thread(void *data)
+{
+    u_char                *p;
+    size_t                sizes[NXT_MEM_ZONE_BENCH_LIVE];
+    u_char                *blocks[NXT_MEM_ZONE_BENCH_LIVE];
+    uint32_t              value;
+    nxt_uint_t            i, n;
+    nxt_mem_zone_cache_t  *cache;
+    nxt_mem_zone_bench_t  *mb;
+
+    mb = data;
+
+    cache = NULL;
+
+    if (mb->cached) {
+        cache = nxt_mem_zone_cache_create(mb->zone);
+        if (cache == NULL) {
+            goto failed;
+        }
+    }
+
+    nxt_memzero(blocks, sizeof(blocks));
+
+    value = mb->id;
+
+    /*
+     * Each thread marks its blocks with its own tag, so overlapped
+     * allocations made by different threads or processes are detected.
+     */
+
+    for (i = 0; i < mb->nops; i++) {
+        value = nxt_murmur_hash2(&value, sizeof(uint32_t));
+
+        n = value % NXT_MEM_ZONE_BENCH_LIVE;
+        p = blocks[n];
+
+        if (p != NULL) {
+            if (p[0] != (u_char) mb->id || p[sizes[n] - 1] != (u_char) n) {
+                goto failed;
+            }
+
+            if (cache != NULL) {
+                nxt_mem_zone_cache_free(cache, p);
+
+            } else {
+                nxt_mem_zone_free(mb->zone, p);
+            }
+        }
+
+        sizes[n] = ((value >> 8) & 255) + 2;
+
+        if (cache != NULL) {
+            p = nxt_mem_zone_cache_alloc(cache, sizes[n]);
+
+        } else {
+            p = nxt_mem_zone_alloc(mb->zone, sizes[n]);
+        }
+
+        if (p == NULL) {
+            blocks[n] = NULL;
+            goto failed;
+        }
+
+        p[0] = (u_char) mb->id;
+        p[sizes[n] - 1] = (u_char) n;
+
+        blocks[n] = p;
+    }
+
+    for (n = 0; n < NXT_MEM_ZONE_BENCH_LIVE; n++) {
+        if (blocks[n] == NULL) {
+            continue;
+        }
+
+        if (cache != NULL) {
+            nxt_mem_zone_cache_free(cache, blocks[n]);
+
+        } else {
+            nxt_mem_zone_free(mb->zone, blocks[n]);
+        }
+    }
+
+    if (cache != NULL) {
+        nxt_mem_zone_cache_destroy(cache);
+    }
+
+    return;
+
+failed:
+
+    (void) nxt_atomic_fetch_add(mb->failed, 1);
+}
@@ -88,3 +88,178 @@ nxt_mp_test(nxt_thread_t *thr, nxt_uint_t runs, nxt_uint_t nblocks,
 
     return NXT_OK;
 }
+
+
+#define NXT_MP_CACHE_TEST_ALLOCS  64
+
+
+static nxt_int_t nxt_mp_cache_test_request(nxt_mp_t *mp, uint32_t *value,
+    nxt_bool_t check);
+
+
+nxt_int_t
+nxt_mp_cache_test(nxt_thread_t *thr, nxt_uint_t runs)
+{
+    nxt_mp_t        *mp;
+    uint32_t        value;
+    nxt_int_t       ret;
+    nxt_uint_t      i;
+    nxt_nsec_t      start, create_time, cache_time;
+    nxt_mp_cache_t  *cache;
+
+    nxt_thread_time_update(thr);
+    nxt_log_error(NXT_LOG_NOTICE, thr->log, "mem pool cache test started");
+
+    cache = nxt_mp_cache_create(4096, 128, 512, 32, 4);
+    if (cache == NULL) {
+        return NXT_ERROR;
+    }
+
+    value = 0;
+    start = nxt_thread_monotonic_time(thr);
+
+    for (i = 0; i < runs; i++) {
+        mp = nxt_mp_create(4096, 128, 512, 32);
+        if (mp == NULL) {
+            return NXT_ERROR;
+        }
+
+        ret = nxt_mp_cache_test_request(mp, &value, i % 64 == 0);
+
+        nxt_mp_destroy(mp);
+
+        if (ret != NXT_OK) {
+            goto fail;
+        }
+    }
+
+    nxt_thread_time_update(thr);
+    create_time = nxt_thread_monotonic_time(thr) - start;
+
+    value = 0;
+    start = nxt_thread_monotonic_time(thr);
+
+    for (i = 0; i < runs; i++) {
+        mp = nxt_mp_cache_get(cache);
+        if (mp == NULL) {
+            return NXT_ERROR;
+        }
+
+        ret = nxt_mp_cache_test_request(mp, &value, i % 64 == 0);
+
+        nxt_mp_release(mp);
+
+        if (ret != NXT_OK) {
+            goto fail;
+        }
+    }
+
+    nxt_thread_time_update(thr);
+    cache_time = nxt_thread_monotonic_time(thr) - start;
+
+    if (cache->created != 1
+        || cache->reused != runs - 1
+        || cache->count != 1
+        || cache->uses != 1)
+    {
+        nxt_log_alert(thr->log, "mem pool cache test failed: "
+                      "created:%ui reused:%ui idle:%uD uses:%uA",
+                      cache->created, cache->reused, cache->count,
+                      cache->uses);
+        return NXT_ERROR;
+    }
+
+    nxt_log_error(NXT_LOG_NOTICE, thr->log,
+                  "mem pool cache: %ui requests, pools created: %ui, "
+                  "create %uL ns/req, cache %uL ns/req",
+                  runs, cache->created, create_time / runs, cache_time / runs);
+
+    /* A pool in use outlives the destroyed cache. */
+
+    mp = nxt_mp_cache_get(cache);
+    if (mp == NULL) {
+        return NXT_ERROR;
+    }
+
+    nxt_mp_cache_destroy(cache);
+
+    ret = nxt_mp_cache_test_request(mp, &value, 1);
+
+    nxt_mp_release(mp);
+
+    if (ret != NXT_OK) {
+        goto fail;
+    }
+
+    nxt_log_error(NXT_LOG_NOTICE, thr->log, "mem pool cache test passed");
+
+    return NXT_OK;
+
+fail:
+
+    nxt_log_alert(thr->log, "mem pool cache test failed: corrupted memory");
+
+    return NXT_ERROR;
+}
+
+
+/*
+ * Emulates a request: mostly small non-freeable allocations of structures
+ * and strings, a few freeable ones, and sometimes a large buffer.
+ */
+
+static nxt_int_t
+nxt_mp_cache_test_request(nxt_mp_t *mp, uint32_t *value, nxt_bool_t check)
+{
+    u_char      *p, *blocks[NXT_MP_CACHE_TEST_ALLOCS];
+    size_t      size, sizes[NXT_MP_CACHE_TEST_ALLOCS];
+    nxt_uint_t  i, n;
+
+    for (n = 0; n < NXT_MP_CACHE_TEST_ALLOCS; n++) {
+        *value = nxt_murmur_hash2(value, sizeof(uint32_t));
+
+        size = (*value & 255) + 1;
+
+        if ((*value >> 8) % 8 == 0) {
+            p = nxt_mp_alloc(mp, size);
+
+        } else if ((*value >> 8) % 8 == 1) {
+            p = nxt_mp_nget(mp, size);
+
+        } else {
+            p = nxt_mp_get(mp, size);
+        }
+
+        if (p == NULL) {
+            return NXT_ERROR;
+        }
+
+        if (check) {
+            nxt_memset(p, (u_char) n, size);
+        }
+
+        blocks[n] = p;
+        sizes[n] = size;
+    }
+
+    if (*value % 16 == 0) {
+        p = nxt_mp_alloc(mp, 8192);
+        if (p == NULL) {
+            return NXT_ERROR;
+        }
+    }
+
+    if (!check) {
+        return NXT_OK;
+    }
+
+    for (n = 0; n < NXT_MP_CACHE_TEST_ALLOCS; n++) {
+        for (i = 0; i < sizes[n]; i++) {
+            if (blocks[n][i] != (u_char) n) {
+                return NXT_ERROR;
+            }
+        }
+    }
+
+    return NXT_OK;
+}
@@ -110,6 +110,10 @@ main(int argc, char **argv)
         return 1;
     }
 
+    if (nxt_mp_cache_test(thr, 100000) != NXT_OK) {
+        return 1;
+    }
+
     if (nxt_mem_zone_test(thr, 100, 20000, 128 - 1) != NXT_OK) {
         return 1;
     }
@@ -122,6 +126,14 @@ main(int argc, char **argv)
         return 1;
     }
 
+    if (nxt_mem_zone_cache_test(thr) != NXT_OK) {
+        return 1;
+    }
+
+    if (nxt_mem_zone_bench(thr, 1024 * 1024) != NXT_OK) {
+        return 1;
+    }
+
     if (nxt_lvlhsh_test(thr, 2, 1) != NXT_OK) {
         return 1;
     }
@@ -138,6 +150,30 @@ main(int argc, char **argv)
         return 1;
     }
 
+    if (nxt_flathsh_test(thr, 2, 1) != NXT_OK) {
+        return 1;
+    }
+
+    if (nxt_flathsh_test(thr, 100 * 1000, 1) != NXT_OK) {
+        return 1;
+    }
+
+    if (nxt_flathsh_test(thr, 100 * 1000, 0) != NXT_OK) {
+        return 1;
+    }
+
+    if (nxt_lvlhsh_bench(thr, 16, 10 * 1000 * 1000) != NXT_OK) {
+        return 1;
+    }
+
+    if (nxt_lvlhsh_bench(thr, 1000, 10 * 1000 * 1000) != NXT_OK) {
+        return 1;
+    }
+
+    if (nxt_lvlhsh_bench(thr, 1000 * 1000, 10 * 1000 * 1000) != NXT_OK) {
+        return 1;
+    }
+
     if (nxt_gmtime_test(thr) != NXT_OK) {
         return 1;
     }
@@ -166,11 +202,25 @@ main(int argc, char **argv)
         return 1;
     }
 
+    if (nxt_conf_json_test(thr) != NXT_OK) {
+        return 1;
+    }
+
+    if (nxt_websocket_test(thr) != NXT_OK) {
+        return 1;
+    }
+
 #if (NXT_HAVE_CLONE_NEWUSER)
     if (nxt_clone_creds_test(thr) != NXT_OK) {
         return 1;
     }
 #endif
 
+#if (NXT_HAVE_NJS)
+    if (nxt_js_pool_test(thr) != NXT_OK) {
+        return 1;
+    }
+#endif
+
     return 0;
 }
@@ -53,10 +53,17 @@ void nxt_rbtree1_mb_delete(nxt_thread_t *thr);
 
 nxt_int_t nxt_mp_test(nxt_thread_t *thr, nxt_uint_t runs, nxt_uint_t nblocks,
     size_t max_size);
+nxt_int_t nxt_mp_cache_test(nxt_thread_t *thr, nxt_uint_t runs);
 nxt_int_t nxt_mem_zone_test(nxt_thread_t *thr, nxt_uint_t runs,
     nxt_uint_t nblocks, size_t max_size);
+nxt_int_t nxt_mem_zone_cache_test(nxt_thread_t *thr);
+nxt_int_t nxt_mem_zone_bench(nxt_thread_t *thr, nxt_uint_t nops);
 nxt_int_t nxt_lvlhsh_test(nxt_thread_t *thr, nxt_uint_t n,
     nxt_bool_t use_pool);
+nxt_int_t nxt_flathsh_test(nxt_thread_t *thr, nxt_uint_t n,
+    nxt_bool_t use_pool);
+nxt_int_t nxt_lvlhsh_bench(nxt_thread_t *thr, nxt_uint_t n,
+    nxt_uint_t lookups);
 
 nxt_int_t nxt_gmtime_test(nxt_thread_t *thr);
 nxt_int_t nxt_sprintf_test(nxt_thread_t *thr);
@@ -65,7 +72,10 @@ nxt_int_t nxt_utf8_test(nxt_thread_t *thr);
 nxt_int_t nxt_http_parse_test(nxt_thread_t *thr);
 nxt_int_t nxt_strverscmp_test(nxt_thread_t *thr);
 nxt_int_t nxt_base64_test(nxt_thread_t *thr);
+nxt_int_t nxt_conf_json_test(nxt_thread_t *thr);
+nxt_int_t nxt_websocket_test(nxt_thread_t *thr);
 nxt_int_t nxt_clone_creds_test(nxt_thread_t *thr);
+nxt_int_t nxt_js_pool_test(nxt_thread_t *thr);
 
 
 #endif /* _NXT_TESTS_H_INCLUDED_ */
@@ -0,0 +1,192 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+/*
+ * WebSocket channels test application.  Text messages are commands:
+ *
+ *   subscribe <channel>              replies "subscribed"
+ *   unsubscribe <channel>            replies "unsubscribed"
+ *   publish <channel> <text>         publishes the text
+ *   flood <channel> <count> <size>   publishes count frames of size bytes
+ *   begin <text>                     sends the first fragment of a message
+ *   end <text>                       sends the last fragment of the message
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <nxt_unit.h>
+#include <nxt_unit_request.h>
+#include <nxt_clang.h>
+#include <nxt_websocket.h>
+#include <nxt_unit_websocket.h>
+
+
+static void
+ws_channel_request_handler(nxt_unit_request_info_t *req)
+{
+    int  rc;
+
+    if (!nxt_unit_request_is_websocket_handshake(req)) {
+        rc = nxt_unit_response_init(req, 404, 0, 0);
+        nxt_unit_request_done(req, rc);
+        return;
+    }
+
+    rc = nxt_unit_response_init(req, 101, 0, 0);
+    if (nxt_slow_path(rc != NXT_UNIT_OK)) {
+        nxt_unit_request_done(req, rc);
+        return;
+    }
+
+    nxt_unit_response_upgrade(req);
+    nxt_unit_response_send(req);
+}
+
+
+static void
+ws_channel_reply(nxt_unit_request_info_t *req, const char *text)
+{
+    nxt_unit_websocket_send(req, NXT_WEBSOCKET_OP_TEXT, 1, text,
+                            strlen(text));
+}
+
+
+static void
+ws_channel_command(nxt_unit_request_info_t *req, char *cmd)
+{
+    int    i, count, size;
+    char   *arg, *text, *buf;
+
+    arg = strchr(cmd, ' ');
+    if (arg == NULL) {
+        return;
+    }
+
+    *arg++ = '\0';
+
+    if (strcmp(cmd, "begin") == 0) {
+        nxt_unit_websocket_send(req, NXT_WEBSOCKET_OP_TEXT, 0, arg,
+                                strlen(arg));
+        return;
+    }
+
+    if (strcmp(cmd, "end") == 0) {
+        nxt_unit_websocket_send(req, NXT_WEBSOCKET_OP_CONT, 1, arg,
+                                strlen(arg));
+        return;
+    }
+
+    if (strcmp(cmd, "subscribe") == 0) {
+        nxt_unit_websocket_subscribe(req, arg, strlen(arg));
+        ws_channel_reply(req, "subscribed");
+        return;
+    }
+
+    if (strcmp(cmd, "unsubscribe") == 0) {
+        nxt_unit_websocket_unsubscribe(req, arg, strlen(arg));
+        ws_channel_reply(req, "unsubscribed");
+        return;
+    }
+
+    text = strchr(arg, ' ');
+    if (text == NULL) {
+        return;
+    }
+
+    *text++ = '\0';
+
+    if (strcmp(cmd, "publish") == 0) {
+        nxt_unit_websocket_publish(req->ctx, arg, strlen(arg),
+                                   NXT_WEBSOCKET_OP_TEXT, text, strlen(text));
+        return;
+    }
+
+    if (strcmp(cmd, "flood") == 0
+        && sscanf(text, "%d %d", &count, &size) == 2
+        && size > 0)
+    {
+        buf = malloc(size);
+        if (buf == NULL) {
+            return;
+        }
+
+        memset(buf, 'x', size);
+
+        for (i = 0; i < count; i++) {
+            nxt_unit_websocket_publish(req->ctx, arg, strlen(arg),
+                                       NXT_WEBSOCKET_OP_TEXT, buf, size);
+        }
+
+        free(buf);
+    }
+}
+
+
+static void
+ws_channel_websocket_handler(nxt_unit_websocket_frame_t *ws)
+{
+    char                     buf[256];
+    ssize_t                  size;
+    nxt_unit_request_info_t  *req;
+
+    req = ws->req;
+
+    if (ws->header->opcode == NXT_WEBSOCKET_OP_CLOSE) {
+        nxt_unit_websocket_done(ws);
+        nxt_unit_request_done(req, NXT_UNIT_OK);
+        return;
+    }
+
+    if (ws->header->opcode != NXT_WEBSOCKET_OP_TEXT) {
+        nxt_unit_websocket_done(ws);
+        return;
+    }
+
+    size = nxt_unit_websocket_read(ws, buf,
+                                   nxt_min(sizeof(buf) - 1,
+                                           ws->content_length));
+    nxt_unit_websocket_done(ws);
+
+    if (size < 0) {
+        return;
+    }
+
+    buf[size] = '\0';
+
+    ws_channel_command(req, buf);
+}
+
+
+static void
+ws_channel_close_handler(nxt_unit_request_info_t *req)
+{
+    nxt_unit_request_done(req, NXT_UNIT_OK);
+}
+
+
+int
+main(void)
+{
+    nxt_unit_ctx_t   *ctx;
+    nxt_unit_init_t  init;
+
+    memset(&init, 0, sizeof(nxt_unit_init_t));
+
+    init.callbacks.request_handler = ws_channel_request_handler;
+    init.callbacks.websocket_handler = ws_channel_websocket_handler;
+    init.callbacks.close_handler = ws_channel_close_handler;
+
+    ctx = nxt_unit_init(&init);
+    if (ctx == NULL) {
+        return 1;
+    }
+
+    nxt_unit_run(ctx);
+    nxt_unit_done(ctx);
+
+    return 0;
+}
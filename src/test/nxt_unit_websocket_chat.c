@@ -22,15 +22,16 @@
 #define CONTENT_TYPE    "Content-Type"
 #define CONTENT_LENGTH  "Content-Length"
 #define TEXT_HTML       "text/html"
+#define CHAT_CHANNEL    "chat"
 
 typedef struct {
-    nxt_queue_link_t  link;
     int               id;
 } ws_chat_request_data_t;
 
 
 static int ws_chat_root(nxt_unit_request_info_t *req);
-static void ws_chat_broadcast(const char *buf, size_t size);
+static void ws_chat_broadcast(nxt_unit_ctx_t *ctx, const char *buf,
+    size_t size);
 
 
 static const char     ws_chat_index_html[];
@@ -39,7 +40,6 @@ static const int      ws_chat_index_html_size;
 static char           ws_chat_index_content_length[34];
 static int            ws_chat_index_content_length_size;
 
-static nxt_queue_t    ws_chat_sessions;
 static int            ws_chat_next_id = 0;
 
 
@@ -72,17 +72,18 @@ ws_chat_request_handler(nxt_unit_request_info_t *req)
         }
 
         data = req->data;
-        nxt_queue_insert_tail(&ws_chat_sessions, &data->link);
-
         data->id = ws_chat_next_id++;
 
         nxt_unit_response_upgrade(req);
         nxt_unit_response_send(req);
 
+        nxt_unit_websocket_subscribe(req, CHAT_CHANNEL,
+                                     nxt_length(CHAT_CHANNEL));
+
 
         buf_size = snprintf(buf, sizeof(buf), "Guest #%d has joined.", data->id);
 
-        ws_chat_broadcast(buf, buf_size);
+        ws_chat_broadcast(req->ctx, buf, buf_size);
 
         return;
     }
@@ -139,21 +140,12 @@ ws_chat_root(nxt_unit_request_info_t *req)
 
 
 static void
-ws_chat_broadcast(const char *buf, size_t size)
+ws_chat_broadcast(nxt_unit_ctx_t *ctx, const char *buf, size_t size)
 {
-    ws_chat_request_data_t   *data;
-    nxt_unit_request_info_t  *req;
-
-    nxt_unit_debug(NULL, "broadcast: %*.s", (int) size, buf);
-
-    nxt_queue_each(data, &ws_chat_sessions, ws_chat_request_data_t, link) {
+    nxt_unit_debug(ctx, "broadcast: %*.s", (int) size, buf);
 
-        req = nxt_unit_get_request_info_from_data(data);
-
-        nxt_unit_req_debug(req, "send: %*.s", (int) size, buf);
-
-        nxt_unit_websocket_send(req, NXT_WEBSOCKET_OP_TEXT, 1, buf, size);
-    } nxt_queue_loop;
+    nxt_unit_websocket_publish(ctx, CHAT_CHANNEL, nxt_length(CHAT_CHANNEL),
+                               NXT_WEBSOCKET_OP_TEXT, buf, size);
 }
 
 
@@ -176,7 +168,7 @@ ws_chat_websocket_handler(nxt_unit_websocket_frame_t *ws)
                                         nxt_min(sizeof(buf),
                                                 ws->content_length));
 
-    ws_chat_broadcast(buf, buf_size);
+    ws_chat_broadcast(ws->req->ctx, buf, buf_size);
 
     nxt_unit_websocket_done(ws);
 }
@@ -187,16 +179,17 @@ ws_chat_close_handler(nxt_unit_request_info_t *req)
 {
     int                     buf_size;
     static char             buf[1024];
+    nxt_unit_ctx_t          *ctx;
     ws_chat_request_data_t  *data;
 
+    ctx = req->ctx;
     data = req->data;
     buf_size = snprintf(buf, sizeof(buf), "Guest #%d has disconnected.",
                         data->id);
 
-    nxt_queue_remove(&data->link);
     nxt_unit_request_done(req, NXT_UNIT_OK);
 
-    ws_chat_broadcast(buf, buf_size);
+    ws_chat_broadcast(ctx, buf, buf_size);
 }
 
 
@@ -211,8 +204,6 @@ main(void)
                  sizeof(ws_chat_index_content_length), "%d",
                  ws_chat_index_html_size);
 
-    nxt_queue_init(&ws_chat_sessions);
-
     memset(&init, 0, sizeof(nxt_unit_init_t));
 
     init.callbacks.request_handler = ws_chat_request_handler;
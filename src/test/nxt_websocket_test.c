@@ -0,0 +1,130 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+#include <nxt_main.h>
+#include <nxt_websocket.h>
+#include "nxt_tests.h"
+
+
+#define NXT_WEBSOCKET_TEST_MAX  (1024 * 1024)
+
+
+static void nxt_websocket_test_unmask_bytes(u_char *p, size_t size,
+    const uint8_t *mask, uint64_t offset);
+static void nxt_websocket_test_bench(nxt_thread_t *thr, u_char *buf,
+    size_t size, const uint8_t *mask);
+
+
+nxt_int_t
+nxt_websocket_test(nxt_thread_t *thr)
+{
+    u_char      *buf, *expect;
+    size_t      size, len;
+    uint64_t    offset;
+    nxt_int_t   ret;
+    nxt_uint_t  i, start;
+
+    static const uint8_t  mask[4] = { 0x37, 0xfa, 0x21, 0x3d };
+
+    nxt_thread_time_update(thr);
+    nxt_log_error(NXT_LOG_NOTICE, thr->log, "websocket unmask test started");
+
+    ret = NXT_ERROR;
+
+    buf = nxt_malloc(NXT_WEBSOCKET_TEST_MAX + 16);
+    expect = nxt_malloc(NXT_WEBSOCKET_TEST_MAX + 16);
+
+    if (buf == NULL || expect == NULL) {
+        goto done;
+    }
+
+    for (i = 0; i < NXT_WEBSOCKET_TEST_MAX + 16; i++) {
+        expect[i] = (u_char) (i * 7 + (i >> 8));
+    }
+
+    /* All alignments, mask offsets, and sizes around the word width. */
+
+    for (start = 0; start < 16; start++) {
+        for (offset = 0; offset < 8; offset++) {
+            for (len = 0; len < 100; len++) {
+                nxt_memcpy(buf, expect, start + len + 1);
+
+                nxt_websocket_unmask(buf + start, len, mask, offset);
+                nxt_websocket_test_unmask_bytes(expect + start, len, mask,
+                                                offset);
+
+                if (memcmp(buf, expect, start + len + 1) != 0) {
+                    nxt_log_alert(thr->log, "websocket unmask test failed: "
+                                  "start:%ui offset:%uL size:%uz",
+                                  start, offset, len);
+                    goto done;
+                }
+            }
+        }
+    }
+
+    for (size = 16; size <= NXT_WEBSOCKET_TEST_MAX; size *= 4) {
+        nxt_websocket_test_bench(thr, buf, size, mask);
+    }
+
+    nxt_log_error(NXT_LOG_NOTICE, thr->log, "websocket unmask test passed");
+
+    ret = NXT_OK;
+
+done:
+
+    nxt_free(buf);
+    nxt_free(expect);
+
+    return ret;
+}
+
+
+static void
+nxt_websocket_test_unmask_bytes(u_char *p, size_t size, const uint8_t *mask,
+    uint64_t offset)
+{
+    size_t  i;
+
+    for (i = 0; i < size; i++) {
+        p[i] ^= mask[(i + offset) % 4];
+    }
+}
+
+
+static void
+nxt_websocket_test_bench(nxt_thread_t *thr, u_char *buf, size_t size,
+    const uint8_t *mask)
+{
+    nxt_nsec_t  start, bytes_time, words_time;
+    nxt_uint_t  i, n;
+
+    n = (256 * 1024 * 1024) / size;
+
+    nxt_thread_time_update(thr);
+    start = nxt_thread_monotonic_time(thr);
+
+    for (i = 0; i < n; i++) {
+        nxt_websocket_test_unmask_bytes(buf, size, mask, i);
+    }
+
+    nxt_thread_time_update(thr);
+    bytes_time = nxt_thread_monotonic_time(thr) - start;
+
+    start = nxt_thread_monotonic_time(thr);
+
+    for (i = 0; i < n; i++) {
+        nxt_websocket_unmask(buf, size, mask, i);
+    }
+
+    nxt_thread_time_update(thr);
+    words_time = nxt_thread_monotonic_time(thr) - start;
+
+    nxt_log_error(NXT_LOG_NOTICE, thr->log,
+                  "websocket unmask %7uz bytes: bytewise %5.0f MB/s, "
+                  "wordwise %5.0f MB/s",
+                  size, (double) size * n * 1000 / nxt_max(bytes_time, 1),
+                  (double) size * n * 1000 / nxt_max(words_time, 1));
+}
@@ -17,6 +17,7 @@ import pytest
 from unit.check.chroot import check_chroot
 from unit.check.go import check_go
 from unit.check.isolation import check_isolation
+from unit.check.ktls import check_ktls
 from unit.check.njs import check_njs
 from unit.check.node import check_node
 from unit.check.regex import check_regex
@@ -222,6 +223,7 @@ def pytest_sessionstart(session):
 
     check_chroot()
     check_isolation()
+    check_ktls()
     check_unix_abstract()
 
     _clear_conf(f'{unit["temp_dir"]}/control.unit.sock')
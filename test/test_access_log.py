@@ -274,6 +274,9 @@ Connection: close
         format = 'BLAH\t0123456789'
         check_format(format, format)
         check_format('$uri $status $uri $status', '/ 200 / 200')
+        check_format('$uri', '^/format$', url='/format')
+        check_format('${uri}$status${uri}', '^/200/$')
+        check_format('$status, ${header_x}', '^200, -$')
 
     def test_access_log_variables(self):
         self.load('mirror')
@@ -287,6 +290,37 @@ Connection: close
             self.wait_for_record(fr'^\/bbs {len(body)}$') is not None
         ), '$body_bytes_sent'
 
+    def test_access_log_phase_times(self):
+        self.load('empty')
+
+        self.set_format(
+            '$uri $tls_handshake_time $queue_time $app_time '
+            '$upstream_connect_time $upstream_response_time'
+        )
+
+        assert self.get(url='/app')['status'] == 200
+        assert (
+            self.wait_for_record(r'^\/app - \d+\.\d{3} \d+\.\d{3} - -$')
+            is not None
+        ), 'application phase times'
+
+        assert 'success' in self.conf(
+            [{"action": {"proxy": "http://127.0.0.1:7080"}}], 'routes'
+        ), 'routes configure'
+        assert 'success' in self.conf(
+            {
+                "*:7080": {"pass": "applications/empty"},
+                "*:7081": {"pass": "routes"},
+            },
+            'listeners',
+        ), 'listeners configure'
+
+        assert self.get(url='/proxy', port=7081)['status'] == 200
+        assert (
+            self.wait_for_record(r'^\/proxy - - - \d+\.\d{3} \d+\.\d{3}$')
+            is not None
+        ), 'upstream phase times'
+
     def test_access_log_incorrect(self, temp_dir, skip_alert):
         skip_alert(r'failed to apply new conf')
 
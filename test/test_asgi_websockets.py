@@ -1,5 +1,6 @@
 import struct
 import time
+import zlib
 
 import pytest
 from packaging import version
@@ -1497,3 +1498,222 @@ class TestASGIWebsockets(TestApplicationPython):
         assert message == frame['data'].decode('utf-8'), 'client'
 
         sock.close()
+
+    def deflate_setup(self, deflate=None):
+        if deflate is None:
+            deflate = {'threshold': 16}
+
+        self.load('websockets/mirror')
+
+        assert 'success' in self.conf(
+            {
+                'http': {
+                    'websocket': {
+                        'keepalive_interval': 0,
+                        'permessage_deflate': deflate,
+                    }
+                }
+            },
+            'settings',
+        ), 'permessage_deflate'
+
+    def deflate_upgrade(self, offer='permessage-deflate'):
+        key = self.ws.key()
+
+        resp, sock, _ = self.ws.upgrade(
+            headers={
+                'Host': 'localhost',
+                'Upgrade': 'websocket',
+                'Connection': 'Upgrade',
+                'Sec-WebSocket-Key': key,
+                'Sec-WebSocket-Version': 13,
+                'Sec-WebSocket-Extensions': offer,
+            }
+        )
+
+        assert resp['status'] == 101, 'status'
+
+        return (resp, sock)
+
+    def deflate_message(self, comp, message):
+        data = comp.compress(message.encode()) + comp.flush(zlib.Z_SYNC_FLUSH)
+
+        assert data.endswith(b'\x00\x00\xff\xff'), 'sync flush tail'
+
+        return data[:-4]
+
+    def deflate_frame_read(self, sock, decomp, compressed=True):
+        frame = self.ws.message_read(sock)
+
+        assert frame['rsv1'] == compressed, 'rsv1'
+
+        if compressed:
+            frame['data'] = decomp.decompress(
+                frame['data'] + b'\x00\x00\xff\xff'
+            )
+
+        return frame['data'].decode()
+
+    def test_asgi_websockets_deflate(self):
+        self.deflate_setup()
+
+        resp, sock = self.deflate_upgrade(
+            'x-webkit-deflate-frame, '
+            'permessage-deflate; client_max_window_bits'
+        )
+
+        assert (
+            resp['headers']['Sec-WebSocket-Extensions']
+            == 'permessage-deflate; server_max_window_bits=12; '
+            'client_max_window_bits=12'
+        ), 'extensions'
+
+        comp = zlib.compressobj(wbits=-12)
+        decomp = zlib.decompressobj(wbits=-12)
+
+        message = '0123456789' * 100
+
+        for i in range(3):
+            data = self.deflate_message(comp, message)
+
+            self.ws.frame_write(sock, self.ws.OP_TEXT, data, rsv1=True)
+
+            assert (
+                self.deflate_frame_read(sock, decomp) == message
+            ), f'compressed message {i}'
+
+        self.ws.frame_write(sock, self.ws.OP_TEXT, 'short')
+
+        assert (
+            self.deflate_frame_read(sock, decomp, compressed=False) == 'short'
+        ), 'below threshold'
+
+        data = self.deflate_message(comp, message)
+
+        self.ws.frame_write(
+            sock, self.ws.OP_TEXT, data[:10], rsv1=True, fin=False
+        )
+        self.ws.frame_write(sock, self.ws.OP_CONT, data[10:20], fin=False)
+        self.ws.frame_write(sock, self.ws.OP_CONT, data[20:])
+
+        assert (
+            self.deflate_frame_read(sock, decomp) == message
+        ), 'fragmented message'
+
+        self.close_connection(sock)
+
+    def test_asgi_websockets_deflate_params(self):
+        self.deflate_setup(
+            {'window_bits': 10, 'context_takeover': False, 'threshold': 0}
+        )
+
+        resp, sock = self.deflate_upgrade()
+
+        assert (
+            resp['headers']['Sec-WebSocket-Extensions']
+            == 'permessage-deflate; server_max_window_bits=10; '
+            'server_no_context_takeover'
+        ), 'extensions'
+
+        comp = zlib.compressobj(wbits=-15)
+
+        for message in ['', 'blah', 'blah' * 1000]:
+            self.ws.frame_write(
+                sock,
+                self.ws.OP_TEXT,
+                self.deflate_message(comp, message),
+                rsv1=True,
+            )
+
+            # No context takeover: every message is decompressed alone.
+
+            assert (
+                self.deflate_frame_read(sock, zlib.decompressobj(wbits=-10))
+                == message
+            ), f'message {len(message)}'
+
+        self.close_connection(sock)
+
+    def test_asgi_websockets_deflate_declined(self):
+        self.deflate_setup()
+
+        for offer in [
+            'x-webkit-deflate-frame',
+            'permessage-deflate; server_max_window_bits=8',
+            'permessage-deflate; unknown_param',
+            'permessage-deflate; server_no_context_takeover=1',
+        ]:
+            resp, sock = self.deflate_upgrade(offer)
+
+            assert (
+                'Sec-WebSocket-Extensions' not in resp['headers']
+            ), f'declined {offer}'
+
+            self.ws.frame_write(sock, self.ws.OP_TEXT, 'blah' * 10)
+
+            assert self.ws.frame_read(sock)['data'] == b'blah' * 10, 'plain'
+
+            self.close_connection(sock)
+
+        resp, sock = self.deflate_upgrade(
+            'permessage-deflate; server_max_window_bits=8, '
+            'permessage-deflate; server_max_window_bits="12"'
+        )
+
+        assert (
+            resp['headers']['Sec-WebSocket-Extensions']
+            == 'permessage-deflate; server_max_window_bits=12'
+        ), 'second offer'
+
+        sock.close()
+
+    def test_asgi_websockets_deflate_invalid(self):
+        self.deflate_setup()
+
+        _, sock = self.deflate_upgrade()
+
+        self.ws.frame_write(sock, self.ws.OP_TEXT, b'\xff' * 20, rsv1=True)
+
+        self.check_close(sock, 1007)
+
+        _, sock = self.deflate_upgrade()
+
+        self.ws.frame_write(sock, self.ws.OP_TEXT, 'blah', fin=False)
+        self.ws.frame_write(sock, self.ws.OP_CONT, 'blah', rsv1=True)
+
+        self.check_close(sock, 1002)
+
+        _, sock = self.deflate_upgrade()
+
+        self.ws.frame_write(sock, self.ws.OP_PING, 'blah', rsv1=True)
+
+        self.check_close(sock, 1002)
+
+        assert 'success' in self.conf(
+            '256', 'settings/http/websocket/max_frame_size'
+        ), 'max_frame_size'
+
+        _, sock = self.deflate_upgrade()
+
+        comp = zlib.compressobj(wbits=-15)
+
+        self.ws.frame_write(
+            sock,
+            self.ws.OP_TEXT,
+            self.deflate_message(comp, '0' * 1000),
+            rsv1=True,
+        )
+
+        self.check_close(sock, 1009)
+
+    def test_asgi_websockets_deflate_conf(self):
+        def check_deflate(deflate):
+            assert 'error' in self.conf(
+                deflate, 'settings/http/websocket/permessage_deflate'
+            ), 'invalid permessage_deflate'
+
+        check_deflate({'window_bits': 8})
+        check_deflate({'window_bits': 16})
+        check_deflate({'context_takeover': 'yes'})
+        check_deflate({'blah': 1})
+        check_deflate('"yes"')
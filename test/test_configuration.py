@@ -3,6 +3,7 @@ import socket
 import pytest
 from unit.control import TestControl
 from unit.option import option
+from unit.status import Status
 
 
 class TestConfiguration(TestControl):
@@ -421,6 +422,111 @@ class TestConfiguration(TestControl):
 
         assert 'success' in self.conf(conf)
 
+    def test_json_batch(self):
+        assert 'success' in self.conf(
+            {
+                "listeners": {"*:7080": {"pass": "routes"}},
+                "routes": [{"action": {"return": 200}}],
+                "applications": {},
+            }
+        )
+
+        Status.init()
+
+        assert 'success' in self.conf_patch(
+            [
+                {
+                    "op": "add",
+                    "path": "/routes/-",
+                    "value": {"action": {"return": 201}},
+                },
+                {
+                    "op": "replace",
+                    "path": "/routes/0/action/return",
+                    "value": 204,
+                },
+                {
+                    "op": "add",
+                    "path": "/listeners/*:7081",
+                    "value": {"pass": "routes"},
+                },
+                {"op": "remove", "path": "/routes/1"},
+            ]
+        ), 'batch'
+
+        assert self.conf_get('routes') == [
+            {"action": {"return": 204}}
+        ], 'batch routes'
+        assert 'routes' in self.conf_get('listeners/*:7081/pass'), 'batch add'
+        assert Status.get('/configuration/reloads') == 1, 'batch one reload'
+
+        assert 'success' in self.conf_patch(
+            [
+                {"op": "add", "path": "/settings", "value": {"http": {}}},
+                {
+                    "op": "add",
+                    "path": "/settings/http/idle_timeout",
+                    "value": 60,
+                },
+                {"op": "remove", "path": "/listeners/*:7081"},
+            ]
+        ), 'batch nested'
+
+        assert self.conf_get('settings') == {
+            "http": {"idle_timeout": 60}
+        }, 'batch nested settings'
+        assert list(self.conf_get('listeners')) == [
+            '*:7080'
+        ], 'batch nested listeners'
+
+        assert 'success' in self.conf_patch([]), 'batch empty'
+
+    def test_json_batch_atomic(self):
+        conf = {
+            "listeners": {"*:7080": {"pass": "routes"}},
+            "routes": [{"action": {"return": 200}}],
+            "applications": {},
+        }
+
+        assert 'success' in self.conf(conf)
+
+        resp = self.conf_patch(
+            [
+                {"op": "replace", "path": "/routes/0", "value": {}},
+                {"op": "replace", "path": "/routes/1", "value": {}},
+            ]
+        )
+        assert 'error' in resp, 'not found'
+        assert resp['detail'] == (
+            'Operation 1 refers to a value that doesn\'t exist.'
+        ), 'not found detail'
+
+        assert 'error' in self.conf_patch(
+            [
+                {"op": "replace", "path": "/routes/0", "value": {}},
+                {
+                    "op": "replace",
+                    "path": "/listeners/*:7080/pass",
+                    "value": "applications/blah",
+                },
+            ]
+        ), 'invalid result'
+
+        assert self.conf_get() == conf, 'unchanged'
+
+    def test_json_batch_invalid(self):
+        assert 'error' in self.conf_patch({"op": "remove", "path": "/"})
+        assert 'error' in self.conf_patch([{"op": "remove"}]), 'no path'
+        assert 'error' in self.conf_patch([{"op": "move", "path": "/"}])
+        assert 'error' in self.conf_patch([{"op": "add", "path": "/routes"}])
+        assert 'error' in self.conf_patch(
+            [{"op": "remove", "path": "/routes", "value": 1}]
+        ), 'remove with value'
+        assert 'error' in self.conf_patch(
+            [{"op": "add", "path": "/listeners/-", "value": 1}]
+        ), 'append to object'
+        assert 'error' in self.conf_patch([], 'applications'), 'not root'
+
     def test_unprivileged_user_error(self, is_su, skip_alert):
         skip_alert(r'cannot set user "root"', r'failed to apply new conf')
         if is_su:
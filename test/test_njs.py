@@ -74,6 +74,17 @@ class TestNJS(TestApplicationProto):
         self.set_share(f'"`{temp_dir}/assets/${{args.foo}}`"')
         assert self.get(url='/?foo=str')['status'] == 200, 'args'
 
+    def test_njs_global_state(self, temp_dir):
+        self.create_files('undefined')
+
+        self.set_share(
+            f'"`{temp_dir}/assets/'
+            '${[typeof globalThis.leak, globalThis.leak = uri][0]}`"'
+        )
+
+        for _ in range(10):
+            assert self.get()['status'] == 200, 'global is reset'
+
     def test_njs_invalid(self, temp_dir, skip_alert):
         skip_alert(r'js exception:')
 
@@ -335,6 +335,57 @@ custom-header: BLAH
 
         self.get(headers=headers_delay_1)
 
+    def test_python_application_max_queue(self):
+        self.load('delayed', processes=1, limits={"max_queue": 1})
+
+        self.get(
+            headers={
+                'Host': 'localhost',
+                'Content-Length': '0',
+                'X-Delay': '2',
+                'Connection': 'close',
+            },
+            no_recv=True,
+        )
+
+        time.sleep(0.5)
+
+        sock = self.get(no_recv=True)
+
+        time.sleep(0.2)
+
+        assert self.get()['status'] == 503, 'queue full'
+
+        assert self.recvall(sock).decode().startswith(
+            'HTTP/1.1 200'
+        ), 'queued request'
+        sock.close()
+
+        assert self.get()['status'] == 200, 'queue empty'
+
+    def test_python_application_queue_timeout(self):
+        self.load('delayed', processes=1, limits={"queue_timeout": 1})
+
+        self.get(
+            headers={
+                'Host': 'localhost',
+                'Content-Length': '0',
+                'X-Delay': '3',
+                'Connection': 'close',
+            },
+            no_recv=True,
+        )
+
+        time.sleep(0.5)
+
+        start = time.time()
+        assert self.get()['status'] == 503, 'queue timeout'
+        assert time.time() - start < 2, 'queue timeout time'
+
+        time.sleep(2)
+
+        assert self.get()['status'] == 200, 'queue timeout reset'
+
     @pytest.mark.skip('not yet')
     def test_python_application_start_response_exit(self):
         self.load('start_response_exit')
@@ -173,6 +173,70 @@ class TestPythonProcman(TestApplicationPython):
 
         sock.close()
 
+    def test_python_processes_autoscale(self):
+        self.load(
+            'delayed',
+            self.app_name,
+            processes={
+                "spare": 0,
+                "max": 3,
+                "idle_timeout": 1,
+                "autoscale": {"queue_time": 0.1, "cooldown": 1},
+            },
+        )
+
+        headers_delay_1 = {
+            'Connection': 'close',
+            'Host': 'localhost',
+            'Content-Length': '0',
+            'X-Delay': '1',
+        }
+
+        assert len(self.pids_for_process()) == 0, 'autoscale 0'
+
+        for _ in range(4):
+            self.get(headers=headers_delay_1, no_recv=True)
+
+        time.sleep(3)
+
+        assert len(self.pids_for_process()) >= 2, 'autoscale up'
+
+        time.sleep(3)
+
+        assert len(self.pids_for_process()) == 1, 'autoscale down'
+
+        status = self.conf_get(f'/status/applications/{self.app_name}')
+        assert status['autoscale']['target'] == 1, 'autoscale target'
+        assert status['autoscale']['up'] >= 1, 'autoscale up count'
+        assert status['autoscale']['down'] >= 1, 'autoscale down count'
+
+    def test_python_processes_autoscale_queued(self):
+        self.load(
+            'delayed',
+            self.app_name,
+            processes={
+                "spare": 0,
+                "max": 3,
+                "autoscale": {"queue_time": 0.1, "cooldown": 60},
+            },
+        )
+
+        headers_delay_2 = {
+            'Connection': 'close',
+            'Host': 'localhost',
+            'Content-Length': '0',
+            'X-Delay': '2',
+        }
+
+        # queued requests start processes before the next evaluation
+
+        for _ in range(3):
+            self.get(headers=headers_delay_2, no_recv=True)
+
+        time.sleep(1)
+
+        assert len(self.pids_for_process()) == 3, 'autoscale queued'
+
     def test_python_processes_access(self):
         self.conf_proc('1')
 
@@ -198,6 +262,15 @@ class TestPythonProcman(TestApplicationPython):
         assert 'error' in self.conf(
             {"spare": 0, "max": 0}, self.app_proc
         ), 'max zero'
+        assert 'error' in self.conf(
+            {"autoscale": {"queue_time": -1}}, self.app_proc
+        ), 'negative autoscale queue_time'
+        assert 'error' in self.conf(
+            {"autoscale": {"step_up": 0}}, self.app_proc
+        ), 'autoscale step_up zero'
+        assert 'error' in self.conf(
+            {"autoscale": {"blah": 1}}, self.app_proc
+        ), 'autoscale unknown member'
 
     def stop_all(self):
         assert 'success' in self.conf({"listeners": {}, "applications": {}})
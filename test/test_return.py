@@ -1,4 +1,5 @@
 import re
+import time
 
 from unit.applications.proto import TestApplicationProto
 
@@ -57,6 +58,23 @@ Connection: close
         assert 'Connection' not in resp['headers']
         assert resp['body'] == '', 'body'
 
+    def test_return_date(self):
+        def dates():
+            resp = self.get_resps_sc(req=3)
+
+            values = re.findall(r'Date: ([^\r]+)\r\n', resp)
+
+            assert len(values) == 3, 'one Date per response'
+            assert len(re.findall('Server: ', resp)) == 3, 'one Server'
+
+            return values[-1]
+
+        date = dates()
+
+        time.sleep(1.1)
+
+        assert dates() != date, 'Date updated'
+
     def test_return_update(self):
         assert 'success' in self.conf('0', 'routes/0/action/return')
 
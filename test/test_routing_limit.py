@@ -0,0 +1,136 @@
+import time
+
+from unit.applications.lang.python import TestApplicationPython
+
+
+class TestRoutingLimit(TestApplicationPython):
+    prerequisites = {'modules': {'python': 'any'}}
+
+    def setup_method(self):
+        assert 'success' in self.conf(
+            {
+                "listeners": {"*:7080": {"pass": "routes"}},
+                "routes": [
+                    {
+                        "limit": {"key": "$remote_addr", "rate": 1},
+                        "action": {"return": 200},
+                    }
+                ],
+                "applications": {},
+            }
+        ), 'limit configure'
+
+    def set_limit(self, limit):
+        assert 'success' in self.conf(limit, 'routes/0/limit'), 'set limit'
+
+    def test_routing_limit_rate(self):
+        assert self.get()['status'] == 200, 'first'
+        assert self.get()['status'] == 503, 'limited'
+        assert self.get()['status'] == 503, 'limited 2'
+
+        time.sleep(1.1)
+
+        assert self.get()['status'] == 200, 'leaked'
+        assert self.get()['status'] == 503, 'limited 3'
+
+    def test_routing_limit_burst(self):
+        self.set_limit({"key": "$remote_addr", "rate": 1, "burst": 2})
+
+        for i in range(3):
+            assert self.get()['status'] == 200, f'burst {i}'
+
+        assert self.get()['status'] == 503, 'limited'
+
+    def test_routing_limit_key(self):
+        self.set_limit({"key": "$arg_id", "rate": 1})
+
+        assert self.get(url='/?id=1')['status'] == 200, 'key 1'
+        assert self.get(url='/?id=1')['status'] == 503, 'key 1 limited'
+        assert self.get(url='/?id=2')['status'] == 200, 'key 2'
+        assert self.get(url='/?id=2')['status'] == 503, 'key 2 limited'
+
+        assert self.get()['status'] == 200, 'empty key'
+        assert self.get()['status'] == 200, 'empty key 2'
+
+    def test_routing_limit_max_keys(self):
+        self.set_limit({"key": "$arg_id", "rate": 1, "max_keys": 1})
+
+        assert self.get(url='/?id=1')['status'] == 200, 'key 1'
+        assert self.get(url='/?id=1')['status'] == 503, 'key 1 limited'
+
+        # The idle key 1 is evicted to add the key 2.
+
+        assert self.get(url='/?id=2')['status'] == 200, 'key 2'
+        assert self.get(url='/?id=1')['status'] == 200, 'key 1 evicted'
+
+    def test_routing_limit_match(self):
+        assert 'success' in self.conf(
+            [
+                {
+                    "match": {"uri": "/limited"},
+                    "limit": {"key": "$remote_addr", "rate": 1},
+                    "action": {"return": 200},
+                },
+                {"action": {"return": 204}},
+            ],
+            'routes',
+        ), 'routes configure'
+
+        assert self.get(url='/limited')['status'] == 200, 'limited first'
+        assert self.get(url='/limited')['status'] == 503, 'limited'
+        assert self.get(url='/')['status'] == 204, 'not limited'
+        assert self.get(url='/')['status'] == 204, 'not limited 2'
+
+    def test_routing_limit_requests(self):
+        self.load('delayed')
+
+        assert 'success' in self.conf(
+            [
+                {
+                    "limit": {"key": "$remote_addr", "requests": 1},
+                    "action": {"pass": "applications/delayed"},
+                }
+            ],
+            'routes',
+        ), 'routes configure'
+        assert 'success' in self.conf(
+            {"*:7080": {"pass": "routes"}}, 'listeners'
+        ), 'listeners configure'
+
+        sock = self.get(
+            headers={
+                'Host': 'localhost',
+                'Content-Length': '0',
+                'X-Delay': '2',
+                'Connection': 'close',
+            },
+            no_recv=True,
+        )
+
+        time.sleep(0.5)
+
+        assert self.get()['status'] == 503, 'requests limited'
+
+        assert self.recvall(sock).decode().startswith(
+            'HTTP/1.1 200'
+        ), 'first request'
+
+        assert self.get()['status'] == 200, 'request released'
+
+    def test_routing_limit_invalid(self):
+        def check_limit(limit):
+            assert 'error' in self.conf(limit, 'routes/0/limit')
+
+        check_limit({"rate": 1})
+        check_limit({"key": "$remote_addr"})
+        check_limit({"key": "$remote_addr", "burst": 1, "requests": 1})
+        check_limit({"key": "$remote_addr", "rate": 0})
+        check_limit({"key": "$remote_addr", "rate": -1})
+        check_limit({"key": "$remote_addr", "rate": "1"})
+        check_limit({"key": "$remote_addr", "rate": 1, "burst": -1})
+        check_limit({"key": "$remote_addr", "requests": 0})
+        check_limit({"key": "$remote_addr", "connections": 1})
+        check_limit({"key": "$remote_addr", "rate": 1, "max_keys": 0})
+        check_limit({"key": "$blah", "rate": 1})
+        check_limit({"key": "$remote_addr", "rate": 1, "blah": 1})
+        check_limit('"$remote_addr"')
@@ -1,3 +1,4 @@
+import re
 import time
 
 import pytest
@@ -205,6 +206,40 @@ Connection: close
         check_application('restart', 0, 1, 0, 1)
         check_application('delayed', 0, 0, 0, 0)
 
+    def test_status_applications_dispatch(self):
+        self.load('empty')
+
+        assert 'error' in self.conf(
+            {"depth": 0}, 'applications/empty/dispatch'
+        ), 'depth zero'
+        assert 'error' in self.conf(
+            {"key": "$blah"}, 'applications/empty/dispatch'
+        ), 'key unknown variable'
+        assert 'success' in self.conf('2', 'applications/empty/processes')
+        assert 'success' in self.conf(
+            {"key": "$header_x_key"}, 'applications/empty/dispatch'
+        )
+
+        Status.init()
+
+        for i in range(10):
+            assert (
+                self.get(
+                    headers={
+                        'Host': 'localhost',
+                        'X-Key': str(i % 2),
+                        'Connection': 'close',
+                    }
+                )['status']
+                == 200
+            )
+
+        assert Status.get('/applications/empty/dispatch') == {
+            'direct': 10,
+            'contended': 0,
+            'stolen': 0,
+        }
+
     def test_status_proxy(self):
         assert 'success' in self.conf(
             {
@@ -229,3 +264,162 @@ Connection: close
         assert self.get()['status'] == 200
         self.check_connections(2, 0, 0, 2)
         assert Status.get('/requests/total') == 2, 'proxy'
+
+    def test_status_configuration(self):
+        conf = {
+            "listeners": {"*:7080": {"pass": "routes"}},
+            "routes": [{"action": {"return": 200}}],
+            "applications": {"empty": self.app_default()},
+        }
+
+        assert 'success' in self.conf(conf)
+
+        Status.init()
+
+        assert 'success' in self.conf(conf)
+        assert Status.get('/configuration/reloads') == 0, 'same reloads'
+        assert Status.get('/configuration/unchanged') == 1, 'same unchanged'
+
+        assert 'success' in self.conf({"return": 204}, 'routes/0/action')
+        assert self.get()['status'] == 204, 'changed'
+        assert Status.get('/configuration/reloads') == 1, 'changed reloads'
+        assert Status.get('/configuration/unchanged') == 1, 'changed unchanged'
+
+        status = self.conf_get('/status/configuration')
+        assert status['max_time'] >= status['last_time'], 'reload time'
+
+    def test_status_traffic(self):
+        assert 'success' in self.conf(
+            {
+                "listeners": {
+                    "*:7080": {"pass": "routes/main"},
+                    "*:7081": {"pass": "applications/empty"},
+                },
+                "routes": {
+                    "main": [
+                        {
+                            "match": {"uri": "/app"},
+                            "action": {"pass": "applications/empty"},
+                        },
+                        {"action": {"return": 404}},
+                    ]
+                },
+                "applications": {"empty": self.app_default()},
+            }
+        )
+
+        Status.init()
+
+        assert self.get()['status'] == 404
+        assert self.post(url='/app', body='0123456789')['status'] == 200
+        assert self.get(port=7081)['status'] == 200
+
+        assert Status.get('/listeners/*:7080/responses') == {
+            '1xx': 0,
+            '2xx': 1,
+            '3xx': 0,
+            '4xx': 1,
+            '5xx': 0,
+        }
+        assert Status.get('/listeners/*:7080/bytes/in') == 10
+        assert Status.get('/listeners/*:7081/latency/total/count') == 1
+
+        assert Status.get('/routes/main/0/responses/2xx') == 1
+        assert Status.get('/routes/main/1/responses/4xx') == 1
+        assert Status.get('/routes/main/1/latency/total/count') == 1
+
+        latency = Status.get('/applications/empty/latency')
+        assert latency['queue']['count'] == 2, 'queue'
+        assert latency['service']['count'] == 2, 'service'
+        assert latency['total']['buckets']['+Inf'] == 2, 'total'
+        assert Status.get('/applications/empty/bytes/in') == 10
+
+        # Routes are kept while only listeners change.
+
+        assert 'success' in self.conf(
+            {
+                "*:7080": {"pass": "routes/main"},
+                "*:7081": {"pass": "routes/main"},
+                "*:7082": {"pass": "applications/empty"},
+            },
+            'listeners',
+        )
+        assert self.get(port=7081)['status'] == 404
+        assert self.get(port=7082)['status'] == 200
+
+        assert Status.get('/listeners/*:7080/responses/4xx') == 1
+        assert Status.get('/routes/main/0/responses/2xx') == 1
+        assert Status.get('/routes/main/1/responses/4xx') == 2
+
+        # Listener counters survive reconfiguration, route counters do not.
+
+        assert 'success' in self.conf({"return": 403}, 'routes/main/1/action')
+        assert self.get()['status'] == 403
+
+        assert Status.get('/listeners/*:7080/responses/4xx') == 2
+        assert self.conf_get('/status/routes/main/1/responses/4xx') == 1
+
+        # Counters of all engines are summed up.
+
+        for _ in range(10):
+            assert self.get()['status'] == 403
+
+        assert Status.get('/listeners/*:7080/responses/4xx') == 12
+
+        # Routes are reported from the current configuration.
+
+        assert 'success' in self.conf({}, 'listeners')
+        assert self.conf_get('/status/routes/main/1/responses/4xx') == 11
+
+        assert 'success' in self.conf({"return": 404}, 'routes/main/1/action')
+        assert self.conf_get('/status/routes/main/1/responses/4xx') == 0
+
+    def test_status_metrics(self):
+        self.load('empty')
+
+        assert self.get()['status'] == 200
+
+        resp = self.get(
+            url='/metrics',
+            sock_type='unix',
+            addr=f'{option.temp_dir}/control.unit.sock',
+        )
+        assert resp['status'] == 200
+        assert resp['headers']['Content-Type'].startswith('text/plain')
+
+        body = resp['body']
+        assert re.search(r'^unit_requests_total \d+$', body, re.M)
+        assert (
+            'unit_listener_responses_total{listener="*:7080",code="2xx"} 1'
+            in body
+        )
+        assert (
+            'unit_application_queue_duration_seconds_count'
+            '{application="empty"} 1' in body
+        )
+        assert (
+            'unit_application_request_duration_seconds_bucket'
+            '{application="empty",le="+Inf"} 1' in body
+        )
+        assert body.count('# TYPE unit_application_processes gauge') == 1
+        assert re.search(
+            r'^unit_connections_tls_handshakes_queued 0$', body, re.M
+        )
+        assert re.search(
+            r'^unit_connections_tls_handshake_duration_seconds_bucket'
+            r'\{le="\+Inf"\} \d+$',
+            body,
+            re.M,
+        )
+        assert re.search(
+            r'^unit_connections_tls_handshake_duration_seconds_count \d+$',
+            body,
+            re.M,
+        )
+
+        resp = self.delete(
+            url='/metrics',
+            sock_type='unix',
+            addr=f'{option.temp_dir}/control.unit.sock',
+        )
+        assert resp['status'] == 405, 'DELETE method'
@@ -1,4 +1,5 @@
 import io
+import socket
 import ssl
 import subprocess
 import time
@@ -6,6 +7,7 @@ import time
 import pytest
 from unit.applications.tls import TestApplicationTLS
 from unit.option import option
+from unit.status import Status
 
 
 class TestTLS(TestApplicationTLS):
@@ -681,3 +683,201 @@ basicConstraints = critical,CA:TRUE"""
         assert self.get_ssl()['status'] == 200, 'listener #1'
 
         assert self.get_ssl(port=7081)['status'] == 200, 'listener #2'
+
+    def test_tls_ktls(self, temp_dir):
+        if 'ktls' not in option.available['features']:
+            pytest.skip('kernel TLS is not supported')
+
+        self.certificate()
+
+        data = '0123456789' * 100000
+
+        with open(f'{temp_dir}/file', 'w') as f:
+            f.write(data)
+
+        assert 'success' in self.conf(
+            {
+                "listeners": {
+                    "*:7080": {
+                        "pass": "routes",
+                        "tls": {"certificate": "default", "ktls": True},
+                    }
+                },
+                "routes": [{"action": {"share": f'{temp_dir}$uri'}}],
+                "applications": {},
+            }
+        ), 'ktls configure'
+
+        Status.init()
+
+        resp = self.get_ssl(url='/file')
+        assert resp['status'] == 200, 'ktls status'
+        assert resp['body'] == data, 'ktls body'
+
+        assert self.get_ssl(url='/file')['body'] == data, 'ktls body 2'
+
+        assert Status.get('/connections/tls') == 2, 'tls connections'
+        assert Status.get('/connections/ktls') == 2, 'ktls connections'
+
+        assert 'error' in self.conf(
+            '"on"', 'listeners/*:7080/tls/ktls'
+        ), 'ktls invalid'
+
+    def test_tls_async_handshake(self, skip_alert):
+        skip_alert(r'SSL_do_handshake\(\d+\) failed')
+
+        self.certificate()
+
+        self.load('empty')
+
+        assert 'success' in self.conf(
+            {
+                "pass": "applications/empty",
+                "tls": {"certificate": "default", "async_handshake": True},
+            },
+            'listeners/*:7080',
+        ), 'async handshake configure'
+
+        Status.init()
+
+        for _ in range(3):
+            assert self.get_ssl()['status'] == 200, 'async handshake'
+
+        assert Status.get('/connections/tls') == 3, 'tls connections'
+        assert (
+            Status.get('/connections/tls_handshakes/latency/count') >= 3
+        ), 'offloaded steps'
+        assert (
+            Status.get('/connections/tls_handshakes/queued') == 0
+        ), 'queued'
+
+        sock = socket.create_connection(('127.0.0.1', 7080))
+        sock.sendall(b'\x16\x03\x01\x00\x05\x01\x00\x00\x01\x00')
+        assert sock.recv(1024)[:1] == b'\x15', 'handshake failure alert'
+        sock.close()
+
+        assert self.get_ssl()['status'] == 200, 'after failure'
+
+        assert 'error' in self.conf(
+            '"on"', 'listeners/*:7080/tls/async_handshake'
+        ), 'async handshake invalid'
+
+    def test_tls_ocsp(self, temp_dir):
+        self.load('empty')
+
+        self.certificate('root', False)
+
+        self.req('end')
+
+        self.generate_ca_conf()
+
+        self.ca(cert='root', out='end')
+
+        # the issuer is required in the chain to check the response
+
+        with open(f'{temp_dir}/end-root.crt', 'wb') as crt, open(
+            f'{temp_dir}/end.crt', 'rb'
+        ) as end, open(f'{temp_dir}/root.crt', 'rb') as root:
+            crt.write(end.read() + root.read())
+
+        assert 'success' in self.certificate_load('end-root', 'end')
+
+        resp_path = f'{temp_dir}/end.der'
+
+        assert 'success' in self.conf(
+            {
+                "pass": "applications/empty",
+                "tls": {
+                    "certificate": "end-root",
+                    "ocsp": {
+                        "responses": {"end-root": resp_path},
+                        "refresh": 1,
+                    },
+                },
+            },
+            'listeners/*:7080',
+        ), 'ocsp configure'
+
+        def stapled():
+            out = subprocess.check_output(
+                [
+                    'openssl',
+                    's_client',
+                    '-connect',
+                    '127.0.0.1:7080',
+                    '-status',
+                ],
+                input=b'',
+                stderr=subprocess.STDOUT,
+            ).decode()
+
+            return 'OCSP Response Status: successful' in out
+
+        assert not stapled(), 'no response'
+
+        with open(resp_path, 'wb') as f:
+            f.write(b'blah')
+
+        time.sleep(1.5)
+
+        assert not stapled(), 'invalid response'
+        assert (
+            self.wait_for_record(r'OCSP response .* is not updated')
+            is not None
+        ), 'invalid response log'
+
+        subprocess.check_output(
+            [
+                'openssl',
+                'ocsp',
+                '-issuer',
+                f'{temp_dir}/root.crt',
+                '-cert',
+                f'{temp_dir}/end.crt',
+                '-no_nonce',
+                '-reqout',
+                f'{temp_dir}/end.req',
+            ],
+            stderr=subprocess.STDOUT,
+        )
+
+        subprocess.check_output(
+            [
+                'openssl',
+                'ocsp',
+                '-index',
+                f'{temp_dir}/certindex',
+                '-rsigner',
+                f'{temp_dir}/root.crt',
+                '-rkey',
+                f'{temp_dir}/root.key',
+                '-CA',
+                f'{temp_dir}/root.crt',
+                '-reqin',
+                f'{temp_dir}/end.req',
+                '-respout',
+                resp_path,
+                '-ndays',
+                '1',
+            ],
+            stderr=subprocess.STDOUT,
+        )
+
+        for _ in range(50):
+            if stapled():
+                break
+
+            time.sleep(0.1)
+
+        assert stapled(), 'response refreshed'
+        assert self.get_ssl()['status'] == 200, 'request'
+
+        def check_ocsp(ocsp):
+            assert 'error' in self.conf(ocsp, 'listeners/*:7080/tls/ocsp')
+
+        check_ocsp({"refresh": 1})
+        check_ocsp({"responses": {"blah": resp_path}})
+        check_ocsp({"responses": {"end-root": "end.der"}})
+        check_ocsp({"responses": {"end-root": 1}})
+        check_ocsp({"responses": {"end-root": resp_path}, "refresh": 0})
+        check_ocsp({"responses": {"end-root": resp_path}, "blah": 1})
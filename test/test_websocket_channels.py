@@ -0,0 +1,209 @@
+import os
+import zlib
+
+import pytest
+from unit.applications.proto import TestApplicationProto
+from unit.applications.websockets import TestApplicationWebsocket
+from unit.option import option
+
+
+class TestWebsocketChannels(TestApplicationProto):
+    prerequisites = {}
+
+    ws = TestApplicationWebsocket()
+
+    @pytest.fixture(autouse=True)
+    def setup_method_fixture(self, skip_alert):
+        executable = f'{option.current_dir}/build/unit_websocket_channel'
+
+        if not os.path.exists(executable):
+            pytest.skip('requires "make tests"')
+
+        app = {"type": "external", "executable": executable}
+
+        assert 'success' in self.conf(
+            {
+                "listeners": {"*:7080": {"pass": "routes"}},
+                "routes": [
+                    {
+                        "match": {"host": "b"},
+                        "action": {"pass": "applications/b"},
+                    },
+                    {"action": {"pass": "applications/a"}},
+                ],
+                "applications": {"a": app, "b": dict(app)},
+                "settings": {
+                    "http": {"websocket": {"keepalive_interval": 0}}
+                },
+            }
+        )
+
+        skip_alert(r'socket close\(\d+\) failed')
+
+    def connect(self, host='localhost', deflate=False):
+        headers = {
+            'Host': host,
+            'Upgrade': 'websocket',
+            'Connection': 'Upgrade',
+            'Sec-WebSocket-Key': self.ws.key(),
+            'Sec-WebSocket-Version': 13,
+        }
+
+        if deflate:
+            headers['Sec-WebSocket-Extensions'] = 'permessage-deflate'
+
+        resp, sock, _ = self.ws.upgrade(headers=headers)
+
+        assert resp['status'] == 101, 'status'
+
+        if deflate:
+            assert 'Sec-WebSocket-Extensions' in resp['headers'], 'deflate'
+
+        sock.setblocking(True)
+
+        return sock
+
+    def command(self, sock, command):
+        self.ws.frame_write(sock, self.ws.OP_TEXT, command)
+
+    def text(self, sock, decomp=None):
+        frame = self.ws.frame_read(sock)
+
+        assert frame['fin'], 'fin'
+        assert frame['rsv1'] == (decomp is not None), 'rsv1'
+
+        if decomp is not None:
+            frame['data'] = decomp.decompress(
+                frame['data'] + b'\x00\x00\xff\xff'
+            )
+
+        return frame['data'].decode()
+
+    def subscribe(self, sock, channel='news', decomp=None):
+        self.command(sock, f'subscribe {channel}')
+
+        assert self.text(sock, decomp) == 'subscribed'
+
+    def no_frames(self, sock):
+        assert self.recvall(sock, read_timeout=0.2) == b'', 'no frames'
+
+    def test_websocket_channels_publish(self):
+        sock1 = self.connect()
+        sock2 = self.connect()
+        sock3 = self.connect()
+
+        self.subscribe(sock1)
+        self.subscribe(sock2)
+        self.subscribe(sock3, 'other')
+
+        self.command(sock3, 'publish news hello')
+
+        assert self.text(sock1) == 'hello'
+        assert self.text(sock2) == 'hello'
+        self.no_frames(sock3)
+
+        self.command(sock2, 'unsubscribe news')
+        assert self.text(sock2) == 'unsubscribed'
+
+        self.command(sock3, 'publish news again')
+
+        assert self.text(sock1) == 'again'
+        self.no_frames(sock2)
+
+        self.command(sock1, 'publish other world')
+
+        assert self.text(sock3) == 'world'
+        self.no_frames(sock1)
+
+    def test_websocket_channels_applications(self):
+        sock_a = self.connect()
+        sock_b = self.connect('b')
+
+        self.subscribe(sock_a)
+        self.subscribe(sock_b)
+
+        self.command(sock_a, 'publish news from-a')
+
+        assert self.text(sock_a) == 'from-a'
+        self.no_frames(sock_b)
+
+        self.command(sock_b, 'publish news from-b')
+
+        assert self.text(sock_b) == 'from-b'
+        self.no_frames(sock_a)
+
+    def test_websocket_channels_fragmented(self):
+        sock1 = self.connect()
+        sock2 = self.connect()
+
+        self.subscribe(sock1)
+
+        self.command(sock1, 'begin first')
+
+        frame = self.ws.frame_read(sock1)
+        assert not frame['fin'] and frame['data'] == b'first', 'fragment'
+
+        self.command(sock2, 'publish news hello')
+
+        self.no_frames(sock1)
+
+        self.command(sock1, 'end last')
+
+        frame = self.ws.frame_read(sock1)
+        assert frame['opcode'] == self.ws.OP_CONT, 'continuation'
+        assert frame['fin'] and frame['data'] == b'last', 'last fragment'
+
+        assert self.text(sock1) == 'hello'
+
+    def test_websocket_channels_deflate(self):
+        assert 'success' in self.conf(
+            {'keepalive_interval': 0, 'permessage_deflate': {'threshold': 0}},
+            'settings/http/websocket',
+        )
+
+        decomp = zlib.decompressobj(-zlib.MAX_WBITS)
+
+        sock1 = self.connect(deflate=True)
+        sock2 = self.connect()
+
+        self.subscribe(sock1, decomp=decomp)
+        self.subscribe(sock2)
+
+        message = 'hello ' * 16
+
+        self.command(sock2, f'publish news {message}')
+
+        assert self.text(sock1, decomp) == message, 'compressed'
+        assert self.text(sock2) == message, 'plain'
+
+        self.command(sock2, f'publish news {message}')
+
+        assert self.text(sock1, decomp) == message, 'context'
+        assert self.text(sock2) == message, 'plain 2'
+
+    def test_websocket_channels_queue_limit(self):
+        sock1 = self.connect()
+        sock2 = self.connect()
+
+        self.subscribe(sock1)
+
+        self.command(sock1, 'begin first')
+        assert self.ws.frame_read(sock1)['data'] == b'first', 'fragment'
+
+        self.command(sock2, 'flood news 40 32768')
+
+        assert (
+            self.wait_for_record(r'published frames pending, closing')
+            is not None
+        ), 'queue limit'
+
+        self.recvall(sock1, read_timeout=5)
+
+        sock1.setblocking(False)
+        assert sock1.recv(4096) == b'', 'closed'
+
+        self.subscribe(sock2)
+
+        self.command(sock2, 'publish news alive')
+
+        assert self.text(sock2) == 'alive'
@@ -0,0 +1,46 @@
+import json
+import socket
+
+from unit.http import TestHTTP
+from unit.option import option
+
+http = TestHTTP()
+
+TCP_ULP = 31
+
+
+def check_kernel_tls():
+    with socket.create_server(('127.0.0.1', 0)) as server:
+        with socket.create_connection(server.getsockname()) as sock:
+            try:
+                sock.setsockopt(socket.IPPROTO_TCP, TCP_ULP, b'tls')
+            except OSError:
+                return False
+
+    return True
+
+
+def check_ktls():
+    available = option.available
+
+    if 'openssl' not in available['modules'] or not check_kernel_tls():
+        return
+
+    # "ktls" goes first to be validated before the missing certificate.
+
+    resp = http.put(
+        url='/config/listeners',
+        sock_type='unix',
+        addr=f'{option.temp_dir}/control.unit.sock',
+        body=json.dumps(
+            {
+                "*:7080": {
+                    "pass": "routes",
+                    "tls": {"ktls": True, "certificate": "ktls"},
+                }
+            }
+        ),
+    )
+
+    if 'without the "ktls"' not in resp['body']:
+        available['features']['ktls'] = True
@@ -46,6 +46,10 @@ class TestControl(TestHTTP):
     def conf_post(self, conf, url):
         return self.post(**self._get_args(url, conf))['body']
 
+    @args_handler
+    def conf_patch(self, conf, url):
+        return self.http('PATCH', **self._get_args(url, conf))['body']
+
     def _get_args(self, url, conf=None):
         args = {
             'url': url,
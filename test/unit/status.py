@@ -6,15 +6,48 @@ class Status:
     control = TestControl()
 
     def _check_zeros():
-        assert Status.control.conf_get('/status') == {
+        status = Status.control.conf_get('/status')
+
+        # Configuration reloads are counted since the router start.
+        status.pop('configuration', None)
+
+        assert status == {
             'connections': {
                 'accepted': 0,
                 'active': 0,
                 'idle': 0,
                 'closed': 0,
+                'tls': 0,
+                'ktls': 0,
+                'tls_handshakes': {
+                    'queued': 0,
+                    'latency': {
+                        'count': 0,
+                        'sum': 0,
+                        'buckets': {
+                            le: 0
+                            for le in [
+                                '5',
+                                '10',
+                                '25',
+                                '50',
+                                '100',
+                                '250',
+                                '500',
+                                '1000',
+                                '2500',
+                                '5000',
+                                '10000',
+                                '+Inf',
+                            ]
+                        },
+                    },
+                },
             },
             'requests': {'total': 0},
             'applications': {},
+            'listeners': {},
+            'routes': {},
         }
 
     def init(status=None):
@@ -30,6 +63,8 @@ class Status:
                     for k in d1
                     if k in d2
                 }
+            elif isinstance(d1, list) and isinstance(d2, list):
+                return [find_diffs(v1, v2) for v1, v2 in zip(d1, d2)]
             else:
                 return d1 - d2
 
@@ -40,6 +75,6 @@ class Status:
         diff = Status.diff()
 
         for p in path:
-            diff = diff[p]
+            diff = diff[int(p)] if isinstance(diff, list) else diff[p]
 
         return diff